@@ -17,11 +17,16 @@
  */
 
 #include "Endpoint.hpp"
+#include "OfflineBuffer.hpp"
+#include "ReconnectBackoff.hpp"
+#include "TlsOptions.hpp"
 
 #include <is/core/runtime/Search.hpp>
 
 #include <chrono>
+#include <mutex>
 #include <thread>
+#include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
 #include <websocketpp/config/asio_client.hpp>
@@ -46,8 +51,40 @@ namespace eprosima
                 const std::string YamlAuthKey = "authentication";
                 const std::string YamlJwtTokenKey = "jwt_secret";
 
+                const std::string YamlReconnectKey = "reconnect";
+                const std::string YamlOfflineBufferKey = "offline_buffer";
+
                 using namespace std::chrono_literals;
 
+                // Upper bound for spin_once to block while no connection event arrives
+                const std::chrono::milliseconds MaxSpinWait(100);
+
+                // TODO(MXG) Make this timeout parameter something that can be
+                // configured by users
+                const std::chrono::milliseconds ShutdownTimeout(10000);
+
+                //==============================================================================
+                /**
+                 * @brief Types and log label of each kind of client, so that the connection handlers
+                 *        are instantiated once per transport instead of branching on every call.
+                 */
+                template <typename ClientType>
+                struct ClientTransport;
+
+                template <>
+                struct ClientTransport<TlsClient>
+                {
+                    using ConnectionPtr = TlsConnectionPtr;
+                    static constexpr const char *name = "TLS";
+                };
+
+                template <>
+                struct ClientTransport<TcpClient>
+                {
+                    using ConnectionPtr = TcpConnectionPtr;
+                    static constexpr const char *name = "TCP";
+                };
+
                 //==============================================================================
                 std::string parse_hostname(
                     const YAML::Node &configuration)
@@ -60,6 +97,16 @@ namespace eprosima
                     return DefaultHostname;
                 }
 
+                //==============================================================================
+                static TlsOptions default_client_tls_options()
+                {
+                    // Clients keep to TLS 1.2, as they always did, unless told otherwise
+                    TlsOptions options;
+                    options.min_version = "1.2";
+                    options.max_version = "1.2";
+                    return options;
+                }
+
                 //==============================================================================
                 /**
                  * @class Client
@@ -73,7 +120,7 @@ namespace eprosima
                 {
                 public:
                     Client()
-                        : Endpoint("is::sh::WebSocket::Client"), _host_uri("<undefined>"), _closing_down(false), _connection_failed(false)
+                        : Endpoint("is::sh::WebSocket::Client"), _host_uri("<undefined>"), _closing_down(false), _connection_failed(false), _reconnect_due(false)
                     {
                         // Do nothing
                     }
@@ -90,6 +137,11 @@ namespace eprosima
                             return nullptr;
                         }
 
+                        if (!parse_reconnection(configuration))
+                        {
+                            return nullptr;
+                        }
+
                         const std::string hostname = parse_hostname(configuration);
                         const YAML::Node auth_node = configuration[YamlAuthKey];
                         if (auth_node)
@@ -97,6 +149,19 @@ namespace eprosima
                             _load_auth_config(auth_node);
                         }
 
+                        if (const YAML::Node tls_node = configuration[YamlTlsKey])
+                        {
+                            std::string error;
+                            if (!parse_tls_options(tls_node, _tls_options, error))
+                            {
+                                _logger << utils::Logger::Level::ERROR
+                                        << "Invalid '" << YamlTlsKey << "' settings '" << tls_node
+                                        << "': " << error << std::endl;
+
+                                return nullptr;
+                            }
+                        }
+
                         const std::vector<std::string> extra_ca = [&]()
                         {
                             std::vector<std::string> _extra_ca;
@@ -139,6 +204,11 @@ namespace eprosima
                             return nullptr;
                         }
 
+                        if (!parse_reconnection(configuration))
+                        {
+                            return nullptr;
+                        }
+
                         const std::string hostname = parse_hostname(configuration);
 
                         const YAML::Node auth_node = configuration[YamlAuthKey];
@@ -164,6 +234,52 @@ namespace eprosima
                         return _tcp_client.get();
                     }
 
+                    bool parse_reconnection(
+                        const YAML::Node &configuration)
+                    {
+                        if (const YAML::Node reconnect_node = configuration[YamlReconnectKey])
+                        {
+                            ReconnectOptions options;
+                            std::string error;
+                            if (!parse_reconnect_options(reconnect_node, options, error))
+                            {
+                                _logger << utils::Logger::Level::ERROR
+                                        << "Invalid '" << YamlReconnectKey << "' settings '" << reconnect_node
+                                        << "': " << error << std::endl;
+
+                                return false;
+                            }
+
+                            _backoff = ReconnectBackoff(options);
+                        }
+
+                        if (const YAML::Node offline_buffer_node = configuration[YamlOfflineBufferKey])
+                        {
+                            OfflineBufferOptions options;
+                            std::string error;
+                            if (!parse_offline_buffer_options(offline_buffer_node, options, error))
+                            {
+                                _logger << utils::Logger::Level::ERROR
+                                        << "Invalid '" << YamlOfflineBufferKey << "' settings '" << offline_buffer_node
+                                        << "': " << error << std::endl;
+
+                                return false;
+                            }
+
+                            if (options.max_messages > 0)
+                            {
+                                _logger << utils::Logger::Level::DEBUG
+                                        << "Holding up to " << options.max_messages
+                                        << (options.latest_only ? " topics" : " publications")
+                                        << " while the server does not listen to them" << std::endl;
+                            }
+
+                            enable_offline_buffer(options);
+                        }
+
+                        return true;
+                    }
+
                     bool configure_client(
                         const std::string &hostname,
                         const uint16_t port,
@@ -173,7 +289,25 @@ namespace eprosima
                         _host_uri = uri_prefix + hostname + ":" + std::to_string(port);
 
                         _context = std::make_shared<SslContext>(
-                            boost::asio::ssl::context::tlsv12);
+                            boost::asio::ssl::context::tls_client);
+
+                        if (_use_security)
+                        {
+                            std::string error;
+                            if (!apply_tls_options(*_context, _tls_options, TlsRole::CLIENT, error))
+                            {
+                                _logger << utils::Logger::Level::ERROR
+                                        << "Failed to apply the '" << YamlTlsKey << "' settings: "
+                                        << error << std::endl;
+
+                                return false;
+                            }
+
+                            if (_tls_options.resume_sessions)
+                            {
+                                _session_cache.attach(*_context);
+                            }
+                        }
 
                         boost::system::error_code ec;
                         _context->set_default_verify_paths(ec);
@@ -258,193 +392,174 @@ namespace eprosima
                             return false;
                         }
 
-                        if (_use_security)
-                        {
-                            _logger << utils::Logger::Level::DEBUG
-                                    << "Initializing TLS client" << std::endl;
+                        bool initialized = false;
+                        with_transport(
+                            [this, &initialized](auto &client)
+                            {
+                                using ClientType = std::decay_t<decltype(client)>;
 
-                            initialize_tls_client();
-                        }
-                        else
-                        {
-                            _logger << utils::Logger::Level::DEBUG
-                                    << "Initializing TCP client" << std::endl;
+                                _logger << utils::Logger::Level::DEBUG
+                                        << "Initializing " << ClientTransport<ClientType>::name << " client" << std::endl;
 
-                            initialize_tcp_client();
-                        }
+                                initialized = this->initialize_client(client);
+                            });
 
-                        return true;
+                        return initialized;
                     }
 
-                    void initialize_tls_client()
+                    /**
+                     * @returns `false` if the dedicated metrics port could not be listened on.
+                     */
+                    template <typename ClientType>
+                    bool initialize_client(
+                        ClientType &client)
                     {
-                        _tls_client->clear_access_channels(
+                        client.clear_access_channels(
                             websocketpp::log::alevel::frame_header |
                             websocketpp::log::alevel::frame_payload);
 
-                        _tls_client->init_asio();
-                        _tls_client->start_perpetual();
+                        client.init_asio();
+                        client.start_perpetual();
+                        if (!initialize_metrics(client))
+                        {
+                            return false;
+                        }
 
-                        _tls_client->set_message_handler(
-                            [&](ConnectionHandlePtr handle, TlsMessagePtr message)
+                        client.set_message_handler(
+                            [this](ConnectionHandlePtr handle, typename ClientType::message_ptr message)
                             {
-                                this->_handle_tls_message(std::move(handle), std::move(message));
+                                this->_handle_message<ClientType>(handle, message);
                             });
 
-                        _tls_client->set_close_handler(
-                            [&](ConnectionHandlePtr handle)
+                        client.set_close_handler(
+                            [this](ConnectionHandlePtr handle)
                             {
-                                this->_handle_close(std::move(handle));
+                                this->_handle_close<ClientType>(handle);
                             });
 
-                        _tls_client->set_open_handler(
-                            [&](ConnectionHandlePtr handle)
+                        client.set_open_handler(
+                            [this](ConnectionHandlePtr handle)
                             {
-                                this->_handle_opening(std::move(handle));
+                                this->_handle_opening<ClientType>(handle);
                             });
 
-                        _tls_client->set_fail_handler(
-                            [&](ConnectionHandlePtr handle)
+                        client.set_fail_handler(
+                            [this](ConnectionHandlePtr handle)
                             {
                                 this->_handle_failed_connection(std::move(handle));
                             });
 
-                        _tls_client->set_tls_init_handler(
-                            [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
-                            {
-                                return this->_context;
-                            });
+                        if constexpr (std::is_same_v<ClientType, TlsClient>)
+                        {
+                            client.set_tls_init_handler(
+                                [this](ConnectionHandlePtr /*handle*/) -> SslContextPtr
+                                {
+                                    return this->_context;
+                                });
 
-                        _tls_client->set_socket_init_handler(
-                            [&](ConnectionHandlePtr handle, auto & /*sock*/)
-                            {
-                                this->_handle_socket_init(std::move(handle));
-                            });
+                            client.set_socket_init_handler(
+                                [this](ConnectionHandlePtr handle, auto &sock)
+                                {
+                                    // Offer the session of the previous connection, if there was one
+                                    if (this->_tls_options.resume_sessions)
+                                    {
+                                        this->_session_cache.prepare(sock.native_handle());
+                                    }
+
+                                    this->_handle_socket_init<ClientType>(handle);
+                                });
+                        }
+                        else
+                        {
+                            client.set_socket_init_handler(
+                                [this](ConnectionHandlePtr handle, auto & /*sock*/)
+                                {
+                                    this->_handle_socket_init<ClientType>(handle);
+                                });
+                        }
 
                         _client_thread = std::thread(
-                            [&]()
+                            [&client]()
                             {
-                                this->_tls_client->run();
+                                client.run();
                             });
+
+                        return true;
                     }
 
-                    void initialize_tcp_client()
+                    template <typename ClientType>
+                    bool initialize_metrics(
+                        ClientType &client)
                     {
-                        _tcp_client->clear_access_channels(
-                            websocketpp::log::alevel::frame_header |
-                            websocketpp::log::alevel::frame_payload);
-
-                        _tcp_client->init_asio();
-                        _tcp_client->start_perpetual();
-
-                        _tcp_client->set_message_handler(
-                            [&](ConnectionHandlePtr handle, TcpMessagePtr message)
-                            {
-                                this->_handle_tcp_message(std::move(handle), std::move(message));
-                            });
-
-                        _tcp_client->set_close_handler(
-                            [&](ConnectionHandlePtr handle)
-                            {
-                                this->_handle_close(std::move(handle));
-                            });
-
-                        _tcp_client->set_open_handler(
-                            [&](ConnectionHandlePtr handle)
-                            {
-                                this->_handle_opening(std::move(handle));
-                            });
+                        MetricsRegistry *registry = metrics();
+                        if (nullptr == registry)
+                        {
+                            return true;
+                        }
 
-                        _tcp_client->set_fail_handler(
-                            [&](ConnectionHandlePtr handle)
-                            {
-                                this->_handle_failed_connection(std::move(handle));
-                            });
+                        _reconnects = &registry->counter(
+                            "websocket_reconnects_total", "Attempts to connect again to the server.");
 
-                        _tcp_client->set_tcp_init_handler(
-                            [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
-                            {
-                                return this->_context;
-                            });
+                        if constexpr (std::is_same_v<ClientType, TlsClient>)
+                        {
+                            registry->sampled(
+                                "websocket_tls_resumed_sessions_total",
+                                "TLS handshakes which resumed the previous session.",
+                                MetricsRegistry::Type::COUNTER,
+                                [this](MetricsRegistry::Samples &samples)
+                                {
+                                    samples.push_back({{}, static_cast<double>(_session_cache.resumptions())});
+                                });
+                        }
 
-                        _tcp_client->set_socket_init_handler(
-                            [&](ConnectionHandlePtr handle, auto & /*sock*/)
-                            {
-                                this->_handle_socket_init(std::move(handle));
-                            });
+                        if (metrics_port() < 0)
+                        {
+                            // A client does not answer HTTP requests on its own
+                            _logger << utils::Logger::Level::WARN
+                                    << "The metrics of a client are only exported with a '"
+                                    << YamlMetricsPortKey << "' of their own" << std::endl;
+                            return true;
+                        }
 
-                        _client_thread = std::thread(
-                            [&]()
-                            {
-                                this->_tcp_client->run();
-                            });
+                        return start_metrics_server(client.get_io_service());
                     }
 
                     ~Client() override
                     {
                         _closing_down = true;
 
-                        if (_use_security && _tls_connection && _tls_connection->get_state() == websocketpp::session::state::open)
-                        {
-                            _tls_connection->close(websocketpp::close::status::normal, "shutdown");
+                        // The encoding workers send through the connections closed below, and the
+                        // dispatch threads deliver what they receive
+                        stop_workers();
+                        notify_event();
 
-                            // TODO(MXG) Make these timeout parameters something that can be
-                            // configured by users
-                            using namespace std::chrono_literals;
-                            const auto start_time = std::chrono::steady_clock::now();
-                            while (_tls_connection->get_state() != websocketpp::session::state::closed)
+                        with_transport(
+                            [this](auto &client)
                             {
-                                // Check for an update every 1/5 of a second
-                                std::this_thread::sleep_for(200ms);
+                                using ClientType = std::decay_t<decltype(client)>;
 
-                                // Wait no more than 10 seconds total.
-                                if (std::chrono::steady_clock::now() - start_time > 10s)
+                                const auto &connection = this->current_connection<ClientType>();
+                                if (connection && connection->get_state() == websocketpp::session::state::open)
                                 {
-                                    _logger << utils::Logger::Level::WARN
-                                            << " Timed out while waiting for the remote server to "
-                                            << "acknowledge the connection shutdown request" << std::endl;
-                                    break;
-                                }
-                            }
-                        }
-                        else if (!_use_security && _tcp_connection && _tcp_connection->get_state() == websocketpp::session::state::open)
-                        {
-                            _tcp_connection->close(websocketpp::close::status::normal, "shutdown");
+                                    connection->close(websocketpp::close::status::normal, "shutdown");
 
-                            // TODO(MXG) Make these timeout parameters something that can be
-                            // configured by users
-                            using namespace std::chrono_literals;
-                            const auto start_time = std::chrono::steady_clock::now();
-                            while (_tcp_connection->get_state() != websocketpp::session::state::closed)
-                            {
-                                // Check for an update every 1/5 of a second
-                                std::this_thread::sleep_for(200ms);
+                                    // The close handler notifies an event once the connection is closed
+                                    if (!wait_for_event(ShutdownTimeout, [&]()
+                                                        { return connection->get_state() == websocketpp::session::state::closed; }))
+                                    {
+                                        _logger << utils::Logger::Level::WARN
+                                                << "Timed out while waiting for the remote server to "
+                                                << "acknowledge the connection shutdown request" << std::endl;
+                                    }
+                                }
 
-                                // Wait no more than 10 seconds total.
-                                if (std::chrono::steady_clock::now() - start_time > 10s)
+                                if (_client_thread.joinable())
                                 {
-                                    _logger << utils::Logger::Level::WARN
-                                            << "Timed out while waiting for the remote server to "
-                                            << "acknowledge the connection shutdown request" << std::endl;
-                                    break;
+                                    client.stop_perpetual();
+                                    client.stop();
+                                    _client_thread.join();
                                 }
-                            }
-                        }
-
-                        if (_client_thread.joinable())
-                        {
-                            if (_use_security)
-                            {
-                                _tls_client->stop_perpetual();
-                                _tls_client->stop();
-                            }
-                            else
-                            {
-                                _tcp_client->stop_perpetual();
-                                _tcp_client->stop();
-                            }
-                            _client_thread.join();
-                        }
+                            });
                     }
 
                     bool okay() const override
@@ -454,54 +569,49 @@ namespace eprosima
 
                     bool spin_once() override
                     {
-                        const bool attempt_reconnect = ((_use_security && !_tls_connection) ||
-                                                        (!_use_security && !_tcp_connection) || (_use_security && _tls_connection->get_state() == websocketpp::session::state::closed) || (!_use_security && _tcp_connection->get_state() == websocketpp::session::state::closed)) &&
-                                                       (std::chrono::steady_clock::now() - _last_connection_attempt > 2s);
+                        if (_has_spun_once)
+                        {
+                            // Woken up by connection state changes, reconnection timers or the shutdown
+                            wait_for_event(MaxSpinWait);
+                        }
+
+                        const bool attempt_reconnect = _reconnect_due.exchange(false) && !_closing_down;
 
                         if (!_has_spun_once || attempt_reconnect)
                         {
+                            const bool reconnecting = _has_spun_once;
                             _has_spun_once = true;
-
-                            websocketpp::lib::error_code ec;
-                            if (_use_security)
-                            {
-                                _tls_connection = _tls_client->get_connection(_host_uri, ec);
-                            }
-                            else
-                            {
-                                _tcp_connection = _tcp_client->get_connection(_host_uri, ec);
-                            }
-
-                            if (ec)
+                            if (reconnecting && _reconnects != nullptr)
                             {
-                                _logger << utils::Logger::Level::ERROR
-                                        << "Creation of connection handle failed: " << ec.message() << std::endl;
+                                _reconnects->increment();
                             }
-                            else
-                            {
-                                _logger << utils::Logger::Level::DEBUG;
-                                _logger << (_has_spun_once ? "Re" : "") << "connecting with ";
 
-                                if (_use_security)
-                                {
-                                    _logger << "TLS";
-                                    _tls_client->connect(_tls_connection);
-                                }
-                                else
+                            with_transport(
+                                [this, reconnecting](auto &client)
                                 {
-                                    _logger << "TCP";
-                                    _tcp_client->connect(_tcp_connection);
-                                }
+                                    using ClientType = std::decay_t<decltype(client)>;
 
-                                _logger << " client" << std::endl;
-                            }
+                                    auto &connection = this->current_connection<ClientType>();
+                                    websocketpp::lib::error_code ec;
+                                    connection = client.get_connection(_host_uri, ec);
+                                    if (ec)
+                                    {
+                                        _logger << utils::Logger::Level::ERROR
+                                                << "Creation of connection handle failed: " << ec.message() << std::endl;
 
-                            _last_connection_attempt = std::chrono::steady_clock::now();
-                        }
+                                        _schedule_reconnect();
+                                        return;
+                                    }
 
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                                    _logger << utils::Logger::Level::DEBUG
+                                            << (reconnecting ? "Re" : "") << "connecting with "
+                                            << ClientTransport<ClientType>::name << " client" << std::endl;
 
-                        return (_use_security) ? (_tls_connection != nullptr) : (_tcp_connection != nullptr);
+                                    client.connect(connection);
+                                });
+                        }
+
+                        return okay();
                     }
 
                     void runtime_advertisement(
@@ -510,171 +620,167 @@ namespace eprosima
                         const std::string &id,
                         const YAML::Node &configuration) override
                     {
-                        if (_use_security && _tls_connection)
+                        with_transport(
+                            [&](auto &client)
+                            {
+                                using ClientType = std::decay_t<decltype(client)>;
+
+                                const auto &connection = this->current_connection<ClientType>();
+                                if (connection)
+                                {
+                                    connection->send(
+                                        get_encoding().encode_advertise_msg(
+                                            topic, message_type.name(), id, configuration),
+                                        message_opcode());
+                                }
+                            });
+                    }
+
+                private:
+                    /**
+                     * @brief Call a function with the client of the transport in use, so that the operations
+                     *        on the connection are written once and instantiated for both TLS and TCP.
+                     */
+                    template <typename Function>
+                    void with_transport(
+                        Function &&function)
+                    {
+                        if (_use_security)
                         {
-                            _tls_connection->send(
-                                get_encoding().encode_advertise_msg(
-                                    topic, message_type.name(), id, configuration));
+                            if (_tls_client)
+                            {
+                                function(*_tls_client);
+                            }
                         }
-                        else if (!_use_security && _tcp_connection)
+                        else if (_tcp_client)
                         {
-                            _tcp_connection->send(
-                                get_encoding().encode_advertise_msg(
-                                    topic, message_type.name(), id, configuration));
+                            function(*_tcp_client);
                         }
                     }
 
-                private:
-                    void _handle_tls_message(
-                        const ConnectionHandlePtr &handle,
-                        const TlsMessagePtr &message)
+                    /**
+                     * @brief Get the current connection of a transport.
+                     */
+                    template <typename ClientType>
+                    typename ClientTransport<ClientType>::ConnectionPtr &current_connection()
                     {
-                        auto incoming_handle = _tls_client->get_con_from_hdl(handle);
-                        if (incoming_handle != _tls_connection)
+                        if constexpr (std::is_same_v<ClientType, TlsClient>)
                         {
-                            _logger << utils::Logger::Level::ERROR
-                                    << "Handle TLS message: unexpected connection is sending messages: '"
-                                    << incoming_handle.get() << "' vs '" << _tls_connection.get() << "'" << std::endl;
-                            return;
+                            return _tls_connection;
                         }
                         else
                         {
-                            _logger << utils::Logger::Level::INFO
-                                    << "Handle TLS message from connection '" << _tls_connection.get() << "': [[ "
-                                    << message->get_payload() << " ]]" << std::endl;
+                            return _tcp_connection;
                         }
+                    }
 
-                        get_encoding().interpret_websocket_msg(
-                            message->get_payload(), *this, _tls_connection);
+                    /**
+                     * @brief Tell whether a handle is the one of the current connection. The handle points
+                     *        to the connection itself, so the connection need not be looked up.
+                     */
+                    template <typename ClientType>
+                    bool is_current(
+                        const ConnectionHandlePtr &handle)
+                    {
+                        return handle.lock().get() == current_connection<ClientType>().get();
                     }
 
-                    void _handle_tcp_message(
+                    template <typename ClientType>
+                    void _handle_message(
                         const ConnectionHandlePtr &handle,
-                        const TcpMessagePtr &message)
+                        const typename ClientType::message_ptr &message)
                     {
-                        auto incoming_handle = _tcp_client->get_con_from_hdl(handle);
-                        if (incoming_handle != _tcp_connection)
+                        const auto &current = current_connection<ClientType>();
+                        if (!is_current<ClientType>(handle))
                         {
                             _logger << utils::Logger::Level::ERROR
-                                    << "Handle TCP message: unexpected connection is sending messages: '"
-                                    << incoming_handle.get() << "' vs '" << _tcp_connection.get() << "'" << std::endl;
+                                    << "Handle " << ClientTransport<ClientType>::name
+                                    << " message: unexpected connection is sending messages: '"
+                                    << handle.lock().get() << "' vs '" << current.get() << "'" << std::endl;
                             return;
                         }
-                        else
-                        {
-                            /*    _logger << utils::Logger::Level::INFO
-                                        << "Handle TCP message from connection '" << _tcp_connection.get() << "': [[ "
-                                        << message->get_payload() << " ]]" << std::endl;*/
-                        }
 
-                        get_encoding().interpret_websocket_msg(
-                            message->get_payload(), *this, _tcp_connection);
+                        WEBSOCKET_TRACE(_logger, _trace_payloads, utils::Logger::Level::INFO)
+                            << "Handle " << ClientTransport<ClientType>::name << " message from connection '"
+                            << current.get() << "': [[ " << message->get_payload() << " ]]" << std::endl;
+
+                        handle_websocket_msg(message->get_payload(), current);
                     }
 
+                    template <typename ClientType>
                     void _handle_close(
                         const ConnectionHandlePtr &handle)
                     {
-                        if (_use_security)
-                        {
-                            auto closing_connection = _tls_client->get_con_from_hdl(handle);
+                        using Connection = typename ClientTransport<ClientType>::ConnectionPtr::element_type;
 
-                            if (_closing_down)
-                            {
-                                _logger << utils::Logger::Level::INFO << "Closing connection to server." << std::endl;
-                            }
-                            else
-                            {
-                                _logger << utils::Logger::Level::WARN
-                                        << "The connection to the server is closing early. [code "
-                                        << closing_connection->get_remote_close_code() << "] reason: "
-                                        << closing_connection->get_remote_close_reason() << std::endl;
-                            }
+                        // Not necessarily the current connection, if it has been replaced meanwhile
+                        const auto closing_connection = std::static_pointer_cast<Connection>(handle.lock());
+                        if (!closing_connection)
+                        {
+                            return;
+                        }
 
-                            notify_connection_closed(closing_connection);
+                        if (_closing_down)
+                        {
+                            _logger << utils::Logger::Level::INFO << "Closing connection to server." << std::endl;
                         }
                         else
                         {
-                            auto closing_connection = _tcp_client->get_con_from_hdl(handle);
-
-                            if (_closing_down)
-                            {
-                                _logger << utils::Logger::Level::INFO << "Closing connection to server." << std::endl;
-                            }
-                            else
-                            {
-                                _logger << utils::Logger::Level::WARN
-                                        << "The connection to the server is closing early. [code "
-                                        << closing_connection->get_remote_close_code() << "] reason: "
-                                        << closing_connection->get_remote_close_reason() << std::endl;
-                            }
+                            _logger << utils::Logger::Level::WARN
+                                    << "The connection to the server is closing early. [code "
+                                    << closing_connection->get_remote_close_code() << "] reason: "
+                                    << closing_connection->get_remote_close_reason() << std::endl;
 
-                            notify_connection_closed(closing_connection);
+                            _schedule_reconnect();
                         }
+
+                        notify_connection_closed(closing_connection);
                     }
 
+                    template <typename ClientType>
                     void _handle_opening(
                         const ConnectionHandlePtr &handle)
                     {
-                        if (_use_security)
+                        const auto &opened_connection = current_connection<ClientType>();
+                        if (!is_current<ClientType>(handle))
                         {
-                            auto opened_connection = _tls_client->get_con_from_hdl(handle);
-                            if (opened_connection != _tls_connection)
-                            {
-                                _logger << utils::Logger::Level::ERROR
-                                        << "Handle opening: unexpected TLS connection opened: '"
-                                        << opened_connection.get() << "' vs expected '"
-                                        << _tls_connection.get() << "'" << std::endl;
-                                return;
-                            }
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Handle opening: unexpected " << ClientTransport<ClientType>::name
+                                    << " connection opened: '" << handle.lock().get() << "' vs expected '"
+                                    << opened_connection.get() << "'" << std::endl;
+                            return;
+                        }
 
-                            _connection_failed = false;
-                            _logger << utils::Logger::Level::INFO
-                                    << "Handle opening: established TLS connection to host '"
-                                    << _host_uri << "'." << std::endl;
+                        _connection_failed = false;
+                        {
+                            const std::lock_guard<std::mutex> lock(_backoff_mutex);
+                            _backoff.reset();
+                        }
 
-                            notify_connection_opened(opened_connection);
+                        _logger << utils::Logger::Level::INFO
+                                << "Handle opening: established " << ClientTransport<ClientType>::name
+                                << " connection to host '" << _host_uri << "'." << std::endl;
 
-                            if (_jwt_token)
-                            {
-                                std::error_code ec;
-                                opened_connection->add_subprotocol(*_jwt_token, ec);
-                                if (ec)
-                                {
-                                    _logger << utils::Logger::Level::WARN
-                                            << "Handle opening: failed to add TLS subprotocol: "
-                                            << ec.message() << std::endl;
-                                }
-                            }
-                        }
-                        else
+                        if constexpr (std::is_same_v<ClientType, TlsClient>)
                         {
-                            auto opened_connection = _tcp_client->get_con_from_hdl(handle);
-                            if (opened_connection != _tcp_connection)
+                            if (_session_cache.handshake_completed(opened_connection->get_socket().native_handle()))
                             {
-                                _logger << utils::Logger::Level::ERROR
-                                        << "Handle opening: unexpected TCP connection opened: '"
-                                        << opened_connection.get() << "' vs expected '"
-                                        << _tcp_connection.get() << "'" << std::endl;
-                                return;
+                                _logger << utils::Logger::Level::DEBUG
+                                        << "Handle opening: resumed the previous TLS session" << std::endl;
                             }
+                        }
 
-                            _connection_failed = false;
-                            _logger << utils::Logger::Level::INFO
-                                    << "Handle opening: established TCP connection to host '"
-                                    << _host_uri << "'." << std::endl;
-
-                            notify_connection_opened(opened_connection);
+                        notify_connection_opened(opened_connection);
 
-                            if (_jwt_token)
+                        if (_jwt_token)
+                        {
+                            std::error_code ec;
+                            opened_connection->add_subprotocol(*_jwt_token, ec);
+                            if (ec)
                             {
-                                std::error_code ec;
-                                opened_connection->add_subprotocol(*_jwt_token, ec);
-                                if (ec)
-                                {
-                                    _logger << utils::Logger::Level::WARN
-                                            << "Handle opening: failed to add TCP subprotocol: "
-                                            << ec.message() << std::endl;
-                                }
+                                _logger << utils::Logger::Level::WARN
+                                        << "Handle opening: failed to add " << ClientTransport<ClientType>::name
+                                        << " subprotocol: " << ec.message() << std::endl;
                             }
                         }
                     }
@@ -690,21 +796,54 @@ namespace eprosima
                                     << "Failed to establish a connection to the host '" << _host_uri
                                     << "'. We will periodically attempt to reconnect." << std::endl;
                         }
+
+                        _schedule_reconnect();
+                    }
+
+                    void _schedule_reconnect()
+                    {
+                        if (_closing_down)
+                        {
+                            return;
+                        }
+
+                        const auto on_timer = [&](const websocketpp::lib::error_code &ec)
+                        {
+                            if (!ec)
+                            {
+                                _reconnect_due = true;
+                                notify_event();
+                            }
+                        };
+
+                        // Clients which lost the server at once spread their attempts to come back
+                        std::chrono::milliseconds delay;
+                        {
+                            const std::lock_guard<std::mutex> lock(_backoff_mutex);
+                            delay = _backoff.next_delay();
+                        }
+
+                        _logger << utils::Logger::Level::DEBUG
+                                << "Attempting to reconnect to '" << _host_uri << "' in "
+                                << delay.count() << " ms" << std::endl;
+
+                        with_transport(
+                            [&](auto &client)
+                            {
+                                client.set_timer(static_cast<long>(delay.count()), on_timer);
+                            });
                     }
 
+                    template <typename ClientType>
                     void _handle_socket_init(
                         const ConnectionHandlePtr &handle)
                     {
+                        using Connection = typename ClientTransport<ClientType>::ConnectionPtr::element_type;
+
                         if (_jwt_token)
                         {
-                            if (_use_security)
-                            {
-                                auto connection = _tls_client->get_con_from_hdl(handle);
-                                connection->add_subprotocol(*_jwt_token);
-                            }
-                            else
+                            if (const auto connection = std::static_pointer_cast<Connection>(handle.lock()))
                             {
-                                auto connection = _tcp_client->get_con_from_hdl(handle);
                                 connection->add_subprotocol(*_jwt_token);
                             }
                         }
@@ -730,12 +869,18 @@ namespace eprosima
                     std::shared_ptr<TcpClient> _tcp_client;
                     bool _use_security;
                     std::thread _client_thread;
-                    std::chrono::steady_clock::time_point _last_connection_attempt;
                     bool _has_spun_once = false;
                     std::atomic_bool _closing_down;
                     std::atomic_bool _connection_failed;
+                    std::atomic_bool _reconnect_due;
+                    TlsOptions _tls_options = default_client_tls_options();
+                    // Declared before the context, which refers to it
+                    TlsSessionCache _session_cache;
                     SslContextPtr _context;
                     std::unique_ptr<std::string> _jwt_token;
+                    MetricsRegistry::Counter *_reconnects = nullptr;
+                    std::mutex _backoff_mutex;
+                    ReconnectBackoff _backoff;
                 };
 
                 IS_REGISTER_SYSTEM("websocket_client", is::sh::websocket::Client)
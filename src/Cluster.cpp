@@ -0,0 +1,213 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Cluster.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+const std::string YamlNodeIdKey = "node_id";
+const std::string YamlPeersKey = "peers";
+const std::string YamlTokenKey = "token";
+const std::string YamlSecretKey = "secret";
+const std::string YamlReconnectKey = "reconnect_ms";
+const std::string YamlCertAuthoritiesKey = "cert_authorities";
+
+//==============================================================================
+static bool is_peer_address(
+        const std::string& address)
+{
+    const std::size_t colon = address.rfind(':');
+    if (colon == std::string::npos || 0 == colon || colon + 1 == address.size()
+            || address.size() - colon - 1 > 5)
+    {
+        return false;
+    }
+
+    unsigned long port = 0;
+    for (std::size_t i = colon + 1; i < address.size(); ++i)
+    {
+        if (address[i] < '0' || address[i] > '9')
+        {
+            return false;
+        }
+        port = port * 10 + static_cast<unsigned long>(address[i] - '0');
+    }
+
+    return port > 0 && port <= 65535;
+}
+
+//==============================================================================
+bool parse_cluster_options(
+        const YAML::Node& cluster_node,
+        ClusterOptions& options,
+        std::string& error)
+{
+    try
+    {
+        options.node_id = cluster_node[YamlNodeIdKey].as<std::string>(options.node_id);
+        options.token = cluster_node[YamlTokenKey].as<std::string>(options.token);
+        options.secret = cluster_node[YamlSecretKey].as<std::string>(options.secret);
+        options.reconnect_delay = std::chrono::milliseconds(
+            cluster_node[YamlReconnectKey].as<uint32_t>(
+                static_cast<uint32_t>(options.reconnect_delay.count())));
+
+        if (const YAML::Node peers_node = cluster_node[YamlPeersKey])
+        {
+            options.peers = peers_node.as<std::vector<std::string>>();
+        }
+
+        if (const YAML::Node ca_node = cluster_node[YamlCertAuthoritiesKey])
+        {
+            options.cert_authorities = ca_node.as<std::vector<std::string>>();
+        }
+    }
+    catch (const YAML::BadConversion& e)
+    {
+        error = e.what();
+        return false;
+    }
+
+    if (options.peers.empty())
+    {
+        error = "the '" + YamlPeersKey + "' of the cluster are missing";
+        return false;
+    }
+
+    for (const std::string& peer : options.peers)
+    {
+        if (!is_peer_address(peer))
+        {
+            error = "the peer '" + peer + "' is not a 'host:port' address";
+            return false;
+        }
+    }
+
+    if (0 == options.reconnect_delay.count())
+    {
+        error = "the '" + YamlReconnectKey + "' delay must be positive";
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+bool is_trusted_cluster_link(
+        const ClusterOptions& options,
+        const std::string& node_id,
+        const std::string& secret)
+{
+    if (node_id.empty())
+    {
+        return false;
+    }
+
+    if (options.secret.empty())
+    {
+        return std::find(options.peers.begin(), options.peers.end(), node_id) != options.peers.end();
+    }
+
+    // Compared in constant time, so that the secret cannot be guessed byte after byte
+    if (secret.size() != options.secret.size())
+    {
+        return false;
+    }
+
+    unsigned char difference = 0;
+    for (std::size_t i = 0; i < secret.size(); ++i)
+    {
+        difference |= static_cast<unsigned char>(secret[i] ^ options.secret[i]);
+    }
+
+    return 0 == difference;
+}
+
+//==============================================================================
+void ClusterInterest::add_link(
+        const std::shared_ptr<void>& connection)
+{
+    _links.insert(connection);
+}
+
+//==============================================================================
+bool ClusterInterest::remove_link(
+        const std::shared_ptr<void>& connection)
+{
+    return _links.erase(connection) > 0;
+}
+
+//==============================================================================
+bool ClusterInterest::add_listener(
+        const std::string& topic,
+        const std::shared_ptr<void>& connection)
+{
+    if (is_link(connection))
+    {
+        return false;
+    }
+
+    return 1 == ++_listeners[topic];
+}
+
+//==============================================================================
+bool ClusterInterest::remove_listener(
+        const std::string& topic,
+        const std::shared_ptr<void>& connection)
+{
+    if (is_link(connection))
+    {
+        return false;
+    }
+
+    auto it = _listeners.find(topic);
+    if (it == _listeners.end())
+    {
+        return false;
+    }
+
+    if (--it->second > 0)
+    {
+        return false;
+    }
+
+    _listeners.erase(it);
+    return true;
+}
+
+//==============================================================================
+std::vector<std::string> ClusterInterest::topics() const
+{
+    std::vector<std::string> topics;
+    topics.reserve(_listeners.size());
+    for (const auto& entry : _listeners)
+    {
+        topics.push_back(entry.first);
+    }
+
+    return topics;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,183 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__CLUSTER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__CLUSTER_HPP_
+
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * Header which tells the links opened by the other nodes of the cluster from the
+ * connections of the clients, holding the identifier of the node.
+ */
+const std::string ClusterNodeHeader = "X-IS-WebSocket-Cluster-Node";
+
+/**
+ * Header which holds the secret shared by the nodes of the cluster, if they have one.
+ */
+const std::string ClusterSecretHeader = "X-IS-WebSocket-Cluster-Secret";
+
+/**
+ * @brief Settings of the cluster a server belongs to.
+ */
+struct ClusterOptions
+{
+    /**
+     * Unique name of this node. If empty, the host name and the port are used.
+     */
+    std::string node_id;
+
+    /**
+     * Address of every other node, as `host:port`. It may list this very node as well, which
+     * lets every node share the same configuration file.
+     */
+    std::vector<std::string> peers;
+
+    /**
+     * Token presented to the peers which require authentication.
+     */
+    std::string token;
+
+    /**
+     * Secret shared by every node, which the links must present to be trusted as such. If empty,
+     * the links are trusted when their node id is one of the peers.
+     */
+    std::string secret;
+
+    /**
+     * Time to wait before linking again with a peer which could not be reached.
+     */
+    std::chrono::milliseconds reconnect_delay{2000};
+
+    /**
+     * Certificate authorities, besides the default ones, which sign the certificates of the peers.
+     */
+    std::vector<std::string> cert_authorities;
+};
+
+/**
+ * @brief Parses the `cluster` node of the configuration. Missing settings keep their value.
+ *
+ * @param[out] error Why the settings are not valid, if they are not.
+ *
+ * @returns `true` if every setting is valid.
+ */
+bool parse_cluster_options(
+        const YAML::Node& cluster_node,
+        ClusterOptions& options,
+        std::string& error);
+
+/**
+ * @brief Tells whether a connection which claims to be a link from another node of the cluster
+ *        can be trusted as such, since links are neither sent the startup messages nor treated
+ *        as listeners.
+ *
+ * @param[in] node_id The ClusterNodeHeader of its opening handshake.
+ *
+ * @param[in] secret The ClusterSecretHeader of its opening handshake.
+ *
+ * @returns `true` if it presents the secret of the cluster or, without any, if its node id is
+ *          one of the peers.
+ */
+bool is_trusted_cluster_link(
+        const ClusterOptions& options,
+        const std::string& node_id,
+        const std::string& secret);
+
+/**
+ * @class ClusterInterest
+ * @brief Keeps track of the links with the other nodes of the cluster, and of the topics
+ *        which have listeners of their own on this node, since only those must be forwarded.
+ * @details A link is never a listener of its own, so that the interest of the other nodes
+ *          is not announced back to them. It is not thread safe.
+ */
+class ClusterInterest
+{
+public:
+
+    /**
+     * @brief Marks a connection as a link with another node.
+     */
+    void add_link(
+            const std::shared_ptr<void>& connection);
+
+    /**
+     * @returns `true` if the connection was a link.
+     */
+    bool remove_link(
+            const std::shared_ptr<void>& connection);
+
+    bool is_link(
+            const std::shared_ptr<void>& connection) const
+    {
+        return _links.count(connection) > 0;
+    }
+
+    std::size_t links() const
+    {
+        return _links.size();
+    }
+
+    /**
+     * @brief Accounts for a new listener of a topic.
+     *
+     * @returns `true` if it is the first one, so that the interest must be announced.
+     */
+    bool add_listener(
+            const std::string& topic,
+            const std::shared_ptr<void>& connection);
+
+    /**
+     * @brief Accounts for a listener of a topic which is gone.
+     *
+     * @returns `true` if it was the last one, so that the interest must be withdrawn.
+     */
+    bool remove_listener(
+            const std::string& topic,
+            const std::shared_ptr<void>& connection);
+
+    /**
+     * @brief The topics with listeners, to be announced to a node which just linked.
+     */
+    std::vector<std::string> topics() const;
+
+private:
+
+    std::unordered_set<std::shared_ptr<void>> _links;
+    std::unordered_map<std::string, std::size_t> _listeners;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__CLUSTER_HPP_
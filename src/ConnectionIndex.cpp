@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include "ConnectionIndex.hpp"
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+bool ConnectionIndex::add(
+        const std::shared_ptr<void>& connection,
+        const std::string& name)
+{
+    return _names[connection].insert(name).second;
+}
+
+//==============================================================================
+bool ConnectionIndex::remove(
+        const std::shared_ptr<void>& connection,
+        const std::string& name)
+{
+    auto it = _names.find(connection);
+    if (it == _names.end() || 0 == it->second.erase(name))
+    {
+        return false;
+    }
+
+    if (it->second.empty())
+    {
+        _names.erase(it);
+    }
+
+    return true;
+}
+
+//==============================================================================
+std::vector<std::string> ConnectionIndex::take(
+        const std::shared_ptr<void>& connection)
+{
+    const auto it = _names.find(connection);
+    if (it == _names.end())
+    {
+        return {};
+    }
+
+    std::vector<std::string> names(it->second.begin(), it->second.end());
+    _names.erase(it);
+    return names;
+}
+
+//==============================================================================
+std::size_t ConnectionIndex::count(
+        const std::shared_ptr<void>& connection) const
+{
+    const auto it = _names.find(connection);
+    return it == _names.end() ? 0 : it->second.size();
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
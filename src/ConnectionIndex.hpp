@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef _WEBSOCKET_IS_SH__SRC__CONNECTIONINDEX_HPP_
+#define _WEBSOCKET_IS_SH__SRC__CONNECTIONINDEX_HPP_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class ConnectionIndex
+ * @brief Reverse index from each connection to the names, of topics or services, it holds some state
+ *        on, so that the state of a closed connection is cleaned up without visiting every name.
+ * @details It is not thread safe, and is meant to be guarded along with the maps it indexes.
+ */
+class ConnectionIndex
+{
+public:
+
+    /**
+     * @returns `true` if the connection was not indexed under the name yet.
+     */
+    bool add(
+            const std::shared_ptr<void>& connection,
+            const std::string& name);
+
+    /**
+     * @returns `true` if the connection was indexed under the name.
+     */
+    bool remove(
+            const std::shared_ptr<void>& connection,
+            const std::string& name);
+
+    /**
+     * @brief Drops a connection from the index.
+     *
+     * @returns Every name the connection was indexed under.
+     */
+    std::vector<std::string> take(
+            const std::shared_ptr<void>& connection);
+
+    /**
+     * @returns The number of names the connection is indexed under.
+     */
+    std::size_t count(
+            const std::shared_ptr<void>& connection) const;
+
+    /**
+     * @returns The number of connections indexed.
+     */
+    std::size_t connections() const
+    {
+        return _names.size();
+    }
+
+private:
+
+    std::unordered_map<std::shared_ptr<void>, std::unordered_set<std::string>> _names;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__CONNECTIONINDEX_HPP_
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__CONNECTIONREGISTRY_HPP_
+#define _WEBSOCKET_IS_SH__SRC__CONNECTIONREGISTRY_HPP_
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class ConnectionRegistry
+ * @brief Keeps track of the open connections of a *WebSocket* server and the ID assigned to each of them.
+ * @details The registry is copy-on-write: every change publishes a new immutable map, so readers
+ *          just take a snapshot and iterate it without ever blocking the accept and close handlers.
+ *          Writers are serialized among themselves.
+ *
+ * @tparam ConnectionPtr The connection pointer type: `TlsConnectionPtr`, `TcpConnectionPtr` or `UnixConnectionPtr`.
+ */
+template<typename ConnectionPtr>
+class ConnectionRegistry
+{
+public:
+
+    /**
+     * @brief Immutable view of the registered connections, mapped to their ID.
+     */
+    using Map = std::unordered_map<ConnectionPtr, uint16_t>;
+    using Snapshot = std::shared_ptr<const Map>;
+
+    /**
+     * @brief Constructor.
+     */
+    ConnectionRegistry()
+        : _connections(std::make_shared<const Map>())
+        , _counter(0)
+    {
+    }
+
+    /**
+     * @brief Registers a new connection.
+     *
+     * @param[in] connection The connection to be added.
+     *
+     * @returns The ID assigned to the connection. If it was already registered, its current ID.
+     */
+    uint16_t add(
+            const ConnectionPtr& connection)
+    {
+        const std::lock_guard<std::mutex> lock(_writer_mutex);
+        const Snapshot current = std::atomic_load(&_connections);
+
+        const auto it = current->find(connection);
+        if (it != current->end())
+        {
+            return it->second;
+        }
+
+        auto updated = std::make_shared<Map>(*current);
+        const uint16_t id = ++_counter;
+        updated->emplace(connection, id);
+        std::atomic_store(&_connections, Snapshot(std::move(updated)));
+
+        return id;
+    }
+
+    /**
+     * @brief Unregisters a connection.
+     *
+     * @param[in] connection The connection to be removed.
+     *
+     * @param[out] id The ID that the connection had, if it was registered.
+     *
+     * @returns `true` if the connection was registered, or `false` otherwise.
+     */
+    bool remove(
+            const ConnectionPtr& connection,
+            uint16_t& id)
+    {
+        const std::lock_guard<std::mutex> lock(_writer_mutex);
+        const Snapshot current = std::atomic_load(&_connections);
+
+        const auto it = current->find(connection);
+        if (it == current->end())
+        {
+            return false;
+        }
+
+        id = it->second;
+        auto updated = std::make_shared<Map>(*current);
+        updated->erase(connection);
+        std::atomic_store(&_connections, Snapshot(std::move(updated)));
+
+        return true;
+    }
+
+    /**
+     * @brief Gets the current set of connections. This never blocks.
+     */
+    Snapshot snapshot() const
+    {
+        return std::atomic_load(&_connections);
+    }
+
+    /**
+     * @brief Gets the ID of a connection.
+     *
+     * @returns The ID of the connection, or `0` if it is not registered.
+     */
+    uint16_t id_of(
+            const ConnectionPtr& connection) const
+    {
+        const Snapshot current = snapshot();
+        const auto it = current->find(connection);
+        return it == current->end() ? 0 : it->second;
+    }
+
+    /**
+     * @brief Gets the number of registered connections.
+     */
+    std::size_t size() const
+    {
+        return snapshot()->size();
+    }
+
+private:
+
+    Snapshot _connections;
+    std::mutex _writer_mutex;
+    uint16_t _counter;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__CONNECTIONREGISTRY_HPP_
@@ -0,0 +1,158 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "DispatchQueue.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+DispatchQueue::DispatchQueue(
+        const Options& options)
+    : _options(options)
+    , _ring(std::max<std::size_t>(options.capacity, 1))
+    , _head(0)
+    , _size(0)
+    , _dropped(0)
+    , _dispatched(0)
+    , _stopping(false)
+{
+    _thread = std::thread(&DispatchQueue::run, this);
+}
+
+//==============================================================================
+DispatchQueue::~DispatchQueue()
+{
+    stop();
+}
+
+//==============================================================================
+bool DispatchQueue::push(
+        Task task)
+{
+    bool queued = true;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        if (_stopping)
+        {
+            ++_dropped;
+            return false;
+        }
+
+        if (_size == _ring.size())
+        {
+            ++_dropped;
+            if (OverflowPolicy::DROP_OLDEST != _options.policy)
+            {
+                return false;
+            }
+
+            _ring[_head] = nullptr;
+            _head = (_head + 1) % _ring.size();
+            --_size;
+            queued = false;
+        }
+
+        _ring[(_head + _size) % _ring.size()] = std::move(task);
+        ++_size;
+    }
+
+    _cv.notify_one();
+    return queued;
+}
+
+//==============================================================================
+void DispatchQueue::stop()
+{
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        _stopping = true;
+        _dropped += _size;
+        for (; _size > 0; --_size)
+        {
+            _ring[_head] = nullptr;
+            _head = (_head + 1) % _ring.size();
+        }
+    }
+    _cv.notify_one();
+
+    if (_thread.joinable() && _thread.get_id() != std::this_thread::get_id())
+    {
+        _thread.join();
+    }
+}
+
+//==============================================================================
+std::size_t DispatchQueue::depth() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _size;
+}
+
+//==============================================================================
+std::size_t DispatchQueue::dropped() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+}
+
+//==============================================================================
+std::size_t DispatchQueue::dispatched() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _dispatched;
+}
+
+//==============================================================================
+void DispatchQueue::run()
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(_mutex);
+            _cv.wait(lock, [this]()
+                    {
+                        return _stopping || _size > 0;
+                    });
+
+            if (_stopping)
+            {
+                return;
+            }
+
+            task = std::move(_ring[_head]);
+            _ring[_head] = nullptr;
+            _head = (_head + 1) % _ring.size();
+            --_size;
+            ++_dispatched;
+        }
+
+        // Run out of the lock, so that the I/O threads can keep pushing meanwhile
+        task();
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
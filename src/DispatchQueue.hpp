@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__DISPATCHQUEUE_HPP_
+#define _WEBSOCKET_IS_SH__SRC__DISPATCHQUEUE_HPP_
+
+#include "OutboundQueue.hpp"
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class DispatchQueue
+ * @brief Bounded ring of deliveries, run in order by a thread of its own.
+ * @details It hands the publications received for a topic over to the downstream system without
+ *          running its callback on the *WebSocket* I/O threads, so that a slow downstream system
+ *          cannot stall the reads of every connection. Once the ring is full, the OverflowPolicy
+ *          drops either the oldest delivery or the new one; `DISCONNECT` is not supported.
+ */
+class DispatchQueue
+{
+public:
+
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Size of the ring, and the policy applied once it is full.
+     */
+    struct Options
+    {
+        std::size_t capacity = 256;
+        OverflowPolicy policy = OverflowPolicy::DROP_OLDEST;
+    };
+
+    explicit DispatchQueue(
+            const Options& options);
+
+    ~DispatchQueue();
+
+    DispatchQueue(
+            const DispatchQueue&) = delete;
+
+    DispatchQueue& operator =(
+            const DispatchQueue&) = delete;
+
+    /**
+     * @brief Queues a delivery.
+     *
+     * @returns `false` if some delivery was dropped to make room for it, or it was dropped itself.
+     */
+    bool push(
+            Task task);
+
+    /**
+     * @brief Stops the thread once it finishes its current delivery. The deliveries still queued are dropped.
+     */
+    void stop();
+
+    /**
+     * @brief Number of deliveries waiting in the ring.
+     */
+    std::size_t depth() const;
+
+    /**
+     * @brief Number of deliveries dropped due to overflows since the queue was created.
+     */
+    std::size_t dropped() const;
+
+    /**
+     * @brief Number of deliveries run since the queue was created.
+     */
+    std::size_t dispatched() const;
+
+    const Options& options() const
+    {
+        return _options;
+    }
+
+private:
+
+    void run();
+
+    const Options _options;
+
+    mutable std::mutex _mutex;
+    std::condition_variable _cv;
+
+    // Fixed-size ring, so that no allocation happens once it has been filled
+    std::vector<Task> _ring;
+    std::size_t _head;
+    std::size_t _size;
+
+    std::size_t _dropped;
+    std::size_t _dispatched;
+    bool _stopping;
+    std::thread _thread;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__DISPATCHQUEUE_HPP_
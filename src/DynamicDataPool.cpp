@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "DynamicDataPool.hpp"
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+DynamicDataPool::Handle::Handle(
+        DynamicDataPool* pool,
+        std::unique_ptr<xtypes::DynamicData> data,
+        bool recycled)
+    : _pool(pool)
+    , _data(std::move(data))
+    , _recycled(recycled)
+{
+}
+
+//==============================================================================
+DynamicDataPool::Handle::Handle(
+        Handle&& other) noexcept
+    : _pool(other._pool)
+    , _data(std::move(other._data))
+    , _recycled(other._recycled)
+{
+    other._pool = nullptr;
+}
+
+//==============================================================================
+DynamicDataPool::Handle& DynamicDataPool::Handle::operator =(
+        Handle&& other) noexcept
+{
+    if (this != &other)
+    {
+        release();
+        _pool = other._pool;
+        _data = std::move(other._data);
+        _recycled = other._recycled;
+        other._pool = nullptr;
+    }
+    return *this;
+}
+
+//==============================================================================
+DynamicDataPool::Handle::~Handle()
+{
+    release();
+}
+
+//==============================================================================
+void DynamicDataPool::Handle::release()
+{
+    if (nullptr != _pool && _data)
+    {
+        _pool->give_back(std::move(_data));
+    }
+    _pool = nullptr;
+    _data.reset();
+}
+
+//==============================================================================
+DynamicDataPool::DynamicDataPool(
+        const xtypes::DynamicType& type,
+        size_t capacity)
+    : _type(type)
+    , _poolable(poolable(type))
+    , _capacity(capacity)
+{
+}
+
+//==============================================================================
+DynamicDataPool::Handle DynamicDataPool::acquire()
+{
+    if (_poolable)
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        if (!_idle.empty())
+        {
+            std::unique_ptr<xtypes::DynamicData> data = std::move(_idle.back());
+            _idle.pop_back();
+            return Handle(this, std::move(data), true);
+        }
+    }
+
+    return create();
+}
+
+//==============================================================================
+DynamicDataPool::Handle DynamicDataPool::create()
+{
+    return Handle(_poolable ? this : nullptr, std::make_unique<xtypes::DynamicData>(_type), false);
+}
+
+//==============================================================================
+bool DynamicDataPool::poolable(
+        const xtypes::DynamicType& type)
+{
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+        case xtypes::TypeKind::INT_8_TYPE:
+        case xtypes::TypeKind::UINT_8_TYPE:
+        case xtypes::TypeKind::INT_16_TYPE:
+        case xtypes::TypeKind::UINT_16_TYPE:
+        case xtypes::TypeKind::INT_32_TYPE:
+        case xtypes::TypeKind::UINT_32_TYPE:
+        case xtypes::TypeKind::INT_64_TYPE:
+        case xtypes::TypeKind::UINT_64_TYPE:
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+        case xtypes::TypeKind::STRING_TYPE:
+            return true;
+        case xtypes::TypeKind::ARRAY_TYPE:
+            return poolable(static_cast<const xtypes::CollectionType&>(type).content_type());
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            const xtypes::StructType& struct_type = static_cast<const xtypes::StructType&>(type);
+            for (const xtypes::Member& member : struct_type.members())
+            {
+                if (!poolable(member.type()))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            // Sequences and maps change their size, unions their active member, and the rest
+            // of the types are never read by the JsonReader
+            return false;
+    }
+}
+
+//==============================================================================
+size_t DynamicDataPool::idle() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _idle.size();
+}
+
+//==============================================================================
+void DynamicDataPool::give_back(
+        std::unique_ptr<xtypes::DynamicData> data)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    if (_idle.size() < _capacity)
+    {
+        _idle.push_back(std::move(data));
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
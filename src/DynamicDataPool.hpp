@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__DYNAMICDATAPOOL_HPP_
+#define _WEBSOCKET_IS_SH__SRC__DYNAMICDATAPOOL_HPP_
+
+#include <is/core/Message.hpp>
+
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class DynamicDataPool
+ * @brief Pool of already laid out data instances of a single type, so that incoming messages
+ *        do not need to allocate a new instance each time they are read.
+ * @details Only fixed layout types are pooled; that is, structures, arrays, primitives and strings,
+ *          which keep their shape whatever the values are. A recycled instance still holds the values
+ *          of the last message read into it, so it must only be used when every value gets overwritten.
+ *          Instances of any other type are created anew and never recycled.
+ */
+class DynamicDataPool
+{
+public:
+
+    /**
+     * @brief Exclusive handle to an instance of the pool, which gives it back when destroyed.
+     * @details The pool must outlive its handles.
+     */
+    class Handle
+    {
+    public:
+
+        Handle() = default;
+
+        Handle(
+                Handle&& other) noexcept;
+
+        Handle& operator =(
+                Handle&& other) noexcept;
+
+        ~Handle();
+
+        xtypes::DynamicData& operator *() const
+        {
+            return *_data;
+        }
+
+        xtypes::DynamicData* operator ->() const
+        {
+            return _data.get();
+        }
+
+        /**
+         * @brief Tells whether the instance comes from a previous use, and hence holds old values.
+         */
+        bool recycled() const
+        {
+            return _recycled;
+        }
+
+    private:
+
+        friend class DynamicDataPool;
+
+        Handle(
+                DynamicDataPool* pool,
+                std::unique_ptr<xtypes::DynamicData> data,
+                bool recycled);
+
+        void release();
+
+        DynamicDataPool* _pool = nullptr;
+        std::unique_ptr<xtypes::DynamicData> _data;
+        bool _recycled = false;
+    };
+
+    /**
+     * @brief Constructor.
+     *
+     * @param[in] type The type of the instances. It must outlive the pool.
+     *
+     * @param[in] capacity Maximum number of idle instances kept by the pool.
+     */
+    explicit DynamicDataPool(
+            const xtypes::DynamicType& type,
+            size_t capacity = DefaultCapacity);
+
+    /**
+     * @brief Takes an idle instance from the pool, or creates a new one if there is none.
+     */
+    Handle acquire();
+
+    /**
+     * @brief Creates a new instance, holding the default values, that will be given back to the pool.
+     */
+    Handle create();
+
+    /**
+     * @brief Tells whether the instances of a type can be recycled.
+     */
+    static bool poolable(
+            const xtypes::DynamicType& type);
+
+    /**
+     * @brief Number of idle instances, ready to be recycled.
+     */
+    size_t idle() const;
+
+    static constexpr size_t DefaultCapacity = 16;
+
+private:
+
+    void give_back(
+            std::unique_ptr<xtypes::DynamicData> data);
+
+    const xtypes::DynamicType& _type;
+    const bool _poolable;
+    const size_t _capacity;
+
+    // Instances are acquired and given back from every io_service thread of the endpoint.
+    mutable std::mutex _mutex;
+    std::vector<std::unique_ptr<xtypes::DynamicData> > _idle;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__DYNAMICDATAPOOL_HPP_
@@ -23,7 +23,12 @@
 
 #include <yaml-cpp/yaml.h>
 
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
 
 namespace xtypes = eprosima::xtypes;
 
@@ -37,6 +42,31 @@ namespace websocket {
  */
 class Endpoint;
 
+/**
+ * @brief Settings requested by a subscriber in its rosbridge `subscribe` operation.
+ */
+struct SubscribeOptions
+{
+    // Minimum time between the messages sent, in milliseconds. Zero means no limit.
+    uint32_t throttle_rate = 0;
+
+    // Number of the newest messages held while the throttle rate does not allow sending them.
+    uint32_t queue_length = 0;
+
+    // Maximum size of the messages sent; larger ones are split into fragments. Zero means no limit.
+    uint32_t fragment_size = 0;
+};
+
+/**
+ * @brief Identifier of a topic interned by an Encoding.
+ */
+using TopicId = uint32_t;
+
+/**
+ * @brief Identifier of the topics that the Encoding did not intern.
+ */
+constexpr TopicId InvalidTopicId = std::numeric_limits<TopicId>::max();
+
 /**
  * @class Encoding
  *        This interface class defines all the methods that must be implemented
@@ -45,6 +75,10 @@ class Endpoint;
  * @details *eprosima::is::sh::websocket::JsonEncoding*: Encoding implementation for message exchanging using
  *          <a href="https://www.ecma-international.org/wp-content/uploads/ECMA-404_2nd_edition_december_2017.pdf">
  *          JSON</a> format.
+ *          *eprosima::is::sh::websocket::CborEncoding* and *eprosima::is::sh::websocket::MsgPackEncoding*:
+ *          Binary encodings which exchange the same messages as the *JSON* one, using
+ *          <a href="https://www.rfc-editor.org/rfc/rfc8949.html">CBOR</a> and
+ *          <a href="https://msgpack.org/">MessagePack</a> formats, respectively.
  */
 class Encoding
 {
@@ -53,7 +87,8 @@ public:
     /**
      * @brief Interpret an incoming *WebSocket* message.
      *
-     * @param[in] msg The message to be interpreted.
+     * @param[in] msg The message to be interpreted. It is only viewed while the call lasts,
+     *            so it may refer straight to the payload buffer of the *WebSocket* message.
      *
      * @param[in] endpoint The target endpoint which will perform the actions
      *            specified by the message.
@@ -61,7 +96,7 @@ public:
      * @param[in] connection_handle Opaque pointer which identifies the current connection.
      */
     virtual void interpret_websocket_msg(
-            const std::string& msg,
+            std::string_view msg,
             Endpoint& endpoint,
             std::shared_ptr<void> connection_handle) const = 0;
 
@@ -88,6 +123,45 @@ public:
             const std::string& id,
             const xtypes::DynamicData& msg) const = 0;
 
+    /**
+     * @brief Intern the name and type of a topic, so that its messages can be encoded
+     *        without looking them up nor transforming them every time.
+     *
+     * @param[in] topic_name The name of the topic.
+     *
+     * @param[in] topic_type The type name of the topic.
+     *
+     * @returns The identifier of the topic, or InvalidTopicId if the encoding does not intern topics.
+     */
+    virtual TopicId register_topic(
+            const std::string& topic_name,
+            const std::string& topic_type) const
+    {
+        (void)topic_name;
+        (void)topic_type;
+        return InvalidTopicId;
+    }
+
+    /**
+     * @brief Encode a publish message for a topic interned through register_topic().
+     *
+     * @param[in] topic The identifier of the topic. If it is InvalidTopicId,
+     *            the topic is identified by its name and type instead.
+     *
+     * @returns A string representation of the encoded publication message,
+     *          ready to be sent using *WebSocket*.
+     */
+    virtual std::string encode_publication_msg(
+            TopicId topic,
+            const std::string& topic_name,
+            const std::string& topic_type,
+            const std::string& id,
+            const xtypes::DynamicData& msg) const
+    {
+        (void)topic;
+        return encode_publication_msg(topic_name, topic_type, id, msg);
+    }
+
     /**
      * @brief Encode a service response message.
      *
@@ -135,6 +209,26 @@ public:
             const std::string& id,
             const YAML::Node& configuration) const = 0;
 
+    /**
+     * @brief Encode an unsubscription message.
+     *
+     * @param[in] topic_name The name of the topic
+     *            whose subscription will be stopped.
+     *
+     * @param[in] id The subscriber ID. If empty, every subscription of the connection is stopped.
+     *
+     * @returns A string representation of the encoded unsubscription message, or an
+     *          empty string if the encoding does not support it.
+     */
+    virtual std::string encode_unsubscribe_msg(
+            const std::string& topic_name,
+            const std::string& id) const
+    {
+        (void)topic_name;
+        (void)id;
+        return std::string();
+    }
+
     /**
      * @brief Encode an advertisement message.
      *        This step is required prior to publish operation.
@@ -230,6 +324,56 @@ public:
         return false;
     }
 
+    /**
+     * @brief Tells whether the encoded messages are binary data.
+     *
+     * @returns `true` if the messages must be sent using *WebSocket* binary frames,
+     *          or `false` if text frames are to be used.
+     */
+    virtual bool binary() const
+    {
+        return false;
+    }
+
+    /**
+     * @brief Encode an already encoded message as a set of rosbridge `fragment` messages.
+     *
+     * @param[in] message The encoded message.
+     *
+     * @param[in] id The identifier shared by all the fragments.
+     *
+     * @param[in] fragment_size The maximum size of the data carried by each fragment.
+     *
+     * @returns The fragment messages, or an empty vector if the message does not need to be
+     *          fragmented or the encoding does not support fragmentation, so that it
+     *          must be sent whole.
+     */
+    virtual std::vector<std::string> encode_fragment_msgs(
+            const std::string& message,
+            const std::string& id,
+            std::size_t fragment_size) const
+    {
+        (void)message;
+        (void)id;
+        (void)fragment_size;
+        return {};
+    }
+
+    /**
+     * @brief Encode a set of already encoded messages as a single `batch` message.
+     *
+     * @param[in] messages The encoded messages, in the order they must be interpreted.
+     *
+     * @returns The batch message, or an empty string if the encoding does not support batches,
+     *          so that the messages must be sent one by one.
+     */
+    virtual std::string encode_batch_msg(
+            const std::vector<std::string>& messages) const
+    {
+        (void)messages;
+        return std::string();
+    }
+
 };
 
 using EncodingPtr = std::shared_ptr<Encoding>;
@@ -241,6 +385,18 @@ using EncodingPtr = std::shared_ptr<Encoding>;
  */
 EncodingPtr make_json_encoding();
 
+//==============================================================================
+/**
+ * @brief Creates the *CBOR* binary encoding.
+ */
+EncodingPtr make_cbor_encoding();
+
+//==============================================================================
+/**
+ * @brief Creates the *MessagePack* binary encoding.
+ */
+EncodingPtr make_msgpack_encoding();
+
 } //  namespace websocket
 } //  namespace sh
 } //  namespace is
@@ -0,0 +1,154 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "EncodingPipeline.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+EncodingPipeline::EncodingPipeline(
+        const Options& options)
+    : _options(options)
+{
+    const std::size_t threads = std::max<std::size_t>(_options.threads, 1);
+    _workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i)
+    {
+        _workers.push_back(std::make_unique<Worker>());
+    }
+
+    // Started once every worker exists, as they are never moved afterwards
+    for (const std::unique_ptr<Worker>& worker : _workers)
+    {
+        worker->thread = std::thread(&EncodingPipeline::run, this, std::ref(*worker));
+    }
+}
+
+//==============================================================================
+EncodingPipeline::~EncodingPipeline()
+{
+    stop();
+}
+
+//==============================================================================
+bool EncodingPipeline::push(
+        std::size_t key,
+        Task task)
+{
+    Worker& worker = *_workers[key % _workers.size()];
+    bool queued = true;
+    {
+        const std::lock_guard<std::mutex> lock(worker.mutex);
+        if (worker.stopping)
+        {
+            ++_dropped;
+            return false;
+        }
+
+        if (worker.tasks.size() >= std::max<std::size_t>(_options.queue_length, 1))
+        {
+            worker.tasks.pop_front();
+            ++_dropped;
+            queued = false;
+        }
+
+        worker.tasks.push_back(std::move(task));
+    }
+
+    worker.cv.notify_one();
+    return queued;
+}
+
+//==============================================================================
+void EncodingPipeline::stop()
+{
+    for (const std::unique_ptr<Worker>& worker : _workers)
+    {
+        {
+            const std::lock_guard<std::mutex> lock(worker->mutex);
+            worker->stopping = true;
+            _dropped += worker->tasks.size();
+            worker->tasks.clear();
+        }
+        worker->cv.notify_one();
+    }
+
+    for (const std::unique_ptr<Worker>& worker : _workers)
+    {
+        if (worker->thread.joinable())
+        {
+            worker->thread.join();
+        }
+    }
+}
+
+//==============================================================================
+std::size_t EncodingPipeline::pending() const
+{
+    std::size_t pending = 0;
+    for (const std::unique_ptr<Worker>& worker : _workers)
+    {
+        const std::lock_guard<std::mutex> lock(worker->mutex);
+        pending += worker->tasks.size();
+    }
+    return pending;
+}
+
+//==============================================================================
+std::size_t EncodingPipeline::dropped() const
+{
+    return _dropped.load();
+}
+
+//==============================================================================
+void EncodingPipeline::run(
+        Worker& worker)
+{
+    while (true)
+    {
+        Task task;
+        {
+            std::unique_lock<std::mutex> lock(worker.mutex);
+            worker.cv.wait(lock, [&]()
+                    {
+                        return worker.stopping || !worker.tasks.empty();
+                    });
+
+            if (worker.stopping)
+            {
+                return;
+            }
+
+            task = std::move(worker.tasks.front());
+            worker.tasks.pop_front();
+        }
+
+        // Run out of the lock, so that the publisher can keep pushing meanwhile
+        task();
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,126 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__ENCODINGPIPELINE_HPP_
+#define _WEBSOCKET_IS_SH__SRC__ENCODINGPIPELINE_HPP_
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class EncodingPipeline
+ * @brief Pool of workers which encode and send the publications, so that the thread publishing
+ *        them is not held by a slow encoding of any topic.
+ * @details Each task is given a key, such as the hash of its topic, which decides the worker that
+ *          runs it; hence the tasks with the same key run in the order they were pushed, while the
+ *          ones with different keys may run concurrently. Each worker holds up to `queue_length`
+ *          tasks; beyond that, its oldest task is dropped in favour of the new one.
+ */
+class EncodingPipeline
+{
+public:
+
+    using Task = std::function<void()>;
+
+    /**
+     * @brief Size of the pool.
+     */
+    struct Options
+    {
+        std::size_t threads = 0;
+        std::size_t queue_length = 1024;
+    };
+
+    explicit EncodingPipeline(
+            const Options& options);
+
+    ~EncodingPipeline();
+
+    EncodingPipeline(
+            const EncodingPipeline&) = delete;
+
+    EncodingPipeline& operator =(
+            const EncodingPipeline&) = delete;
+
+    /**
+     * @brief Queues a task for the worker in charge of its key.
+     *
+     * @returns `false` if the queue of the worker was full, so that its oldest task was dropped,
+     *          or if the pipeline is stopped, so that the task was.
+     */
+    bool push(
+            std::size_t key,
+            Task task);
+
+    /**
+     * @brief Stops the workers once they finish their current task. The tasks still queued are dropped.
+     */
+    void stop();
+
+    /**
+     * @brief Number of tasks waiting for their worker.
+     */
+    std::size_t pending() const;
+
+    /**
+     * @brief Number of tasks dropped since the pipeline was created.
+     */
+    std::size_t dropped() const;
+
+    const Options& options() const
+    {
+        return _options;
+    }
+
+private:
+
+    struct Worker
+    {
+        mutable std::mutex mutex;
+        std::condition_variable cv;
+        std::deque<Task> tasks;
+        bool stopping = false;
+        std::thread thread;
+    };
+
+    void run(
+            Worker& worker);
+
+    const Options _options;
+    std::vector<std::unique_ptr<Worker>> _workers;
+    std::atomic<std::size_t> _dropped{0};
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__ENCODINGPIPELINE_HPP_
@@ -18,7 +18,11 @@
 
 #include "Endpoint.hpp"
 
+#include <algorithm>
 #include <cstdlib>
+#include <limits>
+#include <tuple>
+#include <type_traits>
 
 #include <is/json-xtypes/conversion.hpp>
 
@@ -31,6 +35,15 @@ namespace eprosima
             namespace websocket
             {
 
+                // Period of the retries for handing the messages held by a send queue to its connection
+                const long SendQueueFlushIntervalMs = 10;
+
+                // Time after which a service call without response is given up, unless configured otherwise
+                const std::chrono::milliseconds DefaultServiceTimeout(60000);
+
+                // Size of the publications held while offline beyond which a batch is not extended any further
+                constexpr std::size_t OfflineBatchMaxBytes = 65536;
+
                 //==============================================================================
                 struct CallHandle
                 {
@@ -38,6 +51,7 @@ namespace eprosima
                     std::string request_type;
                     std::string reply_type;
                     std::string id;
+                    uint32_t fragment_size;
                     std::shared_ptr<void> connection_handle;
                 };
 
@@ -47,6 +61,7 @@ namespace eprosima
                     std::string request_type,
                     std::string reply_type,
                     std::string id,
+                    uint32_t fragment_size,
                     std::shared_ptr<void> connection_handle)
                 {
                     return std::make_shared<CallHandle>(
@@ -54,13 +69,14 @@ namespace eprosima
                                    std::move(request_type),
                                    std::move(reply_type),
                                    std::move(id),
+                                   fragment_size,
                                    std::move(connection_handle)});
                 }
 
                 //==============================================================================
                 Endpoint::Endpoint(
                     const std::string &name)
-                    : _logger(name), _next_service_call_id(1)
+                    : _logger(name)
                 {
                     // Do nothing
                 }
@@ -88,11 +104,25 @@ namespace eprosima
 
                             _encoding = make_json_encoding();
                         }
+                        else if (encoding_str == YamlEncoding_Cbor)
+                        {
+                            _logger << utils::Logger::Level::DEBUG
+                                    << "Using CBOR encoding" << std::endl;
+
+                            _encoding = make_cbor_encoding();
+                        }
+                        else if (encoding_str == YamlEncoding_MsgPack)
+                        {
+                            _logger << utils::Logger::Level::DEBUG
+                                    << "Using MessagePack encoding" << std::endl;
+
+                            _encoding = make_msgpack_encoding();
+                        }
                         else
                         {
                             _logger << utils::Logger::Level::ERROR
                                     << "Unknown encoding type was requested: '"
-                                    << _encoding << "'" << std::endl;
+                                    << encoding_str << "'" << std::endl;
 
                             return false;
                         }
@@ -114,6 +144,113 @@ namespace eprosima
                         return false;
                     }
 
+                    if (const YAML::Node send_queue_node = configuration[YamlSendQueueKey])
+                    {
+                        if (!parse_send_queue(send_queue_node, _send_queue_options))
+                        {
+                            return false;
+                        }
+                    }
+
+                    if (const YAML::Node fragment_buffer_node = configuration[YamlFragmentBufferKey])
+                    {
+                        if (!parse_fragment_buffer(fragment_buffer_node, _fragment_limits))
+                        {
+                            return false;
+                        }
+                    }
+
+                    if (const YAML::Node compression_node = configuration[YamlCompressionKey])
+                    {
+                        if (!parse_compression(compression_node, _compression_threshold))
+                        {
+                            return false;
+                        }
+                    }
+
+                    if (const YAML::Node pipeline_node = configuration[YamlEncodingPipelineKey])
+                    {
+                        EncodingPipeline::Options pipeline_options;
+                        if (!parse_encoding_pipeline(pipeline_node, pipeline_options))
+                        {
+                            return false;
+                        }
+
+                        if (pipeline_options.threads > 0)
+                        {
+                            _logger << utils::Logger::Level::DEBUG
+                                    << "Encoding the publications with " << pipeline_options.threads
+                                    << " threads, holding up to " << pipeline_options.queue_length
+                                    << " publications each" << std::endl;
+
+                            _encoding_pipeline = std::make_unique<EncodingPipeline>(pipeline_options);
+                        }
+                    }
+
+                    if (const YAML::Node startup_batch_node = configuration[YamlStartupBatchKey])
+                    {
+                        try
+                        {
+                            if (startup_batch_node.as<bool>())
+                            {
+                                // Each connection gets the advertisements in a few frames rather than one by one
+                                _startup_messages = StartupMessages(
+                                    [this](const std::vector<std::string> &messages)
+                                    {
+                                        return _encoding->encode_batch_msg(messages);
+                                    });
+                            }
+                        }
+                        catch (const YAML::BadConversion &e)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Could not parse a boolean value for the '" << YamlStartupBatchKey
+                                    << "' setting '" << startup_batch_node << "': " << e.what() << std::endl;
+
+                            return false;
+                        }
+                    }
+
+                    if (const YAML::Node trace_node = configuration[YamlTracePayloadsKey])
+                    {
+                        try
+                        {
+                            _trace_payloads = trace_node.as<bool>();
+                        }
+                        catch (const YAML::BadConversion &e)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Could not parse a boolean value for the '" << YamlTracePayloadsKey
+                                    << "' setting '" << trace_node << "': " << e.what() << std::endl;
+
+                            return false;
+                        }
+                    }
+
+                    if (const YAML::Node metrics_node = configuration[YamlMetricsKey])
+                    {
+                        bool metrics_enabled = false;
+                        if (!parse_metrics(metrics_node, metrics_enabled))
+                        {
+                            return false;
+                        }
+
+                        if (metrics_enabled)
+                        {
+                            _logger << utils::Logger::Level::DEBUG
+                                    << "Exporting the metrics on path '" << _metrics_path << "'" << std::endl;
+
+                            _metrics = std::make_unique<MetricsRegistry>();
+                            _encode_seconds = &_metrics->histogram(
+                                "websocket_encode_seconds", "Time spent encoding each publication.");
+                            _decode_seconds = &_metrics->histogram(
+                                "websocket_decode_seconds", "Time spent interpreting each message received.");
+                            _received_bytes = &_metrics->counter(
+                                "websocket_received_bytes_total", "Bytes of the messages received.");
+                            register_sampled_metrics();
+                        }
+                    }
+
                     bool success = false;
 
                     if (configuration["security"] && configuration["security"].as<std::string>() == "none")
@@ -122,7 +259,7 @@ namespace eprosima
                                 << "Security disabled, creating TCP endpoint..." << std::endl;
 
                         _use_security = false;
-                        _tcp_endpoint = std::make_shared<TcpEndpoint>(configure_tcp_endpoint(types, configuration));
+                        _tcp_endpoint = configure_tcp_endpoint(types, configuration);
 
                         success = _tcp_endpoint != nullptr;
                     }
@@ -132,7 +269,7 @@ namespace eprosima
                                 << "Security enabled, creating TLS endpoint..." << std::endl;
 
                         _use_security = true;
-                        _tls_endpoint = std::make_shared<TlsEndpoint>(configure_tls_endpoint(types, configuration));
+                        _tls_endpoint = configure_tls_endpoint(types, configuration);
 
                         success = _tls_endpoint != nullptr;
                     }
@@ -158,13 +295,43 @@ namespace eprosima
 
                     _encoding->add_type(message_type, message_type.name());
 
-                    _startup_messages.emplace_back(
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+
+                    _startup_messages.set(
+                        "subscribe:" + topic_name,
                         _encoding->encode_subscribe_msg(
                             topic_name, message_type.name(), "", configuration));
 
                     TopicSubscribeInfo &info = _topic_subscribe_info[topic_name];
                     info.type = message_type.name();
                     info.callback = callback;
+                    if (_metrics)
+                    {
+                        info.received = &_metrics->counter(
+                            "websocket_received_messages_total", "Publications received, per topic.",
+                            {{"topic", topic_name}});
+                    }
+
+                    if (const YAML::Node dispatch_node = configuration[YamlDispatchKey])
+                    {
+                        bool dispatched = false;
+                        DispatchQueue::Options dispatch_options;
+                        if (!parse_dispatch(dispatch_node, dispatched, dispatch_options))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "The publications received on topic '" << topic_name
+                                    << "' will be delivered from the I/O threads" << std::endl;
+                        }
+                        else if (dispatched && !info.dispatcher)
+                        {
+                            _logger << utils::Logger::Level::DEBUG
+                                    << "Dispatching the publications received on topic '" << topic_name
+                                    << "' from a thread of their own, holding up to "
+                                    << dispatch_options.capacity << " of them" << std::endl;
+
+                            info.dispatcher = std::make_shared<DispatchQueue>(dispatch_options);
+                        }
+                    }
 
                     return true;
                 }
@@ -217,7 +384,9 @@ namespace eprosima
 
                     // add to connection msgs so the other side knowns we have these services
                     // also, by executing encode_advertise_service_msg we add the types to the services
-                    _startup_messages.emplace_back(
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                    _startup_messages.set(
+                        "advertise_service:" + service_name,
                         _encoding->encode_advertise_service_msg(service_name, request_type.name(), reply_type.name(), "", configuration));
 
                     return true;
@@ -254,9 +423,14 @@ namespace eprosima
                             << "Creating service server proxy for service '" << service_name
                             << "' with service type '" << service_type.name() << "'" << std::endl;
 
-                    ServiceProviderInfo &info = _service_provider_info[service_name];
-                    info.req_type = service_type.name();
-                    info.configuration = configuration;
+                    {
+                        const std::lock_guard<std::mutex> lock(_service_provider_mutex);
+                        ServiceProviderInfo &info = _service_provider_info[service_name];
+                        info.req_type = service_type.name();
+                        info.configuration = configuration;
+                        _service_timeouts[service_name] = parse_service_timeout(service_name, configuration);
+                        configure_service_providers(service_name, configuration, info.providers);
+                    }
 
                     return make_service_provider(service_name, *this);
                 }
@@ -273,10 +447,15 @@ namespace eprosima
                             << "' with request type '" << request_type.name()
                             << "' and reply type '" << reply_type.name() << "'" << std::endl;
 
-                    ServiceProviderInfo &info = _service_provider_info[service_name];
-                    info.req_type = request_type.name();
-                    info.reply_type = reply_type.name();
-                    info.configuration = configuration;
+                    {
+                        const std::lock_guard<std::mutex> lock(_service_provider_mutex);
+                        ServiceProviderInfo &info = _service_provider_info[service_name];
+                        info.req_type = request_type.name();
+                        info.reply_type = reply_type.name();
+                        info.configuration = configuration;
+                        _service_timeouts[service_name] = parse_service_timeout(service_name, configuration);
+                        configure_service_providers(service_name, configuration, info.providers);
+                    }
 
                     _encoding->add_type(request_type, request_type.name());
                     _encoding->add_type(reply_type, reply_type.name());
@@ -291,64 +470,247 @@ namespace eprosima
                     const std::string &id,
                     const YAML::Node &configuration)
                 {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+
                     TopicPublishInfo &info = _topic_publish_info[topic];
                     info.type = message_type.name();
+                    info.topic_id = _encoding->register_topic(topic, info.type);
+                    info.policy = _send_queue_options.policy;
+                    info.sent = make_sent_counters(topic);
+
+                    const YAML::Node send_queue_node = configuration[YamlSendQueueKey];
+                    if (send_queue_node && send_queue_node.IsMap())
+                    {
+                        const std::string policy = send_queue_node[YamlSendQueuePolicyKey].as<std::string>("");
+                        if (!policy.empty() && !parse_overflow_policy(policy, info.policy))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Unknown send queue policy '" << policy << "' for topic '"
+                                    << topic << "', using the default one" << std::endl;
+                        }
+                    }
+
+                    info.compression_threshold = _compression_threshold;
+                    if (const YAML::Node compression_node = configuration[YamlCompressionKey])
+                    {
+                        if (!parse_compression(compression_node, info.compression_threshold))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Using the default compression settings for topic '" << topic << "'" << std::endl;
+                            info.compression_threshold = _compression_threshold;
+                        }
+                    }
+
+                    if (const YAML::Node batch_node = configuration[YamlBatchKey])
+                    {
+                        bool batched = false;
+                        PublicationBatcher::Options batch_options;
+                        if (!parse_batch(batch_node, batched, batch_options))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "The publications on topic '" << topic << "' will not be batched" << std::endl;
+                        }
+                        else if (batched)
+                        {
+                            _logger << utils::Logger::Level::DEBUG
+                                    << "Batching the publications on topic '" << topic << "' every "
+                                    << batch_options.window.count() << " ms, up to "
+                                    << batch_options.max_messages << " messages" << std::endl;
+
+                            PublicationBatcher::Hooks hooks;
+                            hooks.send = [this, topic](std::vector<std::string> &&publications)
+                            {
+                                publish_batch(topic, std::move(publications));
+                            };
+                            hooks.schedule = [this](std::chrono::milliseconds delay, std::function<void()> flush)
+                            {
+                                set_timer(delay, std::move(flush));
+                            };
+
+                            info.batcher = std::make_shared<PublicationBatcher>(batch_options, std::move(hooks));
+                        }
+                    }
 
-                    _startup_messages.emplace_back(
+                    _startup_messages.set(
+                        "advertise:" + topic,
                         _encoding->encode_advertise_msg(
                             topic, message_type.name(), id, configuration));
                 }
 
+                //==============================================================================
+                void Endpoint::startup_retraction(
+                    const std::string &topic)
+                {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                    if (_startup_messages.remove("advertise:" + topic))
+                    {
+                        _logger << utils::Logger::Level::DEBUG
+                                << "The idle topic '" << topic << "' is no longer advertised to new connections"
+                                << std::endl;
+                    }
+                }
+
                 //==============================================================================
                 bool Endpoint::publish(
                     const std::string &topic,
                     const xtypes::DynamicData &message)
                 {
-                    const TopicPublishInfo &info = _topic_publish_info.at(topic);
+                    if (!_encoding_pipeline)
+                    {
+                        return encode_and_publish(topic, message);
+                    }
 
-                    // If no one is listening, then don't bother publishing
-                    if (info.listeners.empty())
                     {
-                        return true;
+                        // Spares the copy of the message if no one is listening
+                        const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                        if (_topic_publish_info.at(topic).listeners.empty() && !_offline_buffer.enabled())
+                        {
+                            return true;
+                        }
                     }
 
-                    for (const auto &v_handle : info.listeners)
+                    // The message belongs to the caller, so the worker encodes a copy of it.
+                    // Publications on the same topic go to the same worker, which keeps their order.
+                    if (!_encoding_pipeline->push(
+                            std::hash<std::string>()(topic),
+                            [this, topic, copy = xtypes::DynamicData(message)]()
+                            {
+                                encode_and_publish(topic, copy);
+                            }))
                     {
-                        std::string payload;
-                        ErrorCode ec;
+                        _logger << utils::Logger::Level::WARN
+                                << "The encoding pipeline is full, dropped the oldest publication"
+                                << " queued along with topic '" << topic << "'" << std::endl;
+                    }
+
+                    return true;
+                }
+
+                //==============================================================================
+                bool Endpoint::encode_and_publish(
+                    const std::string &topic,
+                    const xtypes::DynamicData &message,
+                    bool from_cluster)
+                {
+                    TopicId topic_id;
+                    std::string topic_type;
+                    OverflowPolicy policy;
+                    std::size_t compression_threshold;
+                    TopicCounters sent;
+                    PublicationBatcherPtr batcher;
+                    std::vector<std::tuple<OutboundQueuePtr, SubscriptionThrottlePtr, uint32_t>> listeners;
+                    bool offline = false;
+                    {
+                        const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                        auto it = _topic_publish_info.find(topic);
 
-                        if (_use_security)
+                        // If no one is listening, then don't bother publishing, unless it is held for later
+                        if (it == _topic_publish_info.end()
+                            || (it->second.listeners.empty() && !_offline_buffer.enabled()))
                         {
-                            auto connection_handle = _tls_endpoint->get_con_from_hdl(v_handle.first);
+                            return true;
+                        }
 
-                            payload = _encoding->encode_publication_msg(topic, info.type, "", message);
-                            if (!payload.empty())
-                            {
-                                ec = connection_handle->send(payload);
-                            }
+                        const TopicPublishInfo &info = it->second;
+                        offline = info.listeners.empty();
+
+                        topic_id = info.topic_id;
+                        if (InvalidTopicId == topic_id)
+                        {
+                            topic_type = info.type;
                         }
-                        else
+                        policy = info.policy;
+                        compression_threshold = info.compression_threshold;
+                        sent = info.sent;
+                        listeners.reserve(info.listeners.size());
+                        bool batched_listeners = false;
+                        for (const auto &v_handle : info.listeners)
                         {
-                            auto connection_handle = _tcp_endpoint->get_con_from_hdl(v_handle.first);
+                            if (from_cluster && _cluster->is_link(v_handle.first))
+                            {
+                                // Every node forwards the publications of its own, so they never loop
+                                continue;
+                            }
 
-                            payload = _encoding->encode_publication_msg(topic, info.type, "", message);
-                            if (!payload.empty())
+                            if (info.batcher && !v_handle.second.throttle && !from_cluster)
                             {
-                                ec = connection_handle->send(payload);
+                                // Sent by the batcher along with the next publications
+                                batched_listeners = true;
+                                continue;
                             }
+
+                            listeners.emplace_back(
+                                v_handle.second.queue, v_handle.second.throttle, v_handle.second.fragment_size);
                         }
 
-                        if (ec)
+                        if (listeners.empty() && !batched_listeners && !offline)
                         {
-                            _logger << utils::Logger::Level::ERROR
-                                    << "Failed to send publication on topic '" << topic
-                                    << "', error: " << ec.message() << std::endl;
+                            return true;
                         }
-                        else
+
+                        if (batched_listeners)
+                        {
+                            batcher = info.batcher;
+                        }
+                    }
+
+                    // Encode the publication only once: every listener gets the very same bytes,
+                    // so they can all share a single immutable message buffer.
+                    std::string payload;
+                    {
+                        const MetricsRegistry::ScopedTimer timer(_encode_seconds);
+                        payload = _encoding->encode_publication_msg(topic_id, topic, topic_type, "", message);
+                    }
+
+                    if (payload.empty())
+                    {
+                        return false;
+                    }
+
+                    if (offline)
+                    {
+                        const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                        _offline_buffer.add(topic, std::move(payload));
+
+                        // A listener may have shown up while the publication was being encoded
+                        const TopicPublishInfo &info = _topic_publish_info.at(topic);
+                        if (!info.listeners.empty())
+                        {
+                            send_offline_publications(topic, info);
+                        }
+
+                        return true;
+                    }
+
+                    if (batcher)
+                    {
+                        if (listeners.empty())
+                        {
+                            batcher->add(std::move(payload));
+                            return true;
+                        }
+
+                        batcher->add(payload);
+                    }
+
+                    const TlsMessagePtr ws_message = make_message(std::move(payload), message_opcode());
+
+                    ws_message->set_compressed(ws_message->get_payload().size() >= compression_threshold);
+
+                    for (const auto &[queue, throttle, fragment_size] : listeners)
+                    {
+                        if (throttle)
+                        {
+                            // Sent once the throttle rate of the subscriber allows it
+                            throttle->offer(ws_message);
+                        }
+                        else if (send_fragmented(
+                                     queue, ws_message, policy, fragment_size, "", "publication on topic", topic))
                         {
-                            _logger << utils::Logger::Level::INFO
+                            sent.count(ws_message->get_payload().size());
+                            WEBSOCKET_TRACE(_logger, _trace_payloads, utils::Logger::Level::INFO)
                                     << "Sent publication on topic '" << topic << "': [[ "
-                                    << payload << " ]]" << std::endl;
+                                    << ws_message->get_payload() << " ]]" << std::endl;
                         }
                     }
 
@@ -362,50 +724,118 @@ namespace eprosima
                     ServiceClient &client,
                     std::shared_ptr<void> call_handle)
                 {
-                    std::size_t id = 0;
-                    std::string id_str;
+                    std::string req_type;
+                    YAML::Node configuration;
+                    std::chrono::milliseconds timeout = DefaultServiceTimeout;
                     {
-                        const std::lock_guard<std::mutex> lock(_next_service_call_id_mutex);
-                        id = _next_service_call_id++;
+                        const std::lock_guard<std::mutex> lock(_service_provider_mutex);
+                        const ServiceProviderInfo &provider_info = _service_provider_info.at(service);
+                        req_type = provider_info.req_type;
+                        configuration = provider_info.configuration;
 
-                        id_str = std::to_string(id);
-                        _service_request_info[id_str] = {&client, std::move(call_handle)};
+                        const auto timeout_it = _service_timeouts.find(service);
+                        if (timeout_it != _service_timeouts.end())
+                        {
+                            timeout = timeout_it->second;
+                        }
                     }
 
-                    ServiceProviderInfo &provider_info = _service_provider_info.at(service);
+                    // Kept before sending the request, as the response may arrive right away
+                    const uint64_t id = _service_request_info.add({&client, std::move(call_handle), service});
 
-                    const std::string payload = _encoding->encode_call_service_msg(
-                        service, provider_info.req_type, request,
-                        id_str, provider_info.configuration);
+                    std::string payload = _encoding->encode_call_service_msg(
+                        service, req_type, request, std::to_string(id), configuration);
 
                     if (payload.empty())
                     {
+                        ServiceRequestInfo unanswered;
+                        _service_request_info.take(id, unanswered);
                         return;
                     }
 
-                    ErrorCode ec;
+                    WEBSOCKET_TRACE(_logger, _trace_payloads, utils::Logger::Level::DEBUG)
+                            << "Service request " << id << ":: Calling service '" << service << "' with request type '"
+                            << request.type().name() << "', data: [[ " << payload << " ]]" << std::endl;
 
-                    if (_use_security)
+                    // The call waits while every provider has as many calls in flight as allowed
+                    std::vector<ServiceProviders::Call> ready;
                     {
-                        ec = _tls_endpoint->get_con_from_hdl(provider_info.connection_handle)->send(payload);
+                        const std::lock_guard<std::mutex> lock(_service_provider_mutex);
+                        ServiceProviders &providers = _service_provider_info.at(service).providers;
+                        providers.submit(id, std::move(payload));
+                        ready = providers.take_ready();
                     }
-                    else
+
+                    send_service_calls(service, std::move(ready));
+
+                    if (timeout.count() > 0)
                     {
-                        ec = _tcp_endpoint->get_con_from_hdl(provider_info.connection_handle)->send(payload);
+                        set_timer(
+                            timeout,
+                            [this, id, service]()
+                            {
+                                ServiceRequestInfo expired;
+                                if (_service_request_info.take(id, expired))
+                                {
+                                    _logger << utils::Logger::Level::WARN
+                                            << "Service request " << id << ":: The call to service '" << service
+                                            << "' got no response in time, and a late one will be ignored" << std::endl;
+
+                                    complete_service_call(service, id);
+                                }
+                            });
                     }
+                }
 
-                    if (ec)
+                //==============================================================================
+                void Endpoint::send_service_calls(
+                    const std::string &service_name,
+                    std::vector<ServiceProviders::Call> calls)
+                {
+                    for (ServiceProviders::Call &call : calls)
                     {
-                        _logger << utils::Logger::Level::ERROR
-                                << "Failed to call service '" << service << "' with request type '"
-                                << request.type().name() << "', error: " << ec.message() << std::endl;
+                        const OutboundQueuePtr queue = find_outbound_queue(call.provider);
+                        if (!queue)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Service request " << call.id << ":: Failed to call service '" << service_name
+                                    << "', the provider connection is closed" << std::endl;
+                        }
+                        else if (send_queued(
+                                     queue, make_compressed_message(call.payload), _send_queue_options.policy,
+                                     "request for service", service_name))
+                        {
+                            continue;
+                        }
+
+                        // Dropped right away rather than on its timeout, which frees the slot of the
+                        // provider for the next call waiting for it
+                        ServiceRequestInfo unanswered;
+                        if (_service_request_info.take(call.id, unanswered))
+                        {
+                            complete_service_call(service_name, call.id);
+                        }
                     }
-                    else
+                }
+
+                //==============================================================================
+                void Endpoint::complete_service_call(
+                    const std::string &service_name,
+                    uint64_t id)
+                {
+                    std::vector<ServiceProviders::Call> ready;
                     {
-                        _logger << utils::Logger::Level::DEBUG
-                                << "Service request " << id << ":: Called service '" << service << "' with request type '"
-                                << request.type().name() << "', data: [[ " << payload << " ]]" << std::endl;
+                        const std::lock_guard<std::mutex> lock(_service_provider_mutex);
+                        const auto it = _service_provider_info.find(service_name);
+                        if (it == _service_provider_info.end() || !it->second.providers.complete(id))
+                        {
+                            return;
+                        }
+
+                        ready = it->second.providers.take_ready();
                     }
+
+                    send_service_calls(service_name, std::move(ready));
                 }
 
                 //==============================================================================
@@ -416,51 +846,30 @@ namespace eprosima
                     const auto &call_handle =
                         *static_cast<const CallHandle *>(v_call_handle.get());
 
-                    std::string payload;
-                    ErrorCode ec;
-
-                    if (_use_security)
-                    {
-                        auto connection_handle = _tls_endpoint->get_con_from_hdl(
-                            call_handle.connection_handle);
-
-                        payload = _encoding->encode_service_response_msg(
-                            call_handle.service_name,
-                            call_handle.reply_type,
-                            call_handle.id,
-                            response, true);
+                    const std::string payload = _encoding->encode_service_response_msg(
+                        call_handle.service_name,
+                        call_handle.reply_type,
+                        call_handle.id,
+                        response, true);
 
-                        if (!payload.empty())
-                        {
-                            ec = connection_handle->send(payload);
-                        }
-                    }
-                    else
+                    if (payload.empty())
                     {
-                        auto connection_handle = _tcp_endpoint->get_con_from_hdl(
-                            call_handle.connection_handle);
-
-                        payload = _encoding->encode_service_response_msg(
-                            call_handle.service_name,
-                            call_handle.reply_type,
-                            call_handle.id,
-                            response, true);
-
-                        if (!payload.empty())
-                        {
-                            ec = connection_handle->send(payload);
-                        }
+                        return;
                     }
 
-                    if (ec)
+                    const OutboundQueuePtr queue = find_outbound_queue(call_handle.connection_handle);
+                    if (!queue)
                     {
                         _logger << utils::Logger::Level::ERROR
-                                << "Failed to receive response from service, sent payload: [[ "
-                                << payload << " ]], error: " << ec.message() << std::endl;
+                                << "Failed to receive response from service, the requester connection is closed. "
+                                << "Payload: [[ " << payload << " ]]" << std::endl;
                     }
-                    else
+                    else if (send_fragmented(
+                                 queue, make_compressed_message(payload), _send_queue_options.policy,
+                                 call_handle.fragment_size, call_handle.id,
+                                 "response for service", call_handle.service_name))
                     {
-                        _logger << utils::Logger::Level::DEBUG
+                        WEBSOCKET_TRACE(_logger, _trace_payloads, utils::Logger::Level::DEBUG)
                                 << "Received response from service: [[ " << payload << " ]]" << std::endl;
                     }
                 }
@@ -472,6 +881,8 @@ namespace eprosima
                     const std::string & /*id*/,
                     std::shared_ptr<void> connection_handle)
                 {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+
                     auto it = _topic_subscribe_info.find(topic_name);
                     if (it != _topic_subscribe_info.end())
                     {
@@ -479,6 +890,7 @@ namespace eprosima
                         if (message_type.name() != info.type)
                         {
                             info.blacklist.insert(connection_handle);
+                            _blacklisted_topics.add(connection_handle, topic_name);
 
                             _logger << utils::Logger::Level::WARN
                                     << "A remote connection advertised the topic '" << topic_name
@@ -489,11 +901,25 @@ namespace eprosima
                         }
                         else
                         {
-                            _logger << utils::Logger::Level::INFO
-                                    << "Advertising topic '" << topic_name
-                                    << "' with message type '" << message_type.name() << "'" << std::endl;
+                            const bool unblocked = info.blacklist.erase(connection_handle) > 0;
+                            if (unblocked)
+                            {
+                                _blacklisted_topics.remove(connection_handle, topic_name);
+                            }
 
-                            info.blacklist.erase(connection_handle);
+                            // A topic advertised at runtime as the connection opens also arrives among
+                            // the startup messages of the connection, so it may be advertised twice
+                            if (_advertised_topics.add(connection_handle, topic_name) || unblocked)
+                            {
+                                _logger << utils::Logger::Level::INFO
+                                        << "Advertising topic '" << topic_name
+                                        << "' with message type '" << message_type.name() << "'" << std::endl;
+                            }
+                            else
+                            {
+                                _logger << utils::Logger::Level::DEBUG
+                                        << "The topic '" << topic_name << "' was already advertised" << std::endl;
+                            }
                         }
                     }
                     else
@@ -507,37 +933,88 @@ namespace eprosima
 
                 //==============================================================================
                 void Endpoint::receive_topic_unadvertisement_ws(
-                    const std::string & /*topic_name*/,
+                    const std::string &topic_name,
                     const std::string & /*id*/,
-                    std::shared_ptr<void> /*connection_handle*/)
+                    std::shared_ptr<void> connection_handle)
                 {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                    _advertised_topics.remove(connection_handle, topic_name);
                 }
 
                 //==============================================================================
                 void Endpoint::receive_publication_ws(
-                    const std::string &topic_name,
+                    std::string_view topic_name,
                     const xtypes::DynamicData &message,
                     std::shared_ptr<void> connection_handle)
                 {
                     try
                     {
-                        /* _logger << utils::Logger::Level::DEBUG
-                                 << "Received message on subscriber '" << topic_name
-                                 << "', data: [[ " << json_xtypes::convert(message) << " ]]" << std::endl;*/
+                        WEBSOCKET_TRACE(_logger, _trace_payloads, utils::Logger::Level::DEBUG)
+                            << "Received message on subscriber '" << topic_name
+                            << "', data: [[ " << json_xtypes::convert(message) << " ]]" << std::endl;
+
+                        SubscriptionCallback *callback = nullptr;
+                        std::shared_ptr<DispatchQueue> dispatcher;
+                        // The cluster is only enabled while configuring, so it is checked before locking
+                        bool from_cluster = false;
+                        if (_cluster)
+                        {
+                            const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                            from_cluster = _cluster->is_link(connection_handle);
+                        }
 
-                        auto it = _topic_subscribe_info.find(topic_name);
-                        if (it == _topic_subscribe_info.end())
+                        if (from_cluster)
                         {
+                            // The node which received it already handed it over to its own system
+                            encode_and_publish(std::string(topic_name), message, true);
                             return;
                         }
 
-                        TopicSubscribeInfo &info = it->second;
-                        if (info.blacklist.count(connection_handle) > 0)
                         {
+                            const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+
+                            auto it = _topic_subscribe_info.find(topic_name);
+                            if (it == _topic_subscribe_info.end())
+                            {
+                                return;
+                            }
+
+                            TopicSubscribeInfo &info = it->second;
+                            if (info.blacklist.count(connection_handle) > 0)
+                            {
+                                return;
+                            }
+
+                            callback = info.callback;
+                            dispatcher = info.dispatcher;
+                            if (info.received != nullptr)
+                            {
+                                info.received->increment();
+                            }
+                        }
+
+                        if (dispatcher)
+                        {
+                            // The message only lives during this call, so the dispatch thread delivers a copy
+                            dispatcher->push([this, callback, copy = xtypes::DynamicData(message)]()
+                            {
+                                try
+                                {
+                                    (*callback)(copy, nullptr);
+                                }
+                                catch (const std::exception &exception)
+                                {
+                                    _logger << utils::Logger::Level::ERROR
+                                            << "Failed to deliver a publication with type '" << copy.type().name()
+                                            << "', reason: [[ " << exception.what() << " ]]" << std::endl;
+                                }
+                            });
                             return;
                         }
 
-                        (*info.callback)(message, nullptr);
+                        // The callback is invoked without holding the lock, since the downstream
+                        // system might take a while to process the message.
+                        (*callback)(message, nullptr);
                     }
                     catch (const json_xtypes::UnsupportedType &unsupported)
                     {
@@ -561,8 +1038,20 @@ namespace eprosima
                     const std::string &topic_name,
                     const xtypes::DynamicType *message_type,
                     const std::string &id,
+                    const SubscribeOptions &options,
                     std::shared_ptr<void> connection_handle)
                 {
+                    OutboundQueuePtr queue = find_outbound_queue(connection_handle);
+                    if (!queue)
+                    {
+                        _logger << utils::Logger::Level::WARN
+                                << "Received subscription request for topic '" << topic_name
+                                << "' from a connection which is already closed" << std::endl;
+                        return;
+                    }
+
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+
                     auto insertion = _topic_publish_info.insert(
                         std::make_pair(topic_name, TopicPublishInfo{}));
                     const bool inserted = insertion.second;
@@ -570,6 +1059,9 @@ namespace eprosima
 
                     if (inserted)
                     {
+                        info.policy = _send_queue_options.policy;
+                        info.sent = make_sent_counters(topic_name);
+
                         _logger << utils::Logger::Level::WARN
                                 << "Received subscription request for the topic '" << topic_name
                                 << "', that we are not currently advertising" << std::endl;
@@ -591,7 +1083,29 @@ namespace eprosima
                                 << "', with message type '" << message_type->name() << "'" << std::endl;
                     }
 
-                    info.listeners[connection_handle].insert(id);
+                    auto listener_insertion = info.listeners.emplace(connection_handle, TopicListener{});
+                    TopicListener &listener = listener_insertion.first->second;
+                    listener.ids[id] = options;
+                    listener.queue = std::move(queue);
+                    update_listener(topic_name, info.policy, info.sent, listener);
+
+                    if (!listener_insertion.second)
+                    {
+                        return;
+                    }
+
+                    _listened_topics.add(connection_handle, topic_name);
+                    if (_offline_buffer.enabled())
+                    {
+                        send_offline_publications(topic_name, info);
+                    }
+
+                    if (_cluster && _cluster->add_listener(topic_name, connection_handle))
+                    {
+                        cluster_interest_changed(
+                            topic_name, info.type.empty() && message_type != nullptr ? message_type->name() : info.type,
+                            true);
+                    }
                 }
 
                 //==============================================================================
@@ -600,6 +1114,8 @@ namespace eprosima
                     const std::string &id,
                     std::shared_ptr<void> connection_handle)
                 {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+
                     auto it = _topic_publish_info.find(topic_name);
                     if (it == _topic_publish_info.end())
                     {
@@ -625,25 +1141,36 @@ namespace eprosima
                         // If id is empty, then we should erase this connection as a listener
                         // entirely.
                         info.listeners.erase(lit);
-                        return;
                     }
+                    else
+                    {
+                        auto &listeners = lit->second.ids;
+                        listeners.erase(id);
 
-                    std::unordered_set<std::string> &listeners = lit->second;
-                    listeners.erase(id);
+                        if (!listeners.empty())
+                        {
+                            update_listener(topic_name, info.policy, info.sent, lit->second);
+                            return;
+                        }
 
-                    if (listeners.empty())
-                    {
                         // If no more unique ids are listening from this connection, then
                         // erase it entirely.
                         info.listeners.erase(lit);
                     }
+
+                    _listened_topics.remove(connection_handle, topic_name);
+                    if (_cluster && _cluster->remove_listener(topic_name, connection_handle))
+                    {
+                        cluster_interest_changed(topic_name, info.type, false);
+                    }
                 }
 
                 //==============================================================================
                 void Endpoint::receive_service_request_ws(
-                    const std::string &service_name,
+                    std::string_view service_name,
                     const xtypes::DynamicData &request,
-                    const std::string &id,
+                    std::string_view id,
+                    uint32_t fragment_size,
                     std::shared_ptr<void> connection_handle)
                 {
                     try
@@ -657,17 +1184,15 @@ namespace eprosima
 
                             return;
                         }
-                        else
-                        {
-                            _logger << utils::Logger::Level::DEBUG
-                                    << "Received a service request for service '" << service_name
-                                    << "', data: [[ " << json_xtypes::convert(request) << " ]]" << std::endl;
-                        }
+
+                        WEBSOCKET_TRACE(_logger, _trace_payloads, utils::Logger::Level::DEBUG)
+                            << "Received a service request for service '" << service_name
+                            << "', data: [[ " << json_xtypes::convert(request) << " ]]" << std::endl;
 
                         ClientProxyInfo &info = it->second;
                         (*info.callback)(request, *this,
-                                         make_call_handle(service_name, info.req_type, info.reply_type,
-                                                          id, connection_handle));
+                                         make_call_handle(std::string(service_name), info.req_type, info.reply_type,
+                                                          std::string(id), fragment_size, connection_handle));
                     }
                     catch (const json_xtypes::UnsupportedType &unsupported)
                     {
@@ -686,6 +1211,58 @@ namespace eprosima
                     }
                 }
 
+                //==============================================================================
+                void Endpoint::receive_fragment_ws(
+                    const std::string &id,
+                    const std::string &data,
+                    uint32_t num,
+                    uint32_t total,
+                    std::shared_ptr<void> connection_handle)
+                {
+                    std::shared_ptr<FragmentAssembler> assembler;
+                    {
+                        const std::lock_guard<std::mutex> lock(_connection_mutex);
+                        if (_outbound_queues.count(connection_handle) == 0)
+                        {
+                            // The connection is already closed
+                            return;
+                        }
+
+                        std::shared_ptr<FragmentAssembler> &entry = _fragment_assemblers[connection_handle];
+                        if (!entry)
+                        {
+                            entry = std::make_shared<FragmentAssembler>(_fragment_limits);
+                        }
+                        assembler = entry;
+                    }
+
+                    std::string message;
+                    switch (assembler->add(id, data, num, total, message))
+                    {
+                    case FragmentAssembler::Result::INCOMPLETE:
+                        return;
+
+                    case FragmentAssembler::Result::COMPLETE:
+                        _logger << utils::Logger::Level::DEBUG
+                                << "Reassembled message '" << id << "' from " << total << " fragments" << std::endl;
+
+                        _encoding->interpret_websocket_msg(message, *this, std::move(connection_handle));
+                        return;
+
+                    case FragmentAssembler::Result::INVALID:
+                        _logger << utils::Logger::Level::ERROR
+                                << "Received fragment " << num << " of " << total << " of message '" << id
+                                << "', which does not match the previous fragments of the message" << std::endl;
+                        return;
+
+                    case FragmentAssembler::Result::OVERFLOW:
+                        _logger << utils::Logger::Level::ERROR
+                                << "Discarded fragmented message '" << id << "', as it does not fit in the "
+                                << _fragment_limits.max_bytes << " bytes of the fragment buffer" << std::endl;
+                        return;
+                    }
+                }
+
                 //==============================================================================
                 void Endpoint::receive_service_advertisement_ws(
                     const std::string &service_name,
@@ -698,8 +1275,26 @@ namespace eprosima
                             << "' with request type '" << req_type.name() << "', and reply type '"
                             << reply_type.name() << "'" << std::endl;
 
-                    _service_provider_info[service_name] =
-                        ServiceProviderInfo{req_type.name(), reply_type.name(), connection_handle, YAML::Node{}};
+                    std::vector<ServiceProviders::Call> ready;
+                    {
+                        const std::lock_guard<std::mutex> lock(_service_provider_mutex);
+                        ServiceProviderInfo &info = _service_provider_info[service_name];
+                        info.req_type = req_type.name();
+                        info.reply_type = reply_type.name();
+
+                        // Every connection which advertises the service takes a share of its calls
+                        if (info.providers.add_provider(connection_handle))
+                        {
+                            _provided_services.add(connection_handle, service_name);
+                            _logger << utils::Logger::Level::DEBUG
+                                    << "The service '" << service_name << "' has now "
+                                    << info.providers.providers() << " providers" << std::endl;
+                        }
+
+                        ready = info.providers.take_ready();
+                    }
+
+                    send_service_calls(service_name, std::move(ready));
                 }
 
                 //==============================================================================
@@ -708,6 +1303,8 @@ namespace eprosima
                     const xtypes::DynamicType * /*service_type*/,
                     std::shared_ptr<void> connection_handle)
                 {
+                    const std::lock_guard<std::mutex> lock(_service_provider_mutex);
+
                     auto it = _service_provider_info.find(service_name);
                     if (it == _service_provider_info.end())
                     {
@@ -720,43 +1317,43 @@ namespace eprosima
                     _logger << utils::Logger::Level::DEBUG
                             << "Received unadvertise for service '" << service_name << "'" << std::endl;
 
-                    if (it->second.connection_handle == connection_handle)
+                    if (it->second.providers.remove_provider(connection_handle))
                     {
-                        _service_provider_info.erase(it);
+                        _provided_services.remove(connection_handle, service_name);
                     }
                 }
 
                 //==============================================================================
                 void Endpoint::receive_service_response_ws(
-                    const std::string &service_name,
+                    std::string_view service_name,
                     const xtypes::DynamicData &response,
-                    const std::string &id,
+                    std::string_view id,
                     std::shared_ptr<void> /*connection_handle*/)
                 {
                     try
                     {
-                        auto it = _service_request_info.find(id);
-                        if (it == _service_request_info.end())
+                        // TODO(MXG): We could use the service_name and connection_handle info to
+                        // verify that the service response is coming from the source that we were
+                        // expecting.
+                        ServiceRequestInfo info;
+                        uint64_t call_id = 0;
+                        if (!PendingCalls<ServiceRequestInfo>::parse_id(id, call_id)
+                            || !_service_request_info.take(call_id, info))
                         {
                             _logger << utils::Logger::Level::ERROR
                                     << "A remote connection provided a service response for service '"
-                                    << service_name << "' with an unrecognized id '" << id << "'" << std::endl;
+                                    << service_name << "' with an unrecognized or expired id '" << id << "'" << std::endl;
 
                             return;
                         }
 
-                        // TODO(MXG): We could use the service_name and connection_handle info to
-                        // verify that the service response is coming from the source that we were
-                        // expecting.
-                        ServiceRequestInfo &info = it->second;
+                        complete_service_call(info.service, call_id);
 
-                        _logger << utils::Logger::Level::DEBUG
-                                << "Service response " << id << ":: Receive response for service '" << service_name << "', data: [[ "
-                                << json_xtypes::convert(response) << " ]]" << std::endl;
+                        WEBSOCKET_TRACE(_logger, _trace_payloads, utils::Logger::Level::DEBUG)
+                            << "Service response " << id << ":: Receive response for service '" << service_name << "', data: [[ "
+                            << json_xtypes::convert(response) << " ]]" << std::endl;
 
                         info.client->receive_response(info.call_handle, response);
-
-                        _service_request_info.erase(it);
                     }
                     catch (const json_xtypes::UnsupportedType &unsupported)
                     {
@@ -781,29 +1378,32 @@ namespace eprosima
                     return *_encoding;
                 }
 
+                //==============================================================================
+                websocketpp::frame::opcode::value Endpoint::message_opcode() const
+                {
+                    return _encoding->binary() ?
+                               websocketpp::frame::opcode::binary :
+                               websocketpp::frame::opcode::text;
+                }
+
                 //==============================================================================
                 void Endpoint::notify_connection_opened(
                     const TlsConnectionPtr &connection_handle)
                 {
-                    _logger << utils::Logger::Level::DEBUG
-                            << "TLS connection " << connection_handle << " opened" << std::endl;
-
-                    for (const std::string &msg : _startup_messages)
-                    {
-                        connection_handle->send(msg);
-                    }
+                    open_connection(connection_handle, "TLS");
                 }
 
                 void Endpoint::notify_connection_opened(
                     const TcpConnectionPtr &connection_handle)
                 {
-                    _logger << utils::Logger::Level::DEBUG
-                            << "TCP connection " << connection_handle << " opened" << std::endl;
+                    open_connection(connection_handle, "TCP");
+                }
 
-                    for (const std::string &msg : _startup_messages)
-                    {
-                        connection_handle->send(msg);
-                    }
+                void Endpoint::notify_connection_opened(
+                    const UnixConnectionPtr &connection_handle,
+                    std::function<std::size_t()> pending_bytes)
+                {
+                    open_connection(connection_handle, "Unix socket", std::move(pending_bytes));
                 }
 
                 //==============================================================================
@@ -813,34 +1413,1117 @@ namespace eprosima
                     _logger << utils::Logger::Level::DEBUG
                             << "Connection " << connection_handle << " closed" << std::endl;
 
-                    for (auto &entry : _topic_subscribe_info)
                     {
-                        entry.second.blacklist.erase(connection_handle);
+                        const std::lock_guard<std::mutex> lock(_connection_mutex);
+                        _outbound_queues.erase(connection_handle);
+                        _fragment_assemblers.erase(connection_handle);
+                        _connection_names.erase(connection_handle);
                     }
 
-                    for (auto &entry : _topic_publish_info)
                     {
-                        entry.second.listeners.erase(connection_handle);
-                    }
+                        const std::lock_guard<std::mutex> lock(_topic_info_mutex);
 
-                    std::vector<std::string> lost_services;
-                    lost_services.reserve(_service_provider_info.size());
-                    for (auto &entry : _service_provider_info)
-                    {
-                        if (entry.second.connection_handle == connection_handle)
+                        _advertised_topics.take(connection_handle);
+                        for (const std::string &topic : _blacklisted_topics.take(connection_handle))
+                        {
+                            auto it = _topic_subscribe_info.find(topic);
+                            if (it != _topic_subscribe_info.end())
+                            {
+                                it->second.blacklist.erase(connection_handle);
+                            }
+                        }
+
+                        for (const std::string &topic : _listened_topics.take(connection_handle))
+                        {
+                            auto it = _topic_publish_info.find(topic);
+                            if (it != _topic_publish_info.end() && it->second.listeners.erase(connection_handle) > 0
+                                && _cluster && _cluster->remove_listener(topic, connection_handle))
+                            {
+                                cluster_interest_changed(topic, it->second.type, false);
+                            }
+                        }
+
+                        if (_cluster)
                         {
-                            lost_services.push_back(entry.first);
+                            _cluster->remove_link(connection_handle);
                         }
                     }
 
-                    for (const std::string &s : lost_services)
                     {
-                        _service_provider_info.erase(s);
+                        const std::lock_guard<std::mutex> lock(_service_provider_mutex);
+
+                        // The calls in flight on the connection are given up once their timeout elapses
+                        for (const std::string &service : _provided_services.take(connection_handle))
+                        {
+                            auto it = _service_provider_info.find(service);
+                            if (it != _service_provider_info.end())
+                            {
+                                it->second.providers.remove_provider(connection_handle);
+                            }
+                        }
                     }
 
                     // NOTE(MXG): We'll leave _service_request_info alone, because it's feasible
                     // that the service response might arrive later after the other side has
-                    // reconnected. The downside is this could allow lost services to accumulate.
+                    // reconnected. The calls expire anyway once their timeout elapses.
+
+                    notify_event();
+                }
+
+                //==============================================================================
+                void Endpoint::notify_event()
+                {
+                    {
+                        const std::lock_guard<std::mutex> lock(_event_mutex);
+                        _event_pending = true;
+                    }
+
+                    _event_cv.notify_all();
+                }
+
+                //==============================================================================
+                bool Endpoint::wait_for_event(
+                    const std::chrono::milliseconds &timeout)
+                {
+                    std::unique_lock<std::mutex> lock(_event_mutex);
+                    const bool notified = _event_cv.wait_for(
+                        lock, timeout, [&]()
+                        { return _event_pending; });
+
+                    _event_pending = false;
+                    return notified;
+                }
+
+                //==============================================================================
+                bool Endpoint::parse_send_queue(
+                    const YAML::Node &send_queue_node,
+                    OutboundQueue::Options &options)
+                {
+                    try
+                    {
+                        if (const YAML::Node bytes_node = send_queue_node[YamlSendQueueMaxBufferedBytesKey])
+                        {
+                            options.max_buffered_bytes = bytes_node.as<std::size_t>();
+                        }
+
+                        if (const YAML::Node messages_node = send_queue_node[YamlSendQueueMaxMessagesKey])
+                        {
+                            options.max_messages = messages_node.as<std::size_t>();
+                        }
+                    }
+                    catch (const YAML::BadConversion &e)
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Could not parse the send queue limits '" << send_queue_node
+                                << "': " << e.what() << std::endl;
+
+                        return false;
+                    }
+
+                    if (const YAML::Node policy_node = send_queue_node[YamlSendQueuePolicyKey])
+                    {
+                        const std::string policy = policy_node.as<std::string>("");
+                        if (!parse_overflow_policy(policy, options.policy))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Unknown send queue policy '" << policy << "'. Valid values are "
+                                    << "'drop_oldest', 'drop_newest' and 'disconnect'" << std::endl;
+
+                            return false;
+                        }
+                    }
+
+                    _logger << utils::Logger::Level::DEBUG
+                            << "Send queues hold up to " << options.max_messages << " messages once "
+                            << options.max_buffered_bytes << " bytes are buffered by a connection" << std::endl;
+
+                    return true;
+                }
+
+                //==============================================================================
+                bool Endpoint::parse_compression(
+                    const YAML::Node &compression_node,
+                    std::size_t &threshold)
+                {
+                    try
+                    {
+                        if (compression_node.IsMap())
+                        {
+                            const YAML::Node threshold_node = compression_node[YamlCompressionThresholdKey];
+                            threshold = threshold_node ? threshold_node.as<std::size_t>() : 0;
+                        }
+                        else
+                        {
+                            threshold = compression_node.as<bool>() ? 0 : NeverCompress;
+                        }
+                    }
+                    catch (const YAML::BadConversion &e)
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Could not parse the compression settings '" << compression_node
+                                << "': " << e.what() << std::endl;
+
+                        return false;
+                    }
+
+                    return true;
+                }
+
+                //==============================================================================
+                bool Endpoint::parse_batch(
+                    const YAML::Node &batch_node,
+                    bool &enabled,
+                    PublicationBatcher::Options &options)
+                {
+                    try
+                    {
+                        if (!batch_node.IsMap())
+                        {
+                            enabled = batch_node.as<bool>();
+                            return true;
+                        }
+
+                        enabled = true;
+                        if (const YAML::Node window_node = batch_node[YamlBatchWindowKey])
+                        {
+                            options.window = std::chrono::milliseconds(window_node.as<uint32_t>());
+                        }
+
+                        if (const YAML::Node messages_node = batch_node[YamlBatchMaxMessagesKey])
+                        {
+                            options.max_messages = messages_node.as<std::size_t>();
+                        }
+
+                        if (const YAML::Node bytes_node = batch_node[YamlBatchMaxBytesKey])
+                        {
+                            options.max_bytes = bytes_node.as<std::size_t>();
+                        }
+                    }
+                    catch (const YAML::BadConversion &e)
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Could not parse the batch settings '" << batch_node
+                                << "': " << e.what() << std::endl;
+
+                        return false;
+                    }
+
+                    return true;
+                }
+
+                //==============================================================================
+                bool Endpoint::parse_encoding_pipeline(
+                    const YAML::Node &pipeline_node,
+                    EncodingPipeline::Options &options)
+                {
+                    try
+                    {
+                        if (const YAML::Node threads_node = pipeline_node[YamlEncodingPipelineThreadsKey])
+                        {
+                            options.threads = threads_node.as<std::size_t>();
+                        }
+
+                        if (const YAML::Node queue_length_node = pipeline_node[YamlEncodingPipelineQueueLengthKey])
+                        {
+                            options.queue_length = queue_length_node.as<std::size_t>();
+                        }
+                    }
+                    catch (const YAML::BadConversion &e)
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Could not parse the encoding pipeline settings '" << pipeline_node
+                                << "': " << e.what() << std::endl;
+
+                        return false;
+                    }
+
+                    return true;
+                }
+
+                //==============================================================================
+                void Endpoint::configure_service_providers(
+                    const std::string &service_name,
+                    const YAML::Node &configuration,
+                    ServiceProviders &providers)
+                {
+                    const YAML::Node providers_node = configuration[YamlServiceProvidersKey];
+                    if (!providers_node)
+                    {
+                        return;
+                    }
+
+                    ServiceProvidersOptions options;
+                    std::string error;
+                    if (!parse_service_providers_options(providers_node, options, error))
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Invalid '" << YamlServiceProvidersKey << "' settings of service '"
+                                << service_name << "': " << error << "; the calls go to the least busy provider"
+                                << " without limit" << std::endl;
+
+                        return;
+                    }
+
+                    providers.configure(options);
+                }
+
+                //==============================================================================
+                std::chrono::milliseconds Endpoint::parse_service_timeout(
+                    const std::string &service_name,
+                    const YAML::Node &configuration)
+                {
+                    const YAML::Node timeout_node = configuration[YamlServiceTimeoutKey];
+                    if (!timeout_node)
+                    {
+                        return DefaultServiceTimeout;
+                    }
+
+                    try
+                    {
+                        const int64_t timeout = timeout_node.as<int64_t>();
+                        if (timeout >= 0)
+                        {
+                            return std::chrono::milliseconds(timeout);
+                        }
+                    }
+                    catch (const YAML::BadConversion &)
+                    {
+                        // Reported below
+                    }
+
+                    _logger << utils::Logger::Level::ERROR
+                            << "The '" << YamlServiceTimeoutKey << "' of service '" << service_name
+                            << "' must be a non-negative integer, but '" << timeout_node
+                            << "' was given; using " << DefaultServiceTimeout.count() << " ms" << std::endl;
+
+                    return DefaultServiceTimeout;
+                }
+
+                //==============================================================================
+                bool Endpoint::parse_dispatch(
+                    const YAML::Node &dispatch_node,
+                    bool &enabled,
+                    DispatchQueue::Options &options)
+                {
+                    try
+                    {
+                        if (!dispatch_node.IsMap())
+                        {
+                            enabled = dispatch_node.as<bool>();
+                            return true;
+                        }
+
+                        enabled = true;
+                        if (const YAML::Node queue_length_node = dispatch_node[YamlDispatchQueueLengthKey])
+                        {
+                            options.capacity = queue_length_node.as<std::size_t>();
+                        }
+
+                        const std::string policy = dispatch_node[YamlDispatchPolicyKey].as<std::string>("");
+                        if (!policy.empty() &&
+                            (!parse_overflow_policy(policy, options.policy) || OverflowPolicy::DISCONNECT == options.policy))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Unknown dispatch policy '" << policy
+                                    << "', it must be either 'drop_oldest' or 'drop_newest'" << std::endl;
+
+                            return false;
+                        }
+                    }
+                    catch (const YAML::BadConversion &e)
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Could not parse the dispatch settings '" << dispatch_node
+                                << "': " << e.what() << std::endl;
+
+                        return false;
+                    }
+
+                    return true;
+                }
+
+                //==============================================================================
+                void Endpoint::stop_workers()
+                {
+                    if (_metrics_server)
+                    {
+                        ErrorCode ec;
+                        _metrics_server->stop_listening(ec);
+                    }
+
+                    if (_encoding_pipeline)
+                    {
+                        _encoding_pipeline->stop();
+                    }
+
+                    std::vector<std::shared_ptr<DispatchQueue>> dispatchers;
+                    {
+                        const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                        for (const auto &entry : _topic_subscribe_info)
+                        {
+                            if (entry.second.dispatcher)
+                            {
+                                dispatchers.push_back(entry.second.dispatcher);
+                            }
+                        }
+                    }
+
+                    // Stopped out of the lock, as the deliveries under way might need it
+                    for (const std::shared_ptr<DispatchQueue> &dispatcher : dispatchers)
+                    {
+                        dispatcher->stop();
+                    }
+                }
+
+                //==============================================================================
+                MetricsRegistry *Endpoint::metrics() const
+                {
+                    return _metrics.get();
+                }
+
+                //==============================================================================
+                const std::string &Endpoint::metrics_path() const
+                {
+                    return _metrics_path;
+                }
+
+                //==============================================================================
+                int32_t Endpoint::metrics_port() const
+                {
+                    return _metrics_port;
+                }
+
+                //==============================================================================
+                void Endpoint::handle_websocket_msg(
+                    std::string_view payload,
+                    std::shared_ptr<void> connection_handle)
+                {
+                    if (_received_bytes != nullptr)
+                    {
+                        _received_bytes->increment(payload.size());
+                    }
+
+                    const MetricsRegistry::ScopedTimer timer(_decode_seconds);
+                    _encoding->interpret_websocket_msg(payload, *this, std::move(connection_handle));
+                }
+
+                //==============================================================================
+                template <typename ConnectionPtr>
+                static void serve_metrics_request(
+                    const ConnectionPtr &connection,
+                    const MetricsRegistry *registry,
+                    const std::string &path)
+                {
+                    // The query string, if any, does not matter
+                    const std::string resource = connection->get_resource();
+                    if (nullptr == registry || resource.substr(0, resource.find('?')) != path)
+                    {
+                        connection->set_status(websocketpp::http::status_code::not_found);
+                        return;
+                    }
+
+                    connection->set_status(websocketpp::http::status_code::ok);
+                    connection->append_header("Content-Type", "text/plain; version=0.0.4");
+                    connection->set_body(registry->render());
+                }
+
+                //==============================================================================
+                void Endpoint::serve_metrics(
+                    const TlsConnectionPtr &connection) const
+                {
+                    serve_metrics_request(connection, _metrics.get(), _metrics_path);
+                }
+
+                //==============================================================================
+                void Endpoint::serve_metrics(
+                    const TcpConnectionPtr &connection) const
+                {
+                    serve_metrics_request(connection, _metrics.get(), _metrics_path);
+                }
+
+                //==============================================================================
+                bool Endpoint::start_metrics_server(
+                    boost::asio::io_service &io_service)
+                {
+                    if (!_metrics || _metrics_port < 0)
+                    {
+                        return true;
+                    }
+
+                    _logger << utils::Logger::Level::INFO
+                            << "Exporting the metrics on port " << _metrics_port << std::endl;
+
+                    _metrics_server = std::make_shared<TcpServer>();
+                    _metrics_server->clear_access_channels(websocketpp::log::alevel::all);
+                    _metrics_server->set_reuse_addr(true);
+                    _metrics_server->init_asio(&io_service);
+                    _metrics_server->set_http_handler(
+                        [this](ConnectionHandlePtr handle)
+                        {
+                            serve_metrics(_metrics_server->get_con_from_hdl(handle));
+                        });
+
+                    ErrorCode ec;
+                    _metrics_server->listen(static_cast<uint16_t>(_metrics_port), ec);
+                    if (!ec)
+                    {
+                        _metrics_server->start_accept(ec);
+                    }
+
+                    if (ec)
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Could not export the metrics on port " << _metrics_port
+                                << ": " << ec.message() << std::endl;
+
+                        _metrics_server.reset();
+                        return false;
+                    }
+
+                    return true;
+                }
+
+                //==============================================================================
+                bool Endpoint::parse_metrics(
+                    const YAML::Node &metrics_node,
+                    bool &enabled)
+                {
+                    try
+                    {
+                        if (metrics_node.IsMap())
+                        {
+                            enabled = true;
+                            _metrics_path = metrics_node[YamlMetricsPathKey].as<std::string>(_metrics_path);
+                            if (const YAML::Node port_node = metrics_node[YamlMetricsPortKey])
+                            {
+                                _metrics_port = port_node.as<int32_t>();
+                            }
+                        }
+                        else
+                        {
+                            enabled = metrics_node.as<bool>();
+                        }
+                    }
+                    catch (const YAML::BadConversion &e)
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Could not parse the metrics settings '" << metrics_node
+                                << "': " << e.what() << std::endl;
+
+                        return false;
+                    }
+
+                    if (_metrics_path.empty() || _metrics_path.front() != '/')
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "The metrics path '" << _metrics_path << "' must start with '/'" << std::endl;
+
+                        return false;
+                    }
+
+                    return true;
+                }
+
+                //==============================================================================
+                void Endpoint::register_sampled_metrics()
+                {
+                    _metrics->sampled(
+                        "websocket_send_queue_depth", "Messages waiting to be sent, per connection.",
+                        MetricsRegistry::Type::GAUGE,
+                        [this](MetricsRegistry::Samples &samples)
+                        {
+                            const std::lock_guard<std::mutex> lock(_connection_mutex);
+                            for (const auto &[connection, queue] : _outbound_queues)
+                            {
+                                samples.push_back({{{"connection", _connection_names[connection]}},
+                                                   static_cast<double>(queue->depth())});
+                            }
+                        });
+
+                    _metrics->sampled(
+                        "websocket_send_queue_dropped_total", "Messages dropped by the send queue, per connection.",
+                        MetricsRegistry::Type::COUNTER,
+                        [this](MetricsRegistry::Samples &samples)
+                        {
+                            const std::lock_guard<std::mutex> lock(_connection_mutex);
+                            for (const auto &[connection, queue] : _outbound_queues)
+                            {
+                                samples.push_back({{{"connection", _connection_names[connection]}},
+                                                   static_cast<double>(queue->dropped())});
+                            }
+                        });
+
+                    _metrics->sampled(
+                        "websocket_dispatch_queue_depth", "Received publications waiting to be delivered, per topic.",
+                        MetricsRegistry::Type::GAUGE,
+                        [this](MetricsRegistry::Samples &samples)
+                        {
+                            const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                            for (const auto &[topic, info] : _topic_subscribe_info)
+                            {
+                                if (info.dispatcher)
+                                {
+                                    samples.push_back({{{"topic", topic}}, static_cast<double>(info.dispatcher->depth())});
+                                }
+                            }
+                        });
+
+                    _metrics->sampled(
+                        "websocket_dispatch_queue_dropped_total", "Received publications dropped, per topic.",
+                        MetricsRegistry::Type::COUNTER,
+                        [this](MetricsRegistry::Samples &samples)
+                        {
+                            const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                            for (const auto &[topic, info] : _topic_subscribe_info)
+                            {
+                                if (info.dispatcher)
+                                {
+                                    samples.push_back({{{"topic", topic}}, static_cast<double>(info.dispatcher->dropped())});
+                                }
+                            }
+                        });
+
+                    if (_encoding_pipeline)
+                    {
+                        _metrics->sampled(
+                            "websocket_encoding_pipeline_pending", "Publications waiting to be encoded.",
+                            MetricsRegistry::Type::GAUGE,
+                            [this](MetricsRegistry::Samples &samples)
+                            {
+                                samples.push_back({{}, static_cast<double>(_encoding_pipeline->pending())});
+                            });
+
+                        _metrics->sampled(
+                            "websocket_encoding_pipeline_dropped_total", "Publications dropped before being encoded.",
+                            MetricsRegistry::Type::COUNTER,
+                            [this](MetricsRegistry::Samples &samples)
+                            {
+                                samples.push_back({{}, static_cast<double>(_encoding_pipeline->dropped())});
+                            });
+                    }
+                }
+
+                //==============================================================================
+                Endpoint::TopicCounters Endpoint::make_sent_counters(
+                    const std::string &topic)
+                {
+                    TopicCounters counters;
+                    if (_metrics)
+                    {
+                        counters.messages = &_metrics->counter(
+                            "websocket_sent_messages_total", "Publications sent, per topic.", {{"topic", topic}});
+                        counters.bytes = &_metrics->counter(
+                            "websocket_sent_bytes_total", "Bytes of the publications sent, per topic.",
+                            {{"topic", topic}});
+                    }
+                    return counters;
+                }
+
+                //==============================================================================
+                void Endpoint::publish_batch(
+                    const std::string &topic,
+                    std::vector<std::string> &&publications)
+                {
+                    OverflowPolicy policy;
+                    std::size_t compression_threshold;
+                    TopicCounters sent;
+                    std::vector<std::pair<OutboundQueuePtr, uint32_t>> listeners;
+                    {
+                        const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                        const TopicPublishInfo &info = _topic_publish_info.at(topic);
+
+                        policy = info.policy;
+                        compression_threshold = info.compression_threshold;
+                        sent = info.sent;
+                        for (const auto &v_handle : info.listeners)
+                        {
+                            if (!v_handle.second.throttle)
+                            {
+                                listeners.emplace_back(v_handle.second.queue, v_handle.second.fragment_size);
+                            }
+                        }
+                    }
+
+                    if (listeners.empty())
+                    {
+                        return;
+                    }
+
+                    // A single publication goes as is, and so do all of them if the encoding cannot batch them
+                    std::vector<TlsMessagePtr> ws_messages;
+                    std::string batch = publications.size() > 1 ?
+                        _encoding->encode_batch_msg(publications) : std::string();
+                    if (!batch.empty())
+                    {
+                        ws_messages.push_back(make_message(std::move(batch), message_opcode()));
+                    }
+                    else
+                    {
+                        for (std::string &publication : publications)
+                        {
+                            ws_messages.push_back(make_message(std::move(publication), message_opcode()));
+                        }
+                    }
+
+                    for (const TlsMessagePtr &ws_message : ws_messages)
+                    {
+                        ws_message->set_compressed(ws_message->get_payload().size() >= compression_threshold);
+                    }
+
+                    // A batch frame accounts for all of its publications
+                    const std::size_t publications_per_message = ws_messages.size() == 1 ? publications.size() : 1;
+                    for (const auto &[queue, fragment_size] : listeners)
+                    {
+                        for (const TlsMessagePtr &ws_message : ws_messages)
+                        {
+                            if (send_fragmented(
+                                    queue, ws_message, policy, fragment_size, "", "publication on topic", topic))
+                            {
+                                sent.count(ws_message->get_payload().size(), publications_per_message);
+                            }
+                        }
+                    }
+
+                    _logger << utils::Logger::Level::DEBUG
+                            << "Sent a batch of " << publications.size() << " publications on topic '"
+                            << topic << "' to " << listeners.size() << " listeners" << std::endl;
+                }
+
+                //==============================================================================
+                TlsMessagePtr Endpoint::make_compressed_message(
+                    const std::string &payload) const
+                {
+                    TlsMessagePtr message = make_message(payload, message_opcode());
+                    message->set_compressed(payload.size() >= _compression_threshold);
+                    return message;
+                }
+
+                //==============================================================================
+                bool Endpoint::parse_fragment_buffer(
+                    const YAML::Node &fragment_buffer_node,
+                    FragmentAssembler::Limits &limits)
+                {
+                    try
+                    {
+                        if (const YAML::Node bytes_node = fragment_buffer_node[YamlFragmentBufferMaxBytesKey])
+                        {
+                            limits.max_bytes = bytes_node.as<std::size_t>();
+                        }
+
+                        if (const YAML::Node messages_node = fragment_buffer_node[YamlFragmentBufferMaxMessagesKey])
+                        {
+                            limits.max_messages = messages_node.as<std::size_t>();
+                        }
+                    }
+                    catch (const YAML::BadConversion &e)
+                    {
+                        _logger << utils::Logger::Level::ERROR
+                                << "Could not parse the fragment buffer limits '" << fragment_buffer_node
+                                << "': " << e.what() << std::endl;
+
+                        return false;
+                    }
+
+                    _logger << utils::Logger::Level::DEBUG
+                            << "Fragment buffers hold up to " << limits.max_messages << " messages and "
+                            << limits.max_bytes << " bytes per connection" << std::endl;
+
+                    return true;
+                }
+
+                //==============================================================================
+                template <typename ConnectionPtr>
+                OutboundQueuePtr Endpoint::make_outbound_queue(
+                    const ConnectionPtr &connection,
+                    std::function<std::size_t()> pending_bytes)
+                {
+                    const std::weak_ptr<typename ConnectionPtr::element_type> weak_connection = connection;
+
+                    OutboundQueue::Hooks hooks;
+                    hooks.buffered_amount = [weak_connection, pending_bytes]() -> std::size_t
+                    {
+                        const ConnectionPtr connection = weak_connection.lock();
+                        if (!connection)
+                        {
+                            return 0;
+                        }
+
+                        return connection->get_buffered_amount() + (pending_bytes ? pending_bytes() : 0);
+                    };
+                    hooks.send = [weak_connection](const TlsMessagePtr &message) -> bool
+                    {
+                        const ConnectionPtr connection = weak_connection.lock();
+                        return connection && !connection->send(message);
+                    };
+                    hooks.disconnect = [weak_connection]()
+                    {
+                        if (const ConnectionPtr connection = weak_connection.lock())
+                        {
+                            ErrorCode ec;
+                            connection->close(websocketpp::close::status::policy_violation, "Send queue overflow", ec);
+                        }
+                    };
+                    if constexpr (std::is_same_v<ConnectionPtr, UnixConnectionPtr>)
+                    {
+                        // The iostream transport has no timers, so the endpoint ones are used
+                        hooks.schedule = [this](std::function<void()> flush)
+                        {
+                            set_timer(std::chrono::milliseconds(SendQueueFlushIntervalMs), std::move(flush));
+                        };
+                    }
+                    else
+                    {
+                        hooks.schedule = [weak_connection](std::function<void()> flush)
+                        {
+                            // Servers with several acceptors run each connection on an io_service of its own
+                            if (const ConnectionPtr connection = weak_connection.lock())
+                            {
+                                connection->set_timer(SendQueueFlushIntervalMs, [flush](const ErrorCode &ec)
+                                                      {
+                                                          if (!ec)
+                                                          {
+                                                              flush();
+                                                          }
+                                                      });
+                            }
+                        };
+                    }
+
+                    return std::make_shared<OutboundQueue>(_send_queue_options, std::move(hooks));
+                }
+
+                //==============================================================================
+                template <typename ConnectionPtr>
+                void Endpoint::open_connection(
+                    const ConnectionPtr &connection_handle,
+                    const char *transport,
+                    std::function<std::size_t()> pending_bytes)
+                {
+                    _logger << utils::Logger::Level::DEBUG
+                            << transport << " connection " << connection_handle << " opened" << std::endl;
+
+                    {
+                        const OutboundQueuePtr queue = make_outbound_queue(connection_handle, std::move(pending_bytes));
+                        const std::lock_guard<std::mutex> lock(_connection_mutex);
+                        _outbound_queues[connection_handle] = queue;
+                        if (_metrics)
+                        {
+                            _connection_names[connection_handle] = connection_handle->get_remote_endpoint();
+                        }
+                    }
+
+                    {
+                        const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+
+                        // The other nodes of the cluster only ask for the topics their listeners want
+                        if (!_cluster || !_cluster->is_link(connection_handle))
+                        {
+                            for (const std::string &msg : _startup_messages.frames())
+                            {
+                                connection_handle->send(msg, message_opcode());
+                            }
+                        }
+                    }
+
+                    notify_event();
+                }
+
+                //==============================================================================
+                OutboundQueuePtr Endpoint::find_outbound_queue(
+                    const std::shared_ptr<void> &connection_handle)
+                {
+                    const std::lock_guard<std::mutex> lock(_connection_mutex);
+                    const auto it = _outbound_queues.find(connection_handle);
+                    return it != _outbound_queues.end() ? it->second : nullptr;
+                }
+
+                //==============================================================================
+                bool Endpoint::send_queued(
+                    const OutboundQueuePtr &queue,
+                    const TlsMessagePtr &message,
+                    OverflowPolicy policy,
+                    const char *kind,
+                    const std::string &name)
+                {
+                    switch (queue->push(message, policy))
+                    {
+                    case OutboundQueue::Result::SENT:
+                        return true;
+
+                    case OutboundQueue::Result::QUEUED:
+                        _logger << utils::Logger::Level::DEBUG
+                                << "Queued " << kind << " '" << name << "' as the connection is not keeping up, "
+                                << queue->depth() << " messages waiting to be sent" << std::endl;
+                        return true;
+
+                    case OutboundQueue::Result::DROPPED:
+                        _logger << utils::Logger::Level::WARN
+                                << "Dropped " << kind << " '" << name << "' as the send queue of the connection is full, "
+                                << queue->dropped() << " messages dropped so far" << std::endl;
+                        return false;
+
+                    case OutboundQueue::Result::DISCONNECTED:
+                        _logger << utils::Logger::Level::ERROR
+                                << "Closing the connection, as its send queue overflowed while sending "
+                                << kind << " '" << name << "'" << std::endl;
+                        return false;
+
+                    case OutboundQueue::Result::FAILED:
+                        break;
+                    }
+
+                    _logger << utils::Logger::Level::ERROR
+                            << "Failed to send " << kind << " '" << name << "'" << std::endl;
+                    return false;
+                }
+
+                //==============================================================================
+                bool Endpoint::send_fragmented(
+                    const OutboundQueuePtr &queue,
+                    const TlsMessagePtr &message,
+                    OverflowPolicy policy,
+                    std::size_t fragment_size,
+                    const std::string &id,
+                    const char *kind,
+                    const std::string &name)
+                {
+                    if (0 == fragment_size || message->get_payload().size() <= fragment_size)
+                    {
+                        return send_queued(queue, message, policy, kind, name);
+                    }
+
+                    const std::vector<std::string> fragments = _encoding->encode_fragment_msgs(
+                        message->get_payload(),
+                        id.empty() ? "fragment_" + std::to_string(_next_fragment_id++) : id,
+                        fragment_size);
+
+                    if (fragments.empty())
+                    {
+                        // The encoding does not support fragmentation
+                        return send_queued(queue, message, policy, kind, name);
+                    }
+
+                    for (const std::string &fragment : fragments)
+                    {
+                        // A message missing a fragment is useless, so stop at the first one not sent
+                        const TlsMessagePtr fragment_message = make_message(fragment, message_opcode());
+                        fragment_message->set_compressed(message->get_compressed());
+                        if (!send_queued(queue, fragment_message, policy, kind, name))
+                        {
+                            return false;
+                        }
+                    }
+
+                    return true;
+                }
+
+                //==============================================================================
+                void Endpoint::enable_cluster()
+                {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                    if (!_cluster)
+                    {
+                        _cluster = std::make_unique<ClusterInterest>();
+                    }
+                }
+
+                //==============================================================================
+                void Endpoint::enable_offline_buffer(
+                    const OfflineBufferOptions &options)
+                {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                    _offline_buffer = OfflineBuffer(options);
+                }
+
+                //==============================================================================
+                void Endpoint::send_offline_publications(
+                    const std::string &topic_name,
+                    const TopicPublishInfo &info)
+                {
+                    std::vector<std::string> payloads = _offline_buffer.take(topic_name);
+                    if (payloads.empty())
+                    {
+                        return;
+                    }
+
+                    _logger << utils::Logger::Level::INFO
+                            << "Sending the " << payloads.size() << " publications held on topic '"
+                            << topic_name << "' while no one listened to it" << std::endl;
+
+                    const auto send = [&](std::string payload)
+                    {
+                        const TlsMessagePtr ws_message = make_message(std::move(payload), message_opcode());
+                        ws_message->set_compressed(ws_message->get_payload().size() >= info.compression_threshold);
+
+                        for (const auto &listener : info.listeners)
+                        {
+                            send_fragmented(
+                                listener.second.queue, ws_message, info.policy, listener.second.fragment_size,
+                                "", "held publications on topic", topic_name);
+                        }
+                    };
+
+                    std::vector<std::string> batch;
+                    std::size_t batch_bytes = 0;
+                    const auto flush = [&]()
+                    {
+                        std::string frame = batch.size() > 1 ? _encoding->encode_batch_msg(batch) : std::string();
+                        if (!frame.empty())
+                        {
+                            send(std::move(frame));
+                        }
+                        else
+                        {
+                            // A single publication, or an encoding which cannot batch them, goes as is
+                            for (std::string &payload : batch)
+                            {
+                                send(std::move(payload));
+                            }
+                        }
+
+                        batch.clear();
+                        batch_bytes = 0;
+                    };
+
+                    for (std::string &payload : payloads)
+                    {
+                        batch_bytes += payload.size();
+                        batch.push_back(std::move(payload));
+                        if (batch_bytes >= OfflineBatchMaxBytes)
+                        {
+                            flush();
+                        }
+                    }
+
+                    flush();
+                }
+
+                //==============================================================================
+                void Endpoint::add_cluster_link(
+                    const std::shared_ptr<void> &connection_handle)
+                {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                    _cluster->add_link(connection_handle);
+                }
+
+                //==============================================================================
+                void Endpoint::remove_cluster_link(
+                    const std::shared_ptr<void> &connection_handle)
+                {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                    _cluster->remove_link(connection_handle);
+                }
+
+                //==============================================================================
+                void Endpoint::send_cluster_subscriptions(
+                    const std::function<void(const std::string &)> &send)
+                {
+                    const std::lock_guard<std::mutex> lock(_topic_info_mutex);
+                    for (const std::string &topic : _cluster->topics())
+                    {
+                        const std::string message = _encoding->encode_subscribe_msg(
+                            topic, _topic_publish_info[topic].type, "", YAML::Node());
+                        send(message);
+                    }
+                }
+
+                //==============================================================================
+                void Endpoint::cluster_interest_changed(
+                    const std::string & /*topic_name*/,
+                    const std::string & /*message_type*/,
+                    bool /*interested*/)
+                {
+                    // Only servers belong to clusters
+                }
+
+                //==============================================================================
+                void Endpoint::set_timer(
+                    std::chrono::milliseconds delay,
+                    std::function<void()> callback)
+                {
+                    auto handler = [callback](const ErrorCode &ec)
+                    {
+                        if (!ec)
+                        {
+                            callback();
+                        }
+                    };
+
+                    if (_use_security)
+                    {
+                        _tls_endpoint->set_timer(static_cast<long>(delay.count()), handler);
+                    }
+                    else
+                    {
+                        _tcp_endpoint->set_timer(static_cast<long>(delay.count()), handler);
+                    }
+                }
+
+                //==============================================================================
+                void Endpoint::update_listener(
+                    const std::string &topic_name,
+                    OverflowPolicy policy,
+                    const TopicCounters &sent,
+                    TopicListener &listener)
+                {
+                    uint32_t throttle_rate = std::numeric_limits<uint32_t>::max();
+                    uint32_t queue_length = 0;
+                    uint32_t fragment_size = std::numeric_limits<uint32_t>::max();
+                    for (const auto &subscription : listener.ids)
+                    {
+                        throttle_rate = std::min(throttle_rate, subscription.second.throttle_rate);
+                        queue_length = std::max(queue_length, subscription.second.queue_length);
+                        if (subscription.second.fragment_size > 0)
+                        {
+                            fragment_size = std::min(fragment_size, subscription.second.fragment_size);
+                        }
+                    }
+
+                    if (fragment_size == std::numeric_limits<uint32_t>::max())
+                    {
+                        fragment_size = 0;
+                    }
+
+                    if (fragment_size != listener.fragment_size)
+                    {
+                        // The throttle sends with the fragment size it was created with
+                        listener.fragment_size = fragment_size;
+                        listener.throttle.reset();
+                    }
+
+                    if (listener.ids.empty() || 0 == throttle_rate)
+                    {
+                        listener.throttle.reset();
+                        return;
+                    }
+
+                    if (listener.throttle)
+                    {
+                        listener.throttle->configure(std::chrono::milliseconds(throttle_rate), queue_length);
+                        return;
+                    }
+
+                    _logger << utils::Logger::Level::DEBUG
+                            << "Throttling topic '" << topic_name << "' to one message every "
+                            << throttle_rate << " ms, holding up to " << queue_length << " messages" << std::endl;
+
+                    SubscriptionThrottle::Hooks hooks;
+                    hooks.send = [this, queue = listener.queue, policy, fragment_size, topic_name, sent](
+                                     const TlsMessagePtr &message)
+                    {
+                        if (send_fragmented(
+                                queue, message, policy, fragment_size, "", "publication on topic", topic_name))
+                        {
+                            sent.count(message->get_payload().size());
+                        }
+                    };
+                    hooks.schedule = [this](std::chrono::milliseconds delay, std::function<void()> release)
+                    {
+                        set_timer(delay, std::move(release));
+                    };
+
+                    listener.throttle = std::make_shared<SubscriptionThrottle>(
+                        std::chrono::milliseconds(throttle_rate), queue_length, std::move(hooks));
                 }
 
                 //==============================================================================
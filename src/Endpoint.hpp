@@ -19,13 +19,33 @@
 #ifndef _WEBSOCKET_IS_SH__SRC__ENDPOINT_HPP_
 #define _WEBSOCKET_IS_SH__SRC__ENDPOINT_HPP_
 
+#include "Cluster.hpp"
+#include "ConnectionIndex.hpp"
+#include "DispatchQueue.hpp"
 #include "Encoding.hpp"
+#include "EncodingPipeline.hpp"
+#include "Fragmentation.hpp"
+#include "Metrics.hpp"
+#include "OfflineBuffer.hpp"
+#include "OutboundQueue.hpp"
+#include "PendingCalls.hpp"
+#include "PublicationBatcher.hpp"
+#include "ServiceProviders.hpp"
+#include "StartupMessages.hpp"
+#include "SubscriptionThrottle.hpp"
+#include "TraceLog.hpp"
 #include "websocket_types.hpp"
 
 #include <is/systemhandle/SystemHandle.hpp>
 #include <is/utils/Log.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
 #include <memory>
+#include <string_view>
 #include <unordered_map>
 #include <unordered_set>
 #include <mutex>
@@ -43,8 +63,38 @@ namespace eprosima
 
                                 const std::string YamlEncodingKey = "encoding";
                                 const std::string YamlEncoding_Json = "json";
+                                const std::string YamlEncoding_Cbor = "cbor";
+                                const std::string YamlEncoding_MsgPack = "msgpack";
                                 const std::string YamlPortKey = "port";
                                 const std::string YamlHostKey = "host";
+                                const std::string YamlSendQueueKey = "send_queue";
+                                const std::string YamlSendQueueMaxBufferedBytesKey = "max_buffered_bytes";
+                                const std::string YamlSendQueueMaxMessagesKey = "max_messages";
+                                const std::string YamlSendQueuePolicyKey = "policy";
+                                const std::string YamlFragmentBufferKey = "fragment_buffer";
+                                const std::string YamlFragmentBufferMaxBytesKey = "max_bytes";
+                                const std::string YamlFragmentBufferMaxMessagesKey = "max_messages";
+                                const std::string YamlCompressionKey = "compression";
+                                const std::string YamlCompressionThresholdKey = "threshold";
+                                const std::string YamlBatchKey = "batch";
+                                const std::string YamlBatchWindowKey = "window_ms";
+                                const std::string YamlBatchMaxMessagesKey = "max_messages";
+                                const std::string YamlBatchMaxBytesKey = "max_bytes";
+                                const std::string YamlEncodingPipelineKey = "encoding_pipeline";
+                                const std::string YamlEncodingPipelineThreadsKey = "threads";
+                                const std::string YamlEncodingPipelineQueueLengthKey = "queue_length";
+                                const std::string YamlDispatchKey = "dispatch";
+                                const std::string YamlDispatchQueueLengthKey = "queue_length";
+                                const std::string YamlDispatchPolicyKey = "policy";
+                                const std::string YamlMetricsKey = "metrics";
+                                const std::string YamlMetricsPathKey = "path";
+                                const std::string YamlMetricsPortKey = "port";
+                                const std::string YamlTracePayloadsKey = "trace_payloads";
+                                const std::string YamlTlsKey = "tls";
+                                const std::string YamlServiceTimeoutKey = "timeout_ms";
+                                const std::string YamlServiceProvidersKey = "providers";
+                                const std::string YamlStartupBatchKey = "startup_batch";
+                                const std::string YamlIdleTimeoutKey = "idle_timeout_ms";
 
                                 /**
                                  * @class Endpoint
@@ -163,6 +213,16 @@ namespace eprosima
                                             const std::string &id,
                                             const YAML::Node &configuration);
 
+                                        /**
+                                         * @brief Stop advertising a topic to the connections opened from now on.
+                                         *        This is for the topics determined at runtime by topic templates
+                                         *        which went idle.
+                                         *
+                                         * @param[in] topic The topic name.
+                                         */
+                                        void startup_retraction(
+                                            const std::string &topic);
+
                                         /**
                                          * @brief Send out an advertisement to all existing connections right away.
                                          *        This is for publication topics that are determined at runtime by topic templates.
@@ -269,7 +329,7 @@ namespace eprosima
                                          * @param[in] connection_handle Opaque pointer which identifies the current connection.
                                          */
                                         void receive_publication_ws(
-                                            const std::string &topic_name,
+                                            std::string_view topic_name,
                                             const xtypes::DynamicData &message,
                                             std::shared_ptr<void> connection_handle);
 
@@ -284,12 +344,15 @@ namespace eprosima
                                          *
                                          * @param[in] id The identifier of the message.
                                          *
+                                         * @param[in] options The throttling settings requested by the subscriber.
+                                         *
                                          * @param[in] connection_handle Opaque pointer which identifies the current connection.
                                          */
                                         void receive_subscribe_request_ws(
                                             const std::string &topic_name,
                                             const xtypes::DynamicType *message_type,
                                             const std::string &id,
+                                            const SubscribeOptions &options,
                                             std::shared_ptr<void> connection_handle);
 
                                         /**
@@ -316,12 +379,37 @@ namespace eprosima
                                          *
                                          * @param[in] id The service ID.
                                          *
+                                         * @param[in] fragment_size The maximum size of the response messages,
+                                         *            beyond which they are fragmented. Zero means no limit.
+                                         *
                                          * @param[in] connection_handle Opaque pointer which identifies the current connection.
                                          */
                                         void receive_service_request_ws(
-                                            const std::string &service_name,
+                                            std::string_view service_name,
                                             const xtypes::DynamicData &request,
+                                            std::string_view id,
+                                            uint32_t fragment_size,
+                                            std::shared_ptr<void> connection_handle);
+
+                                        /**
+                                         * @brief Process a fragment of a larger message. Once every fragment
+                                         *        has been received, the whole message is interpreted.
+                                         *
+                                         * @param[in] id The identifier of the fragmented message.
+                                         *
+                                         * @param[in] data The contents of the fragment.
+                                         *
+                                         * @param[in] num The index of the fragment.
+                                         *
+                                         * @param[in] total The number of fragments of the message.
+                                         *
+                                         * @param[in] connection_handle Opaque pointer which identifies the current connection.
+                                         */
+                                        void receive_fragment_ws(
                                             const std::string &id,
+                                            const std::string &data,
+                                            uint32_t num,
+                                            uint32_t total,
                                             std::shared_ptr<void> connection_handle);
 
                                         /**
@@ -367,9 +455,9 @@ namespace eprosima
                                          * @param[in] connection_handle Opaque pointer which identifies the current connection.
                                          */
                                         void receive_service_response_ws(
-                                            const std::string &service_name,
+                                            std::string_view service_name,
                                             const xtypes::DynamicData &response,
-                                            const std::string &id,
+                                            std::string_view id,
                                             std::shared_ptr<void> connection_handle);
 
                                 protected:
@@ -380,6 +468,13 @@ namespace eprosima
                                          */
                                         const Encoding &get_encoding() const;
 
+                                        /**
+                                         * @brief Get the *WebSocket* frame opcode that suits the Encoding.
+                                         *
+                                         * @returns `binary` for binary encodings, or `text` otherwise.
+                                         */
+                                        websocketpp::frame::opcode::value message_opcode() const;
+
                                         /**
                                          * @brief Notify when a TLS connection has been opened.
                                          *
@@ -398,6 +493,19 @@ namespace eprosima
                                         void notify_connection_opened(
                                             const TcpConnectionPtr &connection_handle);
 
+                                        /**
+                                         * @brief Notify when a Unix socket connection has been opened.
+                                         *
+                                         * @param[in] connection_handle The Unix socket handle used to send
+                                         *            the notification message.
+                                         *
+                                         * @param[in] pending_bytes Reports the bytes the socket has not written yet,
+                                         *            as the iostream transport hands them over without waiting.
+                                         */
+                                        void notify_connection_opened(
+                                            const UnixConnectionPtr &connection_handle,
+                                            std::function<std::size_t()> pending_bytes);
+
                                         /**
                                          * @brief Notify when a connection has been closed.
                                          *
@@ -407,6 +515,107 @@ namespace eprosima
                                         void notify_connection_closed(
                                             const std::shared_ptr<void> &connection_handle);
 
+                                        /**
+                                         * @brief Wake up the threads waiting for an event of this Endpoint,
+                                         *        such as a connection state change, a reconnection timer
+                                         *        or the shutdown request.
+                                         *        Connection openings and closings are notified automatically.
+                                         */
+                                        void notify_event();
+
+                                        /**
+                                         * @brief Block the calling thread until an event is notified,
+                                         *        or until the timeout expires.
+                                         *
+                                         * @param[in] timeout The maximum time to wait for.
+                                         *
+                                         * @returns `true` if an event was notified, or `false` if the timeout expired.
+                                         */
+                                        bool wait_for_event(
+                                            const std::chrono::milliseconds &timeout);
+
+                                        /**
+                                         * @brief Block the calling thread until the predicate is satisfied,
+                                         *        or until the timeout expires. The predicate is evaluated
+                                         *        every time an event is notified.
+                                         *
+                                         * @param[in] timeout The maximum time to wait for.
+                                         *
+                                         * @param[in] predicate The condition to wait for.
+                                         *
+                                         * @returns The last value of the predicate.
+                                         */
+                                        template <typename Predicate>
+                                        bool wait_for_event(
+                                            const std::chrono::milliseconds &timeout,
+                                            Predicate predicate)
+                                        {
+                                            std::unique_lock<std::mutex> lock(_event_mutex);
+                                            return _event_cv.wait_for(lock, timeout, predicate);
+                                        }
+
+                                        /**
+                                         * @brief Wait for the encoding workers and the dispatch threads to finish their
+                                         *        current task, dropping the ones not started yet, and stop exporting the
+                                         *        metrics. It must be called before the connections are torn down.
+                                         */
+                                        void stop_workers();
+
+                                        /**
+                                         * @brief Get the registry of the metrics of this Endpoint.
+                                         *
+                                         * @returns The registry, or `nullptr` if the metrics are disabled.
+                                         */
+                                        MetricsRegistry *metrics() const;
+
+                                        /**
+                                         * @brief Get the HTTP path where the metrics are exported.
+                                         */
+                                        const std::string &metrics_path() const;
+
+                                        /**
+                                         * @brief Get the port of the dedicated HTTP server for the metrics.
+                                         *
+                                         * @returns The port number, or -1 if the metrics are exported
+                                         *          through the *WebSocket* port.
+                                         */
+                                        int32_t metrics_port() const;
+
+                                        /**
+                                         * @brief Interpret a message received from a connection, accounting for
+                                         *        its size and the time it takes if the metrics are enabled.
+                                         *
+                                         * @param[in] payload The payload of the message.
+                                         *
+                                         * @param[in] connection_handle The connection which received it.
+                                         */
+                                        void handle_websocket_msg(
+                                            std::string_view payload,
+                                            std::shared_ptr<void> connection_handle);
+
+                                        /**
+                                         * @brief Answer a plain HTTP request with the metrics, if it
+                                         *        asks for their path, or with a `404` otherwise.
+                                         *
+                                         * @param[in] connection The connection of the request.
+                                         */
+                                        void serve_metrics(
+                                            const TlsConnectionPtr &connection) const;
+
+                                        void serve_metrics(
+                                            const TcpConnectionPtr &connection) const;
+
+                                        /**
+                                         * @brief Start the dedicated HTTP server for the metrics, if a port
+                                         *        was configured for it, from the given io_service.
+                                         *
+                                         * @param[in] io_service The io_service run by the Endpoint threads.
+                                         *
+                                         * @returns `false` if the server could not listen on its port.
+                                         */
+                                        bool start_metrics_server(
+                                            boost::asio::io_service &io_service);
+
                                         /**
                                          * @brief Get the *WebSocket* port, as specified in the configuration file.
                                          *        This method will warn to the user if no port is present.
@@ -419,8 +628,71 @@ namespace eprosima
                                         int32_t parse_port(
                                             const YAML::Node &configuration);
 
+                                        /**
+                                         * @brief Call a function once a delay has elapsed, from the endpoint threads.
+                                         */
+                                        void set_timer(
+                                            std::chrono::milliseconds delay,
+                                            std::function<void()> callback);
+
+                                        /**
+                                         * @brief Start keeping track of the topics with listeners of their own, whose
+                                         *        changes are reported through cluster_interest_changed.
+                                         */
+                                        void enable_cluster();
+
+                                        /**
+                                         * @brief Hold the publications of the topics without listeners, such as those
+                                         *        published while disconnected, until a connection subscribes to them.
+                                         */
+                                        void enable_offline_buffer(
+                                            const OfflineBufferOptions &options);
+
+                                        /**
+                                         * @brief Mark a connection as a link with another node of the cluster. The
+                                         *        publications received from links are only delivered to the listeners
+                                         *        of this node, and links get no startup messages.
+                                         */
+                                        void add_cluster_link(
+                                            const std::shared_ptr<void> &connection_handle);
+
+                                        /**
+                                         * @brief Forget a link opened by this node, which is not notified as closed.
+                                         */
+                                        void remove_cluster_link(
+                                            const std::shared_ptr<void> &connection_handle);
+
+                                        /**
+                                         * @brief Encode a subscription to every topic with listeners, and pass each one to
+                                         *        the given function, so that a node which just linked learns about them.
+                                         *        No interest change is reported meanwhile.
+                                         */
+                                        void send_cluster_subscriptions(
+                                            const std::function<void(const std::string &)> &send);
+
+                                        /**
+                                         * @brief Called whenever a topic gets its first listener, or loses its last one,
+                                         *        with the topic bookkeeping locked so that the changes keep their order.
+                                         *
+                                         * @param[in] topic_name The name of the topic.
+                                         *
+                                         * @param[in] message_type The type name of the topic.
+                                         *
+                                         * @param[in] interested Whether the topic has listeners now.
+                                         */
+                                        virtual void cluster_interest_changed(
+                                            const std::string &topic_name,
+                                            const std::string &message_type,
+                                            bool interested);
+
                                         utils::Logger _logger;
 
+                                        /**
+                                         * Whether every message sent and received is logged along with its payload.
+                                         * Those traces are written through WEBSOCKET_TRACE, so they cost nothing otherwise.
+                                         */
+                                        bool _trace_payloads = false;
+
                                 private:
                                         /**
                                          * @brief Configure the TLS Endpoint.
@@ -454,20 +726,351 @@ namespace eprosima
                                             const core::RequiredTypes &types,
                                             const YAML::Node &configuration) = 0;
 
+                                        /**
+                                         * @brief Parse the limits and the overflow policy of the send queues,
+                                         *        as specified in the configuration file.
+                                         *
+                                         * @param[in] send_queue_node The `send_queue` node of the configuration.
+                                         *
+                                         * @param[out] options The parsed settings. Missing settings keep their value.
+                                         *
+                                         * @returns `true` if every setting is valid.
+                                         */
+                                        bool parse_send_queue(
+                                            const YAML::Node &send_queue_node,
+                                            OutboundQueue::Options &options);
+
+                                        /**
+                                         * @brief Parse which messages should be compressed, as specified in the configuration file.
+                                         *        The `compression` node is either a boolean or a map with a `threshold` size.
+                                         *
+                                         * @param[in] compression_node The `compression` node of the configuration.
+                                         *
+                                         * @param[out] threshold The size from which the messages are compressed.
+                                         *
+                                         * @returns `true` if the setting is valid.
+                                         */
+                                        bool parse_compression(
+                                            const YAML::Node &compression_node,
+                                            std::size_t &threshold);
+
+                                        /**
+                                         * @brief Parse how the publications of a topic are batched, as specified in the
+                                         *        configuration file. The `batch` node is either a boolean or a map with
+                                         *        the `window_ms`, `max_messages` and `max_bytes` limits.
+                                         *
+                                         * @param[in] batch_node The `batch` node of the topic configuration.
+                                         *
+                                         * @param[out] enabled Whether the publications must be batched.
+                                         *
+                                         * @param[out] options The parsed limits. Missing limits keep their value.
+                                         *
+                                         * @returns `true` if the setting is valid.
+                                         */
+                                        bool parse_batch(
+                                            const YAML::Node &batch_node,
+                                            bool &enabled,
+                                            PublicationBatcher::Options &options);
+
+                                        /**
+                                         * @brief Parse the size of the pool of workers which encode the publications,
+                                         *        as specified in the configuration file.
+                                         *
+                                         * @param[in] pipeline_node The `encoding_pipeline` node of the configuration.
+                                         *
+                                         * @param[out] options The parsed settings. Missing settings keep their value.
+                                         *
+                                         * @returns `true` if every setting is valid.
+                                         */
+                                        bool parse_encoding_pipeline(
+                                            const YAML::Node &pipeline_node,
+                                            EncodingPipeline::Options &options);
+
+                                        /**
+                                         * @brief Encode a publication and send it to the listeners of its topic,
+                                         *        from the calling thread.
+                                         *
+                                         * @param[in] from_cluster Whether the publication comes from another node of the
+                                         *            cluster, so that it is only sent to the listeners of this node.
+                                         */
+                                        bool encode_and_publish(
+                                            const std::string &topic,
+                                            const xtypes::DynamicData &message,
+                                            bool from_cluster = false);
+
+                                        /**
+                                         * @brief Send the calls to a service which were just assigned a provider.
+                                         */
+                                        void send_service_calls(
+                                            const std::string &service_name,
+                                            std::vector<ServiceProviders::Call> calls);
+
+                                        /**
+                                         * @brief Account for a call to a service which got its response or was given
+                                         *        up, and send the calls waiting for the provider it leaves free.
+                                         */
+                                        void complete_service_call(
+                                            const std::string &service_name,
+                                            uint64_t id);
+
+                                        /**
+                                         * @brief Configure how the calls to a service are spread among its providers,
+                                         *        from the `providers` node of its configuration.
+                                         */
+                                        void configure_service_providers(
+                                            const std::string &service_name,
+                                            const YAML::Node &configuration,
+                                            ServiceProviders &providers);
+
+                                        /**
+                                         * @brief Parse the time after which the calls to a service are given up, from
+                                         *        the `timeout_ms` of its configuration. Invalid values are reported,
+                                         *        and replaced by the default.
+                                         */
+                                        std::chrono::milliseconds parse_service_timeout(
+                                            const std::string &service_name,
+                                            const YAML::Node &configuration);
+
+                                        /**
+                                         * @brief Parse how the publications received for a topic are handed over to the
+                                         *        downstream system, as specified in the configuration file. The `dispatch`
+                                         *        node is either a boolean or a map with the `queue_length` and `policy`.
+                                         *
+                                         * @param[in] dispatch_node The `dispatch` node of the topic configuration.
+                                         *
+                                         * @param[out] enabled Whether the publications must be dispatched from a thread of their own.
+                                         *
+                                         * @param[out] options The parsed settings. Missing settings keep their value.
+                                         *
+                                         * @returns `true` if the setting is valid.
+                                         */
+                                        bool parse_dispatch(
+                                            const YAML::Node &dispatch_node,
+                                            bool &enabled,
+                                            DispatchQueue::Options &options);
+
+                                        /**
+                                         * @brief Parse where the metrics are exported, as specified in the configuration
+                                         *        file. The `metrics` node is either a boolean or a map with the HTTP `path`
+                                         *        and, to export them from a dedicated HTTP server, its `port`.
+                                         *
+                                         * @param[in] metrics_node The `metrics` node of the configuration.
+                                         *
+                                         * @param[out] enabled Whether the metrics must be collected.
+                                         *
+                                         * @returns `true` if the setting is valid.
+                                         */
+                                        bool parse_metrics(
+                                            const YAML::Node &metrics_node,
+                                            bool &enabled);
+
+                                        /**
+                                         * @brief Register the families of the metrics which are sampled
+                                         *        from the queues of this Endpoint.
+                                         */
+                                        void register_sampled_metrics();
+
+                                        /**
+                                         * @brief Send a batch of publications of a topic to its listeners without
+                                         *        a throttle rate, which are the ones the batcher stands for.
+                                         */
+                                        void publish_batch(
+                                            const std::string &topic,
+                                            std::vector<std::string> &&publications);
+
+                                        /**
+                                         * @brief Wrap a payload into a message, flagged to be compressed
+                                         *        if it reaches the compression threshold.
+                                         */
+                                        TlsMessagePtr make_compressed_message(
+                                            const std::string &payload) const;
+
+                                        /**
+                                         * @brief Create the send queue of a newly opened connection, which is
+                                         *        flushed from the io_service of the connection itself.
+                                         */
+                                        template <typename ConnectionPtr>
+                                        OutboundQueuePtr make_outbound_queue(
+                                            const ConnectionPtr &connection,
+                                            std::function<std::size_t()> pending_bytes);
+
+                                        /**
+                                         * @brief Start sending through a newly opened connection of any transport,
+                                         *        beginning with the startup messages.
+                                         */
+                                        template <typename ConnectionPtr>
+                                        void open_connection(
+                                            const ConnectionPtr &connection_handle,
+                                            const char *transport,
+                                            std::function<std::size_t()> pending_bytes = nullptr);
+
+                                        /**
+                                         * @brief Get the send queue of a connection.
+                                         *
+                                         * @returns The queue, or `nullptr` if the connection is not open anymore.
+                                         */
+                                        OutboundQueuePtr find_outbound_queue(
+                                            const std::shared_ptr<void> &connection_handle);
+
+                                        /**
+                                         * @brief Send a message through the send queue of a connection,
+                                         *        logging whatever happened to it but a successful delivery.
+                                         *
+                                         * @param[in] kind Kind of message, such as "publication on topic", for logging purposes.
+                                         *
+                                         * @param[in] name Name of the topic or service of the message, for logging purposes.
+                                         *
+                                         * @returns `true` if the message was sent or queued.
+                                         */
+                                        bool send_queued(
+                                            const OutboundQueuePtr &queue,
+                                            const TlsMessagePtr &message,
+                                            OverflowPolicy policy,
+                                            const char *kind,
+                                            const std::string &name);
+
+                                        /**
+                                         * @brief Send a message through the send queue of a connection, split into
+                                         *        rosbridge `fragment` messages if it is larger than the fragment size.
+                                         *
+                                         * @param[in] id The identifier of the fragments. If empty, a new one is generated.
+                                         *
+                                         * @returns `true` if the message, or all of its fragments, were sent or queued.
+                                         */
+                                        bool send_fragmented(
+                                            const OutboundQueuePtr &queue,
+                                            const TlsMessagePtr &message,
+                                            OverflowPolicy policy,
+                                            std::size_t fragment_size,
+                                            const std::string &id,
+                                            const char *kind,
+                                            const std::string &name);
+
+                                        /**
+                                         * @brief Parse the limits of the buffers where the fragmented messages
+                                         *        are reassembled, as specified in the configuration file.
+                                         *
+                                         * @returns `true` if every setting is valid.
+                                         */
+                                        bool parse_fragment_buffer(
+                                            const YAML::Node &fragment_buffer_node,
+                                            FragmentAssembler::Limits &limits);
+
                                         /**
                                          * Class members.
                                          */
                                         EncodingPtr _encoding;
-                                        std::shared_ptr<TlsEndpoint> _tls_endpoint;
-                                        std::shared_ptr<TcpEndpoint> _tcp_endpoint;
+
+                                        /**
+                                         * The Client or Server owns the actual endpoint. They are only used for
+                                         * retrieving connections and setting timers.
+                                         */
+                                        TlsEndpoint *_tls_endpoint = nullptr;
+                                        TcpEndpoint *_tcp_endpoint = nullptr;
                                         bool _use_security;
-                                        std::mutex _next_service_call_id_mutex;
+
+                                        /**
+                                         * Send queue of each open connection, so that a slow peer cannot make
+                                         * the messages pending to be written pile up without limit.
+                                         */
+                                        OutboundQueue::Options _send_queue_options;
+                                        std::mutex _connection_mutex;
+                                        std::unordered_map<std::shared_ptr<void>, OutboundQueuePtr> _outbound_queues;
+
+                                        /**
+                                         * Messages being received as fragments from each connection. Each buffer is
+                                         * only used by the message handler of its connection, which is never concurrent.
+                                         */
+                                        FragmentAssembler::Limits _fragment_limits;
+
+                                        /**
+                                         * Size from which the messages are compressed, unless their topic overrides it.
+                                         */
+                                        std::size_t _compression_threshold = NeverCompress;
+                                        std::unordered_map<std::shared_ptr<void>, std::shared_ptr<FragmentAssembler>> _fragment_assemblers;
+                                        std::atomic<std::size_t> _next_fragment_id{1};
+
+                                        /**
+                                         * Only present if the publications are encoded out of the publishing thread.
+                                         */
+                                        std::unique_ptr<EncodingPipeline> _encoding_pipeline;
+
+                                        /**
+                                         * Only present if the metrics are enabled, so that otherwise
+                                         * they cost no more than checking a null pointer.
+                                         */
+                                        std::unique_ptr<MetricsRegistry> _metrics;
+                                        std::string _metrics_path = "/metrics";
+                                        int32_t _metrics_port = -1;
+                                        MetricsRegistry::Histogram *_encode_seconds = nullptr;
+                                        MetricsRegistry::Histogram *_decode_seconds = nullptr;
+                                        MetricsRegistry::Counter *_received_bytes = nullptr;
+                                        std::shared_ptr<TcpServer> _metrics_server;
+
+                                        /**
+                                         * Remote endpoint of each open connection, which labels its metrics.
+                                         */
+                                        std::unordered_map<std::shared_ptr<void>, std::string> _connection_names;
+
+                                        /**
+                                         * Only present if this node belongs to a cluster. Protected by the topic mutex.
+                                         */
+                                        std::unique_ptr<ClusterInterest> _cluster;
+
+                                        /**
+                                         * The underlying io_service may be run by several threads, so the
+                                         * connection handlers can be executed concurrently for different connections.
+                                         * These protect the topic (including the startup messages) and the service
+                                         * provider bookkeeping, respectively.
+                                         */
+                                        std::mutex _topic_info_mutex;
+                                        std::mutex _service_provider_mutex;
+
+                                        std::mutex _event_mutex;
+                                        std::condition_variable _event_cv;
+                                        bool _event_pending = false;
+
+                                        /**
+                                         * Counters of the messages of a topic, or null if the metrics are disabled.
+                                         */
+                                        struct TopicCounters
+                                        {
+                                                MetricsRegistry::Counter *messages = nullptr;
+                                                MetricsRegistry::Counter *bytes = nullptr;
+
+                                                void count(
+                                                    std::size_t size,
+                                                    std::size_t publications = 1) const
+                                                {
+                                                        if (messages != nullptr)
+                                                        {
+                                                                messages->increment(publications);
+                                                                bytes->increment(size);
+                                                        }
+                                                }
+                                        };
+
+                                        /**
+                                         * @brief Get the counters of the publications sent on a topic.
+                                         */
+                                        TopicCounters make_sent_counters(
+                                            const std::string &topic);
 
                                         struct TopicSubscribeInfo
                                         {
                                                 std::string type;
                                                 SubscriptionCallback *callback;
 
+                                                /**
+                                                 * Publications received on the topic.
+                                                 */
+                                                MetricsRegistry::Counter *received = nullptr;
+
+                                                /**
+                                                 * Only present if the publications are not delivered from the I/O threads.
+                                                 */
+                                                std::shared_ptr<DispatchQueue> dispatcher;
+
                                                 /**
                                                  * Connections whose publications we will ignore because
                                                  * their message type does not match the one we expect.
@@ -475,20 +1078,84 @@ namespace eprosima
                                                 std::unordered_set<std::shared_ptr<void>> blacklist;
                                         };
 
+                                        struct TopicListener
+                                        {
+                                                /**
+                                                 * Settings requested by each subscription ID of the connection.
+                                                 */
+                                                std::unordered_map<std::string, SubscribeOptions> ids;
+                                                OutboundQueuePtr queue;
+
+                                                /**
+                                                 * Only present if some throttle rate was requested.
+                                                 */
+                                                SubscriptionThrottlePtr throttle;
+
+                                                /**
+                                                 * Zero if no fragmentation was requested.
+                                                 */
+                                                uint32_t fragment_size = 0;
+                                        };
+
+                                        /**
+                                         * @brief Apply the settings of the subscriptions of a listener. As in rosbridge, the
+                                         *        smallest throttle rate and the largest queue length requested are used.
+                                         *        So is the smallest fragment size requested.
+                                         */
+                                        void update_listener(
+                                            const std::string &topic_name,
+                                            OverflowPolicy policy,
+                                            const TopicCounters &sent,
+                                            TopicListener &listener);
+
                                         struct TopicPublishInfo
                                         {
                                                 std::string type;
 
+                                                /**
+                                                 * Interned by the encoding once the topic is advertised.
+                                                 */
+                                                TopicId topic_id = InvalidTopicId;
+
+                                                /**
+                                                 * Policy applied when the send queue of a listener is full.
+                                                 */
+                                                OverflowPolicy policy = OverflowPolicy::DROP_OLDEST;
+
+                                                /**
+                                                 * Size from which the publications are compressed, for the
+                                                 * listeners which negotiated permessage-deflate.
+                                                 */
+                                                std::size_t compression_threshold = NeverCompress;
+
+                                                /**
+                                                 * Only present if the publications are batched.
+                                                 */
+                                                PublicationBatcherPtr batcher;
+
+                                                /**
+                                                 * Publications sent to the listeners of the topic, counted once per listener.
+                                                 */
+                                                TopicCounters sent;
+
                                                 using ListenerMap = std::unordered_map<
                                                     std::shared_ptr<void>,
-                                                    std::unordered_set<std::string>>;
+                                                    TopicListener>;
 
                                                 /**
-                                                 * Map from connection handle to listeners ID.
+                                                 * Map from connection handle to listeners ID and send queue.
                                                  */
                                                 ListenerMap listeners;
                                         };
 
+                                        /**
+                                         * @brief Send the publications held for a topic to its listeners, gathered into
+                                         *        a batch if the encoding supports them. The _topic_info_mutex must be held.
+                                         */
+                                        void send_offline_publications(
+                                            const std::string &topic_name,
+                                            const TopicPublishInfo &info);
+
                                         struct ClientProxyInfo
                                         {
                                                 std::string req_type;
@@ -501,25 +1168,52 @@ namespace eprosima
                                         {
                                                 std::string req_type;
                                                 std::string reply_type;
-                                                std::shared_ptr<void> connection_handle;
                                                 YAML::Node configuration;
+
+                                                /**
+                                                 * The connections which advertised the service, and the calls
+                                                 * waiting for one of them.
+                                                 */
+                                                ServiceProviders providers;
                                         };
 
                                         struct ServiceRequestInfo
                                         {
                                                 ServiceClient *client;
                                                 std::shared_ptr<void> call_handle;
+                                                std::string service;
                                         };
 
-                                        std::vector<std::string> _startup_messages;
-                                        std::unordered_map<std::string, TopicSubscribeInfo> _topic_subscribe_info;
+                                        StartupMessages _startup_messages;
+
+                                        /**
+                                         * Disabled unless the Client asks for it, guarded by _topic_info_mutex.
+                                         */
+                                        OfflineBuffer _offline_buffer;
+                                        // The maps looked up for every incoming message compare transparently,
+                                        // so that the names and ids viewed in the payload need not be copied.
+                                        std::map<std::string, TopicSubscribeInfo, std::less<>> _topic_subscribe_info;
                                         std::unordered_map<std::string, TopicPublishInfo> _topic_publish_info;
-                                        std::unordered_map<std::string, ClientProxyInfo> _client_proxy_info;
+                                        std::map<std::string, ClientProxyInfo, std::less<>> _client_proxy_info;
                                         std::unordered_map<std::string, ServiceProviderInfo> _service_provider_info;
-                                        std::unordered_map<std::string, ServiceRequestInfo> _service_request_info;
-                                        std::unordered_map<std::string, xtypes::DynamicType::Ptr> _message_types;
+                                        PendingCalls<ServiceRequestInfo> _service_request_info;
 
-                                        std::size_t _next_service_call_id;
+                                        /**
+                                         * Topics each connection listens to, is blacklisted on or has advertised, guarded by
+                                         * _topic_info_mutex, and services it provides, guarded by _service_provider_mutex, so
+                                         * that closing a connection only visits its own entries instead of every topic and service.
+                                         */
+                                        ConnectionIndex _listened_topics;
+                                        ConnectionIndex _blacklisted_topics;
+                                        ConnectionIndex _advertised_topics;
+                                        ConnectionIndex _provided_services;
+
+                                        /**
+                                         * Time after which the calls to each service are given up, guarded by
+                                         * _service_provider_mutex. Zero means never.
+                                         */
+                                        std::unordered_map<std::string, std::chrono::milliseconds> _service_timeouts;
+                                        std::unordered_map<std::string, xtypes::DynamicType::Ptr> _message_types;
                                 };
 
                                 using EndpointPtr = std::unique_ptr<Endpoint>;
@@ -0,0 +1,203 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Fragmentation.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+static bool is_utf8_continuation(
+        const char c)
+{
+    return (static_cast<unsigned char>(c) & 0xC0) == 0x80;
+}
+
+//==============================================================================
+std::vector<std::string_view> split_into_fragments(
+        std::string_view message,
+        std::size_t fragment_size)
+{
+    std::vector<std::string_view> fragments;
+    if (0 == fragment_size || message.size() <= fragment_size)
+    {
+        fragments.push_back(message);
+        return fragments;
+    }
+
+    fragments.reserve(message.size() / fragment_size + 1);
+    std::size_t begin = 0;
+    while (begin < message.size())
+    {
+        std::size_t end = std::min(begin + fragment_size, message.size());
+        while (end > begin && end < message.size() && is_utf8_continuation(message[end]))
+        {
+            --end;
+        }
+
+        if (end == begin)
+        {
+            // The fragment size is smaller than the character, which goes whole
+            end = begin + 1;
+            while (end < message.size() && is_utf8_continuation(message[end]))
+            {
+                ++end;
+            }
+        }
+
+        fragments.push_back(message.substr(begin, end - begin));
+        begin = end;
+    }
+
+    return fragments;
+}
+
+//==============================================================================
+FragmentAssembler::FragmentAssembler()
+    : FragmentAssembler(Limits())
+{
+}
+
+//==============================================================================
+FragmentAssembler::FragmentAssembler(
+        const Limits& limits)
+    : _limits(limits)
+    , _bytes(0)
+    , _discarded(0)
+    , _counter(0)
+{
+}
+
+//==============================================================================
+FragmentAssembler::Result FragmentAssembler::add(
+        const std::string& id,
+        std::string_view data,
+        uint32_t num,
+        uint32_t total,
+        std::string& message)
+{
+    if (0 == total || num >= total || total > _limits.max_bytes)
+    {
+        return Result::INVALID;
+    }
+
+    if (1 == total)
+    {
+        message.assign(data);
+        return Result::COMPLETE;
+    }
+
+    auto it = _partials.find(id);
+    if (it == _partials.end())
+    {
+        while (_partials.size() >= _limits.max_messages && discard_oldest(id))
+        {
+            // Make room for the new message
+        }
+
+        it = _partials.emplace(id, Partial()).first;
+        it->second.fragments.resize(total);
+        it->second.received.resize(total, false);
+        it->second.order = _counter++;
+    }
+
+    Partial& partial = it->second;
+    if (partial.fragments.size() != total)
+    {
+        erase(it);
+        return Result::INVALID;
+    }
+
+    if (partial.received[num])
+    {
+        // Repeated fragments are ignored
+        return Result::INCOMPLETE;
+    }
+
+    while (_bytes + data.size() > _limits.max_bytes && discard_oldest(id))
+    {
+        // Make room for the new fragment
+    }
+
+    if (_bytes + data.size() > _limits.max_bytes)
+    {
+        erase(it);
+        return Result::OVERFLOW;
+    }
+
+    partial.fragments[num].assign(data);
+    partial.received[num] = true;
+    ++partial.received_count;
+    partial.bytes += data.size();
+    _bytes += data.size();
+
+    if (partial.received_count < total)
+    {
+        return Result::INCOMPLETE;
+    }
+
+    message.clear();
+    message.reserve(partial.bytes);
+    for (const std::string& fragment : partial.fragments)
+    {
+        message += fragment;
+    }
+
+    erase(it);
+    return Result::COMPLETE;
+}
+
+//==============================================================================
+void FragmentAssembler::erase(
+        std::unordered_map<std::string, Partial>::iterator it)
+{
+    _bytes -= it->second.bytes;
+    _partials.erase(it);
+}
+
+//==============================================================================
+bool FragmentAssembler::discard_oldest(
+        const std::string& except)
+{
+    auto oldest = _partials.end();
+    for (auto it = _partials.begin(); it != _partials.end(); ++it)
+    {
+        if (it->first != except && (oldest == _partials.end() || it->second.order < oldest->second.order))
+        {
+            oldest = it;
+        }
+    }
+
+    if (oldest == _partials.end())
+    {
+        return false;
+    }
+
+    erase(oldest);
+    ++_discarded;
+    return true;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
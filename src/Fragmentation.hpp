@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__FRAGMENTATION_HPP_
+#define _WEBSOCKET_IS_SH__SRC__FRAGMENTATION_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Splits a text message into the `data` of the rosbridge `fragment` operations used to send it.
+ * @details Fragments hold at most `fragment_size` bytes, but UTF-8 sequences are never split,
+ *          so that each fragment is valid text on its own.
+ *
+ * @param[in] message The whole message.
+ *
+ * @param[in] fragment_size The maximum size of each fragment. Zero means no fragmentation.
+ *
+ * @returns The fragments, pointing into the message.
+ */
+std::vector<std::string_view> split_into_fragments(
+        std::string_view message,
+        std::size_t fragment_size);
+
+/**
+ * @class FragmentAssembler
+ * @brief Reassembles the messages received as rosbridge `fragment` operations from a single connection.
+ * @details The buffer is bounded: once its limits are exceeded, the oldest partial messages are discarded,
+ *          since their remaining fragments are likely lost. It is not thread safe; the messages of a
+ *          connection are always handled in order, one at a time.
+ */
+class FragmentAssembler
+{
+public:
+
+    /**
+     * @brief Limits of the buffer.
+     */
+    struct Limits
+    {
+        std::size_t max_bytes = 64 * 1024 * 1024;
+        std::size_t max_messages = 16;
+    };
+
+    /**
+     * @brief Outcome of adding a fragment.
+     */
+    enum class Result
+    {
+        INCOMPLETE,
+        COMPLETE,
+        INVALID,
+        OVERFLOW
+    };
+
+    FragmentAssembler();
+
+    explicit FragmentAssembler(
+            const Limits& limits);
+
+    /**
+     * @brief Adds a fragment of a message.
+     *
+     * @param[in] id The identifier of the fragmented message.
+     *
+     * @param[in] data The contents of the fragment.
+     *
+     * @param[in] num The index of the fragment, from zero.
+     *
+     * @param[in] total The number of fragments of the message.
+     *
+     * @param[out] message The whole message, if the result is Result::COMPLETE.
+     *
+     * @returns Result::COMPLETE once every fragment of the message has been added,
+     *          Result::INVALID if the fragment does not match the previous ones, or
+     *          Result::OVERFLOW if the message is given up because it does not fit in the buffer.
+     */
+    Result add(
+            const std::string& id,
+            std::string_view data,
+            uint32_t num,
+            uint32_t total,
+            std::string& message);
+
+    /**
+     * @brief Number of bytes held by the partial messages.
+     */
+    std::size_t buffered_bytes() const
+    {
+        return _bytes;
+    }
+
+    /**
+     * @brief Number of partial messages.
+     */
+    std::size_t pending_messages() const
+    {
+        return _partials.size();
+    }
+
+    /**
+     * @brief Number of partial messages discarded to make room for others.
+     */
+    std::size_t discarded() const
+    {
+        return _discarded;
+    }
+
+private:
+
+    struct Partial
+    {
+        std::vector<std::string> fragments;
+        std::vector<bool> received;
+        std::size_t received_count = 0;
+        std::size_t bytes = 0;
+        uint64_t order = 0;
+    };
+
+    void erase(
+            std::unordered_map<std::string, Partial>::iterator it);
+
+    bool discard_oldest(
+            const std::string& except);
+
+    const Limits _limits;
+    std::unordered_map<std::string, Partial> _partials;
+    std::size_t _bytes;
+    std::size_t _discarded;
+    uint64_t _counter;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__FRAGMENTATION_HPP_
@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "GlobMatcher.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+// States fitting in this many words are simulated without allocating
+constexpr std::size_t InlineStateWords = 4;
+
+//==============================================================================
+static void set_state(
+        uint64_t* states,
+        std::size_t state)
+{
+    states[state / 64] |= uint64_t(1) << (state % 64);
+}
+
+//==============================================================================
+static bool has_state(
+        const uint64_t* states,
+        std::size_t state)
+{
+    return (states[state / 64] >> (state % 64)) & 1;
+}
+
+//==============================================================================
+static std::size_t class_end(
+        const std::string& pattern,
+        std::size_t begin)
+{
+    std::size_t first = begin + 1;
+    if (first < pattern.size() && ('!' == pattern[first] || '^' == pattern[first]))
+    {
+        ++first;
+    }
+
+    // A closing bracket right after the opening one is part of the class
+    return pattern.find(']', first + 1);
+}
+
+//==============================================================================
+GlobMatcher::GlobMatcher(
+        const std::string& pattern)
+    : _pattern(pattern)
+    , _literal(true)
+{
+    std::size_t i = 0;
+    while (i < pattern.size())
+    {
+        const char c = pattern[i];
+        if ('*' == c)
+        {
+            // Consecutive stars are the same as a single one
+            if (_tokens.empty() || Token::Kind::STAR != _tokens.back().kind)
+            {
+                _tokens.push_back(Token{Token::Kind::STAR, true, '\0', 0});
+            }
+            ++i;
+        }
+        else if ('?' == c)
+        {
+            _tokens.push_back(Token{Token::Kind::ANY, true, '\0', 0});
+            ++i;
+        }
+        else if ('[' == c && class_end(pattern, i) != std::string::npos)
+        {
+            const std::size_t end = class_end(pattern, i);
+            std::size_t j = i + 1;
+            const bool negated = '!' == pattern[j] || '^' == pattern[j];
+            if (negated)
+            {
+                ++j;
+            }
+
+            std::bitset<256> chars;
+            for (; j < end; ++j)
+            {
+                const unsigned char first = static_cast<unsigned char>(pattern[j]);
+                if (j + 2 < end && '-' == pattern[j + 1])
+                {
+                    const unsigned char last = static_cast<unsigned char>(pattern[j + 2]);
+                    for (unsigned int k = first; k <= last; ++k)
+                    {
+                        chars.set(k);
+                    }
+                    j += 2;
+                }
+                else
+                {
+                    chars.set(first);
+                }
+            }
+
+            if (negated)
+            {
+                chars.flip();
+            }
+
+            _tokens.push_back(Token{Token::Kind::CLASS, false, '\0', _classes.size()});
+            _classes.push_back(chars);
+            i = end + 1;
+        }
+        else
+        {
+            if (_literal)
+            {
+                _literal_prefix.push_back(c);
+            }
+            else
+            {
+                _tokens.push_back(Token{Token::Kind::CHAR, false, c, 0});
+            }
+            ++i;
+            continue;
+        }
+
+        _literal = false;
+    }
+}
+
+//==============================================================================
+bool GlobMatcher::matches(
+        std::string_view text) const
+{
+    if (_literal)
+    {
+        return text == _literal_prefix;
+    }
+
+    if (text.compare(0, _literal_prefix.size(), _literal_prefix) != 0)
+    {
+        return false;
+    }
+
+    text.remove_prefix(_literal_prefix.size());
+
+    const std::size_t words = (_tokens.size() + 1 + 63) / 64;
+    if (words <= InlineStateWords)
+    {
+        uint64_t current[InlineStateWords];
+        uint64_t next[InlineStateWords];
+        return run(text, current, next, words);
+    }
+
+    std::vector<uint64_t> states(2 * words);
+    return run(text, states.data(), states.data() + words, words);
+}
+
+//==============================================================================
+bool GlobMatcher::matches_token(
+        const Token& token,
+        char c) const
+{
+    switch (token.kind)
+    {
+        case Token::Kind::CHAR:
+            return token.c == c;
+        case Token::Kind::CLASS:
+            return _classes[token.class_index].test(static_cast<unsigned char>(c));
+        case Token::Kind::ANY:
+        case Token::Kind::STAR:
+            return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+bool GlobMatcher::run(
+        std::string_view text,
+        uint64_t* current,
+        uint64_t* next,
+        std::size_t words) const
+{
+    const std::size_t accept = _tokens.size();
+
+    // Optional tokens may be skipped; as those moves only go forward, a single pass closes the set
+    const auto close = [&](uint64_t* states)
+            {
+                for (std::size_t state = 0; state < accept; ++state)
+                {
+                    if (_tokens[state].optional && has_state(states, state))
+                    {
+                        set_state(states, state + 1);
+                    }
+                }
+            };
+
+    std::fill(current, current + words, 0);
+    set_state(current, 0);
+    close(current);
+
+    for (const char c : text)
+    {
+        std::fill(next, next + words, 0);
+        bool alive = false;
+        for (std::size_t state = 0; state < accept; ++state)
+        {
+            if (!has_state(current, state))
+            {
+                continue;
+            }
+
+            const Token& token = _tokens[state];
+            if (Token::Kind::STAR == token.kind)
+            {
+                set_state(next, state);
+                alive = true;
+            }
+            else if (matches_token(token, c))
+            {
+                set_state(next, state + 1);
+                alive = true;
+            }
+        }
+
+        if (!alive)
+        {
+            return false;
+        }
+
+        close(next);
+        std::swap(current, next);
+    }
+
+    return has_state(current, accept);
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
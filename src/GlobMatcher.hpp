@@ -0,0 +1,106 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__GLOBMATCHER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__GLOBMATCHER_HPP_
+
+#include <bitset>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class GlobMatcher
+ * @brief Glob pattern, compiled once, which tells whether whole strings match it.
+ * @details The pattern supports `*`, which matches any sequence of characters, `?`, which matches
+ *          one character or none, and `[...]` character classes with ranges, negated by a leading
+ *          `!` or `^`. Any other character matches itself. Patterns without any of them are compared
+ *          directly, and otherwise their literal prefix is checked before running the automaton.
+ */
+class GlobMatcher
+{
+public:
+
+    explicit GlobMatcher(
+            const std::string& pattern);
+
+    /**
+     * @brief Tells whether the whole text matches the pattern.
+     */
+    bool matches(
+            std::string_view text) const;
+
+    /**
+     * @brief The source pattern.
+     */
+    const std::string& pattern() const
+    {
+        return _pattern;
+    }
+
+private:
+
+    struct Token
+    {
+        enum class Kind : uint8_t
+        {
+            CHAR,
+            ANY,
+            CLASS,
+            STAR
+        };
+
+        Kind kind;
+
+        // Whether the token may also match no character at all
+        bool optional;
+
+        char c;
+        std::size_t class_index;
+    };
+
+    bool matches_token(
+            const Token& token,
+            char c) const;
+
+    bool run(
+            std::string_view text,
+            uint64_t* current,
+            uint64_t* next,
+            std::size_t words) const;
+
+    std::string _pattern;
+    std::string _literal_prefix;
+    bool _literal;
+    std::vector<Token> _tokens;
+    std::vector<std::bitset<256>> _classes;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__GLOBMATCHER_HPP_
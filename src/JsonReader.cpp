@@ -0,0 +1,840 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "JsonReader.hpp"
+
+#include <charconv>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+namespace {
+
+// Envelope fields, as defined by the rosbridge protocol
+constexpr std::string_view EnvelopeOpKey = "op";
+constexpr std::string_view EnvelopeTopicKey = "topic";
+constexpr std::string_view EnvelopeServiceKey = "service";
+constexpr std::string_view EnvelopeIdKey = "id";
+constexpr std::string_view EnvelopeMsgKey = "msg";
+constexpr std::string_view EnvelopeMsgsKey = "msgs";
+constexpr std::string_view EnvelopeArgsKey = "args";
+constexpr std::string_view EnvelopeValuesKey = "values";
+constexpr std::string_view EnvelopeFragmentSizeKey = "fragment_size";
+
+// Deeper documents are left to the JSON library
+constexpr int MaxDepth = 64;
+
+// Members of a structure whose presence is tracked, see JsonReader::read()
+constexpr size_t MaxTrackedMembers = 64;
+
+//==============================================================================
+/**
+ * @brief Minimal forward-only tokenizer over a *JSON* text.
+ */
+class Cursor
+{
+public:
+
+    explicit Cursor(
+            std::string_view text)
+        : _it(text.data())
+        , _end(text.data() + text.size())
+    {
+    }
+
+    const char* position() const
+    {
+        return _it;
+    }
+
+    void skip_whitespace()
+    {
+        while (_it != _end && (*_it == ' ' || *_it == '\t' || *_it == '\n' || *_it == '\r'))
+        {
+            ++_it;
+        }
+    }
+
+    bool consume(
+            const char c)
+    {
+        skip_whitespace();
+        if (_it != _end && *_it == c)
+        {
+            ++_it;
+            return true;
+        }
+        return false;
+    }
+
+    bool peek(
+            const char c)
+    {
+        skip_whitespace();
+        return _it != _end && *_it == c;
+    }
+
+    bool finished()
+    {
+        skip_whitespace();
+        return _it == _end;
+    }
+
+    bool consume_literal(
+            std::string_view literal)
+    {
+        skip_whitespace();
+        if (static_cast<size_t>(_end - _it) < literal.size() ||
+                std::memcmp(_it, literal.data(), literal.size()) != 0)
+        {
+            return false;
+        }
+        _it += literal.size();
+        return true;
+    }
+
+    /**
+     * @brief Reads a string which does not need unescaping, without copying it.
+     */
+    bool read_plain_string(
+            std::string_view& value)
+    {
+        if (!consume('"'))
+        {
+            return false;
+        }
+
+        const char* const begin = _it;
+        while (_it != _end && *_it != '"')
+        {
+            if (*_it == '\\' || static_cast<unsigned char>(*_it) < 0x20)
+            {
+                return false;
+            }
+            ++_it;
+        }
+
+        if (_it == _end)
+        {
+            return false;
+        }
+
+        value = std::string_view(begin, static_cast<size_t>(_it - begin));
+        ++_it;
+        return true;
+    }
+
+    bool read_string(
+            std::string& value)
+    {
+        if (!consume('"'))
+        {
+            return false;
+        }
+
+        value.clear();
+        while (_it != _end && *_it != '"')
+        {
+            const char c = *_it++;
+            if (static_cast<unsigned char>(c) < 0x20)
+            {
+                return false;
+            }
+
+            if (c != '\\')
+            {
+                value += c;
+                continue;
+            }
+
+            if (_it == _end)
+            {
+                return false;
+            }
+
+            switch (*_it++)
+            {
+                case '"': value += '"'; break;
+                case '\\': value += '\\'; break;
+                case '/': value += '/'; break;
+                case 'b': value += '\b'; break;
+                case 'f': value += '\f'; break;
+                case 'n': value += '\n'; break;
+                case 'r': value += '\r'; break;
+                case 't': value += '\t'; break;
+                case 'u':
+                {
+                    uint32_t code_point = 0;
+                    if (!read_hex4(code_point))
+                    {
+                        return false;
+                    }
+
+                    if (code_point >= 0xD800 && code_point <= 0xDBFF)
+                    {
+                        uint32_t low = 0;
+                        if (!consume_literal("\\u") || !read_hex4(low) || low < 0xDC00 || low > 0xDFFF)
+                        {
+                            return false;
+                        }
+                        code_point = 0x10000 + ((code_point - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    else if (code_point >= 0xDC00 && code_point <= 0xDFFF)
+                    {
+                        return false;
+                    }
+
+                    append_utf8(code_point, value);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        if (_it == _end)
+        {
+            return false;
+        }
+
+        ++_it;
+        return true;
+    }
+
+    bool read_number_token(
+            std::string_view& token)
+    {
+        skip_whitespace();
+        const char* const begin = _it;
+        while (_it != _end && ((*_it >= '0' && *_it <= '9') ||
+                *_it == '-' || *_it == '+' || *_it == '.' || *_it == 'e' || *_it == 'E'))
+        {
+            ++_it;
+        }
+
+        token = std::string_view(begin, static_cast<size_t>(_it - begin));
+        return !token.empty();
+    }
+
+    bool skip_value(
+            const int depth)
+    {
+        if (depth > MaxDepth)
+        {
+            return false;
+        }
+
+        skip_whitespace();
+        if (_it == _end)
+        {
+            return false;
+        }
+
+        switch (*_it)
+        {
+            case '"':
+                return skip_string();
+            case '{':
+            {
+                ++_it;
+                if (consume('}'))
+                {
+                    return true;
+                }
+                do
+                {
+                    if (!skip_string() || !consume(':') || !skip_value(depth + 1))
+                    {
+                        return false;
+                    }
+                } while (consume(','));
+                return consume('}');
+            }
+            case '[':
+            {
+                ++_it;
+                if (consume(']'))
+                {
+                    return true;
+                }
+                do
+                {
+                    if (!skip_value(depth + 1))
+                    {
+                        return false;
+                    }
+                } while (consume(','));
+                return consume(']');
+            }
+            case 't':
+                return consume_literal("true");
+            case 'f':
+                return consume_literal("false");
+            case 'n':
+                return consume_literal("null");
+            default:
+            {
+                std::string_view token;
+                return read_number_token(token);
+            }
+        }
+    }
+
+private:
+
+    bool skip_string()
+    {
+        if (!consume('"'))
+        {
+            return false;
+        }
+
+        while (_it != _end && *_it != '"')
+        {
+            if (*_it == '\\' && ++_it == _end)
+            {
+                return false;
+            }
+            ++_it;
+        }
+
+        if (_it == _end)
+        {
+            return false;
+        }
+
+        ++_it;
+        return true;
+    }
+
+    bool read_hex4(
+            uint32_t& value)
+    {
+        if (_end - _it < 4)
+        {
+            return false;
+        }
+
+        const auto result = std::from_chars(_it, _it + 4, value, 16);
+        if (result.ptr != _it + 4)
+        {
+            return false;
+        }
+
+        _it += 4;
+        return true;
+    }
+
+    static void append_utf8(
+            const uint32_t code_point,
+            std::string& output)
+    {
+        if (code_point < 0x80)
+        {
+            output += static_cast<char>(code_point);
+        }
+        else if (code_point < 0x800)
+        {
+            output += static_cast<char>(0xC0 | (code_point >> 6));
+            output += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else if (code_point < 0x10000)
+        {
+            output += static_cast<char>(0xE0 | (code_point >> 12));
+            output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            output += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+        else
+        {
+            output += static_cast<char>(0xF0 | (code_point >> 18));
+            output += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+            output += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+            output += static_cast<char>(0x80 | (code_point & 0x3F));
+        }
+    }
+
+    const char* _it;
+    const char* const _end;
+};
+
+//==============================================================================
+bool parse_double(
+        std::string_view token,
+        double& value)
+{
+    // Numbers are short, copy them so that strtod gets a terminated string
+    char buffer[64];
+    if (token.size() >= sizeof(buffer))
+    {
+        return false;
+    }
+    std::memcpy(buffer, token.data(), token.size());
+    buffer[token.size()] = '\0';
+
+    char* end = nullptr;
+    value = std::strtod(buffer, &end);
+    return end == buffer + token.size();
+}
+
+//==============================================================================
+template<typename T>
+bool read_integer(
+        Cursor& cursor,
+        T& value)
+{
+    std::string_view token;
+    if (!cursor.read_number_token(token))
+    {
+        return false;
+    }
+
+    const auto result = std::from_chars(token.data(), token.data() + token.size(), value);
+    if (result.ec == std::errc() && result.ptr == token.data() + token.size())
+    {
+        return true;
+    }
+
+    // Same as the JSON library, a floating point value is truncated
+    double floating = 0.0;
+    if (result.ec == std::errc() && parse_double(token, floating))
+    {
+        value = static_cast<T>(floating);
+        return true;
+    }
+
+    return false;
+}
+
+//==============================================================================
+template<typename T>
+bool read_primitive(
+        Cursor& cursor,
+        T& value)
+{
+    return read_integer(cursor, value);
+}
+
+template<>
+bool read_primitive<bool>(
+        Cursor& cursor,
+        bool& value)
+{
+    if (cursor.consume_literal("true"))
+    {
+        value = true;
+        return true;
+    }
+    if (cursor.consume_literal("false"))
+    {
+        value = false;
+        return true;
+    }
+    return false;
+}
+
+template<>
+bool read_primitive<double>(
+        Cursor& cursor,
+        double& value)
+{
+    std::string_view token;
+    return cursor.read_number_token(token) && parse_double(token, value);
+}
+
+template<>
+bool read_primitive<float>(
+        Cursor& cursor,
+        float& value)
+{
+    double floating = 0.0;
+    if (!read_primitive(cursor, floating))
+    {
+        return false;
+    }
+    value = static_cast<float>(floating);
+    return true;
+}
+
+template<>
+bool read_primitive<std::string>(
+        Cursor& cursor,
+        std::string& value)
+{
+    return cursor.read_string(value);
+}
+
+//==============================================================================
+template<typename T>
+bool read_primitive_into(
+        Cursor& cursor,
+        xtypes::WritableDynamicDataRef& data)
+{
+    T value;
+    if (!read_primitive(cursor, value))
+    {
+        return false;
+    }
+    data = value;
+    return true;
+}
+
+template<typename T>
+bool push_primitive(
+        Cursor& cursor,
+        xtypes::WritableDynamicDataRef& data)
+{
+    T value;
+    if (!read_primitive(cursor, value))
+    {
+        return false;
+    }
+    data.push(value);
+    return true;
+}
+
+bool read_value(
+        Cursor& cursor,
+        xtypes::WritableDynamicDataRef& data,
+        int depth,
+        bool& complete);
+
+//==============================================================================
+bool push_element(
+        Cursor& cursor,
+        xtypes::WritableDynamicDataRef& data,
+        const xtypes::DynamicType& content_type,
+        const int depth,
+        bool& complete)
+{
+    switch (content_type.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE: return push_primitive<bool>(cursor, data);
+        case xtypes::TypeKind::INT_8_TYPE: return push_primitive<int8_t>(cursor, data);
+        case xtypes::TypeKind::UINT_8_TYPE: return push_primitive<uint8_t>(cursor, data);
+        case xtypes::TypeKind::INT_16_TYPE: return push_primitive<int16_t>(cursor, data);
+        case xtypes::TypeKind::UINT_16_TYPE: return push_primitive<uint16_t>(cursor, data);
+        case xtypes::TypeKind::INT_32_TYPE: return push_primitive<int32_t>(cursor, data);
+        case xtypes::TypeKind::UINT_32_TYPE: return push_primitive<uint32_t>(cursor, data);
+        case xtypes::TypeKind::INT_64_TYPE: return push_primitive<int64_t>(cursor, data);
+        case xtypes::TypeKind::UINT_64_TYPE: return push_primitive<uint64_t>(cursor, data);
+        case xtypes::TypeKind::FLOAT_32_TYPE: return push_primitive<float>(cursor, data);
+        case xtypes::TypeKind::FLOAT_64_TYPE: return push_primitive<double>(cursor, data);
+        case xtypes::TypeKind::STRING_TYPE: return push_primitive<std::string>(cursor, data);
+        default:
+        {
+            data.push(xtypes::DynamicData(content_type));
+            xtypes::WritableDynamicDataRef element = data[data.size() - 1];
+            return read_value(cursor, element, depth + 1, complete);
+        }
+    }
+}
+
+//==============================================================================
+bool read_value(
+        Cursor& cursor,
+        xtypes::WritableDynamicDataRef& data,
+        const int depth,
+        bool& complete)
+{
+    if (depth > MaxDepth)
+    {
+        return false;
+    }
+
+    switch (data.type().kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE: return read_primitive_into<bool>(cursor, data);
+        case xtypes::TypeKind::INT_8_TYPE: return read_primitive_into<int8_t>(cursor, data);
+        case xtypes::TypeKind::UINT_8_TYPE: return read_primitive_into<uint8_t>(cursor, data);
+        case xtypes::TypeKind::INT_16_TYPE: return read_primitive_into<int16_t>(cursor, data);
+        case xtypes::TypeKind::UINT_16_TYPE: return read_primitive_into<uint16_t>(cursor, data);
+        case xtypes::TypeKind::INT_32_TYPE: return read_primitive_into<int32_t>(cursor, data);
+        case xtypes::TypeKind::UINT_32_TYPE: return read_primitive_into<uint32_t>(cursor, data);
+        case xtypes::TypeKind::INT_64_TYPE: return read_primitive_into<int64_t>(cursor, data);
+        case xtypes::TypeKind::UINT_64_TYPE: return read_primitive_into<uint64_t>(cursor, data);
+        case xtypes::TypeKind::FLOAT_32_TYPE: return read_primitive_into<float>(cursor, data);
+        case xtypes::TypeKind::FLOAT_64_TYPE: return read_primitive_into<double>(cursor, data);
+        case xtypes::TypeKind::STRING_TYPE: return read_primitive_into<std::string>(cursor, data);
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+        {
+            const xtypes::SequenceType& sequence_type = static_cast<const xtypes::SequenceType&>(data.type());
+            if (!cursor.consume('[') || data.size() != 0)
+            {
+                return false;
+            }
+            if (cursor.consume(']'))
+            {
+                return true;
+            }
+            do
+            {
+                if (sequence_type.bounds() != 0 && data.size() >= sequence_type.bounds())
+                {
+                    return false;
+                }
+                if (!push_element(cursor, data, sequence_type.content_type(), depth, complete))
+                {
+                    return false;
+                }
+            } while (cursor.consume(','));
+            return cursor.consume(']');
+        }
+        case xtypes::TypeKind::ARRAY_TYPE:
+        {
+            if (!cursor.consume('['))
+            {
+                return false;
+            }
+            if (cursor.consume(']'))
+            {
+                complete = complete && data.size() == 0;
+                return true;
+            }
+            size_t index = 0;
+            do
+            {
+                if (index >= data.size())
+                {
+                    return false;
+                }
+                xtypes::WritableDynamicDataRef element = data[index++];
+                if (!read_value(cursor, element, depth + 1, complete))
+                {
+                    return false;
+                }
+            } while (cursor.consume(','));
+            complete = complete && index == data.size();
+            return cursor.consume(']');
+        }
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            const xtypes::StructType& struct_type = static_cast<const xtypes::StructType&>(data.type());
+            const size_t members = struct_type.members().size();
+            if (!cursor.consume('{'))
+            {
+                return false;
+            }
+            if (cursor.consume('}'))
+            {
+                complete = complete && members == 0;
+                return true;
+            }
+
+            // Members usually come in declaration order, so the next one is tried first
+            size_t hint = 0;
+
+            // Keeps track of the members found, to tell whether all of them have been written.
+            // Larger structures are never told complete, which only prevents reusing their data.
+            uint64_t found = 0;
+            size_t found_count = 0;
+            do
+            {
+                std::string_view key;
+                if (!cursor.read_plain_string(key) || !cursor.consume(':'))
+                {
+                    return false;
+                }
+
+                size_t index = members;
+                if (hint < members && struct_type.member(hint).name() == key)
+                {
+                    index = hint;
+                }
+                else
+                {
+                    for (size_t i = 0; i < members; ++i)
+                    {
+                        if (struct_type.member(i).name() == key)
+                        {
+                            index = i;
+                            break;
+                        }
+                    }
+                }
+
+                if (index == members)
+                {
+                    // Unknown members are ignored
+                    if (!cursor.skip_value(depth + 1))
+                    {
+                        return false;
+                    }
+                    continue;
+                }
+
+                xtypes::WritableDynamicDataRef member = data[index];
+                if (!read_value(cursor, member, depth + 1, complete))
+                {
+                    return false;
+                }
+                if (index < MaxTrackedMembers && !(found & (uint64_t(1) << index)))
+                {
+                    found |= uint64_t(1) << index;
+                    ++found_count;
+                }
+                hint = index + 1;
+            } while (cursor.consume(','));
+            complete = complete && found_count == members;
+            return cursor.consume('}');
+        }
+        default:
+            return false;
+    }
+}
+
+} //  anonymous namespace
+
+//==============================================================================
+bool JsonReader::scan_envelope(
+        std::string_view message,
+        Envelope& envelope)
+{
+    Cursor cursor(message);
+    envelope = Envelope();
+
+    if (!cursor.consume('{'))
+    {
+        return false;
+    }
+    if (cursor.consume('}'))
+    {
+        return cursor.finished();
+    }
+
+    do
+    {
+        std::string_view key;
+        if (!cursor.read_plain_string(key) || !cursor.consume(':'))
+        {
+            return false;
+        }
+
+        cursor.skip_whitespace();
+        const char* const begin = cursor.position();
+
+        if (key == EnvelopeOpKey || key == EnvelopeTopicKey || key == EnvelopeServiceKey)
+        {
+            std::string_view& field = (key == EnvelopeOpKey) ? envelope.op :
+                    (key == EnvelopeTopicKey) ? envelope.topic : envelope.service;
+            if (!cursor.read_plain_string(field))
+            {
+                return false;
+            }
+        }
+        else if (key == EnvelopeIdKey && cursor.peek('"'))
+        {
+            if (!cursor.read_plain_string(envelope.id))
+            {
+                return false;
+            }
+        }
+        else
+        {
+            if (!cursor.skip_value(0))
+            {
+                return false;
+            }
+
+            const std::string_view value(begin, static_cast<size_t>(cursor.position() - begin));
+            if (key == EnvelopeIdKey)
+            {
+                envelope.id = value;
+            }
+            else if (key == EnvelopeMsgKey)
+            {
+                envelope.msg = value;
+            }
+            else if (key == EnvelopeMsgsKey)
+            {
+                envelope.msgs = value;
+            }
+            else if (key == EnvelopeArgsKey)
+            {
+                envelope.args = value;
+            }
+            else if (key == EnvelopeValuesKey)
+            {
+                envelope.values = value;
+            }
+            else if (key == EnvelopeFragmentSizeKey)
+            {
+                envelope.fragment_size = value;
+            }
+        }
+    } while (cursor.consume(','));
+
+    return cursor.consume('}') && cursor.finished();
+}
+
+//==============================================================================
+bool JsonReader::split_array(
+        std::string_view json,
+        std::vector<std::string_view>& elements)
+{
+    Cursor cursor(json);
+    elements.clear();
+
+    if (!cursor.consume('['))
+    {
+        return false;
+    }
+    if (cursor.consume(']'))
+    {
+        return cursor.finished();
+    }
+
+    do
+    {
+        cursor.skip_whitespace();
+        const char* const begin = cursor.position();
+        if (!cursor.skip_value(0))
+        {
+            return false;
+        }
+
+        elements.emplace_back(begin, static_cast<size_t>(cursor.position() - begin));
+    } while (cursor.consume(','));
+
+    return cursor.consume(']') && cursor.finished();
+}
+
+//==============================================================================
+bool JsonReader::read(
+        std::string_view json,
+        xtypes::WritableDynamicDataRef& data,
+        bool* complete)
+{
+    Cursor cursor(json);
+    bool all_written = true;
+    const bool success = read_value(cursor, data, 0, all_written) && cursor.finished();
+    if (nullptr != complete)
+    {
+        *complete = success && all_written;
+    }
+    return success;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,116 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__JSONREADER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__JSONREADER_HPP_
+
+#include <is/core/Message.hpp>
+
+#include <string_view>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class JsonReader
+ * @brief On-demand reader for incoming *JSON* messages, which never builds a *JSON* document.
+ * @details The envelope of a message is scanned first, so that its operation and destination
+ *          can be known before touching the payload; then the payload is read straight into
+ *          the destination *xTypes* data. Only the types for which JsonWriter::supports() holds
+ *          can be read; any other type must be converted using *is-json-xtypes* instead.
+ */
+class JsonReader
+{
+public:
+
+    /**
+     * @brief Fields of a rosbridge message envelope, pointing into the scanned message.
+     * @details The string fields hold the unquoted values; the `id` may also hold a raw number.
+     *          The payload fields, as well as the `fragment_size`, hold the raw *JSON* text of the value.
+     *          Absent fields are empty.
+     */
+    struct Envelope
+    {
+        std::string_view op;
+        std::string_view topic;
+        std::string_view service;
+        std::string_view id;
+        std::string_view msg;
+        std::string_view msgs;
+        std::string_view args;
+        std::string_view values;
+        std::string_view fragment_size;
+    };
+
+    /**
+     * @brief Scans the top level fields of a message.
+     *
+     * @param[in] message The raw *JSON* message. It must outlive the envelope.
+     *
+     * @param[out] envelope The scanned fields.
+     *
+     * @returns `true` if the message is a well formed object whose envelope fields can be
+     *          used without unescaping, or `false` if it must be parsed as a *JSON* document.
+     */
+    static bool scan_envelope(
+            std::string_view message,
+            Envelope& envelope);
+
+    /**
+     * @brief Splits a *JSON* array into the raw text of its elements.
+     *
+     * @param[in] json The raw *JSON* text of the array. It must outlive the elements.
+     *
+     * @param[out] elements The text of each element, in order.
+     *
+     * @returns `true` if the text is a well formed array.
+     */
+    static bool split_array(
+            std::string_view json,
+            std::vector<std::string_view>& elements);
+
+    /**
+     * @brief Reads a *JSON* value straight into some data.
+     *
+     * @pre The data type must be supported by the JsonWriter.
+     *
+     * @param[in] json The raw *JSON* text of the value.
+     *
+     * @param[out] data The destination data. Members not present in the *JSON* object keep their value.
+     *
+     * @param[out] complete If not null, it tells whether every member and array element of the data
+     *             has been written, so that no value from its previous contents is left.
+     *
+     * @returns `true` if the value was read, or `false` if it is malformed or does not match the data type;
+     *          in that case, the data might have been partially modified.
+     */
+    static bool read(
+            std::string_view json,
+            xtypes::WritableDynamicDataRef& data,
+            bool* complete = nullptr);
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__JSONREADER_HPP_
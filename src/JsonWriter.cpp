@@ -0,0 +1,236 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "JsonWriter.hpp"
+
+#include <is/json-xtypes/json.hpp>
+
+#include <charconv>
+#include <cmath>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+template<typename T>
+static void write_integer(
+        const T value,
+        std::string& output)
+{
+    char buffer[24];
+    const auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    output.append(buffer, result.ptr);
+}
+
+//==============================================================================
+static void write_floating_point(
+        const double value,
+        std::string& output)
+{
+    // Same output as nlohmann::json::dump(), which is used when converting with is-json-xtypes
+    if (!std::isfinite(value))
+    {
+        output += "null";
+        return;
+    }
+
+    char buffer[64];
+    char* const end = nlohmann::detail::to_chars(buffer, buffer + sizeof(buffer), value);
+    output.append(buffer, end);
+}
+
+//==============================================================================
+bool JsonWriter::supports(
+        const xtypes::DynamicType& type)
+{
+    switch (type.kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+        case xtypes::TypeKind::INT_8_TYPE:
+        case xtypes::TypeKind::UINT_8_TYPE:
+        case xtypes::TypeKind::INT_16_TYPE:
+        case xtypes::TypeKind::UINT_16_TYPE:
+        case xtypes::TypeKind::INT_32_TYPE:
+        case xtypes::TypeKind::UINT_32_TYPE:
+        case xtypes::TypeKind::INT_64_TYPE:
+        case xtypes::TypeKind::UINT_64_TYPE:
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+        case xtypes::TypeKind::STRING_TYPE:
+            return true;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+            return supports(static_cast<const xtypes::CollectionType&>(type).content_type());
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            const xtypes::StructType& struct_type = static_cast<const xtypes::StructType&>(type);
+            for (const xtypes::Member& member : struct_type.members())
+            {
+                if (!supports(member.type()))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+        default:
+            // Characters, wide strings, enumerations, unions, maps... are left to is-json-xtypes
+            return false;
+    }
+}
+
+//==============================================================================
+void JsonWriter::write(
+        const xtypes::ReadableDynamicDataRef& data,
+        std::string& output)
+{
+    switch (data.type().kind())
+    {
+        case xtypes::TypeKind::BOOLEAN_TYPE:
+            output += data.value<bool>() ? "true" : "false";
+            break;
+        case xtypes::TypeKind::INT_8_TYPE:
+            write_integer(data.value<int8_t>(), output);
+            break;
+        case xtypes::TypeKind::UINT_8_TYPE:
+            write_integer(data.value<uint8_t>(), output);
+            break;
+        case xtypes::TypeKind::INT_16_TYPE:
+            write_integer(data.value<int16_t>(), output);
+            break;
+        case xtypes::TypeKind::UINT_16_TYPE:
+            write_integer(data.value<uint16_t>(), output);
+            break;
+        case xtypes::TypeKind::INT_32_TYPE:
+            write_integer(data.value<int32_t>(), output);
+            break;
+        case xtypes::TypeKind::UINT_32_TYPE:
+            write_integer(data.value<uint32_t>(), output);
+            break;
+        case xtypes::TypeKind::INT_64_TYPE:
+            write_integer(data.value<int64_t>(), output);
+            break;
+        case xtypes::TypeKind::UINT_64_TYPE:
+            write_integer(data.value<uint64_t>(), output);
+            break;
+        case xtypes::TypeKind::FLOAT_32_TYPE:
+            write_floating_point(static_cast<double>(data.value<float>()), output);
+            break;
+        case xtypes::TypeKind::FLOAT_64_TYPE:
+            write_floating_point(data.value<double>(), output);
+            break;
+        case xtypes::TypeKind::STRING_TYPE:
+            write_string(data.value<std::string>(), output);
+            break;
+        case xtypes::TypeKind::ARRAY_TYPE:
+        case xtypes::TypeKind::SEQUENCE_TYPE:
+        {
+            output += '[';
+            const size_t size = data.size();
+            for (size_t i = 0; i < size; ++i)
+            {
+                if (i > 0)
+                {
+                    output += ',';
+                }
+                write(data[i], output);
+            }
+            output += ']';
+            break;
+        }
+        case xtypes::TypeKind::STRUCTURE_TYPE:
+        {
+            const xtypes::StructType& struct_type = static_cast<const xtypes::StructType&>(data.type());
+            output += '{';
+            const size_t members = struct_type.members().size();
+            for (size_t i = 0; i < members; ++i)
+            {
+                if (i > 0)
+                {
+                    output += ',';
+                }
+                write_string(struct_type.member(i).name(), output);
+                output += ':';
+                write(data[i], output);
+            }
+            output += '}';
+            break;
+        }
+        default:
+            // Not reachable as long as supports() was checked beforehand
+            output += "null";
+            break;
+    }
+}
+
+//==============================================================================
+void JsonWriter::write_string(
+        std::string_view value,
+        std::string& output)
+{
+    static const char hex_digits[] = "0123456789abcdef";
+
+    output += '"';
+    for (const char c : value)
+    {
+        switch (c)
+        {
+            case '"':
+                output += "\\\"";
+                break;
+            case '\\':
+                output += "\\\\";
+                break;
+            case '\b':
+                output += "\\b";
+                break;
+            case '\f':
+                output += "\\f";
+                break;
+            case '\n':
+                output += "\\n";
+                break;
+            case '\r':
+                output += "\\r";
+                break;
+            case '\t':
+                output += "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20)
+                {
+                    output += "\\u00";
+                    output += hex_digits[(c >> 4) & 0x0F];
+                    output += hex_digits[c & 0x0F];
+                }
+                else
+                {
+                    output += c;
+                }
+                break;
+        }
+    }
+    output += '"';
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
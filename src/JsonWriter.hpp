@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__JSONWRITER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__JSONWRITER_HPP_
+
+#include <is/core/Message.hpp>
+
+#include <string>
+#include <string_view>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class JsonWriter
+ * @brief Serializes *xTypes* data straight into a *JSON* text buffer, walking the data only once
+ *        and without building an intermediate *JSON* document.
+ * @details Only the types for which supports() holds can be written; any other type must be
+ *          converted using *is-json-xtypes* instead. The output is equivalent to the one obtained
+ *          with `json_xtypes::convert`, except for the members order, which here follows the type definition.
+ */
+class JsonWriter
+{
+public:
+
+    /**
+     * @brief Checks whether a type can be written by this class.
+     *
+     * @param[in] type The type to be checked, including all its nested types.
+     *
+     * @returns `true` if the type is made only of booleans, integers, floating points,
+     *          strings, structures, sequences and arrays, or `false` otherwise.
+     */
+    static bool supports(
+            const xtypes::DynamicType& type);
+
+    /**
+     * @brief Appends the *JSON* representation of some data to the output buffer.
+     *
+     * @pre The data type must be supported.
+     *
+     * @param[in] data The data to be written.
+     *
+     * @param[out] output The buffer where the data is appended to.
+     */
+    static void write(
+            const xtypes::ReadableDynamicDataRef& data,
+            std::string& output);
+
+    /**
+     * @brief Appends a quoted and escaped *JSON* string to the output buffer.
+     *
+     * @param[in] value The string to be written.
+     *
+     * @param[out] output The buffer where the string is appended to.
+     */
+    static void write_string(
+            std::string_view value,
+            std::string& output);
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__JSONWRITER_HPP_
@@ -2,8 +2,10 @@
 
 #include "Errors.hpp"
 
+#include <openssl/sha.h>
+
+#include <algorithm>
 #include <unordered_map>
-#include <regex>
 #include <utility>
 #include <iostream>
 
@@ -15,21 +17,73 @@ namespace websocket {
 VerificationPolicy::VerificationPolicy(
         std::vector<Rule> rules,
         std::vector<Rule> header_rules,
-        std::string secret_or_pubkey
+        std::string secret_or_pubkey,
+        std::string kid
         )
     : _secret_or_pubkey(std::move(secret_or_pubkey))
-    , _rules(std::move(rules))
-    , _header_rules(std::move(header_rules))
+    , _kid(std::move(kid))
+    , _is_pubkey(_secret_or_pubkey.find("-----BEGIN") != std::string::npos)
+{
+    // This is so that we don't have to compile the patterns everytime the policy is used.
+    _matchers.reserve(rules.size());
+    for (const auto& r : rules)
+    {
+        _matchers.emplace_back(r.first, GlobMatcher(r.second));
+    }
+    _header_matchers.reserve(header_rules.size());
+    for (const auto& r : header_rules)
+    {
+        _header_matchers.emplace_back(r.first, GlobMatcher(r.second));
+    }
+}
+
+bool VerificationPolicy::accepts(
+        const json_t& header,
+        std::string& reason) const
 {
-    // This is so that we don't have to create the regexes everytime the policy is used.
-    for (const auto& r : _rules)
+    const auto alg = header.find("alg");
+    if (alg == header.end() || !alg->is_string())
     {
-        _matchers[r.first] = std::regex{r.second};
+        reason = "'alg' not found in headers";
+        return false;
     }
-    for (const auto& r : _header_rules)
+
+    // MAC algorithms take a secret, while the others take a public key
+    const std::string& alg_str = alg->get_ref<const std::string&>();
+    if (alg_str.compare(0, 2, "HS") == 0)
     {
-        _header_matchers[r.first] = std::regex(r.second);
+        if (_is_pubkey)
+        {
+            reason = "'" + alg_str + "' requires a secret, not a public key";
+            return false;
+        }
+    }
+    else if (alg_str.compare(0, 2, "RS") == 0 || alg_str.compare(0, 2, "ES") == 0 ||
+            alg_str.compare(0, 2, "PS") == 0)
+    {
+        if (!_is_pubkey)
+        {
+            reason = "'" + alg_str + "' requires a public key, not a secret";
+            return false;
+        }
+    }
+    else
+    {
+        reason = "'" + alg_str + "' is not supported";
+        return false;
+    }
+
+    if (!_kid.empty())
+    {
+        const auto kid = header.find("kid");
+        if (kid == header.end() || !kid->is_string() || kid->get_ref<const std::string&>() != _kid)
+        {
+            reason = "'kid' does not match policy";
+            return false;
+        }
     }
+
+    return true;
 }
 
 void VerificationPolicy::check(
@@ -37,11 +91,8 @@ void VerificationPolicy::check(
         const json_t& header,
         const json_t& payload)
 {
-    jwt::decode(token, jwt::params::algorithms(
-                {header["alg"].get_ref<const std::string&>()}), jwt::params::secret(
-                _secret_or_pubkey));
-
-    for (const auto& r : _header_rules)
+    // The rules are checked first, as they are much cheaper than the signature
+    for (const auto& r : _header_matchers)
     {
         auto it = header.find(r.first);
         if (it == header.end())
@@ -53,13 +104,13 @@ void VerificationPolicy::check(
             throw jwt::VerificationError("'" + r.first + "' expected to be string");
         }
         const auto& s = it->get_ref<const std::string&>();
-        if (!std::regex_match(s, _header_matchers.at(r.first)))
+        if (!r.second.matches(s))
         {
             throw jwt::VerificationError("'" + r.first + "' does not match policy");
         }
     }
 
-    for (const auto& r : _rules)
+    for (const auto& r : _matchers)
     {
         auto it = payload.find(r.first);
         if (it == payload.end())
@@ -71,18 +122,130 @@ void VerificationPolicy::check(
             throw jwt::VerificationError("'" + r.first + "' expected to be string");
         }
         const auto& s = it->get_ref<const std::string&>();
-        if (!std::regex_match(s, _matchers.at(r.first)))
+        if (!r.second.matches(s))
         {
             throw jwt::VerificationError("'" + r.first + "' does not match policy");
         }
     }
+
+    jwt::decode(token, jwt::params::algorithms(
+                {header["alg"].get_ref<const std::string&>()}), jwt::params::secret(
+                _secret_or_pubkey));
 }
 
-void JwtValidator::verify(
+TokenCache::TokenCache(
+        std::size_t capacity,
+        std::chrono::seconds ttl)
+    : _capacity(capacity)
+    , _ttl(ttl)
+{
+}
+
+void TokenCache::configure(
+        std::size_t capacity,
+        std::chrono::seconds ttl)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _capacity = capacity;
+    _ttl = ttl;
+    _entries.clear();
+    _index.clear();
+}
+
+bool TokenCache::contains(
+        const std::string& token,
+        Clock::time_point now)
+{
+    const std::string key = digest(token);
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    const auto it = _index.find(key);
+    if (it == _index.end())
+    {
+        return false;
+    }
+
+    if (it->second->expiry <= now)
+    {
+        _entries.erase(it->second);
+        _index.erase(it);
+        return false;
+    }
+
+    _entries.splice(_entries.begin(), _entries, it->second);
+    return true;
+}
+
+void TokenCache::insert(
+        const std::string& token,
+        Clock::time_point expiry,
+        Clock::time_point now)
+{
+    std::string key = digest(token);
+
+    const std::lock_guard<std::mutex> lock(_mutex);
+    expiry = std::min(expiry, now + _ttl);
+    if (0 == _capacity || expiry <= now)
+    {
+        return;
+    }
+
+    const auto it = _index.find(key);
+    if (it != _index.end())
+    {
+        it->second->expiry = expiry;
+        _entries.splice(_entries.begin(), _entries, it->second);
+        return;
+    }
+
+    while (_entries.size() >= _capacity)
+    {
+        _index.erase(_entries.back().digest);
+        _entries.pop_back();
+    }
+
+    _entries.push_front(Entry{std::move(key), expiry});
+    _index.emplace(_entries.front().digest, _entries.begin());
+}
+
+void TokenCache::clear()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _entries.clear();
+    _index.clear();
+}
+
+std::size_t TokenCache::size() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _entries.size();
+}
+
+std::string TokenCache::digest(
         const std::string& token)
+{
+    std::string digest(SHA256_DIGEST_LENGTH, '\0');
+    SHA256(reinterpret_cast<const unsigned char*>(token.data()), token.size(),
+            reinterpret_cast<unsigned char*>(&digest[0]));
+    return digest;
+}
+
+JwtValidator::JwtValidator()
+    : _cache(std::make_unique<TokenCache>(DefaultCacheCapacity, DefaultCacheTtl))
+{
+}
+
+void JwtValidator::verify(
+        const std::string& token,
+        TokenCache::Clock::time_point now)
 {
     using namespace jwt::params;
 
+    if (_cache->contains(token, now))
+    {
+        return;
+    }
+
     auto parts = jwt::jwt_object::three_parts(token);
     json_t header = json_t::parse(
         jwt::base64_uri_decode(parts[0].data(), parts[0].size()), nullptr, false);
@@ -100,9 +263,26 @@ void JwtValidator::verify(
     std::vector<std::string> error_msgs(_verification_policies.size());
     for (size_t i = 0; i < _verification_policies.size(); i++)
     {
+        // Policies which cannot verify the token are skipped without checking the signature
+        if (!_verification_policies[i].accepts(header, error_msgs[i]))
+        {
+            continue;
+        }
+
         try
         {
             _verification_policies[i].check(token, header, payload);
+
+            TokenCache::Clock::time_point expiry = TokenCache::Clock::time_point::max();
+            const auto exp = payload.find("exp");
+            const uint64_t max_exp = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::seconds>(
+                        TokenCache::Clock::time_point::max().time_since_epoch()).count());
+            if (exp != payload.end() && exp->is_number_unsigned() && exp->get<uint64_t>() < max_exp)
+            {
+                expiry = TokenCache::Clock::time_point(std::chrono::seconds(exp->get<uint64_t>()));
+            }
+
+            _cache->insert(token, expiry, now);
             return;
         }
         catch (const jwt::VerificationError& e)
@@ -123,6 +303,19 @@ void JwtValidator::add_verification_policy(
         const VerificationPolicy& policy)
 {
     _verification_policies.emplace_back(policy);
+    _cache->clear();
+}
+
+void JwtValidator::set_cache_limits(
+        std::size_t capacity,
+        std::chrono::seconds ttl)
+{
+    _cache->configure(capacity, ttl);
+}
+
+std::size_t JwtValidator::cached_tokens() const
+{
+    return _cache->size();
 }
 
 } // namespace websocket
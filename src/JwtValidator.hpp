@@ -19,9 +19,15 @@
 #ifndef _WEBSOCKET_IS_SH__SRC__JWTVALIDATOR_HPP_
 #define _WEBSOCKET_IS_SH__SRC__JWTVALIDATOR_HPP_
 
+#include "GlobMatcher.hpp"
+
 #include <jwt/jwt.hpp>
 
-#include <regex>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 namespace eprosima {
 namespace is {
@@ -38,7 +44,7 @@ class VerificationPolicy
 public:
 
     /**
-     * @brief Rule signature.
+     * @brief Rule signature: the claim, and the glob pattern its value must match.
      */
     using Rule = std::pair<std::string, std::string>;
 
@@ -48,7 +54,8 @@ public:
     VerificationPolicy(
             std::vector<Rule> rules,
             std::vector<Rule> header_rules,
-            std::string secret_or_pubkey);
+            std::string secret_or_pubkey,
+            std::string kid = "");
 
     /**
      * @brief Retrieves the public key or secret.
@@ -58,6 +65,19 @@ public:
         return _secret_or_pubkey;
     }
 
+    /**
+     * @brief Tells whether the policy may verify a token, judging only by its header: the `alg`
+     *        must match the kind of key of the policy and, if the policy has a `kid`, so must the
+     *        one of the token. It is much cheaper than a check.
+     *
+     * @param[in] header The header of the token.
+     *
+     * @param[out] reason Why the policy cannot verify the token, if it cannot.
+     */
+    bool accepts(
+            const json_t& header,
+            std::string& reason) const;
+
     void check(
             const std::string& token,
             const json_t& header,
@@ -66,10 +86,79 @@ public:
 private:
 
     std::string _secret_or_pubkey;
-    std::vector<Rule> _rules;
-    std::vector<Rule> _header_rules;
-    std::unordered_map<std::string, std::regex> _matchers;
-    std::unordered_map<std::string, std::regex> _header_matchers;
+    std::string _kid;
+    bool _is_pubkey;
+    std::vector<std::pair<std::string, GlobMatcher>> _matchers;
+    std::vector<std::pair<std::string, GlobMatcher>> _header_matchers;
+};
+
+/**
+ * @class TokenCache
+ * @brief Bounded LRU set of the tokens which passed verification, so that clients reconnecting
+ *        with the same token do not pay for the signature verification again.
+ * @details Tokens are keyed by their SHA-256 digest, and are forgotten once they expire or once
+ *          they have been cached for longer than the time to live.
+ */
+class TokenCache
+{
+public:
+
+    using Clock = std::chrono::system_clock;
+
+    TokenCache(
+            std::size_t capacity,
+            std::chrono::seconds ttl);
+
+    /**
+     * @brief Changes the limits of the cache, forgetting every token.
+     */
+    void configure(
+            std::size_t capacity,
+            std::chrono::seconds ttl);
+
+    /**
+     * @brief Tells whether a token is cached and still valid, forgetting it otherwise.
+     */
+    bool contains(
+            const std::string& token,
+            Clock::time_point now);
+
+    /**
+     * @brief Caches a verified token until its expiry, at most for the time to live.
+     */
+    void insert(
+            const std::string& token,
+            Clock::time_point expiry,
+            Clock::time_point now);
+
+    /**
+     * @brief Forgets every token.
+     */
+    void clear();
+
+    /**
+     * @brief Number of cached tokens.
+     */
+    std::size_t size() const;
+
+private:
+
+    struct Entry
+    {
+        std::string digest;
+        Clock::time_point expiry;
+    };
+
+    static std::string digest(
+            const std::string& token);
+
+    mutable std::mutex _mutex;
+    std::size_t _capacity;
+    std::chrono::seconds _ttl;
+
+    // Most recently used first
+    std::list<Entry> _entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> _index;
 };
 
 /**
@@ -81,15 +170,23 @@ class JwtValidator
 {
 public:
 
+    static constexpr std::size_t DefaultCacheCapacity = 1024;
+    static constexpr std::chrono::seconds DefaultCacheTtl = std::chrono::seconds(300);
+
+    JwtValidator();
+
     /**
-     * @brief Verifies the token.
+     * @brief Verifies the token. Tokens verified recently are accepted straight away.
      *
      * @param [in] token String containing the *JSON Web Token*.
      *
+     * @param [in] now Current time, against which the cached tokens expire.
+     *
      * @throws VerificationError
      */
     void verify(
-            const std::string& token);
+            const std::string& token,
+            TokenCache::Clock::time_point now = TokenCache::Clock::now());
 
 
     /**
@@ -107,9 +204,24 @@ public:
     void add_verification_policy(
             const VerificationPolicy& policy);
 
+    /**
+     * @brief Changes the limits of the cache of verified tokens. A capacity of zero disables it.
+     */
+    void set_cache_limits(
+            std::size_t capacity,
+            std::chrono::seconds ttl);
+
+    /**
+     * @brief Number of verified tokens currently cached.
+     */
+    std::size_t cached_tokens() const;
+
 private:
 
     std::vector<VerificationPolicy> _verification_policies;
+
+    // Handshakes are validated concurrently by the server threads
+    std::unique_ptr<TokenCache> _cache;
 };
 
 } //  namespace websocket
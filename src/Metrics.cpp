@@ -0,0 +1,270 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <sstream>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+static const char* type_name(
+        MetricsRegistry::Type type)
+{
+    switch (type)
+    {
+        case MetricsRegistry::Type::COUNTER:
+            return "counter";
+        case MetricsRegistry::Type::GAUGE:
+            return "gauge";
+        case MetricsRegistry::Type::HISTOGRAM:
+            return "histogram";
+    }
+
+    return "untyped";
+}
+
+//==============================================================================
+static void write_value(
+        std::ostringstream& output,
+        double value)
+{
+    if (value == static_cast<double>(static_cast<int64_t>(value)))
+    {
+        output << static_cast<int64_t>(value);
+    }
+    else
+    {
+        output << value;
+    }
+}
+
+//==============================================================================
+std::string render_labels(
+        const MetricsRegistry::Labels& labels)
+{
+    if (labels.empty())
+    {
+        return std::string();
+    }
+
+    std::string output = "{";
+    for (std::size_t i = 0; i < labels.size(); ++i)
+    {
+        if (i > 0)
+        {
+            output += ',';
+        }
+
+        output += labels[i].first;
+        output += "=\"";
+        for (const char c : labels[i].second)
+        {
+            if ('\\' == c || '"' == c)
+            {
+                output += '\\';
+                output += c;
+            }
+            else if ('\n' == c)
+            {
+                output += "\\n";
+            }
+            else
+            {
+                output += c;
+            }
+        }
+        output += '"';
+    }
+    output += '}';
+    return output;
+}
+
+//==============================================================================
+MetricsRegistry::Histogram::Histogram()
+    : _buckets(new std::atomic<uint64_t>[bounds().size()])
+{
+    for (std::size_t i = 0; i < bounds().size(); ++i)
+    {
+        _buckets[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+//==============================================================================
+void MetricsRegistry::Histogram::observe(
+        std::chrono::nanoseconds duration)
+{
+    const double seconds = std::chrono::duration<double>(duration).count();
+    const std::vector<double>& upper_bounds = bounds();
+
+    // Buckets are not cumulative here, they are summed up when rendered
+    const auto it = std::lower_bound(upper_bounds.begin(), upper_bounds.end(), seconds);
+    if (it != upper_bounds.end())
+    {
+        _buckets[static_cast<std::size_t>(it - upper_bounds.begin())].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    _count.fetch_add(1, std::memory_order_relaxed);
+    _sum_ns.fetch_add(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)), std::memory_order_relaxed);
+}
+
+//==============================================================================
+const std::vector<double>& MetricsRegistry::Histogram::bounds()
+{
+    static const std::vector<double> upper_bounds = {
+        0.00001, 0.00005, 0.0001, 0.0005, 0.001, 0.005, 0.01, 0.05, 0.1, 0.5, 1, 10};
+    return upper_bounds;
+}
+
+//==============================================================================
+MetricsRegistry::Family& MetricsRegistry::family(
+        const std::string& name,
+        const std::string& help,
+        Type type)
+{
+    auto it = _families.find(name);
+    if (it == _families.end())
+    {
+        it = _families.emplace(name, Family()).first;
+        it->second.type = type;
+        it->second.help = help;
+    }
+
+    return it->second;
+}
+
+//==============================================================================
+MetricsRegistry::Counter& MetricsRegistry::counter(
+        const std::string& name,
+        const std::string& help,
+        const Labels& labels)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    std::unique_ptr<Counter>& counter = family(name, help, Type::COUNTER).counters[render_labels(labels)];
+    if (!counter)
+    {
+        counter = std::make_unique<Counter>();
+    }
+    return *counter;
+}
+
+//==============================================================================
+MetricsRegistry::Histogram& MetricsRegistry::histogram(
+        const std::string& name,
+        const std::string& help,
+        const Labels& labels)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    std::unique_ptr<Histogram>& histogram = family(name, help, Type::HISTOGRAM).histograms[render_labels(labels)];
+    if (!histogram)
+    {
+        histogram = std::make_unique<Histogram>();
+    }
+    return *histogram;
+}
+
+//==============================================================================
+void MetricsRegistry::sampled(
+        const std::string& name,
+        const std::string& help,
+        Type type,
+        Sampler sampler)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    family(name, help, type).sampler = std::move(sampler);
+}
+
+//==============================================================================
+std::string MetricsRegistry::render() const
+{
+    // The samplers take the locks of their components, which may be held while registering
+    // metrics, so they are called once the registry is unlocked.
+    std::vector<std::pair<std::string, Sampler>> samplers;
+    std::vector<std::string> outputs;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        outputs.reserve(_families.size());
+        for (const auto& [name, family] : _families)
+        {
+            std::ostringstream output;
+            output << "# HELP " << name << ' ' << family.help << '\n';
+            output << "# TYPE " << name << ' ' << type_name(family.type) << '\n';
+
+            for (const auto& [labels, counter] : family.counters)
+            {
+                output << name << labels << ' ' << counter->value() << '\n';
+            }
+
+            for (const auto& [labels, histogram] : family.histograms)
+            {
+                // The bucket bound goes along with the other labels
+                const std::string prefix = labels.empty() ? "{" : labels.substr(0, labels.size() - 1) + ",";
+                const std::vector<double>& upper_bounds = Histogram::bounds();
+                uint64_t cumulative = 0;
+                for (std::size_t i = 0; i < upper_bounds.size(); ++i)
+                {
+                    cumulative += histogram->_buckets[i].load(std::memory_order_relaxed);
+                    output << name << "_bucket" << prefix << "le=\"" << upper_bounds[i] << "\"} " << cumulative << '\n';
+                }
+
+                // Observations under way may have been counted in a bucket but not in the total yet
+                const uint64_t count = std::max(histogram->count(), cumulative);
+                output << name << "_bucket" << prefix << "le=\"+Inf\"} " << count << '\n';
+                output << name << "_sum" << labels << ' ' << histogram->_sum_ns.load(std::memory_order_relaxed) / 1e9
+                       << '\n';
+                output << name << "_count" << labels << ' ' << count << '\n';
+            }
+
+            outputs.push_back(output.str());
+            samplers.emplace_back(name, family.sampler);
+        }
+    }
+
+    std::string result;
+    for (std::size_t i = 0; i < outputs.size(); ++i)
+    {
+        result += outputs[i];
+
+        const auto& [name, sampler] = samplers[i];
+        if (sampler)
+        {
+            Samples samples;
+            sampler(samples);
+
+            std::ostringstream output;
+            for (const auto& [labels, value] : samples)
+            {
+                output << name << render_labels(labels) << ' ';
+                write_value(output, value);
+                output << '\n';
+            }
+            result += output.str();
+        }
+    }
+
+    return result;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
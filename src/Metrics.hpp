@@ -0,0 +1,219 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__METRICS_HPP_
+#define _WEBSOCKET_IS_SH__SRC__METRICS_HPP_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class MetricsRegistry
+ * @brief Counters and histograms of an endpoint, rendered in the Prometheus text exposition format.
+ * @details Metrics are registered once, under a lock, and then updated through the returned
+ *          references with relaxed atomic operations only. Gauges, as well as the counters kept
+ *          by other components, are sampled by callbacks when the metrics are rendered.
+ */
+class MetricsRegistry
+{
+public:
+
+    using Labels = std::vector<std::pair<std::string, std::string>>;
+
+    /**
+     * @brief Monotonic counter.
+     */
+    class Counter
+    {
+    public:
+
+        void increment(
+                uint64_t amount = 1)
+        {
+            _value.fetch_add(amount, std::memory_order_relaxed);
+        }
+
+        uint64_t value() const
+        {
+            return _value.load(std::memory_order_relaxed);
+        }
+
+    private:
+
+        std::atomic<uint64_t> _value{0};
+    };
+
+    /**
+     * @brief Histogram of durations, with fixed buckets from 10 microseconds to 10 seconds.
+     */
+    class Histogram
+    {
+    public:
+
+        Histogram();
+
+        void observe(
+                std::chrono::nanoseconds duration);
+
+        /**
+         * @brief Upper bounds of the buckets, in seconds. The last, infinite one is implicit.
+         */
+        static const std::vector<double>& bounds();
+
+        uint64_t count() const
+        {
+            return _count.load(std::memory_order_relaxed);
+        }
+
+    private:
+
+        friend class MetricsRegistry;
+
+        std::unique_ptr<std::atomic<uint64_t>[]> _buckets;
+        std::atomic<uint64_t> _count{0};
+        std::atomic<uint64_t> _sum_ns{0};
+    };
+
+    /**
+     * @brief Measures the time until it is destroyed into a histogram, if any.
+     */
+    class ScopedTimer
+    {
+    public:
+
+        explicit ScopedTimer(
+                Histogram* histogram)
+            : _histogram(histogram)
+            , _start(nullptr != histogram ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point())
+        {
+        }
+
+        ~ScopedTimer()
+        {
+            if (nullptr != _histogram)
+            {
+                _histogram->observe(std::chrono::steady_clock::now() - _start);
+            }
+        }
+
+        ScopedTimer(
+                const ScopedTimer&) = delete;
+
+        ScopedTimer& operator =(
+                const ScopedTimer&) = delete;
+
+    private:
+
+        Histogram* const _histogram;
+        const std::chrono::steady_clock::time_point _start;
+    };
+
+    enum class Type
+    {
+        COUNTER,
+        GAUGE,
+        HISTOGRAM
+    };
+
+    /**
+     * @brief Values of a sampled family, one for each set of labels.
+     */
+    using Samples = std::vector<std::pair<Labels, double>>;
+    using Sampler = std::function<void(Samples&)>;
+
+    /**
+     * @brief Gets the counter of a family with the given labels, creating it if needed.
+     *        The reference is valid as long as the registry.
+     */
+    Counter& counter(
+            const std::string& name,
+            const std::string& help,
+            const Labels& labels = {});
+
+    /**
+     * @brief Gets the histogram of a family with the given labels, creating it if needed.
+     *        The reference is valid as long as the registry.
+     */
+    Histogram& histogram(
+            const std::string& name,
+            const std::string& help,
+            const Labels& labels = {});
+
+    /**
+     * @brief Adds a family whose values are taken from a callback every time the metrics are rendered.
+     *
+     * @param[in] type Either COUNTER or GAUGE.
+     */
+    void sampled(
+            const std::string& name,
+            const std::string& help,
+            Type type,
+            Sampler sampler);
+
+    /**
+     * @brief Renders every family in the Prometheus text exposition format.
+     */
+    std::string render() const;
+
+private:
+
+    struct Family
+    {
+        Type type;
+        std::string help;
+
+        // Keyed by the rendered labels
+        std::map<std::string, std::unique_ptr<Counter>> counters;
+        std::map<std::string, std::unique_ptr<Histogram>> histograms;
+        Sampler sampler;
+    };
+
+    Family& family(
+            const std::string& name,
+            const std::string& help,
+            Type type);
+
+    mutable std::mutex _mutex;
+    std::map<std::string, Family> _families;
+};
+
+/**
+ * @brief Renders a set of labels as `{name="value",...}`, escaping their values.
+ */
+std::string render_labels(
+        const MetricsRegistry::Labels& labels);
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__METRICS_HPP_
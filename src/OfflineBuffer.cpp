@@ -0,0 +1,171 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include "OfflineBuffer.hpp"
+
+#include <iterator>
+#include <utility>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+const std::string YamlMaxMessagesKey = "max_messages";
+const std::string YamlModeKey = "mode";
+const std::string YamlModeAllValue = "all";
+const std::string YamlModeLatestValue = "latest";
+
+// Publications held by a buffer enabled with just `true`
+constexpr std::size_t DefaultMaxMessages = 1024;
+
+//==============================================================================
+bool parse_offline_buffer_options(
+        const YAML::Node& offline_buffer_node,
+        OfflineBufferOptions& options,
+        std::string& error)
+{
+    try
+    {
+        if (offline_buffer_node.IsScalar())
+        {
+            options.max_messages = offline_buffer_node.as<bool>() ? DefaultMaxMessages : 0;
+            return true;
+        }
+
+        if (!offline_buffer_node.IsMap())
+        {
+            error = "expected a boolean or a map";
+            return false;
+        }
+
+        options.max_messages = DefaultMaxMessages;
+        if (const YAML::Node max_messages_node = offline_buffer_node[YamlMaxMessagesKey])
+        {
+            options.max_messages = max_messages_node.as<std::size_t>();
+        }
+
+        if (const YAML::Node mode_node = offline_buffer_node[YamlModeKey])
+        {
+            const std::string mode = mode_node.as<std::string>();
+            if (mode != YamlModeAllValue && mode != YamlModeLatestValue)
+            {
+                error = "unknown '" + YamlModeKey + "' '" + mode + "'. Valid values are '"
+                        + YamlModeAllValue + "' and '" + YamlModeLatestValue + "'";
+                return false;
+            }
+
+            options.latest_only = YamlModeLatestValue == mode;
+        }
+    }
+    catch (const YAML::BadConversion& e)
+    {
+        error = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+OfflineBuffer::OfflineBuffer(
+        const OfflineBufferOptions& options)
+    : _options(options)
+    , _dropped(0)
+{
+}
+
+//==============================================================================
+void OfflineBuffer::add(
+        const std::string& topic,
+        std::string payload)
+{
+    if (!enabled())
+    {
+        return;
+    }
+
+    if (_options.latest_only)
+    {
+        const auto it = _latest.find(topic);
+        if (it != _latest.end())
+        {
+            // The replaced publication counts as the newest one
+            it->second->payload = std::move(payload);
+            _publications.splice(_publications.end(), _publications, it->second);
+            return;
+        }
+    }
+
+    if (_publications.size() >= _options.max_messages)
+    {
+        if (_options.latest_only)
+        {
+            _latest.erase(_publications.front().topic);
+        }
+
+        _publications.pop_front();
+        ++_dropped;
+    }
+
+    _publications.push_back(Publication{topic, std::move(payload)});
+    if (_options.latest_only)
+    {
+        _latest.emplace(topic, std::prev(_publications.end()));
+    }
+}
+
+//==============================================================================
+std::vector<std::string> OfflineBuffer::take(
+        const std::string& topic)
+{
+    std::vector<std::string> payloads;
+    if (_options.latest_only)
+    {
+        const auto it = _latest.find(topic);
+        if (it != _latest.end())
+        {
+            payloads.push_back(std::move(it->second->payload));
+            _publications.erase(it->second);
+            _latest.erase(it);
+        }
+
+        return payloads;
+    }
+
+    for (auto it = _publications.begin(); it != _publications.end(); )
+    {
+        if (it->topic == topic)
+        {
+            payloads.push_back(std::move(it->payload));
+            it = _publications.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+
+    return payloads;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,130 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef _WEBSOCKET_IS_SH__SRC__OFFLINEBUFFER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__OFFLINEBUFFER_HPP_
+
+#include <yaml-cpp/yaml.h>
+
+#include <cstddef>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Limits of the publications held while no one listens to their topic.
+ */
+struct OfflineBufferOptions
+{
+    /**
+     * Publications held, among every topic. Zero disables the buffer.
+     */
+    std::size_t max_messages = 0;
+
+    /**
+     * Whether only the last publication of each topic is held.
+     */
+    bool latest_only = false;
+};
+
+/**
+ * @brief Parses the `offline_buffer` node of the configuration, which is either a boolean, to hold up to
+ *        1024 publications, or a map with any of the settings. Missing settings keep their value.
+ *
+ * @param[out] error Why the settings are not valid, if they are not.
+ *
+ * @returns `true` if every setting is valid.
+ */
+bool parse_offline_buffer_options(
+        const YAML::Node& offline_buffer_node,
+        OfflineBufferOptions& options,
+        std::string& error);
+
+/**
+ * @class OfflineBuffer
+ * @brief Holds the encoded publications of the topics which have no listener, until one shows up.
+ * @details Once full, the oldest publication of any topic is dropped to make room. It is not thread safe.
+ */
+class OfflineBuffer
+{
+public:
+
+    explicit OfflineBuffer(
+            const OfflineBufferOptions& options = OfflineBufferOptions());
+
+    bool enabled() const
+    {
+        return _options.max_messages > 0;
+    }
+
+    /**
+     * @brief Holds a publication, which replaces the previous one of its topic if only the latest are held.
+     */
+    void add(
+            const std::string& topic,
+            std::string payload);
+
+    /**
+     * @brief Releases the publications held for a topic, in the order they were added.
+     */
+    std::vector<std::string> take(
+            const std::string& topic);
+
+    std::size_t size() const
+    {
+        return _publications.size();
+    }
+
+    /**
+     * @brief Number of publications dropped to make room for newer ones.
+     */
+    std::size_t dropped() const
+    {
+        return _dropped;
+    }
+
+private:
+
+    struct Publication
+    {
+        std::string topic;
+        std::string payload;
+    };
+
+    OfflineBufferOptions _options;
+    std::list<Publication> _publications;
+
+    // Only used if the latest publications are held
+    std::unordered_map<std::string, std::list<Publication>::iterator> _latest;
+
+    std::size_t _dropped;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__OFFLINEBUFFER_HPP_
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "OutboundQueue.hpp"
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+bool parse_overflow_policy(
+        const std::string& name,
+        OverflowPolicy& policy)
+{
+    if (name == "drop_oldest")
+    {
+        policy = OverflowPolicy::DROP_OLDEST;
+    }
+    else if (name == "drop_newest")
+    {
+        policy = OverflowPolicy::DROP_NEWEST;
+    }
+    else if (name == "disconnect")
+    {
+        policy = OverflowPolicy::DISCONNECT;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+//==============================================================================
+OutboundQueue::OutboundQueue(
+        const Options& options,
+        Hooks hooks)
+    : _options(options)
+    , _hooks(std::move(hooks))
+    , _dropped(0)
+    , _flush_scheduled(false)
+    , _disconnected(false)
+{
+}
+
+//==============================================================================
+OutboundQueue::Result OutboundQueue::push(
+        const TlsMessagePtr& message,
+        OverflowPolicy policy)
+{
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        if (_disconnected)
+        {
+            return Result::DROPPED;
+        }
+
+        // Messages already held go first, so that the order is kept
+        while (!_held.empty() && has_room())
+        {
+            _hooks.send(_held.front());
+            _held.pop_front();
+        }
+
+        if (_held.empty() && has_room())
+        {
+            return _hooks.send(message) ? Result::SENT : Result::FAILED;
+        }
+
+        if (_held.size() < _options.max_messages)
+        {
+            _held.push_back(message);
+            schedule_flush();
+            return Result::QUEUED;
+        }
+
+        switch (policy)
+        {
+            case OverflowPolicy::DROP_NEWEST:
+                ++_dropped;
+                return Result::DROPPED;
+            case OverflowPolicy::DROP_OLDEST:
+                ++_dropped;
+                _held.pop_front();
+                _held.push_back(message);
+                return Result::QUEUED;
+            case OverflowPolicy::DISCONNECT:
+                break;
+        }
+
+        _dropped += _held.size() + 1;
+        _held.clear();
+        _disconnected = true;
+    }
+
+    if (_hooks.disconnect)
+    {
+        _hooks.disconnect();
+    }
+    return Result::DISCONNECTED;
+}
+
+//==============================================================================
+std::size_t OutboundQueue::flush()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _flush_scheduled = false;
+
+    while (!_held.empty() && has_room())
+    {
+        _hooks.send(_held.front());
+        _held.pop_front();
+    }
+
+    if (!_held.empty())
+    {
+        schedule_flush();
+    }
+    return _held.size();
+}
+
+//==============================================================================
+std::size_t OutboundQueue::depth() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _held.size();
+}
+
+//==============================================================================
+std::size_t OutboundQueue::dropped() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _dropped;
+}
+
+//==============================================================================
+bool OutboundQueue::has_room() const
+{
+    return !_hooks.buffered_amount || _hooks.buffered_amount() < _options.max_buffered_bytes;
+}
+
+//==============================================================================
+void OutboundQueue::schedule_flush()
+{
+    if (_flush_scheduled || !_hooks.schedule)
+    {
+        return;
+    }
+
+    const std::weak_ptr<OutboundQueue> weak_queue = weak_from_this();
+    _flush_scheduled = true;
+    _hooks.schedule([weak_queue]()
+            {
+                if (const OutboundQueuePtr queue = weak_queue.lock())
+                {
+                    queue->flush();
+                }
+            });
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__OUTBOUNDQUEUE_HPP_
+#define _WEBSOCKET_IS_SH__SRC__OUTBOUNDQUEUE_HPP_
+
+#include "websocket_types.hpp"
+
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief What to do with the messages of a connection that cannot keep up with them.
+ */
+enum class OverflowPolicy
+{
+    DROP_OLDEST,
+    DROP_NEWEST,
+    DISCONNECT
+};
+
+/**
+ * @brief Parses the name of an overflow policy, namely `drop_oldest`, `drop_newest` or `disconnect`.
+ *
+ * @returns `true` if the name is a valid policy, which is then written into `policy`.
+ */
+bool parse_overflow_policy(
+        const std::string& name,
+        OverflowPolicy& policy);
+
+/**
+ * @class OutboundQueue
+ * @brief Bounded send queue of a single connection.
+ * @details *websocketpp* buffers every message sent without any limit, so a slow peer would make
+ *          the memory grow unboundedly. Messages are handed to the connection as long as the amount
+ *          of bytes it still has to write is under a threshold; beyond it, they are held by this
+ *          queue, which holds a limited number of them and applies an OverflowPolicy once full.
+ *          The held messages are handed to the connection as it drains, on each new message and
+ *          on a flush scheduled through the Hooks.
+ */
+class OutboundQueue : public std::enable_shared_from_this<OutboundQueue>
+{
+public:
+
+    /**
+     * @brief Limits of the queue, and the policy applied by default.
+     */
+    struct Options
+    {
+        std::size_t max_buffered_bytes = 4 * 1024 * 1024;
+        std::size_t max_messages = 512;
+        OverflowPolicy policy = OverflowPolicy::DROP_OLDEST;
+    };
+
+    /**
+     * @brief Operations on the underlying connection.
+     */
+    struct Hooks
+    {
+        // Bytes handed to the connection but not written yet.
+        std::function<std::size_t()> buffered_amount;
+
+        // Hands a message to the connection. Returns false if it could not be sent.
+        std::function<bool(const TlsMessagePtr&)> send;
+
+        // Closes the connection, because of an overflow with the DISCONNECT policy.
+        std::function<void()> disconnect;
+
+        // Calls the given flush function at some later time, from any thread.
+        std::function<void(std::function<void()>)> schedule;
+    };
+
+    /**
+     * @brief Fate of a message pushed into the queue.
+     */
+    enum class Result
+    {
+        SENT,
+        QUEUED,
+        DROPPED,
+        DISCONNECTED,
+        FAILED
+    };
+
+    OutboundQueue(
+            const Options& options,
+            Hooks hooks);
+
+    /**
+     * @brief Sends a message, or holds it until the connection has room for it.
+     *
+     * @param[in] message The message to be sent.
+     *
+     * @param[in] policy The policy to be applied if the queue is full.
+     *
+     * @returns What happened to the message.
+     */
+    Result push(
+            const TlsMessagePtr& message,
+            OverflowPolicy policy);
+
+    /**
+     * @brief Sends a message, applying the default policy of the queue.
+     */
+    Result push(
+            const TlsMessagePtr& message)
+    {
+        return push(message, _options.policy);
+    }
+
+    /**
+     * @brief Hands the held messages to the connection, as long as it has room for them.
+     *
+     * @returns The number of messages still held.
+     */
+    std::size_t flush();
+
+    /**
+     * @brief Number of messages held by the queue, which have not been handed to the connection yet.
+     */
+    std::size_t depth() const;
+
+    /**
+     * @brief Number of messages dropped due to overflows since the queue was created.
+     */
+    std::size_t dropped() const;
+
+    const Options& options() const
+    {
+        return _options;
+    }
+
+private:
+
+    bool has_room() const;
+
+    void schedule_flush();
+
+    const Options _options;
+    const Hooks _hooks;
+
+    mutable std::mutex _mutex;
+    std::deque<TlsMessagePtr> _held;
+    std::size_t _dropped;
+    bool _flush_scheduled;
+    bool _disconnected;
+};
+
+using OutboundQueuePtr = std::shared_ptr<OutboundQueue>;
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__OUTBOUNDQUEUE_HPP_
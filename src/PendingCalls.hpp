@@ -0,0 +1,153 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__PENDINGCALLS_HPP_
+#define _WEBSOCKET_IS_SH__SRC__PENDINGCALLS_HPP_
+
+#include <array>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class PendingCalls
+ * @brief Keeps the calls waiting for their response, under the integer ID sent along with each request.
+ * @details IDs are taken from an atomic counter, and the calls are spread among shards of their own,
+ *          each with its own mutex, so that concurrent calls seldom contend for the same lock.
+ *
+ * @tparam T The information kept for each call.
+ */
+template<typename T>
+class PendingCalls
+{
+public:
+
+    static constexpr std::size_t Shards = 16;
+
+    /**
+     * @brief Constructor.
+     */
+    PendingCalls()
+        : _next_id(1)
+    {
+    }
+
+    /**
+     * @brief Keeps a new call.
+     *
+     * @returns The ID assigned to the call, which is never `0`.
+     */
+    uint64_t add(
+            T call)
+    {
+        const uint64_t id = _next_id.fetch_add(1, std::memory_order_relaxed);
+        Shard& shard = shard_of(id);
+
+        const std::lock_guard<std::mutex> lock(shard.mutex);
+        shard.calls.emplace(id, std::move(call));
+        return id;
+    }
+
+    /**
+     * @brief Removes a call, either because its response arrived or because it expired.
+     *
+     * @param[in] id The ID of the call.
+     *
+     * @param[out] call The information kept for the call, if it was still pending.
+     *
+     * @returns `true` if the call was still pending, or `false` otherwise.
+     */
+    bool take(
+            uint64_t id,
+            T& call)
+    {
+        Shard& shard = shard_of(id);
+
+        const std::lock_guard<std::mutex> lock(shard.mutex);
+        const auto it = shard.calls.find(id);
+        if (it == shard.calls.end())
+        {
+            return false;
+        }
+
+        call = std::move(it->second);
+        shard.calls.erase(it);
+        return true;
+    }
+
+    /**
+     * @brief Gets the number of pending calls.
+     */
+    std::size_t size() const
+    {
+        std::size_t calls = 0;
+        for (const Shard& shard : _shards)
+        {
+            const std::lock_guard<std::mutex> lock(shard.mutex);
+            calls += shard.calls.size();
+        }
+
+        return calls;
+    }
+
+    /**
+     * @brief Parses the ID of a call as received along with its response.
+     *
+     * @returns `true` if the whole text is a valid ID, or `false` otherwise.
+     */
+    static bool parse_id(
+            std::string_view text,
+            uint64_t& id)
+    {
+        const char* const end = text.data() + text.size();
+        const std::from_chars_result result = std::from_chars(text.data(), end, id);
+        return result.ec == std::errc() && result.ptr == end && id != 0;
+    }
+
+private:
+
+    struct Shard
+    {
+        mutable std::mutex mutex;
+        std::unordered_map<uint64_t, T> calls;
+    };
+
+    Shard& shard_of(
+            uint64_t id)
+    {
+        return _shards[id % Shards];
+    }
+
+    std::array<Shard, Shards> _shards;
+    std::atomic<uint64_t> _next_id;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__PENDINGCALLS_HPP_
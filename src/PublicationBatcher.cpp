@@ -0,0 +1,119 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "PublicationBatcher.hpp"
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+PublicationBatcher::PublicationBatcher(
+        const Options& options,
+        Hooks hooks)
+    : _options(options)
+    , _hooks(std::move(hooks))
+    , _bytes(0)
+    , _batches(0)
+    , _generation(0)
+{
+}
+
+//==============================================================================
+void PublicationBatcher::add(
+        std::string publication)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    _bytes += publication.size();
+    _publications.push_back(std::move(publication));
+
+    if (_publications.size() >= _options.max_messages || _bytes >= _options.max_bytes)
+    {
+        send_batch();
+        return;
+    }
+
+    if (_publications.size() > 1 || !_hooks.schedule)
+    {
+        return;
+    }
+
+    // The first publication of a batch starts its window
+    const std::weak_ptr<PublicationBatcher> weak_batcher = weak_from_this();
+    const uint64_t generation = _generation;
+    _hooks.schedule(_options.window, [weak_batcher, generation]()
+            {
+                const std::shared_ptr<PublicationBatcher> batcher = weak_batcher.lock();
+                if (!batcher)
+                {
+                    return;
+                }
+
+                const std::lock_guard<std::mutex> batcher_lock(batcher->_mutex);
+                if (generation == batcher->_generation)
+                {
+                    batcher->send_batch();
+                }
+            });
+}
+
+//==============================================================================
+void PublicationBatcher::flush()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    send_batch();
+}
+
+//==============================================================================
+std::size_t PublicationBatcher::pending() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _publications.size();
+}
+
+//==============================================================================
+std::size_t PublicationBatcher::batches() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _batches;
+}
+
+//==============================================================================
+void PublicationBatcher::send_batch()
+{
+    if (_publications.empty())
+    {
+        return;
+    }
+
+    std::vector<std::string> publications;
+    publications.swap(_publications);
+    _bytes = 0;
+    ++_batches;
+    ++_generation;
+
+    // Sent under the lock, so that the batches of the topic keep their order
+    _hooks.send(std::move(publications));
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
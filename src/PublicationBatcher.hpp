@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__PUBLICATIONBATCHER_HPP_
+#define _WEBSOCKET_IS_SH__SRC__PUBLICATIONBATCHER_HPP_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class PublicationBatcher
+ * @brief Gathers the encoded publications of a topic, so that they are sent together in a single
+ *        `batch` message instead of one *WebSocket* frame each.
+ * @details A batch is sent once it holds `max_messages` publications or `max_bytes` bytes, or
+ *          once `window` has elapsed since its first publication, whatever comes first.
+ */
+class PublicationBatcher : public std::enable_shared_from_this<PublicationBatcher>
+{
+public:
+
+    /**
+     * @brief Limits of a batch.
+     */
+    struct Options
+    {
+        std::chrono::milliseconds window{5};
+        std::size_t max_messages = 32;
+        std::size_t max_bytes = 64 * 1024;
+    };
+
+    /**
+     * @brief Operations on the topic.
+     */
+    struct Hooks
+    {
+        // Sends the publications of a batch, in the order they were added.
+        std::function<void(std::vector<std::string>&&)> send;
+
+        // Calls the given function once the delay has elapsed, from any thread.
+        std::function<void(std::chrono::milliseconds, std::function<void()>)> schedule;
+    };
+
+    PublicationBatcher(
+            const Options& options,
+            Hooks hooks);
+
+    /**
+     * @brief Adds a publication to the current batch, which is sent right away if it becomes full.
+     */
+    void add(
+            std::string publication);
+
+    /**
+     * @brief Sends the current batch, if it holds any publication.
+     */
+    void flush();
+
+    /**
+     * @brief Number of publications waiting in the current batch.
+     */
+    std::size_t pending() const;
+
+    /**
+     * @brief Number of batches sent since the batcher was created.
+     */
+    std::size_t batches() const;
+
+    const Options& options() const
+    {
+        return _options;
+    }
+
+private:
+
+    void send_batch();
+
+    const Options _options;
+    const Hooks _hooks;
+
+    // Publications and timers are handled by different threads.
+    mutable std::mutex _mutex;
+    std::vector<std::string> _publications;
+    std::size_t _bytes;
+    std::size_t _batches;
+
+    // Tells the timer of a batch apart from the ones of the batches already sent
+    uint64_t _generation;
+};
+
+using PublicationBatcherPtr = std::shared_ptr<PublicationBatcher>;
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__PUBLICATIONBATCHER_HPP_
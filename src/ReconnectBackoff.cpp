@@ -0,0 +1,134 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include "ReconnectBackoff.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+const std::string YamlInitialDelayKey = "initial_ms";
+const std::string YamlMaxDelayKey = "max_ms";
+const std::string YamlMultiplierKey = "multiplier";
+const std::string YamlJitterKey = "jitter";
+
+//==============================================================================
+bool parse_reconnect_options(
+        const YAML::Node& reconnect_node,
+        ReconnectOptions& options,
+        std::string& error)
+{
+    if (!reconnect_node.IsMap())
+    {
+        error = "expected a map";
+        return false;
+    }
+
+    try
+    {
+        if (const YAML::Node initial_node = reconnect_node[YamlInitialDelayKey])
+        {
+            options.initial_delay = std::chrono::milliseconds(initial_node.as<uint32_t>());
+        }
+
+        if (const YAML::Node max_node = reconnect_node[YamlMaxDelayKey])
+        {
+            options.max_delay = std::chrono::milliseconds(max_node.as<uint32_t>());
+        }
+
+        if (const YAML::Node multiplier_node = reconnect_node[YamlMultiplierKey])
+        {
+            options.multiplier = multiplier_node.as<double>();
+        }
+
+        if (const YAML::Node jitter_node = reconnect_node[YamlJitterKey])
+        {
+            options.jitter = jitter_node.as<double>();
+        }
+    }
+    catch (const YAML::BadConversion& e)
+    {
+        error = e.what();
+        return false;
+    }
+
+    if (options.initial_delay.count() <= 0)
+    {
+        error = "'" + YamlInitialDelayKey + "' must be positive";
+        return false;
+    }
+
+    if (options.max_delay < options.initial_delay)
+    {
+        error = "'" + YamlMaxDelayKey + "' must not be lower than '" + YamlInitialDelayKey + "'";
+        return false;
+    }
+
+    if (!(options.multiplier >= 1.0))
+    {
+        error = "'" + YamlMultiplierKey + "' must not be lower than 1";
+        return false;
+    }
+
+    if (!(options.jitter >= 0.0 && options.jitter <= 1.0))
+    {
+        error = "'" + YamlJitterKey + "' must be between 0 and 1";
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+ReconnectBackoff::ReconnectBackoff(
+        const ReconnectOptions& options,
+        uint64_t seed)
+    : _options(options)
+    , _delay_ms(static_cast<double>(options.initial_delay.count()))
+    , _attempts(0)
+    , _random(seed)
+{
+}
+
+//==============================================================================
+std::chrono::milliseconds ReconnectBackoff::next_delay()
+{
+    const double delay_ms = _delay_ms;
+    const double max_ms = static_cast<double>(_options.max_delay.count());
+    _delay_ms = std::min(_delay_ms * _options.multiplier, max_ms);
+    ++_attempts;
+
+    std::uniform_real_distribution<double> jitter(1.0 - _options.jitter, 1.0);
+    return std::chrono::milliseconds(static_cast<int64_t>(delay_ms * jitter(_random)));
+}
+
+//==============================================================================
+void ReconnectBackoff::reset()
+{
+    _delay_ms = static_cast<double>(_options.initial_delay.count());
+    _attempts = 0;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
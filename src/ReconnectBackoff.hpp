@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef _WEBSOCKET_IS_SH__SRC__RECONNECTBACKOFF_HPP_
+#define _WEBSOCKET_IS_SH__SRC__RECONNECTBACKOFF_HPP_
+
+#include <yaml-cpp/yaml.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Delays between the attempts of a client to connect again to its server.
+ */
+struct ReconnectOptions
+{
+    /**
+     * Delay before the first attempt after a connection is lost.
+     */
+    std::chrono::milliseconds initial_delay{2000};
+
+    /**
+     * Delay beyond which the attempts are not backed off any further.
+     */
+    std::chrono::milliseconds max_delay{30000};
+
+    /**
+     * Factor applied to the delay after every failed attempt.
+     */
+    double multiplier = 2.0;
+
+    /**
+     * Fraction of each delay which is drawn at random, so that the clients which lost
+     * their server at once do not come back all at once.
+     */
+    double jitter = 0.5;
+};
+
+/**
+ * @brief Parses the `reconnect` node of the configuration. Missing settings keep their value.
+ *
+ * @param[out] error Why the settings are not valid, if they are not.
+ *
+ * @returns `true` if every setting is valid.
+ */
+bool parse_reconnect_options(
+        const YAML::Node& reconnect_node,
+        ReconnectOptions& options,
+        std::string& error);
+
+/**
+ * @class ReconnectBackoff
+ * @brief Computes the delay before each attempt to reconnect, which grows exponentially
+ *        with every failed attempt, up to a limit, and is lowered by a random jitter.
+ * @details Each delay is drawn uniformly from `[(1 - jitter) * d, d]`, `d` being the backed off
+ *          delay. It is not thread safe.
+ */
+class ReconnectBackoff
+{
+public:
+
+    explicit ReconnectBackoff(
+            const ReconnectOptions& options = ReconnectOptions(),
+            uint64_t seed = std::random_device()());
+
+    /**
+     * @brief The delay before the next attempt, which backs off the one after it.
+     */
+    std::chrono::milliseconds next_delay();
+
+    /**
+     * @brief Starts over from the initial delay, once a connection succeeds.
+     */
+    void reset();
+
+    /**
+     * @brief Number of delays drawn since the last reset.
+     */
+    std::size_t attempts() const
+    {
+        return _attempts;
+    }
+
+private:
+
+    ReconnectOptions _options;
+    double _delay_ms;
+    std::size_t _attempts;
+    std::mt19937_64 _random;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__RECONNECTBACKOFF_HPP_
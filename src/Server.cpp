@@ -18,14 +18,31 @@
 
 #include "Endpoint.hpp"
 #include "Errors.hpp"
+#include "Cluster.hpp"
+#include "ConnectionRegistry.hpp"
 #include "ServerConfig.hpp"
+#include "TlsOptions.hpp"
+#include "UnixSocketStream.hpp"
 #include "websocket_types.hpp"
 #include "JwtValidator.hpp"
 
 #include <is/core/runtime/Search.hpp>
+#include <boost/asio/ip/host_name.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
 #include <websocketpp/endpoint.hpp>
 #include <websocketpp/http/constants.hpp>
 
+#include <atomic>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace eprosima
 {
     namespace is
@@ -46,6 +63,26 @@ namespace eprosima
 
                 const std::string YamlAuthKey = "authentication";
 
+                const std::string YamlThreadsKey = "threads";
+                const std::string YamlAcceptorsKey = "acceptors";
+
+                const std::string YamlClusterKey = "cluster";
+
+                const std::string YamlUnixSocketKey = "unix_socket";
+                const std::string YamlUnixSocketPathKey = "path";
+                const std::string YamlUnixHandshakeTimeoutKey = "handshake_timeout_ms";
+                const std::string YamlUnixIdleTimeoutKey = "idle_timeout_ms";
+
+                // Same as the open handshake timeout of the websocketpp transports, which the iostream one lacks
+                const std::chrono::milliseconds DefaultUnixHandshakeTimeout(5000);
+
+                // Upper bound for spin_once to block while no connection event arrives
+                const std::chrono::milliseconds MaxSpinWait(100);
+
+                // TODO(MXG): Make this timeout parameter something that can be
+                // configured by users.
+                const std::chrono::milliseconds ShutdownTimeout(10000);
+
                 //==============================================================================
                 static std::string find_websocket_config_file(
                     const YAML::Node &configuration,
@@ -136,12 +173,13 @@ namespace eprosima
                 }
 
                 //==============================================================================
-                static bool all_tls_closed(
-                    const std::unordered_set<TlsConnectionPtr> &connections)
+                template <typename ConnectionPtr>
+                static bool all_closed(
+                    const typename ConnectionRegistry<ConnectionPtr>::Map &connections)
                 {
                     for (const auto &connection : connections)
                     {
-                        if (connection->get_state() != websocketpp::session::state::closed)
+                        if (connection.first->get_state() != websocketpp::session::state::closed)
                         {
                             return false;
                         }
@@ -150,18 +188,69 @@ namespace eprosima
                     return true;
                 }
 
-                static bool all_tcp_closed(
-                    const std::unordered_set<TcpConnectionPtr> &connections)
+                //==============================================================================
+                /**
+                 * @brief Types and log label of each kind of server, so that the connection handlers
+                 *        are instantiated once per transport instead of branching on every call.
+                 */
+                template <typename ServerType>
+                struct Transport;
+
+                template <>
+                struct Transport<TlsServer>
                 {
-                    for (const auto &connection : connections)
+                    using ConnectionPtr = TlsConnectionPtr;
+                    static constexpr const char *name = "TLS";
+                };
+
+                template <>
+                struct Transport<TcpServer>
+                {
+                    using ConnectionPtr = TcpConnectionPtr;
+                    static constexpr const char *name = "TCP";
+                };
+
+                template <>
+                struct Transport<UnixServer>
+                {
+                    using ConnectionPtr = UnixConnectionPtr;
+                    static constexpr const char *name = "Unix socket";
+                };
+
+                //==============================================================================
+                /**
+                 * @brief Remove the socket file left behind by a previous run, which would make the bind fail.
+                 *        Any other kind of file is kept.
+                 */
+                static void remove_stale_socket(
+                    const std::string &path)
+                {
+#ifdef __linux__
+                    struct stat status;
+                    if (0 == ::stat(path.c_str(), &status) && S_ISSOCK(status.st_mode))
                     {
-                        if (connection->get_state() != websocketpp::session::state::closed)
-                        {
-                            return false;
-                        }
+                        ::unlink(path.c_str());
                     }
+#else
+                    (void)path;
+#endif
+                }
 
-                    return true;
+                //==============================================================================
+                static bool pin_to_core(
+                    std::thread &thread,
+                    unsigned int core)
+                {
+#ifdef __linux__
+                    cpu_set_t cpus;
+                    CPU_ZERO(&cpus);
+                    CPU_SET(core, &cpus);
+                    return 0 == pthread_setaffinity_np(thread.native_handle(), sizeof(cpu_set_t), &cpus);
+#else
+                    (void)thread;
+                    (void)core;
+                    return false;
+#endif
                 }
 
                 //==============================================================================
@@ -176,7 +265,7 @@ namespace eprosima
                 {
                 public:
                     Server()
-                        : Endpoint("is::sh::WebSocket::Server"), _opened_tls_conn_counter(0), _opened_tcp_conn_counter(0)
+                        : Endpoint("is::sh::WebSocket::Server")
                     {
                         // Do nothing
                     }
@@ -194,6 +283,28 @@ namespace eprosima
                         }
                         const uint16_t uport = static_cast<uint16_t>(port);
 
+                        _num_threads = parse_count(configuration, YamlThreadsKey);
+                        if (0 == _num_threads)
+                        {
+                            return nullptr;
+                        }
+
+                        _num_acceptors = parse_count(configuration, YamlAcceptorsKey);
+                        if (0 == _num_acceptors)
+                        {
+                            return nullptr;
+                        }
+
+                        if (!parse_cluster(configuration, uport))
+                        {
+                            return nullptr;
+                        }
+
+                        if (!parse_unix_socket(configuration))
+                        {
+                            return nullptr;
+                        }
+
                         const std::string cert_file = find_certificate(configuration);
                         if (cert_file.empty())
                         {
@@ -227,6 +338,11 @@ namespace eprosima
                         const boost::asio::ssl::context::file_format format =
                             parse_format(configuration);
 
+                        if (!parse_tls(configuration))
+                        {
+                            return nullptr;
+                        }
+
                         const YAML::Node auth_node = configuration[YamlAuthKey];
                         if (auth_node)
                         {
@@ -267,6 +383,28 @@ namespace eprosima
                         }
                         const uint16_t uport = static_cast<uint16_t>(port);
 
+                        _num_threads = parse_count(configuration, YamlThreadsKey);
+                        if (0 == _num_threads)
+                        {
+                            return nullptr;
+                        }
+
+                        _num_acceptors = parse_count(configuration, YamlAcceptorsKey);
+                        if (0 == _num_acceptors)
+                        {
+                            return nullptr;
+                        }
+
+                        if (!parse_cluster(configuration, uport))
+                        {
+                            return nullptr;
+                        }
+
+                        if (!parse_unix_socket(configuration))
+                        {
+                            return nullptr;
+                        }
+
                         const boost::asio::ssl::context::file_format format =
                             parse_format(configuration);
 
@@ -297,6 +435,171 @@ namespace eprosima
                         return _tcp_server.get();
                     }
 
+                    bool parse_tls(
+                        const YAML::Node &configuration)
+                    {
+                        const YAML::Node tls_node = configuration[YamlTlsKey];
+                        if (!tls_node)
+                        {
+                            return true;
+                        }
+
+                        std::string error;
+                        if (!parse_tls_options(tls_node, _tls_options, error))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Invalid '" << YamlTlsKey << "' settings '" << tls_node
+                                    << "': " << error << std::endl;
+
+                            return false;
+                        }
+
+                        if (!_tls_options.ticket_key_file.empty())
+                        {
+                            _tls_options.ticket_key_file = find_websocket_config_file(
+                                tls_node, "ticket_key_file",
+                                "which should point to the session ticket keys shared by the servers!");
+
+                            if (_tls_options.ticket_key_file.empty())
+                            {
+                                return false;
+                            }
+                        }
+
+                        return true;
+                    }
+
+                    bool parse_unix_socket(
+                        const YAML::Node &configuration)
+                    {
+                        const YAML::Node unix_node = configuration[YamlUnixSocketKey];
+                        if (!unix_node)
+                        {
+                            return true;
+                        }
+
+                        // Either the path alone, or a map with the path and the timeouts
+                        const YAML::Node path_node = unix_node.IsMap() ? unix_node[YamlUnixSocketPathKey] : unix_node;
+                        try
+                        {
+                            if (path_node)
+                            {
+                                _unix_socket_path = path_node.as<std::string>();
+                            }
+                        }
+                        catch (const YAML::BadConversion &)
+                        {
+                        }
+
+                        if (_unix_socket_path.empty())
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "The '" << YamlUnixSocketKey << "' setting must be the path of the socket, but '"
+                                    << unix_node << "' was given" << std::endl;
+
+                            return false;
+                        }
+
+                        if (unix_node.IsMap())
+                        {
+                            return parse_unix_timeout(unix_node, YamlUnixHandshakeTimeoutKey, _unix_handshake_timeout) &&
+                                   parse_unix_timeout(unix_node, YamlUnixIdleTimeoutKey, _unix_idle_timeout);
+                        }
+
+                        return true;
+                    }
+
+                    bool parse_unix_timeout(
+                        const YAML::Node &unix_node,
+                        const std::string &key,
+                        std::chrono::milliseconds &timeout)
+                    {
+                        const YAML::Node timeout_node = unix_node[key];
+                        if (!timeout_node)
+                        {
+                            return true;
+                        }
+
+                        try
+                        {
+                            const int64_t value = timeout_node.as<int64_t>();
+                            if (value >= 0)
+                            {
+                                timeout = std::chrono::milliseconds(value);
+                                return true;
+                            }
+                        }
+                        catch (const YAML::BadConversion &)
+                        {
+                        }
+
+                        _logger << utils::Logger::Level::ERROR
+                                << "The '" << key << "' setting of '" << YamlUnixSocketKey
+                                << "' must be a number of milliseconds, or 0 to disable it, but '"
+                                << timeout_node << "' was given" << std::endl;
+
+                        return false;
+                    }
+
+                    bool parse_cluster(
+                        const YAML::Node &configuration,
+                        uint16_t port)
+                    {
+                        const YAML::Node cluster_node = configuration[YamlClusterKey];
+                        if (!cluster_node)
+                        {
+                            return true;
+                        }
+
+                        std::string error;
+                        if (!parse_cluster_options(cluster_node, _cluster_options, error))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Invalid '" << YamlClusterKey << "' settings '" << cluster_node
+                                    << "': " << error << std::endl;
+
+                            return false;
+                        }
+
+                        if (_cluster_options.node_id.empty())
+                        {
+                            _cluster_options.node_id = boost::asio::ip::host_name() + ":" + std::to_string(port);
+                        }
+
+                        const is::core::Search search = is::core::Search(WebsocketMiddlewareName)
+                                                            .relative_to_config()
+                                                            .relative_to_home();
+
+                        for (std::string &ca_file : _cluster_options.cert_authorities)
+                        {
+                            const std::string ca_path = search.find_file(ca_file, "");
+                            if (ca_path.empty())
+                            {
+                                _logger << utils::Logger::Level::ERROR
+                                        << "Could not find the certificate authority '" << ca_file
+                                        << "' of the cluster peers" << std::endl;
+
+                                return false;
+                            }
+
+                            ca_file = ca_path;
+                        }
+
+                        const std::string uri_prefix = _use_security ? "wss://" : "ws://";
+                        for (const std::string &peer : _cluster_options.peers)
+                        {
+                            _cluster_peers.emplace_back();
+                            _cluster_peers.back().uri = uri_prefix + peer;
+                        }
+
+                        _logger << utils::Logger::Level::INFO
+                                << "Joining a cluster of " << _cluster_peers.size() << " peers as node '"
+                                << _cluster_options.node_id << "'" << std::endl;
+
+                        enable_cluster();
+                        return true;
+                    }
+
                     bool configure_server(
                         const uint16_t port,
                         const std::string &cert_file,
@@ -311,6 +614,19 @@ namespace eprosima
                             asio::ssl::context::no_sslv2 |
                             asio::ssl::context::no_sslv3);
 
+                        if (_use_security)
+                        {
+                            std::string error;
+                            if (!apply_tls_options(*_context, _tls_options, TlsRole::SERVER, error))
+                            {
+                                _logger << utils::Logger::Level::ERROR
+                                        << "Failed to apply the '" << YamlTlsKey << "' settings: "
+                                        << error << std::endl;
+
+                                return false;
+                            }
+                        }
+
                         boost::system::error_code ec;
                         if (!cert_file.empty())
                         {
@@ -358,245 +674,616 @@ namespace eprosima
                         // using this?
                         if (_use_security)
                         {
-                            initialize_tls_server(port);
+                            if (!initialize_tls_server(port))
+                            {
+                                return false;
+                            }
                         }
-                        else
+                        else if (!initialize_tcp_server(port))
                         {
-                            initialize_tcp_server(port);
+                            return false;
                         }
 
-                        return true;
+                        if (_unix_socket_path.empty())
+                        {
+                            return true;
+                        }
+
+                        return initialize_unix_server(
+                            _use_security ? _tls_server->get_io_service() : _tcp_server->get_io_service());
                     }
 
-                    void initialize_tls_server(
-                        uint16_t port)
+                    uint32_t parse_count(
+                        const YAML::Node &configuration,
+                        const std::string &key)
                     {
-                        _logger << utils::Logger::Level::INFO
-                                << "Initializing TLS server on port " << port << std::endl;
+                        const YAML::Node count_node = configuration[key];
+                        if (!count_node)
+                        {
+                            return 1;
+                        }
 
-                        _tls_server->set_reuse_addr(true);
+                        try
+                        {
+                            const int count = count_node.as<int>();
+                            if (count > 0)
+                            {
+                                _logger << utils::Logger::Level::DEBUG
+                                        << "Using " << count << " " << key << " to run the server" << std::endl;
 
-                        _tls_server->clear_access_channels(
-                            websocketpp::log::alevel::frame_header |
-                            websocketpp::log::alevel::frame_payload);
+                                return static_cast<uint32_t>(count);
+                            }
 
-                        _tls_server->init_asio();
-                        _tls_server->start_perpetual();
+                            _logger << utils::Logger::Level::ERROR
+                                    << "The '" << key << "' setting must be a positive integer, but '"
+                                    << count << "' was given" << std::endl;
+                        }
+                        catch (const YAML::BadConversion &v)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Could not parse an integer value for the '" << key
+                                    << "' setting '" << count_node << "': " << v.what() << std::endl;
+                        }
 
-                        _tls_server->set_message_handler(
-                            [&](ConnectionHandlePtr handle, TlsMessagePtr message)
-                            {
-                                this->_handle_tls_message(handle, message);
-                            });
+                        return 0;
+                    }
 
-                        _tls_server->set_close_handler(
-                            [&](ConnectionHandlePtr handle)
-                            {
-                                this->_handle_close(std::move(handle));
-                            });
+                    bool initialize_tls_server(
+                        uint16_t port)
+                    {
+                        _logger << utils::Logger::Level::INFO
+                                << "Initializing TLS server on port " << port << std::endl;
 
-                        _tls_server->set_open_handler(
-                            [&](ConnectionHandlePtr handle)
-                            {
-                                this->_handle_opening(std::move(handle));
-                            });
+                        _tls_acceptors.push_back(_tls_server);
+                        for (uint32_t i = 1; i < _num_acceptors; ++i)
+                        {
+                            _tls_acceptors.push_back(std::make_shared<TlsServer>());
+                        }
 
-                        _tls_server->set_fail_handler(
-                            [&](ConnectionHandlePtr handle)
+                        for (uint32_t i = 0; i < _num_acceptors; ++i)
+                        {
+                            if (!initialize_acceptor(*_tls_acceptors[i], port))
                             {
-                                this->_handle_failed_connection(std::move(handle));
-                            });
+                                return false;
+                            }
+                        }
 
-                        _tls_server->set_tls_init_handler(
-                            [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
-                            {
-                                return _context;
-                            });
+                        // The metrics server runs on the io_service of the first acceptor, created above
+                        if (!initialize_metrics(*_tls_server))
+                        {
+                            return false;
+                        }
 
-                        _tls_server->set_validate_handler(
-                            [&](ConnectionHandlePtr handle) -> bool
-                            {
-                                return this->_handle_validate(std::move(handle));
-                            });
+                        if (!_cluster_peers.empty())
+                        {
+                            _cluster_tls_client = std::make_shared<TlsClient>();
+                            initialize_cluster_client(*_cluster_tls_client, _tls_server->get_io_service());
+                        }
 
-                        _tls_server->listen(port);
+                        for (uint32_t i = 0; i < _num_acceptors; ++i)
+                        {
+                            start_acceptor_threads(*_tls_acceptors[i], i);
+                        }
 
-                        _server_thread = std::thread([&]()
-                                                     { this->_tls_server->run(); });
+                        return true;
                     }
 
-                    void initialize_tcp_server(
+                    bool initialize_tcp_server(
                         uint16_t port)
                     {
                         _logger << utils::Logger::Level::INFO
                                 << "Initializing TCP server on port " << port << std::endl;
 
-                        _tcp_server->set_reuse_addr(true);
-
-                        _tcp_server->clear_access_channels(
-                            websocketpp::log::alevel::frame_header |
-                            websocketpp::log::alevel::frame_payload);
-
-                        _tcp_server->init_asio();
-                        _tcp_server->start_perpetual();
+                        _tcp_acceptors.push_back(_tcp_server);
+                        for (uint32_t i = 1; i < _num_acceptors; ++i)
+                        {
+                            _tcp_acceptors.push_back(std::make_shared<TcpServer>());
+                        }
 
-                        _tcp_server->set_message_handler(
-                            [&](ConnectionHandlePtr handle, TlsMessagePtr message)
+                        for (uint32_t i = 0; i < _num_acceptors; ++i)
+                        {
+                            if (!initialize_acceptor(*_tcp_acceptors[i], port))
                             {
-                                this->_handle_tcp_message(handle, message);
-                            });
+                                return false;
+                            }
+                        }
 
-                        _tcp_server->set_close_handler(
-                            [&](ConnectionHandlePtr handle)
-                            {
-                                this->_handle_close(std::move(handle));
-                            });
+                        // The metrics server runs on the io_service of the first acceptor, created above
+                        if (!initialize_metrics(*_tcp_server))
+                        {
+                            return false;
+                        }
 
-                        _tcp_server->set_open_handler(
-                            [&](ConnectionHandlePtr handle)
-                            {
-                                this->_handle_opening(std::move(handle));
-                            });
+                        if (!_cluster_peers.empty())
+                        {
+                            _cluster_tcp_client = std::make_shared<TcpClient>();
+                            initialize_cluster_client(*_cluster_tcp_client, _tcp_server->get_io_service());
+                        }
 
-                        _tcp_server->set_fail_handler(
-                            [&](ConnectionHandlePtr handle)
-                            {
-                                this->_handle_failed_connection(std::move(handle));
-                            });
+                        for (uint32_t i = 0; i < _num_acceptors; ++i)
+                        {
+                            start_acceptor_threads(*_tcp_acceptors[i], i);
+                        }
 
-                        _tcp_server->set_tcp_init_handler(
-                            [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
-                            {
-                                return _context;
-                            });
+                        return true;
+                    }
 
-                        _tcp_server->set_validate_handler(
-                            [&](ConnectionHandlePtr handle) -> bool
+                    /**
+                     * @brief Listen on the Unix domain socket, whose connections are served by the threads
+                     *        of the given io_service, along with the TCP ones. Each connection runs on a
+                     *        strand of its own, so a slow reader never blocks the threads sending to it.
+                     */
+                    bool initialize_unix_server(
+                        boost::asio::io_service &io_service)
+                    {
+                        _logger << utils::Logger::Level::INFO
+                                << "Initializing Unix socket server on '" << _unix_socket_path << "'" << std::endl;
+
+                        _unix_server = std::make_shared<UnixServer>();
+                        _unix_server->clear_access_channels(
+                            websocketpp::log::alevel::frame_header |
+                            websocketpp::log::alevel::frame_payload);
+                        set_connection_handlers(*_unix_server);
+
+                        _unix_io_service = &io_service;
+                        _unix_acceptor = std::make_unique<boost::asio::local::stream_protocol::acceptor>(io_service);
+
+                        remove_stale_socket(_unix_socket_path);
+
+                        boost::system::error_code ec;
+                        const boost::asio::local::stream_protocol::endpoint endpoint(_unix_socket_path);
+                        _unix_acceptor->open(endpoint.protocol(), ec);
+                        if (!ec)
+                        {
+                            _unix_acceptor->bind(endpoint, ec);
+                        }
+                        if (!ec)
+                        {
+                            _unix_acceptor->listen(boost::asio::socket_base::max_connections, ec);
+                        }
+
+                        if (ec)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Failed to listen on the Unix socket '" << _unix_socket_path
+                                    << "': " << ec.message() << std::endl;
+
+                            return false;
+                        }
+
+                        return true;
+                    }
+
+                    void accept_unix_connection()
+                    {
+                        const auto stream = std::make_shared<UnixSocketStream>(*_unix_io_service);
+                        _unix_acceptor->async_accept(
+                            stream->socket(),
+                            [this, stream](const boost::system::error_code &ec)
                             {
-                                return this->_handle_validate(std::move(handle));
+                                if (boost::asio::error::operation_aborted == ec || _closing_down)
+                                {
+                                    return;
+                                }
+
+                                if (ec)
+                                {
+                                    _logger << utils::Logger::Level::WARN
+                                            << "Failed to accept a Unix socket connection: " << ec.message() << std::endl;
+                                }
+                                else
+                                {
+                                    this->_handle_unix_socket(stream);
+                                }
+
+                                this->accept_unix_connection();
                             });
+                    }
 
-                        _tcp_server->listen(port);
+                    /**
+                     * @brief Bind the connection handlers to a server. Every handler resolves and registers the
+                     *        connections through its own server, without checking which transport is in use.
+                     */
+                    template <typename ServerType>
+                    void set_connection_handlers(
+                        ServerType &server)
+                    {
+                        server.set_message_handler(
+                            [this, &server](ConnectionHandlePtr handle, typename ServerType::message_ptr message)
+                            {
+                                this->_handle_message(server, handle, message);
+                            });
+
+                        server.set_close_handler(
+                            [this, &server](ConnectionHandlePtr handle)
+                            {
+                                this->_handle_close(server, handle);
+                            });
 
-                        _server_thread = std::thread([&]()
-                                                     { this->_tcp_server->run(); });
+                        server.set_open_handler(
+                            [this, &server](ConnectionHandlePtr handle)
+                            {
+                                this->_handle_opening(server, handle);
+                            });
+
+                        server.set_fail_handler(
+                            [this](ConnectionHandlePtr handle)
+                            {
+                                this->_handle_failed_connection(std::move(handle));
+                            });
+
+                        server.set_validate_handler(
+                            [this, &server](ConnectionHandlePtr handle) -> bool
+                            {
+                                return this->_handle_validate(server, handle);
+                            });
                     }
 
-                    ~Server() override
+                    /**
+                     * @brief Set up one of the endpoints listening on the port. Each one has an io_service of
+                     *        its own, and the kernel spreads the incoming connections among them.
+                     */
+                    template <typename ServerType>
+                    bool initialize_acceptor(
+                        ServerType &server,
+                        uint16_t port)
                     {
-                        _closing_down = true;
+                        server.set_reuse_addr(true);
 
-                        // NOTE(MXG): _open_connections can get modified in other threads so we'll
-                        // make a copy of it here before using it.
-                        // TODO(MXG): We should probably be using mutexes to protect the operations
-                        // on these connections.
+                        server.clear_access_channels(
+                            websocketpp::log::alevel::frame_header |
+                            websocketpp::log::alevel::frame_payload);
 
-                        // First instruct all connections to close
-                        if (_use_security)
+                        server.init_asio();
+                        server.start_perpetual();
+
+                        if (_num_acceptors > 1)
                         {
-                            _mutex.lock();
-                            for (const auto &connection : _open_tls_connections)
-                            {
-                                if (connection->get_state() != websocketpp::session::state::closed)
+                            server.set_tcp_pre_bind_handler(
+                                [this](std::shared_ptr<boost::asio::ip::tcp::acceptor> acceptor) -> ErrorCode
                                 {
-                                    try
+                                    return this->_handle_pre_bind(*acceptor);
+                                });
+                        }
+
+                        if (metrics() != nullptr && metrics_port() < 0)
+                        {
+                            // Plain HTTP requests to the WebSocket port get the metrics, as long as they
+                            // carry a valid token when the WebSocket connections need one
+                            server.set_http_handler(
+                                [this, &server](ConnectionHandlePtr handle)
+                                {
+                                    const auto connection = server.get_con_from_hdl(handle);
+                                    if (this->_authorize_http_request<ServerType>(connection))
                                     {
-                                        connection->close(websocketpp::close::status::normal, "shutdown");
+                                        serve_metrics(connection);
                                     }
-                                    catch (websocketpp::exception &e)
+                                });
+                        }
+
+                        set_connection_handlers(server);
+
+                        if constexpr (std::is_same_v<ServerType, TlsServer>)
+                        {
+                            server.set_tls_init_handler(
+                                [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
+                                {
+                                    return _context;
+                                });
+                        }
+                        else
+                        {
+                            server.set_tcp_init_handler(
+                                [&](ConnectionHandlePtr /*handle*/) -> SslContextPtr
+                                {
+                                    return _context;
+                                });
+                        }
+
+                        ErrorCode ec;
+                        server.listen(port, ec);
+                        if (ec)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Failed to listen on port " << port << ": " << ec.message() << std::endl;
+
+                            return false;
+                        }
+
+                        return true;
+                    }
+
+                    template <typename ServerType>
+                    void start_acceptor_threads(
+                        ServerType &server,
+                        uint32_t acceptor)
+                    {
+                        const unsigned int cores = std::thread::hardware_concurrency();
+
+                        // websocketpp wraps the handlers of each connection into its own strand,
+                        // so running the io_service on several threads keeps the per-connection ordering.
+                        for (uint32_t i = 0; i < _num_threads; ++i)
+                        {
+                            _server_threads.emplace_back([&server]()
+                                                         { server.run(); });
+
+                            // Several acceptors share nothing but the topics, so each thread keeps to a core
+                            if (_num_acceptors > 1 && cores > 0
+                                && !pin_to_core(_server_threads.back(), (acceptor * _num_threads + i) % cores))
+                            {
+                                _logger << utils::Logger::Level::WARN
+                                        << "Could not pin the thread " << i << " of the acceptor "
+                                        << acceptor << " to a core" << std::endl;
+                            }
+                        }
+                    }
+
+                    /**
+                     * @returns `false` if the dedicated metrics port could not be listened on.
+                     */
+                    template <typename ServerType>
+                    bool initialize_metrics(
+                        ServerType &server)
+                    {
+                        MetricsRegistry *registry = metrics();
+                        if (nullptr == registry)
+                        {
+                            return true;
+                        }
+
+                        _handshake_seconds = &registry->histogram(
+                            "websocket_handshake_seconds", "Time spent validating each opening handshake.");
+                        _handshake_rejections = &registry->counter(
+                            "websocket_handshake_rejections_total", "Opening handshakes rejected.");
+
+                        if (_jwt_validator)
+                        {
+                            registry->sampled(
+                                "websocket_jwt_cached_tokens", "Verified tokens currently cached.",
+                                MetricsRegistry::Type::GAUGE,
+                                [this](MetricsRegistry::Samples &samples)
+                                {
+                                    samples.push_back({{}, static_cast<double>(_jwt_validator->cached_tokens())});
+                                });
+                        }
+
+                        if (!_cluster_peers.empty())
+                        {
+                            registry->sampled(
+                                "websocket_cluster_links", "Links currently open with the other nodes of the cluster.",
+                                MetricsRegistry::Type::GAUGE,
+                                [this](MetricsRegistry::Samples &samples)
+                                {
+                                    const std::lock_guard<std::mutex> lock(_cluster_mutex);
+                                    std::size_t links = 0;
+                                    for (const ClusterPeer &peer : _cluster_peers)
                                     {
-                                        _logger << utils::Logger::Level::WARN
-                                                << "Exception ocurred while closing connection";
-                                        if (_open_tls_conn_to_id.end() != _open_tls_conn_to_id.find(connection))
-                                        {
-                                            _logger << " with ID '" << _open_tls_conn_to_id[connection] << "'";
-                                        }
-                                        _logger << std::endl;
+                                        links += peer.send ? 1 : 0;
                                     }
+                                    samples.push_back({{}, static_cast<double>(links)});
+                                });
+                        }
+
+                        if (_use_security)
+                        {
+                            registry->sampled(
+                                "websocket_tls_resumed_sessions_total",
+                                "TLS handshakes which resumed a session, by id or by ticket.",
+                                MetricsRegistry::Type::COUNTER,
+                                [this](MetricsRegistry::Samples &samples)
+                                {
+                                    samples.push_back(
+                                        {{}, static_cast<double>(SSL_CTX_sess_hits(_context->native_handle()))});
+                                });
+                        }
+
+                        return start_metrics_server(server.get_io_service());
+                    }
+
+                    template <typename ClientType>
+                    void initialize_cluster_client(
+                        ClientType &client,
+                        boost::asio::io_service &io_service)
+                    {
+                        client.clear_access_channels(websocketpp::log::alevel::all);
+                        client.clear_error_channels(websocketpp::log::elevel::all);
+
+                        // The links are run by the threads of the server
+                        client.init_asio(&io_service);
+
+                        if constexpr (std::is_same_v<ClientType, TlsClient>)
+                        {
+                            _cluster_context = std::make_shared<SslContext>(boost::asio::ssl::context::tls_client);
+
+                            boost::system::error_code ec;
+                            _cluster_context->set_default_verify_paths(ec);
+                            for (const std::string &ca_file : _cluster_options.cert_authorities)
+                            {
+                                if (!ec)
+                                {
+                                    _cluster_context->load_verify_file(ca_file, ec);
                                 }
                             }
 
-                            // Then wait for all of them to close
-
-                            using namespace std::chrono_literals;
-                            const auto start_time = std::chrono::steady_clock::now();
-                            // TODO(MXG): Make these timeout parameters something that can be
-                            // configured by users.
-                            while (!all_tls_closed(_open_tls_connections))
+                            if (ec)
                             {
-                                std::this_thread::sleep_for(200ms);
+                                // The links fail to verify the peers, and keep on retrying
+                                _logger << utils::Logger::Level::ERROR
+                                        << "Failed to load the certificate authorities of the cluster peers: "
+                                        << ec.message() << std::endl;
+                            }
+
+                            _cluster_context->set_verify_mode(boost::asio::ssl::verify_peer);
 
-                                if (std::chrono::steady_clock::now() - start_time > 10s)
+                            client.set_tls_init_handler(
+                                [this](ConnectionHandlePtr /*handle*/) -> SslContextPtr
                                 {
-                                    _logger << utils::Logger::Level::ERROR
-                                            << "Timed out while waiting for "
-                                            << "the remote clients to acknowledge the connection "
-                                            << "shutdown request" << std::endl;
+                                    return this->_cluster_context;
+                                });
 
-                                    break;
-                                }
+                            client.set_socket_init_handler(
+                                [&client](ConnectionHandlePtr handle, auto &sock)
+                                {
+                                    sock.set_verify_callback(
+                                        boost::asio::ssl::rfc2818_verification(client.get_con_from_hdl(handle)->get_host()));
+                                });
+                        }
+                    }
+
+                    void connect_cluster_peers()
+                    {
+                        for (std::size_t i = 0; i < _cluster_peers.size(); ++i)
+                        {
+                            if (_use_security)
+                            {
+                                connect_cluster_peer(*_cluster_tls_client, i);
+                            }
+                            else
+                            {
+                                connect_cluster_peer(*_cluster_tcp_client, i);
                             }
-                            _mutex.unlock();
                         }
-                        else
+                    }
+
+                    template <typename ClientType>
+                    void connect_cluster_peer(
+                        ClientType &client,
+                        std::size_t index)
+                    {
+                        std::string uri;
                         {
-                            _mutex.lock();
-                            for (const auto &connection : _open_tcp_connections)
+                            const std::lock_guard<std::mutex> lock(_cluster_mutex);
+                            if (_closing_down || _cluster_peers[index].is_this_node)
                             {
-                                if (connection->get_state() != websocketpp::session::state::closed)
-                                {
-                                    try
-                                    {
-                                        connection->close(websocketpp::close::status::normal, "shutdown");
-                                    }
-                                    catch (websocketpp::exception &e)
-                                    {
-                                        _logger << utils::Logger::Level::WARN
-                                                << "Exception ocurred while closing connection";
-                                        if (_open_tcp_conn_to_id.end() != _open_tcp_conn_to_id.find(connection))
-                                        {
-                                            _logger << " with ID '" << _open_tcp_conn_to_id[connection] << "'";
-                                        }
-                                        _logger << std::endl;
-                                    }
-                                }
+                                return;
                             }
-                            // Then wait for all of them to close
 
-                            using namespace std::chrono_literals;
-                            const auto start_time = std::chrono::steady_clock::now();
-                            // TODO(MXG): Make these timeout parameters something that can be
-                            // configured by users.
-                            while (!all_tcp_closed(_open_tcp_connections))
+                            uri = _cluster_peers[index].uri;
+                        }
+
+                        ErrorCode ec;
+                        const auto connection = client.get_connection(uri, ec);
+                        if (ec)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Failed to link with the cluster peer '" << uri << "': "
+                                    << ec.message() << std::endl;
+
+                            return;
+                        }
+
+                        connection->append_header(ClusterNodeHeader, _cluster_options.node_id);
+                        if (!_cluster_options.secret.empty())
+                        {
+                            connection->append_header(ClusterSecretHeader, _cluster_options.secret);
+                        }
+                        if (!_cluster_options.token.empty())
+                        {
+                            connection->add_subprotocol(_cluster_options.token, ec);
+                        }
+
+                        connection->set_open_handler(
+                            [this, &client, index](ConnectionHandlePtr handle)
                             {
-                                std::this_thread::sleep_for(200ms);
+                                this->_handle_cluster_link_opened(index, client.get_con_from_hdl(handle));
+                            });
 
-                                if (std::chrono::steady_clock::now() - start_time > 10s)
-                                {
-                                    _logger << utils::Logger::Level::ERROR
-                                            << "Timed out while waiting for "
-                                            << "the remote clients to acknowledge the connection "
-                                            << "shutdown request" << std::endl;
+                        connection->set_message_handler(
+                            [this, &client](ConnectionHandlePtr handle, typename ClientType::message_ptr message)
+                            {
+                                this->handle_websocket_msg(message->get_payload(), client.get_con_from_hdl(handle));
+                            });
+
+                        const auto closed = [this, &client, index](ConnectionHandlePtr handle)
+                        {
+                            this->_handle_cluster_link_closed(client, index, client.get_con_from_hdl(handle));
+                        };
+                        connection->set_close_handler(closed);
+                        connection->set_fail_handler(closed);
+
+                        client.connect(connection);
+                    }
+
+                    void cluster_interest_changed(
+                        const std::string &topic_name,
+                        const std::string &message_type,
+                        bool interested) override
+                    {
+                        const std::string message = interested ?
+                            get_encoding().encode_subscribe_msg(topic_name, message_type, "", YAML::Node()) :
+                            get_encoding().encode_unsubscribe_msg(topic_name, "");
+
+                        if (message.empty())
+                        {
+                            return;
+                        }
+
+                        const std::lock_guard<std::mutex> lock(_cluster_mutex);
+                        for (const ClusterPeer &peer : _cluster_peers)
+                        {
+                            if (peer.send)
+                            {
+                                peer.send(message);
+                            }
+                        }
+                    }
 
-                                    break;
+                    ~Server() override
+                    {
+                        _closing_down = true;
+
+                        // The encoding workers send through the connections closed below, and the
+                        // dispatch threads deliver what they receive
+                        stop_workers();
+
+                        {
+                            const std::lock_guard<std::mutex> lock(_cluster_mutex);
+                            for (const ClusterPeer &peer : _cluster_peers)
+                            {
+                                if (peer.close)
+                                {
+                                    peer.close();
                                 }
                             }
-                            _mutex.unlock();
                         }
 
-                        if (_server_thread.joinable())
+                        if (_use_security)
                         {
-                            if (_use_security)
+                            close_connections<TlsServer>();
+                        }
+                        else
+                        {
+                            close_connections<TcpServer>();
+                        }
+
+                        if (_unix_acceptor)
+                        {
+                            boost::system::error_code ec;
+                            _unix_acceptor->close(ec);
+                            close_connections<UnixServer>();
+                            remove_stale_socket(_unix_socket_path);
+                        }
+
+                        if (!_server_threads.empty())
+                        {
+                            for (const std::shared_ptr<TlsServer> &server : _tls_acceptors)
                             {
-                                _tls_server->stop();
+                                server->stop();
                             }
-                            else
+
+                            for (const std::shared_ptr<TcpServer> &server : _tcp_acceptors)
                             {
-                                _tcp_server->stop();
+                                server->stop();
                             }
 
-                            _server_thread.join();
+                            for (std::thread &server_thread : _server_threads)
+                            {
+                                server_thread.join();
+                            }
                         }
+
+                        // The acceptor goes before the io_service it belongs to
+                        _unix_acceptor.reset();
                     }
 
                     bool okay() const override
@@ -610,17 +1297,25 @@ namespace eprosima
                         if (!_has_spun_once)
                         {
                             _has_spun_once = true;
-                            if (_use_security)
+                            for (const std::shared_ptr<TlsServer> &server : _tls_acceptors)
                             {
-                                _tls_server->start_accept();
+                                server->start_accept();
                             }
-                            else
+
+                            for (const std::shared_ptr<TcpServer> &server : _tcp_acceptors)
                             {
-                                _tcp_server->start_accept();
+                                server->start_accept();
                             }
+
+                            if (_unix_acceptor)
+                            {
+                                accept_unix_connection();
+                            }
+
+                            connect_cluster_peers();
                         }
 
-                        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                        wait_for_event(MaxSpinWait);
 
                         // TODO(MXG): How do we know if the server is okay?
                         return true;
@@ -632,239 +1327,557 @@ namespace eprosima
                         const std::string &id,
                         const YAML::Node &configuration) override
                     {
-                        const std::string advertise_msg =
+                        const TlsMessagePtr advertise_msg = make_message(
                             get_encoding().encode_advertise_msg(
-                                topic, message_type.name(), id, configuration);
+                                topic, message_type.name(), id, configuration),
+                            message_opcode());
 
                         if (_use_security)
                         {
-                            _mutex.lock();
-                            for (const TlsConnectionPtr &connection : _open_tls_connections)
-                            {
-                                connection->send(advertise_msg);
-                            }
-                            _mutex.unlock();
+                            send_to_all<TlsServer>(advertise_msg);
                         }
                         else
                         {
-                            _mutex.lock();
-                            for (const TcpConnectionPtr &connection : _open_tcp_connections)
-                            {
-                                connection->send(advertise_msg);
-                            }
-                            _mutex.unlock();
+                            send_to_all<TcpServer>(advertise_msg);
+                        }
+
+                        if (_unix_server)
+                        {
+                            send_to_all<UnixServer>(advertise_msg);
                         }
                     }
 
                 private:
-                    void _handle_tls_message(
-                        const ConnectionHandlePtr &handle,
-                        const TlsMessagePtr &message)
+                    template <typename ServerType>
+                    ConnectionRegistry<typename Transport<ServerType>::ConnectionPtr> &open_connections()
                     {
-                        auto incoming_handle = _tls_server->get_con_from_hdl(handle);
+                        if constexpr (std::is_same_v<ServerType, TlsServer>)
+                        {
+                            return _open_tls_connections;
+                        }
+                        else if constexpr (std::is_same_v<ServerType, TcpServer>)
+                        {
+                            return _open_tcp_connections;
+                        }
+                        else
+                        {
+                            return _open_unix_connections;
+                        }
+                    }
 
-                        _logger << utils::Logger::Level::INFO
-                                << "Handle TLS message from connection '"
-                                << _open_tls_conn_to_id[incoming_handle] << "': [[ "
-                                << message->get_payload() << " ]]" << std::endl;
+                    template <typename ServerType>
+                    void close_connections()
+                    {
+                        using ConnectionPtr = typename Transport<ServerType>::ConnectionPtr;
 
-                        get_encoding().interpret_websocket_msg(
-                            message->get_payload(), *this, incoming_handle);
+                        // NOTE(MXG): _open_connections can get modified in other threads so we'll
+                        // take a snapshot of it here before using it.
+                        const auto connections = open_connections<ServerType>().snapshot();
+
+                        // First instruct all connections to close
+                        for (const auto &connection : *connections)
+                        {
+                            if (connection.first->get_state() != websocketpp::session::state::closed)
+                            {
+                                try
+                                {
+                                    connection.first->close(websocketpp::close::status::normal, "shutdown");
+                                }
+                                catch (websocketpp::exception &e)
+                                {
+                                    _logger << utils::Logger::Level::WARN
+                                            << "Exception ocurred while closing connection"
+                                            << " with ID '" << connection.second << "'" << std::endl;
+                                }
+                            }
+                        }
+
+                        // Then wait for all of them to close. Every close handler notifies an event.
+                        if (!wait_for_event(ShutdownTimeout, [&]()
+                                            { return all_closed<ConnectionPtr>(*connections); }))
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Timed out while waiting for "
+                                    << "the remote clients to acknowledge the connection "
+                                    << "shutdown request" << std::endl;
+                        }
+                    }
+
+                    template <typename ServerType>
+                    void send_to_all(
+                        const TlsMessagePtr &message)
+                    {
+                        const auto connections = open_connections<ServerType>().snapshot();
+                        for (const auto &connection : *connections)
+                        {
+                            connection.first->send(message);
+                        }
                     }
 
-                    void _handle_tcp_message(
+                    template <typename ServerType>
+                    void _handle_message(
+                        ServerType &server,
                         const ConnectionHandlePtr &handle,
-                        const TcpMessagePtr &message)
+                        const typename ServerType::message_ptr &message)
                     {
-                        auto incoming_handle = _tcp_server->get_con_from_hdl(handle);
+                        auto incoming_handle = server.get_con_from_hdl(handle);
 
-                        /*_logger << utils::Logger::Level::INFO
-                                << "Handle TCP message from connection '"
-                                << _open_tcp_conn_to_id[incoming_handle] << "': [[ "
-                                << message->get_payload() << " ]]" << std::endl;*/
+                        WEBSOCKET_TRACE(_logger, _trace_payloads, utils::Logger::Level::INFO)
+                            << "Handle " << Transport<ServerType>::name << " message from connection '"
+                            << open_connections<ServerType>().id_of(incoming_handle) << "': [[ "
+                            << message->get_payload() << " ]]" << std::endl;
 
-                        get_encoding().interpret_websocket_msg(
-                            message->get_payload(), *this, incoming_handle);
+                        handle_websocket_msg(message->get_payload(), incoming_handle);
                     }
 
+                    template <typename ServerType>
                     void _handle_close(
+                        ServerType &server,
                         const ConnectionHandlePtr &handle)
                     {
-                        _mutex.lock();
-                        if (_use_security)
+                        auto &connections = open_connections<ServerType>();
+                        const auto connection = server.get_con_from_hdl(handle);
+                        uint16_t connection_id = 0;
+                        if (!connections.remove(connection, connection_id))
                         {
-                            const auto connection = _tls_server->get_con_from_hdl(handle);
-                            const uint16_t connection_id = _open_tls_conn_to_id[connection];
+                            return;
+                        }
 
-                            _open_tls_conn_to_id.erase(connection);
+                        notify_connection_closed(connection);
 
-                            notify_connection_closed(connection);
+                        _logger << utils::Logger::Level::INFO
+                                << "Closed " << Transport<ServerType>::name << " client connection with ID '"
+                                << connection_id << "'. Now, " << connections.size()
+                                << " " << Transport<ServerType>::name << " connections remain active" << std::endl;
+                    }
 
-                            _open_tls_connections.erase(connection);
+                    /**
+                     * @param[in] pending_bytes For the Unix socket connections, reports the bytes written by
+                     *            the connection which its stream has not sent yet.
+                     */
+                    template <typename ServerType>
+                    void _handle_opening(
+                        ServerType &server,
+                        const ConnectionHandlePtr &handle,
+                        std::function<std::size_t()> pending_bytes = nullptr)
+                    {
+                        const auto connection = server.get_con_from_hdl(handle);
 
-                            _logger << utils::Logger::Level::INFO
-                                    << "Closed TLS client connection with ID '" << connection_id
-                                    << "'. Now, " << _open_tls_connections.size()
-                                    << " TLS connections remain active" << std::endl;
+                        if (_closing_down)
+                        {
+                            connection->close(websocketpp::close::status::normal, "shutdown");
+                            return;
+                        }
+
+                        _mark_cluster_link(connection);
+
+                        // Registered first, so that a topic advertised meanwhile is not missed by the
+                        // connection: at worst, it gets the advertisement twice
+                        auto &connections = open_connections<ServerType>();
+                        const uint16_t connection_id = connections.add(connection);
+
+                        if constexpr (std::is_same_v<ServerType, UnixServer>)
+                        {
+                            notify_connection_opened(connection, std::move(pending_bytes));
                         }
                         else
                         {
-                            const auto connection = _tcp_server->get_con_from_hdl(handle);
-                            const uint16_t connection_id = _open_tcp_conn_to_id[connection];
+                            notify_connection_opened(connection);
+                        }
 
-                            _open_tcp_conn_to_id.erase(connection);
+                        _logger << utils::Logger::Level::INFO
+                                << "Opened " << Transport<ServerType>::name << " connection with ID '"
+                                << connection_id << "'. " << "Number of active " << Transport<ServerType>::name
+                                << " connections: " << connections.size() << std::endl;
+                    }
 
-                            notify_connection_closed(connection);
+                    /**
+                     * @brief Serve a connection accepted on the Unix socket: its stream feeds the bytes it
+                     *        reads to the iostream transport, and writes the frames of the transport back.
+                     */
+                    void _handle_unix_socket(
+                        const std::shared_ptr<UnixSocketStream> &stream)
+                    {
+                        const UnixConnectionPtr connection = _unix_server->get_connection();
+                        connection->set_remote_endpoint("unix:" + _unix_socket_path);
 
-                            _open_tcp_connections.erase(connection);
+                        // The frames are only queued on the stream, which writes them from its strand
+                        connection->set_write_handler(
+                            [stream](ConnectionHandlePtr /*handle*/, const char *data, std::size_t size) -> ErrorCode
+                            {
+                                stream->write(std::string(data, size));
+                                return ErrorCode();
+                            });
 
-                            _logger << utils::Logger::Level::INFO
-                                    << "Closed TCP client connection with ID '" << connection_id
-                                    << "'. Now, " << _open_tcp_connections.size()
-                                    << " TCP connections remain active" << std::endl;
-                        }
-                        _mutex.unlock();
+                        connection->set_vector_write_handler(
+                            [stream](ConnectionHandlePtr /*handle*/,
+                                     const std::vector<websocketpp::transport::buffer> &buffers) -> ErrorCode
+                            {
+                                std::size_t size = 0;
+                                for (const websocketpp::transport::buffer &buffer : buffers)
+                                {
+                                    size += buffer.len;
+                                }
+
+                                std::string data;
+                                data.reserve(size);
+                                for (const websocketpp::transport::buffer &buffer : buffers)
+                                {
+                                    data.append(buffer.buf, buffer.len);
+                                }
+
+                                stream->write(std::move(data));
+                                return ErrorCode();
+                            });
+
+                        connection->set_shutdown_handler(
+                            [stream](ConnectionHandlePtr /*handle*/) -> ErrorCode
+                            {
+                                stream->close();
+                                return ErrorCode();
+                            });
+
+                        // Overrides the handler of the server, to stop the handshake timeout of the stream
+                        // and to report the bytes still queued on it to the send queue of the connection
+                        const std::chrono::milliseconds idle_timeout = _unix_idle_timeout;
+                        connection->set_open_handler(
+                            [this, stream, idle_timeout](ConnectionHandlePtr handle)
+                            {
+                                stream->opened(idle_timeout);
+                                this->_handle_opening(
+                                    *_unix_server, handle,
+                                    [stream]() -> std::size_t
+                                    {
+                                        return stream->pending_bytes();
+                                    });
+                            });
+
+                        connection->start();
+                        stream->start(
+                            [connection](const char *data, std::size_t size)
+                            {
+                                connection->read_all(data, size);
+                            },
+                            [connection](const boost::system::error_code &ec)
+                            {
+                                if (boost::asio::error::eof == ec)
+                                {
+                                    connection->eof();
+                                }
+                                // The stream is also aborted once the connection has shut it down
+                                else if (boost::asio::error::operation_aborted != ec)
+                                {
+                                    connection->fatal_error();
+                                }
+                            },
+                            _unix_handshake_timeout);
                     }
 
-                    void _handle_opening(
-                        const ConnectionHandlePtr &handle)
+                    void _handle_failed_connection(
+                        const ConnectionHandlePtr & /*handle*/)
                     {
-                        _mutex.lock();
-                        if (_use_security)
+                        _logger << utils::Logger::Level::WARN
+                                << "An incoming client failed to "
+                                << "connect." << std::endl;
+                    }
+
+                    template <typename ConnectionPtr>
+                    void _handle_cluster_link_opened(
+                        std::size_t index,
+                        const ConnectionPtr &connection)
+                    {
+                        const websocketpp::frame::opcode::value opcode = message_opcode();
+                        add_cluster_link(connection);
+
+                        std::string uri;
                         {
-                            const auto connection = _tls_server->get_con_from_hdl(handle);
+                            const std::lock_guard<std::mutex> lock(_cluster_mutex);
+                            ClusterPeer &peer = _cluster_peers[index];
+                            peer.send = [connection, opcode](const std::string &message)
+                            {
+                                connection->send(message, opcode);
+                            };
+                            peer.close = [connection]()
+                            {
+                                ErrorCode ec;
+                                connection->close(websocketpp::close::status::going_away, "shutdown", ec);
+                            };
+                            uri = peer.uri;
+                        }
 
-                            if (_closing_down)
+                        // The interest changes from now on are sent along with the current one
+                        send_cluster_subscriptions(
+                            [&](const std::string &message)
                             {
-                                connection->close(websocketpp::close::status::normal, "shutdown");
-                                return;
-                            }
+                                connection->send(message, opcode);
+                            });
 
-                            _open_tls_conn_to_id.insert({connection, ++_opened_tls_conn_counter});
+                        _logger << utils::Logger::Level::INFO
+                                << "Linked with the cluster peer '" << uri << "'" << std::endl;
+                    }
 
-                            notify_connection_opened(connection);
+                    template <typename ClientType, typename ConnectionPtr>
+                    void _handle_cluster_link_closed(
+                        ClientType &client,
+                        std::size_t index,
+                        const ConnectionPtr &connection)
+                    {
+                        remove_cluster_link(connection);
 
-                            _open_tls_connections.insert(connection);
+                        // Peers refuse the links which this very node opens with them
+                        const bool this_node =
+                            connection->get_response_code() == websocketpp::http::status_code::conflict;
 
-                            _logger << utils::Logger::Level::INFO
-                                    << "Opened TLS connection with ID '" << _opened_tls_conn_counter << "'. "
-                                    << "Number of active TLS connections: " << _open_tls_connections.size() << std::endl;
+                        std::string uri;
+                        {
+                            const std::lock_guard<std::mutex> lock(_cluster_mutex);
+                            ClusterPeer &peer = _cluster_peers[index];
+                            peer.send = nullptr;
+                            peer.close = nullptr;
+                            peer.is_this_node = this_node;
+                            uri = peer.uri;
                         }
-                        else
+
+                        if (this_node)
                         {
-                            const auto connection = _tcp_server->get_con_from_hdl(handle);
+                            _logger << utils::Logger::Level::DEBUG
+                                    << "The cluster peer '" << uri << "' is this very node" << std::endl;
+                            return;
+                        }
 
-                            if (_closing_down)
+                        if (_closing_down)
+                        {
+                            return;
+                        }
+
+                        _logger << utils::Logger::Level::WARN
+                                << "The link with the cluster peer '" << uri << "' is down, retrying in "
+                                << _cluster_options.reconnect_delay.count() << " ms" << std::endl;
+
+                        set_timer(
+                            _cluster_options.reconnect_delay,
+                            [this, &client, index]()
                             {
-                                connection->close(websocketpp::close::status::normal, "shutdown");
-                                return;
-                            }
+                                this->connect_cluster_peer(client, index);
+                            });
+                    }
 
-                            _open_tcp_conn_to_id.insert({connection, ++_opened_tcp_conn_counter});
+                    template <typename ConnectionPtr>
+                    void _mark_cluster_link(
+                        const ConnectionPtr &connection)
+                    {
+                        if (_cluster_peers.empty())
+                        {
+                            return;
+                        }
 
-                            notify_connection_opened(connection);
+                        const std::string node_id = connection->get_request_header(ClusterNodeHeader);
+                        if (node_id.empty())
+                        {
+                            return;
+                        }
 
-                            _open_tcp_connections.insert(connection);
+                        // Otherwise, any client could opt out of the startup messages and the fan-out
+                        if (!is_trusted_cluster_link(
+                                _cluster_options, node_id, connection->get_request_header(ClusterSecretHeader)))
+                        {
+                            _logger << utils::Logger::Level::WARN
+                                    << "A connection claimed to be the cluster node '" << node_id
+                                    << "', but is not trusted as such. It is served as a client" << std::endl;
+                            return;
+                        }
 
-                            _logger << utils::Logger::Level::INFO
-                                    << "Opened TCP connection with ID '" << _opened_tcp_conn_counter << "'. "
-                                    << "Number of active TCP connections: " << _open_tcp_connections.size() << std::endl;
+                        add_cluster_link(connection);
+
+                        _logger << utils::Logger::Level::INFO
+                                << "The cluster node '" << node_id << "' linked with this one" << std::endl;
+                    }
+
+                    template <typename ConnectionPtr>
+                    bool _is_link_from_this_node(
+                        const ConnectionPtr &connection) const
+                    {
+                        if (_cluster_peers.empty()
+                            || connection->get_request_header(ClusterNodeHeader) != _cluster_options.node_id)
+                        {
+                            return false;
                         }
-                        _mutex.unlock();
+
+                        connection->set_status(websocketpp::http::status_code::conflict);
+                        return true;
                     }
 
-                    void _handle_failed_connection(
-                        const ConnectionHandlePtr & /*handle*/)
+                    ErrorCode _handle_pre_bind(
+                        boost::asio::ip::tcp::acceptor &acceptor)
                     {
-                        _logger << utils::Logger::Level::WARN
-                                << "An incoming client failed to "
-                                << "connect." << std::endl;
+                        boost::system::error_code ec;
+#ifdef SO_REUSEPORT
+                        acceptor.set_option(
+                            boost::asio::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>(true), ec);
+#else
+                        ec = boost::asio::error::operation_not_supported;
+#endif
+                        if (ec)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Failed to share the port among the '" << YamlAcceptorsKey << "': "
+                                    << ec.message() << std::endl;
+
+                            return websocketpp::transport::asio::error::make_error_code(
+                                websocketpp::transport::asio::error::pass_through);
+                        }
+
+                        return ErrorCode();
                     }
 
+                    template <typename ServerType>
                     bool _handle_validate(
+                        ServerType &server,
                         const ConnectionHandlePtr &handle)
+                    {
+                        const auto connection = server.get_con_from_hdl(handle);
+                        if (_is_link_from_this_node(connection))
+                        {
+                            return false;
+                        }
+
+                        const MetricsRegistry::ScopedTimer timer(_handshake_seconds);
+                        const bool valid = _validate_token<ServerType>(connection);
+                        if (!valid && _handshake_rejections != nullptr)
+                        {
+                            _handshake_rejections->increment();
+                        }
+
+                        return valid;
+                    }
+
+                    template <typename ServerType>
+                    bool _validate_token(
+                        const typename Transport<ServerType>::ConnectionPtr &connection_ptr)
                     {
                         if (!_jwt_validator)
                         {
                             return true;
                         }
 
-                        if (_use_security)
+                        std::vector<std::string> requested_sub_protos = connection_ptr->get_requested_subprotocols();
+                        if (requested_sub_protos.size() != 1)
                         {
-                            TlsConnectionPtr connection_ptr = _tls_server->get_con_from_hdl(handle);
-                            std::vector<std::string> requested_sub_protos = connection_ptr->get_requested_subprotocols();
-                            if (requested_sub_protos.size() != 1)
-                            {
-                                connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
-                                return false; // a valid Integration Service client should always send exactly 1 subprotocols.
-                            }
+                            connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
+                            return false; // a valid Integration Service client should always send exactly 1 subprotocols.
+                        }
 
-                            const std::string token = requested_sub_protos[0]; // the subprotocol is the jwt token
+                        const std::string token = requested_sub_protos[0]; // the subprotocol is the jwt token
 
-                            try
-                            {
-                                _jwt_validator->verify(token);
-                            }
-                            catch (const jwt::VerificationError &e)
-                            {
-                                _logger << utils::Logger::Level::ERROR
-                                        << "Error while validating token on TLS server'" << token
-                                        << "'" << e.what() << std::endl;
+                        try
+                        {
+                            _jwt_validator->verify(token);
+                        }
+                        catch (const jwt::VerificationError &e)
+                        {
+                            _logger << utils::Logger::Level::ERROR
+                                    << "Error while validating token on " << Transport<ServerType>::name
+                                    << " server'" << token << "'" << e.what() << std::endl;
 
-                                connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
-                                return false;
-                            }
+                            connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
+                            return false;
+                        }
 
-                            connection_ptr->select_subprotocol(token);
+                        connection_ptr->select_subprotocol(token);
+                        return true;
+                    }
+
+                    /**
+                     * @brief Check the `Authorization: Bearer <token>` header of a plain HTTP request, against
+                     *        the same policies as the WebSocket handshakes. Otherwise, answer it with a `401`.
+                     */
+                    template <typename ServerType>
+                    bool _authorize_http_request(
+                        const typename Transport<ServerType>::ConnectionPtr &connection_ptr)
+                    {
+                        if (!_jwt_validator)
+                        {
                             return true;
                         }
-                        else
-                        {
-                            TcpConnectionPtr connection_ptr = _tcp_server->get_con_from_hdl(handle);
-                            std::vector<std::string> requested_sub_protos = connection_ptr->get_requested_subprotocols();
-                            if (requested_sub_protos.size() != 1)
-                            {
-                                connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
-                                return false; // a valid Integration Service client should always send exactly 1 subprotocols.
-                            }
-
-                            const std::string token = requested_sub_protos[0]; // the subprotocol is the jwt token
 
+                        static const std::string bearer = "Bearer ";
+                        const std::string &authorization = connection_ptr->get_request_header("Authorization");
+                        if (0 == authorization.compare(0, bearer.size(), bearer))
+                        {
                             try
                             {
-                                _jwt_validator->verify(token);
+                                _jwt_validator->verify(authorization.substr(bearer.size()));
+                                return true;
                             }
                             catch (const jwt::VerificationError &e)
                             {
-                                _logger << utils::Logger::Level::ERROR
-                                        << "Error while validating token on TCP server'" << token
-                                        << "'" << e.what() << std::endl;
-
-                                connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
-                                return false;
+                                _logger << utils::Logger::Level::WARN
+                                        << "Refused a " << Transport<ServerType>::name
+                                        << " HTTP request with an invalid token: " << e.what() << std::endl;
                             }
-
-                            connection_ptr->select_subprotocol(token);
-                            return true;
                         }
+
+                        connection_ptr->set_status(websocketpp::http::status_code::unauthorized);
+                        connection_ptr->append_header("WWW-Authenticate", "Bearer");
+                        return false;
                     }
 
                     std::shared_ptr<TlsServer> _tls_server;
                     std::shared_ptr<TcpServer> _tcp_server;
                     bool _use_security;
-                    std::thread _server_thread;
-                    std::mutex _mutex;
+                    uint32_t _num_threads = 1;
+                    uint32_t _num_acceptors = 1;
+
+                    /**
+                     * The endpoints listening on the port, the first of which is the one given to the Endpoint.
+                     */
+                    std::vector<std::shared_ptr<TlsServer>> _tls_acceptors;
+                    std::vector<std::shared_ptr<TcpServer>> _tcp_acceptors;
+                    std::vector<std::thread> _server_threads;
                     EncodingPtr _encoding;
                     SslContextPtr _context;
-                    std::unordered_set<TlsConnectionPtr> _open_tls_connections;
-                    uint16_t _opened_tls_conn_counter;
-                    std::unordered_map<TlsConnectionPtr, uint16_t> _open_tls_conn_to_id;
-                    std::unordered_set<TcpConnectionPtr> _open_tcp_connections;
-                    uint16_t _opened_tcp_conn_counter;
-                    std::unordered_map<TcpConnectionPtr, uint16_t> _open_tcp_conn_to_id;
+                    TlsOptions _tls_options;
+                    ConnectionRegistry<TlsConnectionPtr> _open_tls_connections;
+                    ConnectionRegistry<TcpConnectionPtr> _open_tcp_connections;
                     bool _has_spun_once = false;
-                    bool _closing_down = false;
+                    std::atomic_bool _closing_down{false};
                     std::unique_ptr<JwtValidator> _jwt_validator;
+                    MetricsRegistry::Histogram *_handshake_seconds = nullptr;
+                    MetricsRegistry::Counter *_handshake_rejections = nullptr;
+
+                    struct ClusterPeer
+                    {
+                            std::string uri;
+
+                            /**
+                             * Send through and close the link with the peer, only while it is open.
+                             */
+                            std::function<void(const std::string &)> send;
+                            std::function<void()> close;
+
+                            /**
+                             * Whether the peer turned out to be this very node, which is not linked.
+                             */
+                            bool is_this_node = false;
+                    };
+
+                    ClusterOptions _cluster_options;
+                    std::mutex _cluster_mutex;
+                    std::vector<ClusterPeer> _cluster_peers;
+                    std::shared_ptr<TlsClient> _cluster_tls_client;
+                    std::shared_ptr<TcpClient> _cluster_tcp_client;
+                    SslContextPtr _cluster_context;
+
+                    /**
+                     * Optional Unix domain socket for the local clients, served by the io_service of the first acceptor.
+                     */
+                    std::string _unix_socket_path;
+                    std::shared_ptr<UnixServer> _unix_server;
+                    boost::asio::io_service *_unix_io_service = nullptr;
+                    std::unique_ptr<boost::asio::local::stream_protocol::acceptor> _unix_acceptor;
+                    ConnectionRegistry<UnixConnectionPtr> _open_unix_connections;
+                    std::chrono::milliseconds _unix_handshake_timeout = DefaultUnixHandshakeTimeout;
+                    std::chrono::milliseconds _unix_idle_timeout{0};
                 };
 
                 IS_REGISTER_SYSTEM("websocket_server", is::sh::websocket::Server)
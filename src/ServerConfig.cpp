@@ -22,7 +22,7 @@
 
 #include <is/core/runtime/Search.hpp>
 
-#include <boost/algorithm/string.hpp>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -37,6 +37,10 @@ const std::string YamlRulesKey = "rules";
 const std::string YamlSecretKey = "secret";
 const std::string YamlPubkeyKey = "pubkey";
 const std::string YamlAlgoKey = "algo";
+const std::string YamlKidKey = "kid";
+const std::string YamlCacheKey = "cache";
+const std::string YamlCacheCapacityKey = "capacity";
+const std::string YamlCacheTtlKey = "ttl";
 
 bool ServerConfig::load_auth_policy(
         JwtValidator& jwt_validator,
@@ -58,6 +62,21 @@ bool ServerConfig::load_auth_policy(
                 jwt_validator.add_verification_policy(_parse_policy_yaml(policy_node));
             }
         }
+
+        if (const YAML::Node& cache_node = auth_node[YamlCacheKey])
+        {
+            try
+            {
+                jwt_validator.set_cache_limits(
+                    cache_node[YamlCacheCapacityKey].as<std::size_t>(JwtValidator::DefaultCacheCapacity),
+                    std::chrono::seconds(cache_node[YamlCacheTtlKey].as<int64_t>(
+                        JwtValidator::DefaultCacheTtl.count())));
+            }
+            catch (const YAML::BadConversion& e)
+            {
+                throw ParseError("invalid '" + YamlCacheKey + "' settings: " + e.what());
+            }
+        }
     }
     catch (const ParseError& e)
     {
@@ -68,31 +87,6 @@ bool ServerConfig::load_auth_policy(
     return true;
 }
 
-std::string ServerConfig::_glob_to_regex(
-        const std::string& str)
-{
-    using namespace boost::algorithm;
-
-    return find_format_all_copy(
-        str, token_finder(is_any_of(".*?\\")), [](auto s)
-        {
-            auto c = s.begin();
-            switch (*c)
-            {
-                case '.':
-                    return std::string("\\.");
-                case '*':
-                    return std::string(".*");
-                case '?':
-                    return std::string(".?");
-                case '\\':
-                    return std::string("\\\\");
-                default:
-                    return std::string(s.begin(), s.end());
-            }
-        });
-}
-
 VerificationPolicy ServerConfig::_parse_policy_yaml(
         const YAML::Node& policy_node)
 {
@@ -159,19 +153,24 @@ VerificationPolicy ServerConfig::_parse_policy_yaml(
     if (policy_node[YamlAlgoKey])
     {
         header_rules.emplace_back(VerificationPolicy::Rule("alg",
-                _glob_to_regex(policy_node[YamlAlgoKey].as<std::string>())));
+                policy_node[YamlAlgoKey].as<std::string>()));
     }
 
     for (const auto& r : policy_node[YamlRulesKey])
     {
-        std::string regex_pattern = _glob_to_regex(r.second.as<std::string>());
         rules.emplace_back(VerificationPolicy::Rule{
-                            r.first.as<std::string>(), std::move(regex_pattern)
+                            r.first.as<std::string>(), r.second.as<std::string>()
                         });
     }
 
+    std::string kid;
+    if (policy_node[YamlKidKey])
+    {
+        kid = policy_node[YamlKidKey].as<std::string>();
+    }
+
     return VerificationPolicy(
-        std::move(rules), std::move(header_rules), std::move(secret_or_pubkey));
+        std::move(rules), std::move(header_rules), std::move(secret_or_pubkey), std::move(kid));
 }
 
 } // namespace websocket
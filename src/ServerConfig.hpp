@@ -42,8 +42,6 @@ public:
 
 private:
 
-    static std::string _glob_to_regex(
-            const std::string& s);
     static VerificationPolicy _parse_policy_yaml(
             const YAML::Node& policy_node);
 };
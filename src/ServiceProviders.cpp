@@ -0,0 +1,229 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "ServiceProviders.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+const std::string YamlBalanceKey = "balance";
+const std::string YamlBalance_LeastOutstanding = "least_outstanding";
+const std::string YamlBalance_RoundRobin = "round_robin";
+const std::string YamlMaxInFlightKey = "max_in_flight";
+
+//==============================================================================
+bool parse_service_providers_options(
+        const YAML::Node& providers_node,
+        ServiceProvidersOptions& options,
+        std::string& error)
+{
+    try
+    {
+        const std::string balance = providers_node[YamlBalanceKey].as<std::string>("");
+        if (YamlBalance_LeastOutstanding == balance)
+        {
+            options.balance = ServiceProvidersOptions::Balance::LEAST_OUTSTANDING;
+        }
+        else if (YamlBalance_RoundRobin == balance)
+        {
+            options.balance = ServiceProvidersOptions::Balance::ROUND_ROBIN;
+        }
+        else if (!balance.empty())
+        {
+            error = "unknown balance '" + balance + "', it must be either '" + YamlBalance_LeastOutstanding
+                    + "' or '" + YamlBalance_RoundRobin + "'";
+            return false;
+        }
+
+        if (const YAML::Node max_in_flight_node = providers_node[YamlMaxInFlightKey])
+        {
+            options.max_in_flight = max_in_flight_node.as<std::size_t>();
+        }
+    }
+    catch (const YAML::BadConversion& e)
+    {
+        error = e.what();
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+bool ServiceProviders::add_provider(
+        const std::shared_ptr<void>& connection)
+{
+    const auto it = std::find_if(_providers.begin(), _providers.end(),
+                    [&](const Provider& provider)
+                    {
+                        return provider.connection == connection;
+                    });
+
+    if (it != _providers.end())
+    {
+        return false;
+    }
+
+    _providers.push_back(Provider{connection, 0});
+    return true;
+}
+
+//==============================================================================
+bool ServiceProviders::remove_provider(
+        const std::shared_ptr<void>& connection)
+{
+    const auto it = std::find_if(_providers.begin(), _providers.end(),
+                    [&](const Provider& provider)
+                    {
+                        return provider.connection == connection;
+                    });
+
+    if (it == _providers.end())
+    {
+        return false;
+    }
+
+    _providers.erase(it);
+    for (auto call = _in_flight.begin(); call != _in_flight.end();)
+    {
+        call = call->second == connection ? _in_flight.erase(call) : std::next(call);
+    }
+
+    return true;
+}
+
+//==============================================================================
+void ServiceProviders::submit(
+        uint64_t id,
+        std::string payload)
+{
+    _waiting.push_back(Call{id, std::move(payload), nullptr});
+}
+
+//==============================================================================
+bool ServiceProviders::complete(
+        uint64_t id)
+{
+    const auto call = _in_flight.find(id);
+    if (call != _in_flight.end())
+    {
+        for (Provider& provider : _providers)
+        {
+            if (provider.connection == call->second)
+            {
+                --provider.in_flight;
+                break;
+            }
+        }
+
+        _in_flight.erase(call);
+        return true;
+    }
+
+    const auto waiting = std::find_if(_waiting.begin(), _waiting.end(),
+                    [id](const Call& waiting_call)
+                    {
+                        return waiting_call.id == id;
+                    });
+
+    if (waiting == _waiting.end())
+    {
+        return false;
+    }
+
+    _waiting.erase(waiting);
+    return true;
+}
+
+//==============================================================================
+std::vector<ServiceProviders::Call> ServiceProviders::take_ready()
+{
+    std::vector<Call> ready;
+    while (!_waiting.empty())
+    {
+        const std::size_t index = pick();
+        if (index == _providers.size())
+        {
+            break;
+        }
+
+        Provider& provider = _providers[index];
+        ++provider.in_flight;
+        _next = index + 1;
+
+        Call call = std::move(_waiting.front());
+        _waiting.pop_front();
+        call.provider = provider.connection;
+        _in_flight.emplace(call.id, provider.connection);
+        ready.push_back(std::move(call));
+    }
+
+    return ready;
+}
+
+//==============================================================================
+std::size_t ServiceProviders::in_flight(
+        const std::shared_ptr<void>& connection) const
+{
+    for (const Provider& provider : _providers)
+    {
+        if (provider.connection == connection)
+        {
+            return provider.in_flight;
+        }
+    }
+
+    return 0;
+}
+
+//==============================================================================
+std::size_t ServiceProviders::pick() const
+{
+    const std::size_t count = _providers.size();
+    std::size_t best = count;
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const std::size_t index = (_next + i) % count;
+        const Provider& provider = _providers[index];
+        if (_options.max_in_flight > 0 && provider.in_flight >= _options.max_in_flight)
+        {
+            continue;
+        }
+
+        if (ServiceProvidersOptions::Balance::ROUND_ROBIN == _options.balance)
+        {
+            return index;
+        }
+
+        if (best == count || provider.in_flight < _providers[best].in_flight)
+        {
+            best = index;
+        }
+    }
+
+    return best;
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
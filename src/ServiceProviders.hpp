@@ -0,0 +1,181 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__SERVICEPROVIDERS_HPP_
+#define _WEBSOCKET_IS_SH__SRC__SERVICEPROVIDERS_HPP_
+
+#include <yaml-cpp/yaml.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief How the calls to a service advertised by several connections are spread among them.
+ */
+struct ServiceProvidersOptions
+{
+    enum class Balance
+    {
+        LEAST_OUTSTANDING,
+        ROUND_ROBIN
+    };
+
+    /**
+     * Whether each call goes to the provider with the fewest calls in flight, or to the next one in turn.
+     */
+    Balance balance = Balance::LEAST_OUTSTANDING;
+
+    /**
+     * Calls in flight on each provider, beyond which the calls wait for one to finish. Zero means no limit.
+     */
+    std::size_t max_in_flight = 0;
+};
+
+/**
+ * @brief Parses the `providers` node of a service configuration. Missing settings keep their value.
+ *
+ * @param[out] error Why the settings are not valid, if they are not.
+ *
+ * @returns `true` if every setting is valid.
+ */
+bool parse_service_providers_options(
+        const YAML::Node& providers_node,
+        ServiceProvidersOptions& options,
+        std::string& error);
+
+/**
+ * @class ServiceProviders
+ * @brief Keeps the connections which provide a service, and hands each call to one of them.
+ * @details Calls are submitted in order, and become ready once a provider below its limit of calls
+ *          in flight is assigned to them. Calls wait while there is none, until another call finishes
+ *          or a new provider shows up. It is not thread safe.
+ */
+class ServiceProviders
+{
+public:
+
+    /**
+     * @brief A call, already encoded, along with the provider it must be sent to once it is ready.
+     */
+    struct Call
+    {
+        uint64_t id;
+        std::string payload;
+        std::shared_ptr<void> provider;
+    };
+
+    void configure(
+            const ServiceProvidersOptions& options)
+    {
+        _options = options;
+    }
+
+    /**
+     * @returns `true` if the connection was not a provider yet.
+     */
+    bool add_provider(
+            const std::shared_ptr<void>& connection);
+
+    /**
+     * @brief Forgets a provider. Its calls in flight are no longer accounted for, although their
+     *        responses may still arrive.
+     *
+     * @returns `true` if the connection was a provider.
+     */
+    bool remove_provider(
+            const std::shared_ptr<void>& connection);
+
+    std::size_t providers() const
+    {
+        return _providers.size();
+    }
+
+    /**
+     * @brief Queues a call, which is handed out by take_ready.
+     */
+    void submit(
+            uint64_t id,
+            std::string payload);
+
+    /**
+     * @brief Accounts for a call which got its response or was given up, wherever it was.
+     *
+     * @returns `true` if the call was known.
+     */
+    bool complete(
+            uint64_t id);
+
+    /**
+     * @brief Assigns a provider to as many waiting calls as the limits allow, in order.
+     *
+     * @returns The calls to be sent right away.
+     */
+    std::vector<Call> take_ready();
+
+    /**
+     * @brief Number of calls in flight on a provider.
+     */
+    std::size_t in_flight(
+            const std::shared_ptr<void>& connection) const;
+
+    std::size_t waiting() const
+    {
+        return _waiting.size();
+    }
+
+private:
+
+    struct Provider
+    {
+        std::shared_ptr<void> connection;
+        std::size_t in_flight;
+    };
+
+    /**
+     * @returns The index of the provider which takes the next call, or the number of providers if all
+     *          of them are full.
+     */
+    std::size_t pick() const;
+
+    ServiceProvidersOptions _options;
+    std::vector<Provider> _providers;
+    std::deque<Call> _waiting;
+
+    // The provider handling each call in flight
+    std::unordered_map<uint64_t, std::shared_ptr<void>> _in_flight;
+
+    // Where the search for the next provider begins, which spreads the ties
+    std::size_t _next = 0;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__SERVICEPROVIDERS_HPP_
@@ -0,0 +1,151 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "StartupMessages.hpp"
+
+#include <iterator>
+#include <utility>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+StartupMessages::StartupMessages(
+        BatchEncoder batch_encoder,
+        std::size_t max_frame_bytes)
+    : _batch_encoder(std::move(batch_encoder))
+    , _max_frame_bytes(max_frame_bytes)
+    , _dirty(false)
+{
+}
+
+//==============================================================================
+bool StartupMessages::set(
+        const std::string& key,
+        std::string message)
+{
+    const auto it = _index.find(key);
+    if (it != _index.end())
+    {
+        if (it->second->message == message)
+        {
+            return false;
+        }
+
+        it->second->message = std::move(message);
+    }
+    else
+    {
+        _messages.push_back(Entry{key, std::move(message)});
+        _index.emplace(key, std::prev(_messages.end()));
+    }
+
+    _dirty = true;
+    return true;
+}
+
+//==============================================================================
+bool StartupMessages::remove(
+        const std::string& key)
+{
+    const auto it = _index.find(key);
+    if (it == _index.end())
+    {
+        return false;
+    }
+
+    _messages.erase(it->second);
+    _index.erase(it);
+    _dirty = true;
+    return true;
+}
+
+//==============================================================================
+const std::vector<std::string>& StartupMessages::frames()
+{
+    if (_dirty)
+    {
+        build_frames();
+        _dirty = false;
+    }
+
+    return _frames;
+}
+
+//==============================================================================
+void StartupMessages::build_frames()
+{
+    _frames.clear();
+
+    std::vector<std::string> batch;
+    std::size_t batch_bytes = 0;
+    const auto flush = [&]()
+            {
+                std::string frame = batch.size() > 1 ? _batch_encoder(batch) : std::string();
+                if (!frame.empty())
+                {
+                    _frames.push_back(std::move(frame));
+                }
+                else
+                {
+                    // A single message, or an encoding which cannot batch them, goes as is
+                    for (std::string& message : batch)
+                    {
+                        _frames.push_back(std::move(message));
+                    }
+                }
+
+                batch.clear();
+                batch_bytes = 0;
+            };
+
+    for (const Entry& entry : _messages)
+    {
+        if (!_batch_encoder)
+        {
+            _frames.push_back(entry.message);
+            continue;
+        }
+
+        // A message which would make the batch too big starts the next one, unless the batch is
+        // empty: a message bigger than the limit goes alone
+        if (!batch.empty() && batch_bytes + entry.message.size() > _max_frame_bytes)
+        {
+            flush();
+        }
+
+        batch.push_back(entry.message);
+        batch_bytes += entry.message.size();
+        if (batch_bytes >= _max_frame_bytes)
+        {
+            flush();
+        }
+    }
+
+    if (!batch.empty())
+    {
+        flush();
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__STARTUPMESSAGES_HPP_
+#define _WEBSOCKET_IS_SH__SRC__STARTUPMESSAGES_HPP_
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class StartupMessages
+ * @brief Keeps the messages sent to every connection as soon as it opens, such as the advertisements of
+ *        the topics and services of the endpoint, along with the frames which carry them.
+ * @details Each message is kept under a key, so that repeating it replaces the former one, and it can be
+ *          withdrawn. The frames are only built again after the messages change, gathering the messages
+ *          into batches when a batch encoder is given. It is not thread safe.
+ */
+class StartupMessages
+{
+public:
+
+    /**
+     * @brief Encodes several messages as a single one, or returns an empty string if it cannot.
+     */
+    using BatchEncoder = std::function<std::string(const std::vector<std::string>&)>;
+
+    /**
+     * @param[in] batch_encoder Encoder of the batches, or none to send every message on its own.
+     *
+     * @param[in] max_frame_bytes Size of the messages which no batch exceeds. A bigger message
+     *            is sent on its own.
+     */
+    explicit StartupMessages(
+            BatchEncoder batch_encoder = nullptr,
+            std::size_t max_frame_bytes = 65536);
+
+    /**
+     * @brief Keeps a message, replacing the one with the same key while keeping its position.
+     *
+     * @returns `true` if the messages changed.
+     */
+    bool set(
+            const std::string& key,
+            std::string message);
+
+    /**
+     * @brief Withdraws the message with the given key.
+     *
+     * @returns `true` if there was one.
+     */
+    bool remove(
+            const std::string& key);
+
+    std::size_t size() const
+    {
+        return _messages.size();
+    }
+
+    /**
+     * @brief The frames to send to a new connection, in the order the messages were first kept.
+     */
+    const std::vector<std::string>& frames();
+
+private:
+
+    struct Entry
+    {
+        std::string key;
+        std::string message;
+    };
+
+    void build_frames();
+
+    BatchEncoder _batch_encoder;
+    std::size_t _max_frame_bytes;
+    std::list<Entry> _messages;
+    std::unordered_map<std::string, std::list<Entry>::iterator> _index;
+    std::vector<std::string> _frames;
+    bool _dirty;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__STARTUPMESSAGES_HPP_
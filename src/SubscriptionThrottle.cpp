@@ -0,0 +1,157 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "SubscriptionThrottle.hpp"
+
+#include <algorithm>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+SubscriptionThrottle::SubscriptionThrottle(
+        std::chrono::milliseconds throttle_rate,
+        std::size_t queue_length,
+        Hooks hooks)
+    : _throttle_rate(throttle_rate)
+    , _queue_length(queue_length)
+    , _hooks(std::move(hooks))
+    , _sent_any(false)
+    , _release_scheduled(false)
+    , _coalesced(0)
+{
+}
+
+//==============================================================================
+void SubscriptionThrottle::configure(
+        std::chrono::milliseconds throttle_rate,
+        std::size_t queue_length)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _throttle_rate = throttle_rate;
+    _queue_length = queue_length;
+
+    while (_pending.size() > std::max<std::size_t>(_queue_length, 1))
+    {
+        _pending.pop_front();
+        ++_coalesced;
+    }
+}
+
+//==============================================================================
+void SubscriptionThrottle::offer(
+        const TlsMessagePtr& message,
+        Clock::time_point now)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+
+    const Clock::duration elapsed = now - _last_sent;
+    if (_pending.empty() && (!_sent_any || elapsed >= _throttle_rate))
+    {
+        _hooks.send(message);
+        _last_sent = now;
+        _sent_any = true;
+        return;
+    }
+
+    _pending.push_back(message);
+    while (_pending.size() > std::max<std::size_t>(_queue_length, 1))
+    {
+        _pending.pop_front();
+        ++_coalesced;
+    }
+
+    schedule_release(std::max<Clock::duration>(_throttle_rate - elapsed, Clock::duration::zero()));
+}
+
+//==============================================================================
+void SubscriptionThrottle::release(
+        Clock::time_point now)
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _release_scheduled = false;
+
+    if (_pending.empty())
+    {
+        return;
+    }
+
+    const Clock::duration elapsed = now - _last_sent;
+    if (elapsed < _throttle_rate)
+    {
+        schedule_release(_throttle_rate - elapsed);
+        return;
+    }
+
+    _hooks.send(_pending.front());
+    _pending.pop_front();
+    _last_sent = now;
+
+    if (!_pending.empty())
+    {
+        schedule_release(_throttle_rate);
+    }
+}
+
+//==============================================================================
+std::size_t SubscriptionThrottle::pending() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _pending.size();
+}
+
+//==============================================================================
+std::size_t SubscriptionThrottle::coalesced() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return _coalesced;
+}
+
+//==============================================================================
+void SubscriptionThrottle::schedule_release(
+        Clock::duration delay)
+{
+    if (_release_scheduled || !_hooks.schedule)
+    {
+        return;
+    }
+
+    // Rounded up, so that the release never comes before its turn
+    std::chrono::milliseconds delay_ms = std::chrono::duration_cast<std::chrono::milliseconds>(delay);
+    if (delay_ms < delay)
+    {
+        ++delay_ms;
+    }
+
+    const std::weak_ptr<SubscriptionThrottle> weak_throttle = weak_from_this();
+    _release_scheduled = true;
+    _hooks.schedule(delay_ms, [weak_throttle]()
+            {
+                if (const SubscriptionThrottlePtr throttle = weak_throttle.lock())
+                {
+                    throttle->release();
+                }
+            });
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
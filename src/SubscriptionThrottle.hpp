@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__SUBSCRIPTIONTHROTTLE_HPP_
+#define _WEBSOCKET_IS_SH__SRC__SUBSCRIPTIONTHROTTLE_HPP_
+
+#include "websocket_types.hpp"
+
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class SubscriptionThrottle
+ * @brief Rate limiter for the publications sent to a single subscriber, following the
+ *        `throttle_rate` and `queue_length` semantics of the rosbridge `subscribe` operation.
+ * @details At most one message is sent every `throttle_rate`. The messages published in between
+ *          are held, up to `queue_length` of them, so that the newest ones are sent afterwards
+ *          and the oldest ones are dropped. A `queue_length` of zero keeps only the latest value.
+ */
+class SubscriptionThrottle : public std::enable_shared_from_this<SubscriptionThrottle>
+{
+public:
+
+    using Clock = std::chrono::steady_clock;
+
+    /**
+     * @brief Operations on the subscriber.
+     */
+    struct Hooks
+    {
+        // Sends a message to the subscriber.
+        std::function<void(const TlsMessagePtr&)> send;
+
+        // Calls the given function once the delay has elapsed, from any thread.
+        std::function<void(std::chrono::milliseconds, std::function<void()>)> schedule;
+    };
+
+    SubscriptionThrottle(
+            std::chrono::milliseconds throttle_rate,
+            std::size_t queue_length,
+            Hooks hooks);
+
+    /**
+     * @brief Changes the rate and the number of held messages, for instance when the subscriber
+     *        subscribes again with other settings.
+     */
+    void configure(
+            std::chrono::milliseconds throttle_rate,
+            std::size_t queue_length);
+
+    /**
+     * @brief Sends a message right away if the throttle rate allows it, or holds it otherwise.
+     */
+    void offer(
+            const TlsMessagePtr& message,
+            Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Sends the oldest held message, if its turn has come. It is called once the delay
+     *        requested through the Hooks expires.
+     */
+    void release(
+            Clock::time_point now = Clock::now());
+
+    /**
+     * @brief Number of messages waiting for their turn.
+     */
+    std::size_t pending() const;
+
+    /**
+     * @brief Number of messages dropped in favour of newer ones.
+     */
+    std::size_t coalesced() const;
+
+private:
+
+    void schedule_release(
+            Clock::duration delay);
+
+    std::chrono::milliseconds _throttle_rate;
+    std::size_t _queue_length;
+    const Hooks _hooks;
+
+    // Publications and timers are handled by different threads.
+    mutable std::mutex _mutex;
+    std::deque<TlsMessagePtr> _pending;
+    Clock::time_point _last_sent;
+    bool _sent_any;
+    bool _release_scheduled;
+    std::size_t _coalesced;
+};
+
+using SubscriptionThrottlePtr = std::shared_ptr<SubscriptionThrottle>;
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__SUBSCRIPTIONTHROTTLE_HPP_
@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include "TlsOptions.hpp"
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+const std::string YamlMinVersionKey = "min_version";
+const std::string YamlMaxVersionKey = "max_version";
+const std::string YamlCiphersKey = "ciphers";
+const std::string YamlCiphersuitesKey = "ciphersuites";
+const std::string YamlSessionCacheKey = "session_cache";
+const std::string YamlSessionCacheSizeKey = "size";
+const std::string YamlSessionCacheTimeoutKey = "timeout";
+const std::string YamlSessionTicketsKey = "session_tickets";
+const std::string YamlTicketKeyFileKey = "ticket_key_file";
+const std::string YamlSessionIdContextKey = "session_id_context";
+const std::string YamlResumeSessionsKey = "resume_sessions";
+
+//==============================================================================
+static bool parse_tls_version(
+        const std::string& version,
+        int& value)
+{
+    if ("1.0" == version)
+    {
+        value = TLS1_VERSION;
+    }
+    else if ("1.1" == version)
+    {
+        value = TLS1_1_VERSION;
+    }
+    else if ("1.2" == version)
+    {
+        value = TLS1_2_VERSION;
+    }
+    else if ("1.3" == version)
+    {
+        value = TLS1_3_VERSION;
+    }
+    else
+    {
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+static bool load_ticket_keys(
+        const std::string& path,
+        std::size_t size,
+        std::vector<unsigned char>& keys,
+        std::string& error)
+{
+    std::ifstream file(path, std::ios::binary);
+    if (!file)
+    {
+        error = "could not open the ticket key file '" + path + "'";
+        return false;
+    }
+
+    keys.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    if (keys.size() != size)
+    {
+        error = "the ticket key file '" + path + "' must hold exactly " + std::to_string(size)
+                + " bytes, but it holds " + std::to_string(keys.size());
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+bool parse_tls_options(
+        const YAML::Node& tls_node,
+        TlsOptions& options,
+        std::string& error)
+{
+    try
+    {
+        options.min_version = tls_node[YamlMinVersionKey].as<std::string>(options.min_version);
+        options.max_version = tls_node[YamlMaxVersionKey].as<std::string>(options.max_version);
+        options.ciphers = tls_node[YamlCiphersKey].as<std::string>(options.ciphers);
+        options.ciphersuites = tls_node[YamlCiphersuitesKey].as<std::string>(options.ciphersuites);
+
+        if (const YAML::Node cache_node = tls_node[YamlSessionCacheKey])
+        {
+            if (cache_node.IsMap())
+            {
+                options.session_cache_size =
+                        cache_node[YamlSessionCacheSizeKey].as<std::size_t>(options.session_cache_size);
+                options.session_timeout = std::chrono::seconds(
+                    cache_node[YamlSessionCacheTimeoutKey].as<uint32_t>(
+                        static_cast<uint32_t>(options.session_timeout.count())));
+            }
+            else if (!cache_node.as<bool>())
+            {
+                options.session_cache_size = 0;
+            }
+        }
+
+        options.session_tickets = tls_node[YamlSessionTicketsKey].as<bool>(options.session_tickets);
+        options.ticket_key_file = tls_node[YamlTicketKeyFileKey].as<std::string>(options.ticket_key_file);
+        options.session_id_context = tls_node[YamlSessionIdContextKey].as<std::string>(options.session_id_context);
+        options.resume_sessions = tls_node[YamlResumeSessionsKey].as<bool>(options.resume_sessions);
+    }
+    catch (const YAML::BadConversion& e)
+    {
+        error = e.what();
+        return false;
+    }
+
+    int version = 0;
+    for (const std::string& value : {options.min_version, options.max_version})
+    {
+        if (!value.empty() && !parse_tls_version(value, version))
+        {
+            error = "unknown TLS version '" + value + "', it must be one of 1.0, 1.1, 1.2 or 1.3";
+            return false;
+        }
+    }
+
+    if (options.session_id_context.size() > SSL_MAX_SID_CTX_LENGTH)
+    {
+        error = "the session id context must not be longer than " + std::to_string(SSL_MAX_SID_CTX_LENGTH)
+                + " bytes";
+        return false;
+    }
+
+    return true;
+}
+
+//==============================================================================
+bool apply_tls_options(
+        boost::asio::ssl::context& context,
+        const TlsOptions& options,
+        TlsRole role,
+        std::string& error)
+{
+    SSL_CTX* ctx = context.native_handle();
+
+    int version = 0;
+    if (!options.min_version.empty())
+    {
+        if (!parse_tls_version(options.min_version, version) || 1 != SSL_CTX_set_min_proto_version(ctx, version))
+        {
+            error = "could not set the minimum TLS version to " + options.min_version;
+            return false;
+        }
+    }
+
+    if (!options.max_version.empty())
+    {
+        if (!parse_tls_version(options.max_version, version) || 1 != SSL_CTX_set_max_proto_version(ctx, version))
+        {
+            error = "could not set the maximum TLS version to " + options.max_version;
+            return false;
+        }
+    }
+
+    if (!options.ciphers.empty() && 1 != SSL_CTX_set_cipher_list(ctx, options.ciphers.c_str()))
+    {
+        error = "none of the ciphers '" + options.ciphers + "' is supported";
+        return false;
+    }
+
+    if (!options.ciphersuites.empty() && 1 != SSL_CTX_set_ciphersuites(ctx, options.ciphersuites.c_str()))
+    {
+        error = "none of the cipher suites '" + options.ciphersuites + "' is supported";
+        return false;
+    }
+
+    if (!options.session_tickets)
+    {
+        SSL_CTX_set_options(ctx, SSL_OP_NO_TICKET);
+    }
+
+    if (TlsRole::CLIENT == role)
+    {
+        return true;
+    }
+
+    if (0 == options.session_cache_size)
+    {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_OFF);
+    }
+    else
+    {
+        SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_SERVER);
+        SSL_CTX_sess_set_cache_size(ctx, static_cast<long>(options.session_cache_size));
+    }
+
+    // Tickets expire along with the cached sessions
+    SSL_CTX_set_timeout(ctx, static_cast<long>(options.session_timeout.count()));
+
+    if (1 != SSL_CTX_set_session_id_context(
+                ctx,
+                reinterpret_cast<const unsigned char*>(options.session_id_context.data()),
+                static_cast<unsigned int>(options.session_id_context.size())))
+    {
+        error = "could not set the session id context '" + options.session_id_context + "'";
+        return false;
+    }
+
+    if (options.session_tickets && !options.ticket_key_file.empty())
+    {
+        // Asking for the keys without a buffer tells their size
+        const long size = SSL_CTX_get_tlsext_ticket_keys(ctx, nullptr, 0);
+
+        std::vector<unsigned char> keys;
+        if (!load_ticket_keys(options.ticket_key_file, static_cast<std::size_t>(size), keys, error))
+        {
+            return false;
+        }
+
+        if (1 != SSL_CTX_set_tlsext_ticket_keys(ctx, keys.data(), static_cast<long>(keys.size())))
+        {
+            error = "could not set the session ticket keys";
+            return false;
+        }
+
+        std::fill(keys.begin(), keys.end(), 0);
+    }
+
+    return true;
+}
+
+//==============================================================================
+static int session_cache_index()
+{
+    static const int index = SSL_CTX_get_ex_new_index(0, nullptr, nullptr, nullptr, nullptr);
+    return index;
+}
+
+//==============================================================================
+TlsSessionCache::TlsSessionCache() = default;
+
+//==============================================================================
+TlsSessionCache::~TlsSessionCache() = default;
+
+//==============================================================================
+void TlsSessionCache::attach(
+        boost::asio::ssl::context& context)
+{
+    SSL_CTX* ctx = context.native_handle();
+
+    // The sessions are only kept here, where the next connection finds them
+    SSL_CTX_set_session_cache_mode(ctx, SSL_SESS_CACHE_CLIENT | SSL_SESS_CACHE_NO_INTERNAL_STORE);
+    SSL_CTX_set_ex_data(ctx, session_cache_index(), this);
+    SSL_CTX_sess_set_new_cb(ctx, &TlsSessionCache::on_new_session);
+}
+
+//==============================================================================
+int TlsSessionCache::on_new_session(
+        SSL* ssl,
+        SSL_SESSION* session)
+{
+    auto* cache = static_cast<TlsSessionCache*>(SSL_CTX_get_ex_data(SSL_get_SSL_CTX(ssl), session_cache_index()));
+    if (nullptr == cache)
+    {
+        return 0;
+    }
+
+    // A connection which is not shut down cleanly marks its session as not resumable,
+    // and a reconnection usually follows one of those; so a copy is kept instead
+    SSL_SESSION* copy = SSL_SESSION_dup(session);
+    if (nullptr != copy)
+    {
+        const std::lock_guard<std::mutex> lock(cache->_mutex);
+        cache->_session.reset(copy, &SSL_SESSION_free);
+    }
+
+    return 0;
+}
+
+//==============================================================================
+void TlsSessionCache::prepare(
+        SSL* ssl) const
+{
+    SSL_SESSION* copy = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(_mutex);
+        if (_session)
+        {
+            copy = SSL_SESSION_dup(_session.get());
+        }
+    }
+
+    // The connection gets its own copy too, for the same reason as in on_new_session
+    if (nullptr != copy)
+    {
+        SSL_set_session(ssl, copy);
+        SSL_SESSION_free(copy);
+    }
+}
+
+//==============================================================================
+bool TlsSessionCache::handshake_completed(
+        SSL* ssl)
+{
+    if (1 != SSL_session_reused(ssl))
+    {
+        return false;
+    }
+
+    _resumptions.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+//==============================================================================
+void TlsSessionCache::clear()
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    _session.reset();
+}
+
+//==============================================================================
+bool TlsSessionCache::has_session() const
+{
+    const std::lock_guard<std::mutex> lock(_mutex);
+    return static_cast<bool>(_session);
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
@@ -0,0 +1,191 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__TLSOPTIONS_HPP_
+#define _WEBSOCKET_IS_SH__SRC__TLSOPTIONS_HPP_
+
+#include <boost/asio/ssl.hpp>
+
+#include <yaml-cpp/yaml.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @brief Settings of the TLS contexts, beyond their certificates, which are mostly
+ *        about resuming the sessions instead of doing a full handshake every time.
+ */
+struct TlsOptions
+{
+    /**
+     * Lowest and highest protocol versions, from "1.0" to "1.3".
+     * If empty, those of the context are kept.
+     */
+    std::string min_version;
+    std::string max_version;
+
+    /**
+     * OpenSSL cipher list for TLS 1.2 and below, and cipher suites for TLS 1.3.
+     * If empty, those of OpenSSL are kept.
+     */
+    std::string ciphers;
+    std::string ciphersuites;
+
+    /**
+     * Sessions kept by a server for their clients to resume them, and for how long.
+     * A size of zero disables the cache.
+     */
+    std::size_t session_cache_size = 20480;
+    std::chrono::seconds session_timeout{300};
+
+    /**
+     * Whether session tickets are issued by a server, or resumed by a client.
+     */
+    bool session_tickets = true;
+
+    /**
+     * File with the 80 bytes of the keys which encrypt the session tickets: 16 for their name,
+     * 32 for the HMAC secret and 32 for the AES key. Servers behind a load balancer which share
+     * it resume the sessions started by any of them. If empty, each server draws its own keys.
+     */
+    std::string ticket_key_file;
+
+    /**
+     * A server only resumes the sessions started with the same context, up to 32 bytes.
+     */
+    std::string session_id_context = "is-websocket";
+
+    /**
+     * Whether a client offers to resume its last session when it reconnects.
+     */
+    bool resume_sessions = true;
+};
+
+enum class TlsRole
+{
+    CLIENT,
+    SERVER
+};
+
+/**
+ * @brief Parses the `tls` node of the configuration. Missing settings keep their value.
+ *
+ * @param[out] error Why the settings are not valid, if they are not.
+ *
+ * @returns `true` if every setting is valid.
+ */
+bool parse_tls_options(
+        const YAML::Node& tls_node,
+        TlsOptions& options,
+        std::string& error);
+
+/**
+ * @brief Applies the settings to a context, before any connection uses it.
+ *
+ * @param[out] error Why the settings could not be applied, if they could not.
+ *
+ * @returns `true` if every setting was applied.
+ */
+bool apply_tls_options(
+        boost::asio::ssl::context& context,
+        const TlsOptions& options,
+        TlsRole role,
+        std::string& error);
+
+/**
+ * @class TlsSessionCache
+ * @brief Keeps the last session a client context was given by the server, so that the
+ *        next connection resumes it instead of doing a full handshake.
+ * @details Sessions are taken as the context receives them, which for TLS 1.3 is after the
+ *          handshake. The cache must outlive the connections of the context it is attached to.
+ */
+class TlsSessionCache
+{
+public:
+
+    TlsSessionCache();
+
+    ~TlsSessionCache();
+
+    TlsSessionCache(
+            const TlsSessionCache&) = delete;
+
+    TlsSessionCache& operator =(
+            const TlsSessionCache&) = delete;
+
+    /**
+     * @brief Starts keeping the sessions received by a client context.
+     */
+    void attach(
+            boost::asio::ssl::context& context);
+
+    /**
+     * @brief Offers the last session, if any, to a connection about to do its handshake.
+     */
+    void prepare(
+            SSL* ssl) const;
+
+    /**
+     * @brief Accounts for a completed handshake.
+     *
+     * @returns `true` if it resumed the session.
+     */
+    bool handshake_completed(
+            SSL* ssl);
+
+    /**
+     * @brief Forgets the last session, so that the next handshake is a full one.
+     */
+    void clear();
+
+    bool has_session() const;
+
+    /**
+     * @brief Number of handshakes which resumed a session.
+     */
+    std::size_t resumptions() const
+    {
+        return _resumptions.load(std::memory_order_relaxed);
+    }
+
+private:
+
+    static int on_new_session(
+            SSL* ssl,
+            SSL_SESSION* session);
+
+    mutable std::mutex _mutex;
+    std::shared_ptr<SSL_SESSION> _session;
+    std::atomic<std::size_t> _resumptions{0};
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__TLSOPTIONS_HPP_
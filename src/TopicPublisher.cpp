@@ -20,6 +20,9 @@
 
 #include <is/core/runtime/StringTemplate.hpp>
 
+#include <chrono>
+#include <unordered_map>
+
 namespace eprosima {
 namespace is {
 namespace sh {
@@ -83,6 +86,7 @@ public:
         , _message_type(message_type)
         , _id(id)
         , _config(configuration)
+        , _idle_timeout(std::chrono::milliseconds(configuration[YamlIdleTimeoutKey].as<uint32_t>(0)))
         , _endpoint(endpoint)
     {
         // Do nothing
@@ -92,24 +96,60 @@ public:
             const xtypes::DynamicData& message)
     {
         const std::string topic = _string_template.compute_string(message);
-        const bool inserted = _advertised_topics.insert(topic).second;
+        const auto now = std::chrono::steady_clock::now();
+        const auto inserted = _advertised_topics.emplace(topic, now);
 
-        if (inserted)
+        if (inserted.second)
         {
             _endpoint.startup_advertisement(topic, *_message_type, _id, _config);
             _endpoint.runtime_advertisement(topic, *_message_type, _id, _config);
         }
+        else
+        {
+            inserted.first->second = now;
+        }
+
+        if (_idle_timeout.count() > 0 && now - _last_sweep >= _idle_timeout)
+        {
+            retract_idle_topics(now);
+        }
 
         return _endpoint.publish(topic, message);
     }
 
 private:
 
+    /**
+     * @brief Stop advertising the topics without publications for longer than the idle timeout to the
+     *        new connections. They are advertised again once they get another publication.
+     */
+    void retract_idle_topics(
+            std::chrono::steady_clock::time_point now)
+    {
+        _last_sweep = now;
+        for (auto it = _advertised_topics.begin(); it != _advertised_topics.end();)
+        {
+            if (now - it->second >= _idle_timeout)
+            {
+                _endpoint.startup_retraction(it->first);
+                it = _advertised_topics.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
     const is::core::StringTemplate _string_template;
     const xtypes::DynamicType::Ptr _message_type;
     const std::string _id;
     const YAML::Node _config;
-    std::unordered_set<std::string> _advertised_topics;
+    const std::chrono::milliseconds _idle_timeout;
+
+    // The topics computed so far, along with the time of their last publication
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> _advertised_topics;
+    std::chrono::steady_clock::time_point _last_sweep;
     Endpoint& _endpoint;
 
 };
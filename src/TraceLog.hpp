@@ -0,0 +1,45 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#ifndef _WEBSOCKET_IS_SH__SRC__TRACELOG_HPP_
+#define _WEBSOCKET_IS_SH__SRC__TRACELOG_HPP_
+
+/**
+ * The traces of the hot paths, such as every message sent or received along with its payload,
+ * are only built when they are enabled at runtime, and disappear from the build altogether
+ * if `IS_WEBSOCKET_TRACE` is defined to 0.
+ */
+#ifndef IS_WEBSOCKET_TRACE
+#define IS_WEBSOCKET_TRACE 1
+#endif // ifndef IS_WEBSOCKET_TRACE
+
+/**
+ * @brief Starts a log entry which is only evaluated if the trace is enabled. It is used as
+ *        the logger itself: `WEBSOCKET_TRACE(_logger, enabled, Level::INFO) << ... << std::endl;`.
+ *        Otherwise, none of the values streamed into it is even computed.
+ *
+ * @param[in] logger The utils::Logger of the entry.
+ *
+ * @param[in] enabled Whether the trace is enabled.
+ *
+ * @param[in] level The utils::Logger::Level of the entry.
+ */
+#define WEBSOCKET_TRACE(logger, enabled, level) \
+    if (!(IS_WEBSOCKET_TRACE && (enabled))) {} else (logger) << (level)
+
+#endif //  _WEBSOCKET_IS_SH__SRC__TRACELOG_HPP_
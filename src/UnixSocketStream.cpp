@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include "UnixSocketStream.hpp"
+
+#include <boost/asio/write.hpp>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+//==============================================================================
+UnixSocketStream::UnixSocketStream(
+        boost::asio::io_service& io_service)
+    : _socket(io_service)
+    , _strand(io_service)
+    , _timer(io_service)
+{
+}
+
+//==============================================================================
+void UnixSocketStream::start(
+        ReadHandler on_read,
+        CloseHandler on_close,
+        std::chrono::milliseconds handshake_timeout)
+{
+    const auto self = shared_from_this();
+    _strand.dispatch([self, on_read = std::move(on_read), on_close = std::move(on_close), handshake_timeout]()
+            {
+                self->_on_read = std::move(on_read);
+                self->_on_close = std::move(on_close);
+                self->arm_timer(handshake_timeout);
+                self->read();
+            });
+}
+
+//==============================================================================
+void UnixSocketStream::opened(
+        std::chrono::milliseconds idle_timeout)
+{
+    const auto self = shared_from_this();
+    _strand.dispatch([self, idle_timeout]()
+            {
+                self->_idle_timeout = idle_timeout;
+                self->arm_timer(idle_timeout);
+            });
+}
+
+//==============================================================================
+void UnixSocketStream::write(
+        std::string data)
+{
+    _pending_bytes += data.size();
+
+    // Posted rather than dispatched, as the writers may be in the middle of a read handler
+    const auto self = shared_from_this();
+    _strand.post([self, data = std::move(data)]() mutable
+            {
+                if (self->_closed)
+                {
+                    self->_pending_bytes -= data.size();
+                    return;
+                }
+
+                self->_writes.push_back(std::move(data));
+                if (!self->_writing)
+                {
+                    self->write_next();
+                }
+            });
+}
+
+//==============================================================================
+void UnixSocketStream::close()
+{
+    const auto self = shared_from_this();
+    _strand.post([self]()
+            {
+                self->close_now(boost::asio::error::operation_aborted);
+            });
+}
+
+//==============================================================================
+void UnixSocketStream::read()
+{
+    const auto self = shared_from_this();
+    _socket.async_read_some(
+        boost::asio::buffer(_read_buffer),
+        _strand.wrap([self](const boost::system::error_code& ec, std::size_t size)
+        {
+            if (self->_closed)
+            {
+                return;
+            }
+
+            if (ec)
+            {
+                self->close_now(ec);
+                return;
+            }
+
+            self->arm_timer(self->_idle_timeout);
+            self->_on_read(self->_read_buffer.data(), size);
+            if (!self->_closed)
+            {
+                self->read();
+            }
+        }));
+}
+
+//==============================================================================
+void UnixSocketStream::write_next()
+{
+    _writing = true;
+
+    const auto self = shared_from_this();
+    boost::asio::async_write(
+        _socket,
+        boost::asio::buffer(_writes.front()),
+        _strand.wrap([self](const boost::system::error_code& ec, std::size_t /*size*/)
+        {
+            self->_pending_bytes -= self->_writes.front().size();
+            self->_writes.pop_front();
+            self->_writing = false;
+
+            if (self->_closed)
+            {
+                return;
+            }
+
+            if (ec)
+            {
+                self->close_now(ec);
+                return;
+            }
+
+            self->arm_timer(self->_idle_timeout);
+            if (!self->_writes.empty())
+            {
+                self->write_next();
+            }
+        }));
+}
+
+//==============================================================================
+void UnixSocketStream::arm_timer(
+        std::chrono::milliseconds timeout)
+{
+    // A wait which has already expired cannot be cancelled anymore, so its handler is told
+    // apart by the generation it was armed for
+    ++_timer_generation;
+
+    boost::system::error_code ignored;
+    if (timeout.count() <= 0)
+    {
+        _timer.cancel(ignored);
+        return;
+    }
+
+    _timer.expires_from_now(timeout, ignored);
+
+    const auto self = shared_from_this();
+    const unsigned int generation = _timer_generation;
+    _timer.async_wait(_strand.wrap([self, generation](const boost::system::error_code& ec)
+            {
+                if (!ec && !self->_closed && generation == self->_timer_generation)
+                {
+                    self->close_now(boost::asio::error::timed_out);
+                }
+            }));
+}
+
+//==============================================================================
+void UnixSocketStream::close_now(
+        const boost::system::error_code& ec)
+{
+    if (_closed)
+    {
+        return;
+    }
+
+    _closed = true;
+
+    boost::system::error_code ignored;
+    _timer.cancel(ignored);
+    _socket.shutdown(Socket::shutdown_both, ignored);
+    _socket.close(ignored);
+
+    // The bytes that were never written do not count anymore
+    std::size_t unwritten = 0;
+    for (std::size_t i = _writing ? 1 : 0; i < _writes.size(); ++i)
+    {
+        unwritten += _writes[i].size();
+    }
+    _writes.erase(_writes.begin() + (_writing ? 1 : 0), _writes.end());
+    _pending_bytes -= unwritten;
+
+    // The handlers hold the connection, which holds this stream through its own handlers
+    const CloseHandler on_close = std::move(_on_close);
+    _on_read = nullptr;
+    _on_close = nullptr;
+    if (on_close)
+    {
+        on_close(ec);
+    }
+}
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
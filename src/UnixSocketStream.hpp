@@ -0,0 +1,149 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#ifndef _WEBSOCKET_IS_SH__SRC__UNIXSOCKETSTREAM_HPP_
+#define _WEBSOCKET_IS_SH__SRC__UNIXSOCKETSTREAM_HPP_
+
+#include <boost/asio/io_service.hpp>
+#include <boost/asio/local/stream_protocol.hpp>
+#include <boost/asio/steady_timer.hpp>
+#include <boost/asio/strand.hpp>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <string>
+
+namespace eprosima {
+namespace is {
+namespace sh {
+namespace websocket {
+
+/**
+ * @class UnixSocketStream
+ * @brief Byte stream of a connection accepted on a Unix domain socket, which feeds the *websocketpp*
+ *        iostream transport.
+ * @details Every operation on the socket runs on a strand, so that writes from any thread never
+ *          overlap with the pending read. Writes are queued and return right away; the bytes they
+ *          still have to write are reported by pending_bytes(), which lets the send queue of the
+ *          connection apply its limits. The iostream transport has no timers, so the stream closes
+ *          itself if the handshake takes too long, or once it has been idle for too long.
+ */
+class UnixSocketStream : public std::enable_shared_from_this<UnixSocketStream>
+{
+public:
+
+    using Socket = boost::asio::local::stream_protocol::socket;
+
+    // Called from the strand with the bytes read.
+    using ReadHandler = std::function<void(const char* data, std::size_t size)>;
+
+    // Called from the strand once the stream is closed, with `eof` if the peer closed it,
+    // `timed_out` if a timeout expired, or `operation_aborted` if close() was called.
+    using CloseHandler = std::function<void(const boost::system::error_code& ec)>;
+
+    UnixSocketStream(
+            boost::asio::io_service& io_service);
+
+    /**
+     * @brief Get the socket, which the connection is accepted into.
+     */
+    Socket& socket()
+    {
+        return _socket;
+    }
+
+    /**
+     * @brief Start reading from the socket.
+     *
+     * @param[in] handshake_timeout Time given to the peer to complete its handshake, after which
+     *            the stream is closed unless opened() is called. Zero disables it.
+     */
+    void start(
+            ReadHandler on_read,
+            CloseHandler on_close,
+            std::chrono::milliseconds handshake_timeout);
+
+    /**
+     * @brief Notify that the handshake has been completed, which stops its timeout.
+     *
+     * @param[in] idle_timeout Time without any byte read or written after which the stream is
+     *            closed. Zero disables it.
+     */
+    void opened(
+            std::chrono::milliseconds idle_timeout);
+
+    /**
+     * @brief Queue some bytes to be written. May be called from any thread.
+     */
+    void write(
+            std::string data);
+
+    /**
+     * @brief Close the socket. May be called from any thread.
+     */
+    void close();
+
+    /**
+     * @brief Get the amount of bytes queued but not written yet.
+     */
+    std::size_t pending_bytes() const
+    {
+        return _pending_bytes;
+    }
+
+private:
+
+    void read();
+
+    void write_next();
+
+    void arm_timer(
+            std::chrono::milliseconds timeout);
+
+    void close_now(
+            const boost::system::error_code& ec);
+
+    Socket _socket;
+    boost::asio::io_service::strand _strand;
+    boost::asio::steady_timer _timer;
+
+    // Everything below is only used from the strand, except for _pending_bytes
+    std::array<char, 65536> _read_buffer;
+    std::deque<std::string> _writes;
+    bool _writing = false;
+    bool _closed = false;
+    std::chrono::milliseconds _idle_timeout{0};
+    unsigned int _timer_generation = 0;
+    std::atomic<std::size_t> _pending_bytes{0};
+
+    ReadHandler _on_read;
+    CloseHandler _on_close;
+};
+
+} //  namespace websocket
+} //  namespace sh
+} //  namespace is
+} //  namespace eprosima
+
+#endif //  _WEBSOCKET_IS_SH__SRC__UNIXSOCKETSTREAM_HPP_
@@ -16,13 +16,27 @@
  *
  */
 
+#include "DynamicDataPool.hpp"
 #include "Encoding.hpp"
 #include "Endpoint.hpp"
+#include "Fragmentation.hpp"
+#include "JsonReader.hpp"
+#include "JsonWriter.hpp"
 
 #include <is/json-xtypes/conversion.hpp>
 #include <is/json-xtypes/json.hpp>
 
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace eprosima {
 namespace is {
@@ -47,6 +61,13 @@ const std::string JsonServiceKey = "service";
 const std::string JsonArgsKey = "args";
 const std::string JsonValuesKey = "values";
 const std::string JsonResultKey = "result";
+const std::string JsonThrottleRateKey = "throttle_rate";
+const std::string JsonQueueLengthKey = "queue_length";
+const std::string JsonFragmentSizeKey = "fragment_size";
+const std::string JsonDataKey = "data";
+const std::string JsonNumKey = "num";
+const std::string JsonTotalKey = "total";
+const std::string JsonMsgsKey = "msgs";
 
 
 // op codes
@@ -59,6 +80,8 @@ const std::string JsonOpServiceRequestKey = "call_service";
 const std::string JsonOpAdvertiseServiceKey = "advertise_service";
 const std::string JsonOpUnadvertiseServiceKey = "unadvertise_service";
 const std::string JsonOpServiceResponseKey = "service_response";
+const std::string JsonOpFragmentKey = "fragment";
+const std::string JsonOpBatchKey = "batch";
 
 // idl of ROSBRIDGE PROTOCOL messages
 const std::string idl_messages =
@@ -201,6 +224,22 @@ static void throw_missing_key(
            << op_code << "' is missing the required field '" << key << "'" << std::endl;
 }
 
+//==============================================================================
+/**
+ * @brief Text of a field. Strings are copied straight from the document, and any other
+ *        value, such as a numeric id, is given in its *JSON* form.
+ */
+static std::string string_value(
+        const Json& value)
+{
+    if (value.is_string())
+    {
+        return value.get_ref<const std::string&>();
+    }
+
+    return value.dump();
+}
+
 //==============================================================================
 static std::string get_optional_string(
         const Json& object,
@@ -214,15 +253,24 @@ static std::string get_optional_string(
     }
     else
     {
-        std::string temp_str = it.value().dump();
-        if (temp_str.find("\"") == 0)
-        {
-            return temp_str.substr(1, temp_str.size() - 2);
-        }
-        return temp_str;
+        return string_value(it.value());
     }
 }
 
+//==============================================================================
+static uint32_t get_optional_uint(
+        const Json& object,
+        const std::string& key)
+{
+    const auto it = object.find(key);
+    if (it == object.end() || !it->is_number() || it->get<double>() < 0)
+    {
+        return 0;
+    }
+
+    return it->get<uint32_t>();
+}
+
 //==============================================================================
 static std::string get_required_string(
         const Json& object,
@@ -235,12 +283,7 @@ static std::string get_required_string(
         return std::string();
     }
 
-    std::string temp_str = it.value().dump();
-    if (temp_str.find("\"") == 0)
-    {
-        return temp_str.substr(1, temp_str.size() - 2);
-    }
-    return temp_str;
+    return string_value(it.value());
 }
 
 //==============================================================================
@@ -296,28 +339,61 @@ public:
     }
 
     void interpret_websocket_msg(
-            const std::string& msg_str,
+            std::string_view msg_str,
             Endpoint& endpoint,
             std::shared_ptr<void> connection_handle) const override
     {
+        interpret(msg_str, endpoint, std::move(connection_handle), false);
+    }
+
+    /**
+     * @brief Interprets a raw message, which may be one of the messages of a batch.
+     */
+    void interpret(
+            std::string_view msg_str,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle,
+            bool in_batch) const
+    {
+        // The binary formats are always deserialized into a JSON document
+        if (!binary() && interpret_on_demand(msg_str, endpoint, connection_handle, in_batch))
+        {
+            return;
+        }
+
         Json msg;
         try
         {
-            msg = Json::parse(msg_str);
+            msg = deserialize(msg_str);
         }
         catch (const Json::exception& e)
         {
             logger << utils::Logger::Level::ERROR
-                   << "Failed to parse raw received WebSocket message as a JSON: [[ "
-                   << msg_str << " ]]" << std::endl;
+                   << "Failed to parse raw received WebSocket message as a " << name() << ": [[ "
+                   << (binary() ? std::string("<binary>") : std::string(msg_str)) << " ]], reason: [[ "
+                   << e.what() << " ]]" << std::endl;
             return;
         }
 
+        interpret_json(msg, endpoint, std::move(connection_handle), in_batch);
+    }
+
+    /**
+     * @brief Interprets a message already parsed into a *JSON* document.
+     *
+     * @param[in] in_batch Whether the message comes within a batch, which cannot hold further batches.
+     */
+    void interpret_json(
+            const Json& msg,
+            Endpoint& endpoint,
+            std::shared_ptr<void> connection_handle,
+            bool in_batch) const
+    {
         const auto op_it = msg.find(JsonOpKey);
         if (op_it == msg.end())
         {
             logger << utils::Logger::Level::ERROR
-                   << "Incoming message [[ " << msg_str << " ]] was missing the required 'op' code"
+                   << "Incoming message [[ " << msg.dump() << " ]] was missing the required 'op' code"
                    << std::endl;
             return;
         }
@@ -326,10 +402,13 @@ public:
 
         xtypes::DynamicType::Ptr type_ptr;
 
-        auto type_it = types_.find(op_str);
-        if (type_it != types_.end())
         {
-            type_ptr = type_it->second;
+            const std::lock_guard<std::mutex> lock(types_mutex_);
+            auto type_it = types_.find(op_str);
+            if (type_it != types_.end())
+            {
+                type_ptr = type_it->second;
+            }
         }
 
         // Publish is the most likely type of message to be received, so we'll check
@@ -372,6 +451,7 @@ public:
                     service_name,
                     dest_data,
                     get_optional_string(msg, JsonIdKey),
+                    get_optional_uint(msg, JsonFragmentSizeKey),
                     std::move(connection_handle));
             }
             return;
@@ -433,10 +513,16 @@ public:
                 return;
             }
 
+            SubscribeOptions options;
+            options.throttle_rate = get_optional_uint(msg, JsonThrottleRateKey);
+            options.queue_length = get_optional_uint(msg, JsonQueueLengthKey);
+            options.fragment_size = get_optional_uint(msg, JsonFragmentSizeKey);
+
             endpoint.receive_subscribe_request_ws(
                 get_required_string(msg, JsonTopicNameKey),
                 topic_type,
                 get_optional_string(msg, JsonIdKey),
+                options,
                 std::move(connection_handle));
             return;
         }
@@ -465,6 +551,7 @@ public:
                 *reply_type,
                 std::move(connection_handle));
 
+            const std::lock_guard<std::mutex> lock(types_mutex_);
             types_by_service_[get_required_string(msg, JsonServiceKey)] =
                     std::pair<std::string, std::string>(
                 transform_type(get_required_string(msg, JsonRequestTypeNameKey)),
@@ -487,16 +574,161 @@ public:
             return;
         }
 
+        if (op_str == JsonOpFragmentKey)
+        {
+            const auto data_it = msg.find(JsonDataKey);
+            if (data_it == msg.end() || !data_it->is_string())
+            {
+                throw_missing_key(msg, JsonDataKey);
+                return;
+            }
+
+            endpoint.receive_fragment_ws(
+                get_required_string(msg, JsonIdKey),
+                data_it->get_ref<const std::string&>(),
+                get_optional_uint(msg, JsonNumKey),
+                get_optional_uint(msg, JsonTotalKey),
+                std::move(connection_handle));
+            return;
+        }
+
+        if (op_str == JsonOpBatchKey)
+        {
+            const auto msgs_it = msg.find(JsonMsgsKey);
+            if (msgs_it == msg.end() || !msgs_it->is_array())
+            {
+                throw_missing_key(msg, JsonMsgsKey);
+                return;
+            }
+
+            if (in_batch)
+            {
+                logger << utils::Logger::Level::ERROR
+                       << "Ignoring a batch nested within another batch" << std::endl;
+                return;
+            }
+
+            for (const Json& element : *msgs_it)
+            {
+                interpret_json(element, endpoint, connection_handle, true);
+            }
+            return;
+        }
+
         logger << utils::Logger::Level::ERROR
                << "Unrecognized operation: '" << op_str << "'" << std::endl;
     }
 
+    std::vector<std::string> encode_fragment_msgs(
+            const std::string& message,
+            const std::string& id,
+            std::size_t fragment_size) const override
+    {
+        // Fragments carry slices of the message as text, which binary messages cannot be split into
+        std::vector<std::string> output;
+        if (binary() || 0 == fragment_size || message.size() <= fragment_size)
+        {
+            return output;
+        }
+
+        const std::vector<std::string_view> fragments = split_into_fragments(message, fragment_size);
+        output.reserve(fragments.size());
+
+        std::string prefix = "{\"" + JsonOpKey + "\":\"" + JsonOpFragmentKey + "\",\"" + JsonIdKey + "\":";
+        JsonWriter::write_string(id, prefix);
+        prefix += ",\"" + JsonTotalKey + "\":" + std::to_string(fragments.size()) + ",\"" + JsonNumKey + "\":";
+
+        for (std::size_t num = 0; num < fragments.size(); ++num)
+        {
+            std::string fragment;
+            fragment.reserve(prefix.size() + fragments[num].size() + 32);
+            fragment += prefix;
+            fragment += std::to_string(num);
+            fragment += ",\"" + JsonDataKey + "\":";
+            JsonWriter::write_string(fragments[num], fragment);
+            fragment += '}';
+            output.push_back(std::move(fragment));
+        }
+
+        return output;
+    }
+
+    std::string encode_batch_msg(
+            const std::vector<std::string>& messages) const override
+    {
+        if (binary())
+        {
+            // Binary messages cannot be spliced, so they are decoded back into a single document
+            Json batch;
+            batch[JsonOpKey] = JsonOpBatchKey;
+            Json& msgs = batch[JsonMsgsKey] = Json::array();
+            for (const std::string& message : messages)
+            {
+                msgs.push_back(deserialize(message));
+            }
+            return serialize(batch);
+        }
+
+        std::size_t size = 32;
+        for (const std::string& message : messages)
+        {
+            size += message.size() + 1;
+        }
+
+        std::string output;
+        output.reserve(size);
+        output += "{\"" + JsonOpKey + "\":\"" + JsonOpBatchKey + "\",\"" + JsonMsgsKey + "\":[";
+        for (std::size_t i = 0; i < messages.size(); ++i)
+        {
+            if (i > 0)
+            {
+                output += ',';
+            }
+            output += messages[i];
+        }
+        output += "]}";
+        return output;
+    }
+
     std::string encode_publication_msg(
             const std::string& topic_name,
             const std::string& topic_type,
             const std::string& id,
             const xtypes::DynamicData& msg) const override
     {
+        return encode_publication_msg(InvalidTopicId, topic_name, topic_type, id, msg);
+    }
+
+    TopicId register_topic(
+            const std::string& topic_name,
+            const std::string& topic_type) const override
+    {
+        const std::lock_guard<std::mutex> lock(types_mutex_);
+        return intern_topic(topic_name, topic_type);
+    }
+
+    std::string encode_publication_msg(
+            TopicId topic,
+            const std::string& topic_name,
+            const std::string& topic_type,
+            const std::string& id,
+            const xtypes::DynamicData& msg) const override
+    {
+        if (InvalidTopicId == topic)
+        {
+            topic = register_topic(topic_name, topic_type);
+        }
+
+        // The binary formats are always serialized from the JSON document
+        if (!binary())
+        {
+            std::string output;
+            if (write_publication_msg(topic, id, msg, output))
+            {
+                return output;
+            }
+        }
+
         try
         {
             Json output;
@@ -508,15 +740,13 @@ public:
                 output[JsonIdKey] = id;
             }
 
-            types_by_topic_[topic_name] = transform_type(topic_type);
-
-            return output.dump();
+            return serialize(output);
         }
         catch (const json_xtypes::UnsupportedType& unsupported)
         {
             logger << utils::Logger::Level::ERROR
                    << "Failed to encode publication message for topic '" << topic_name
-                   << "' because its type '" << topic_type << "' is unsupported,"
+                   << "' because its type '" << msg.type().name() << "' is unsupported,"
                    << " reason: [[ " << unsupported.what() << " ]]" << std::endl;
 
             return std::string();
@@ -525,7 +755,7 @@ public:
         {
             logger << utils::Logger::Level::ERROR
                    << "Failed to encode publication message for topic '" << topic_name
-                   << "' with type '" << topic_type << "' because conversion from xTypes"
+                   << "' with type '" << msg.type().name() << "' because conversion from xTypes"
                    << " to JSON failed. Details: [[ " << exception.what() << " ]]" << std::endl;
 
             return std::string();
@@ -551,6 +781,7 @@ public:
                 output[JsonIdKey] = id;
             }
 
+            const std::lock_guard<std::mutex> lock(types_mutex_);
             auto it = types_by_service_.find(service_name);
             if (it != types_by_service_.end())
             {
@@ -563,7 +794,7 @@ public:
                     "", transform_type(service_type));
             }
 
-            return output.dump();
+            return serialize(output);
         }
         catch (const json_xtypes::UnsupportedType& unsupported)
         {
@@ -589,10 +820,10 @@ public:
             const std::string& topic_name,
             const std::string& message_type,
             const std::string& id,
-            const YAML::Node& /*configuration*/) const override
+            const YAML::Node& configuration) const override
     {
         // TODO(MXG): Consider parsing the `configuration` for details like
-        // throttle_rate, queue_length, fragment_size, and compression
+        // fragment_size, and compression
         Json output;
         output[JsonOpKey] = JsonOpSubscribeKey;
         output[JsonTopicNameKey] = topic_name;
@@ -602,9 +833,34 @@ public:
             output[JsonIdKey] = id;
         }
 
-        types_by_topic_[topic_name] = transform_type(message_type);
+        // Let the remote endpoint throttle the topic, if requested
+        for (const std::string& key : {JsonThrottleRateKey, JsonQueueLengthKey})
+        {
+            if (const YAML::Node node = configuration[key])
+            {
+                output[key] = node.as<uint32_t>(0);
+            }
+        }
 
-        return output.dump();
+        const std::lock_guard<std::mutex> lock(types_mutex_);
+        intern_topic(topic_name, message_type);
+
+        return serialize(output);
+    }
+
+    std::string encode_unsubscribe_msg(
+            const std::string& topic_name,
+            const std::string& id) const override
+    {
+        Json output;
+        output[JsonOpKey] = JsonOpUnsubscribeKey;
+        output[JsonTopicNameKey] = topic_name;
+        if (!id.empty())
+        {
+            output[JsonIdKey] = id;
+        }
+
+        return serialize(output);
     }
 
     std::string encode_advertise_msg(
@@ -622,9 +878,10 @@ public:
             output[JsonIdKey] = id;
         }
 
-        types_by_topic_[topic_name] = transform_type(message_type);
+        const std::lock_guard<std::mutex> lock(types_mutex_);
+        intern_topic(topic_name, message_type);
 
-        return output.dump();
+        return serialize(output);
     }
 
     std::string encode_call_service_msg(
@@ -647,6 +904,7 @@ public:
                 output[JsonIdKey] = id;
             }
 
+            const std::lock_guard<std::mutex> lock(types_mutex_);
             auto it = types_by_service_.find(service_name);
             if (it != types_by_service_.end())
             {
@@ -659,7 +917,7 @@ public:
                     transform_type(service_type), "");
             }
 
-            return output.dump();
+            return serialize(output);
         }
         catch (const json_xtypes::UnsupportedType& unsupported)
         {
@@ -694,10 +952,11 @@ public:
         output[JsonReplyTypeNameKey] = transform_type(reply_type);
         output[JsonServiceKey] = service_name;
 
+        const std::lock_guard<std::mutex> lock(types_mutex_);
         types_by_service_[service_name] = std::pair<std::string, std::string>(transform_type(
                             request_type), transform_type(reply_type));
 
-        return output.dump();
+        return serialize(output);
     }
 
     const xtypes::DynamicType* get_type(
@@ -711,19 +970,22 @@ public:
             return nullptr;
         }
 
-        auto type_it = types_.find(transform_type(type_name));
-        if (type_it != types_.end())
+        // Types are never removed, so the one found stays valid once the lock is released
+        const std::string transformed_type_name = transform_type(type_name);
+        const xtypes::DynamicType* type = nullptr;
         {
-            return type_it->second.get();
+            const std::lock_guard<std::mutex> lock(types_mutex_);
+            type = find_type(transformed_type_name);
         }
-        else
+
+        if (nullptr == type)
         {
             logger << utils::Logger::Level::ERROR
                    << "Incoming message refers to an unregistered type: '"
                    << type_name << "'" << std::endl;
-
-            return nullptr;
         }
+
+        return type;
     }
 
     bool add_type(
@@ -731,20 +993,54 @@ public:
             const std::string& type_name) override
     {
         std::string name = transform_type(type_name.empty() ? type.name() : type_name);
+
+        // Messages may be parsed by the server threads while the types are still being added
+        const std::lock_guard<std::mutex> lock(types_mutex_);
         auto result = types_.emplace(name, type);
         return result.second;
     }
 
     const xtypes::DynamicType* get_type_by_topic(
-            const std::string& topic_name) const
+            std::string_view topic_name) const
     {
-        return get_type(types_by_topic_[topic_name]);
+        std::string type_name;
+        {
+            const std::lock_guard<std::mutex> lock(types_mutex_);
+            auto it = topic_ids_.find(topic_name);
+            if (it != topic_ids_.end())
+            {
+                TopicEntry& entry = topic_table_[it->second];
+                if (nullptr == entry.type && !entry.type_name.empty())
+                {
+                    // The type may have been registered after the topic
+                    entry.type = find_type(entry.type_name);
+                }
+
+                if (nullptr != entry.type)
+                {
+                    return entry.type;
+                }
+
+                type_name = entry.type_name;
+            }
+        }
+
+        // Reports why the type is missing
+        return get_type(type_name);
     }
 
     const xtypes::DynamicType* get_req_type_from_service(
-            const std::string& service_name) const
+            std::string_view service_name) const
     {
-        std::string req_type = types_by_service_[service_name].first;
+        std::string req_type;
+        {
+            const std::lock_guard<std::mutex> lock(types_mutex_);
+            auto it = types_by_service_.find(service_name);
+            if (it != types_by_service_.end())
+            {
+                req_type = it->second.first;
+            }
+        }
         if (req_type.empty())
         {
             logger << utils::Logger::Level::ERROR
@@ -756,9 +1052,17 @@ public:
     }
 
     const xtypes::DynamicType* get_rep_type_from_service(
-            const std::string& service_name) const
+            std::string_view service_name) const
     {
-        std::string rep_type = types_by_service_[service_name].second;
+        std::string rep_type;
+        {
+            const std::lock_guard<std::mutex> lock(types_mutex_);
+            auto it = types_by_service_.find(service_name);
+            if (it != types_by_service_.end())
+            {
+                rep_type = it->second.second;
+            }
+        }
         if (rep_type.empty())
         {
             logger << utils::Logger::Level::ERROR
@@ -771,9 +1075,421 @@ public:
 
 protected:
 
+    /**
+     * @brief Interprets the most frequent messages, namely publications, service requests and
+     *        service responses, as well as the batches of them, without parsing them into a *JSON* document.
+     *
+     * @returns `true` if the message has been handled, or `false` if it must be interpreted
+     *          from its *JSON* document; that is the case for any other operation, for types
+     *          not supported by the JsonReader, and for malformed messages, so that they get
+     *          reported exactly as before.
+     */
+    bool interpret_on_demand(
+            std::string_view msg_str,
+            Endpoint& endpoint,
+            std::shared_ptr<void>& connection_handle,
+            bool in_batch) const
+    {
+        JsonReader::Envelope envelope;
+        if (!JsonReader::scan_envelope(msg_str, envelope))
+        {
+            return false;
+        }
+
+        if (envelope.op == JsonOpPublishKey)
+        {
+            if (envelope.topic.empty() || envelope.msg.empty())
+            {
+                return false;
+            }
+
+            const xtypes::DynamicType* dest_type = get_type_by_topic(envelope.topic);
+            if (nullptr == dest_type)
+            {
+                return true;
+            }
+
+            DynamicDataPool::Handle dest_data;
+            if (!read_on_demand(envelope.msg, *dest_type, dest_data))
+            {
+                return false;
+            }
+
+            endpoint.receive_publication_ws(
+                envelope.topic,
+                *dest_data,
+                std::move(connection_handle));
+            return true;
+        }
+
+        if (envelope.op == JsonOpServiceRequestKey)
+        {
+            if (envelope.service.empty() || envelope.args.empty())
+            {
+                return false;
+            }
+
+            const xtypes::DynamicType* dest_type = get_req_type_from_service(envelope.service);
+            if (nullptr == dest_type)
+            {
+                return true;
+            }
+
+            DynamicDataPool::Handle dest_data;
+            if (!read_on_demand(envelope.args, *dest_type, dest_data))
+            {
+                return false;
+            }
+
+            uint32_t fragment_size = 0;
+            if (!envelope.fragment_size.empty())
+            {
+                const char* const end = envelope.fragment_size.data() + envelope.fragment_size.size();
+                if (std::from_chars(envelope.fragment_size.data(), end, fragment_size).ptr != end)
+                {
+                    return false;
+                }
+            }
+
+            endpoint.receive_service_request_ws(
+                envelope.service,
+                *dest_data,
+                envelope.id,
+                fragment_size,
+                std::move(connection_handle));
+            return true;
+        }
+
+        if (envelope.op == JsonOpServiceResponseKey)
+        {
+            if (envelope.service.empty() || envelope.values.empty())
+            {
+                return false;
+            }
+
+            const xtypes::DynamicType* dest_type = get_rep_type_from_service(envelope.service);
+            if (nullptr == dest_type)
+            {
+                return true;
+            }
+
+            DynamicDataPool::Handle dest_data;
+            if (!read_on_demand(envelope.values, *dest_type, dest_data))
+            {
+                return false;
+            }
+
+            endpoint.receive_service_response_ws(
+                envelope.service,
+                *dest_data,
+                envelope.id,
+                std::move(connection_handle));
+            return true;
+        }
+
+        if (envelope.op == JsonOpBatchKey)
+        {
+            // Nested and malformed batches are reported from the JSON document
+            std::vector<std::string_view> elements;
+            if (in_batch || !JsonReader::split_array(envelope.msgs, elements))
+            {
+                return false;
+            }
+
+            for (const std::string_view element : elements)
+            {
+                interpret(element, endpoint, connection_handle, true);
+            }
+            return true;
+        }
+
+        return false;
+    }
+
+    /**
+     * @brief Reads a payload into an instance taken from the pool of its type, which is given back
+     *        once the handle is destroyed, after the message has been delivered.
+     * @details A recycled instance is only used if the payload has overwritten every value in it;
+     *          otherwise the payload is read again into a new instance, so that the members absent
+     *          from the payload keep their default value, as when it is converted by *is-json-xtypes*.
+     */
+    bool read_on_demand(
+            std::string_view json,
+            const xtypes::DynamicType& dest_type,
+            DynamicDataPool::Handle& dest_data) const
+    {
+        if (!JsonWriter::supports(dest_type))
+        {
+            return false;
+        }
+
+        DynamicDataPool& pool = data_pool(dest_type);
+        dest_data = pool.acquire();
+
+        bool complete = false;
+        if (JsonReader::read(json, *dest_data, &complete) && (complete || !dest_data.recycled()))
+        {
+            return true;
+        }
+        else if (!dest_data.recycled())
+        {
+            return false;
+        }
+
+        dest_data = pool.create();
+        return JsonReader::read(json, *dest_data);
+    }
+
+    DynamicDataPool& data_pool(
+            const xtypes::DynamicType& type) const
+    {
+        const std::lock_guard<std::mutex> lock(types_mutex_);
+        std::unique_ptr<DynamicDataPool>& pool = data_pools_[&type];
+        if (!pool)
+        {
+            pool = std::make_unique<DynamicDataPool>(type);
+        }
+        return *pool;
+    }
+
+    /**
+     * @brief Writes a publication message straight into a text buffer, using the JsonWriter.
+     *
+     * @returns `true` if the message was written, or `false` if its type is not supported
+     *          by the JsonWriter and hence the message must be converted by *is-json-xtypes*.
+     */
+    bool write_publication_msg(
+            TopicId topic,
+            const std::string& id,
+            const xtypes::DynamicData& msg,
+            std::string& output) const
+    {
+        PublicationFormat* format = nullptr;
+        {
+            const std::lock_guard<std::mutex> lock(types_mutex_);
+            format = &topic_table_[topic].format;
+            if (format->type_name != msg.type().name())
+            {
+                format->type_name = msg.type().name();
+                format->streamable = JsonWriter::supports(msg.type());
+            }
+
+            if (!format->streamable)
+            {
+                return false;
+            }
+
+            // Messages of a topic tend to have similar sizes, so the last one is a good guess
+            output.reserve(std::max(format->last_size.load(std::memory_order_relaxed), format->prefix.size()));
+            output += format->prefix;
+        }
+
+        JsonWriter::write(msg, output);
+        if (!id.empty())
+        {
+            output += ",\"" + JsonIdKey + "\":";
+            JsonWriter::write_string(id, output);
+        }
+        output += '}';
+
+        format->last_size.store(output.size(), std::memory_order_relaxed);
+        return true;
+    }
+
+    /**
+     * @brief Finds the entry of a topic, creating it if needed, and updates its type.
+     *        The types_mutex_ must be locked.
+     */
+    TopicId intern_topic(
+            const std::string& topic_name,
+            const std::string& topic_type) const
+    {
+        auto it = topic_ids_.find(topic_name);
+        if (it == topic_ids_.end())
+        {
+            it = topic_ids_.emplace(topic_name, static_cast<TopicId>(topic_table_.size())).first;
+
+            PublicationFormat& format = topic_table_.emplace_back().format;
+            format.prefix = "{\"" + JsonOpKey + "\":\"" + JsonOpPublishKey + "\",\"" + JsonTopicNameKey + "\":";
+            JsonWriter::write_string(topic_name, format.prefix);
+            format.prefix += ",\"" + JsonMsgKey + "\":";
+        }
+
+        TopicEntry& entry = topic_table_[it->second];
+        if (entry.source_type_name != topic_type)
+        {
+            entry.source_type_name = topic_type;
+            entry.type_name = transform_type(topic_type);
+            entry.type = find_type(entry.type_name);
+        }
+
+        return it->second;
+    }
+
+    /**
+     * @brief Looks up a registered type, without reporting it if it has not been registered.
+     *        The types_mutex_ must be locked.
+     */
+    const xtypes::DynamicType* find_type(
+            const std::string& transformed_type_name) const
+    {
+        auto type_it = types_.find(transformed_type_name);
+        return type_it != types_.end() ? type_it->second.get() : nullptr;
+    }
+
+    /**
+     * @brief Name of the format, used for logging purposes.
+     */
+    virtual const char* name() const
+    {
+        return "JSON";
+    }
+
+    /**
+     * @brief Serializes an already built message into the raw *WebSocket* payload.
+     */
+    virtual std::string serialize(
+            const Json& output) const
+    {
+        return output.dump();
+    }
+
+    /**
+     * @brief Parses a raw *WebSocket* payload.
+     *
+     * @throws Json::exception if the payload is not well formed.
+     */
+    virtual Json deserialize(
+            std::string_view msg_str) const
+    {
+        return Json::parse(msg_str.begin(), msg_str.end());
+    }
+
     std::map<std::string, xtypes::DynamicType::Ptr> types_;
-    mutable std::map<std::string, std::string> types_by_topic_;
-    mutable std::map<std::string, std::pair<std::string, std::string> > types_by_service_;
+    // Transparent comparators let the views of an incoming message be looked up without copies
+    mutable std::map<std::string, std::pair<std::string, std::string>, std::less<> > types_by_service_;
+
+    /**
+     * @brief Pre-rendered publication envelope of a topic: `{"op":"publish","topic":"<topic>","msg":`.
+     */
+    struct PublicationFormat
+    {
+        std::string type_name;
+        std::string prefix;
+        bool streamable = false;
+        std::atomic<size_t> last_size{0};
+    };
+
+    /**
+     * @brief Metadata of a topic, interned when it is subscribed to or advertised.
+     */
+    struct TopicEntry
+    {
+        std::string source_type_name;
+        // Already transformed, see transform_type()
+        std::string type_name;
+        const xtypes::DynamicType* type = nullptr;
+        PublicationFormat format;
+    };
+
+    // Indexed by TopicId. Entries are never erased, so they can be used out of the lock once found
+    mutable std::deque<TopicEntry> topic_table_;
+    mutable std::map<std::string, TopicId, std::less<> > topic_ids_;
+    // Keyed by the registered types, which live as long as the encoding. Never erased either.
+    mutable std::map<const xtypes::DynamicType*, std::unique_ptr<DynamicDataPool> > data_pools_;
+    // The encoding is shared by every io_service thread of the endpoint.
+    mutable std::mutex types_mutex_;
+
+};
+
+//==============================================================================
+/**
+ * @brief Checks whether a raw payload is a *JSON* object in text form.
+ * @details Following rosbridge, clients requesting a binary format may still send
+ *          their own operations as plain *JSON* text.
+ */
+static bool is_json_text(
+        std::string_view msg_str)
+{
+    const std::size_t first = msg_str.find_first_not_of(" \t\r\n");
+    return first != std::string_view::npos && msg_str[first] == '{';
+}
+
+//==============================================================================
+/**
+ * @brief Encoding implementation for message exchanging using
+ * <a href="https://www.rfc-editor.org/rfc/rfc8949.html">CBOR</a> binary format.
+ * @details The messages have the very same structure as in JsonEncoding,
+ *          but they are sent using *WebSocket* binary frames.
+ */
+class CborEncoding : public JsonEncoding
+{
+public:
+
+    bool binary() const override
+    {
+        return true;
+    }
+
+protected:
+
+    const char* name() const override
+    {
+        return "CBOR";
+    }
+
+    std::string serialize(
+            const Json& output) const override
+    {
+        const std::vector<std::uint8_t> bytes = Json::to_cbor(output);
+        return std::string(bytes.begin(), bytes.end());
+    }
+
+    Json deserialize(
+            std::string_view msg_str) const override
+    {
+        return is_json_text(msg_str) ? Json::parse(msg_str.begin(), msg_str.end()) :
+               Json::from_cbor(msg_str.begin(), msg_str.end());
+    }
+
+};
+
+//==============================================================================
+/**
+ * @brief Encoding implementation for message exchanging using
+ * <a href="https://msgpack.org/">MessagePack</a> binary format.
+ * @details The messages have the very same structure as in JsonEncoding,
+ *          but they are sent using *WebSocket* binary frames.
+ */
+class MsgPackEncoding : public JsonEncoding
+{
+public:
+
+    bool binary() const override
+    {
+        return true;
+    }
+
+protected:
+
+    const char* name() const override
+    {
+        return "MessagePack";
+    }
+
+    std::string serialize(
+            const Json& output) const override
+    {
+        const std::vector<std::uint8_t> bytes = Json::to_msgpack(output);
+        return std::string(bytes.begin(), bytes.end());
+    }
+
+    Json deserialize(
+            std::string_view msg_str) const override
+    {
+        return is_json_text(msg_str) ? Json::parse(msg_str.begin(), msg_str.end()) :
+               Json::from_msgpack(msg_str.begin(), msg_str.end());
+    }
 
 };
 
@@ -783,6 +1499,18 @@ EncodingPtr make_json_encoding()
     return std::make_shared<JsonEncoding>();
 }
 
+//==============================================================================
+EncodingPtr make_cbor_encoding()
+{
+    return std::make_shared<CborEncoding>();
+}
+
+//==============================================================================
+EncodingPtr make_msgpack_encoding()
+{
+    return std::make_shared<MsgPackEncoding>();
+}
+
 } //  namespace websocket
 } //  namespace sh
 } //  namespace is
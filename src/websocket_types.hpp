@@ -20,16 +20,34 @@
 #define _WEBSOCKET_IS_SH__SRC__WEBSOCKET_TYPES_HPP_
 
 #include <websocketpp/config/asio.hpp>
+#include <websocketpp/config/core.hpp>
+#include <websocketpp/extensions/permessage_deflate/enabled.hpp>
 #include <websocketpp/server.hpp>
 #include <websocketpp/client.hpp>
 
+#include <cstddef>
+#include <limits>
+
 namespace eprosima {
 namespace is {
 namespace sh {
 namespace websocket {
 
-using TlsConfig = websocketpp::config::asio_tls;
-using TcpConfig = websocketpp::config::asio;
+/**
+ * @brief Stock *websocketpp* configuration, with the permessage-deflate extension enabled,
+ *        so that it gets negotiated with the peers that offer it.
+ * @details Only the messages flagged as compressed through `set_compressed()` are deflated.
+ */
+template<typename BaseConfig>
+struct DeflateConfig : public BaseConfig
+{
+    using type = DeflateConfig<BaseConfig>;
+    using permessage_deflate_type = websocketpp::extensions::permessage_deflate::enabled<
+        typename BaseConfig::permessage_deflate_config>;
+};
+
+using TlsConfig = DeflateConfig<websocketpp::config::asio_tls>;
+using TcpConfig = DeflateConfig<websocketpp::config::asio>;
 using TlsConnection = websocketpp::connection<TlsConfig>;
 using TcpConnection = websocketpp::connection<TcpConfig>;
 
@@ -48,11 +66,48 @@ using TcpMessagePtr = TcpEndpoint::message_ptr;
 using TlsConnectionPtr = TlsEndpoint::connection_ptr;
 using TcpConnectionPtr = TcpEndpoint::connection_ptr;
 
+using TlsMessage = TlsConfig::message_type;
+using TcpMessage = TcpConfig::message_type;
+
+/**
+ * @brief Connections accepted through a Unix domain socket. Their bytes are moved by the server
+ *        itself through the iostream transport, which has no sockets nor timers of its own.
+ */
+using UnixConfig = DeflateConfig<websocketpp::config::core>;
+using UnixConnection = websocketpp::connection<UnixConfig>;
+using UnixServer = websocketpp::server<UnixConfig>;
+using UnixEndpoint = websocketpp::endpoint<UnixConnection, UnixConfig>;
+using UnixConnectionPtr = UnixEndpoint::connection_ptr;
+
 using SslContext = boost::asio::ssl::context;
 using SslContextPtr = std::shared_ptr<SslContext>;
 
 using ErrorCode = websocketpp::lib::error_code;
 
+/**
+ * @brief Compression threshold of the messages which are never compressed.
+ */
+constexpr std::size_t NeverCompress = std::numeric_limits<std::size_t>::max();
+
+/**
+ * @brief Wrap an already encoded payload into a message buffer that can be shared,
+ *        without copying nor re-encoding it, among every connection it is sent to.
+ *
+ * @param[in] payload The encoded payload. It is moved into the message buffer.
+ *
+ * @param[in] opcode The *WebSocket* frame opcode to be used.
+ *
+ * @returns A message pointer suitable for the TLS, TCP and Unix socket connections.
+ */
+inline TlsMessagePtr make_message(
+        std::string payload,
+        websocketpp::frame::opcode::value opcode = websocketpp::frame::opcode::text)
+{
+    auto message = std::make_shared<TlsMessage>(TlsMessage::con_msg_man_ptr(), opcode, 0);
+    message->get_raw_payload() = std::move(payload);
+    return message;
+}
+
 } //  namespace websocket
 } //  namespace sh
 } //  namespace is
@@ -0,0 +1,644 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+/**
+ * Throughput and latency benchmarks of the WebSocket System Handle.
+ *
+ * The end-to-end scenarios run a real `websocket_server` and one or more `websocket_client`
+ * instances over the loopback interface, with the mock System Handle publishing on the server
+ * side and receiving on the client side. They sweep the message size, the publication rate,
+ * the number of subscribers and the number of topics. The micro-benchmarks measure the
+ * encodings and the JWT verification on their own.
+ *
+ * Usage: is-websocket-bench [--quick] [--transport tcp|tls|both] [--messages N]
+ *                           [--micro-only] [--no-micro]
+ */
+
+#include <Encoding.hpp>
+#include <Endpoint.hpp>
+#include <JwtValidator.hpp>
+
+#include <is/sh/mock/api.hpp>
+#include <is/core/Instance.hpp>
+#include <is/utils/Log.hpp>
+
+#include <yaml-cpp/yaml.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace is = eprosima::is;
+namespace xtypes = eprosima::xtypes;
+namespace websocket = eprosima::is::sh::websocket;
+
+static is::utils::Logger logger("is::sh::WebSocket::bench");
+
+//==============================================================================
+// Every allocation of the process is accounted for, so that the scenarios can
+// tell how many bytes it takes to deliver a message, both sides included.
+static std::atomic<uint64_t> allocated_bytes{0};
+
+void* operator new(
+        std::size_t size)
+{
+    allocated_bytes.fetch_add(size, std::memory_order_relaxed);
+    if (void* ptr = std::malloc(size > 0 ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(
+        void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(
+        void* ptr,
+        std::size_t /*size*/) noexcept
+{
+    std::free(ptr);
+}
+
+//==============================================================================
+// { user: "soss-websocket-test" } signed with secret "soss-websocket-test"
+const std::string BenchToken =
+        "eyJhbGciOiJIUzI1NiIsInR5cCI6IkpXVCJ9.eyJ1c2VyIjoic29zcy13ZWJzb2NrZXQtdGVzdCIsImlhdCI6MTU1NDc5ODg4N30."
+        "c7XzL8ytDezkXTuniNi1YEYXOpKj0_Tj2gm0BLn4c4o";
+const std::string BenchSecret = "soss-websocket-test";
+const std::string BenchIdl = "struct BenchMessage { unsigned long long stamp; string payload; };";
+const std::string CertsDir = WEBSOCKET__BENCH__CERTS_DIR;
+
+const std::chrono::seconds ConnectTimeout(10);
+const std::chrono::seconds DrainTimeout(30);
+
+//==============================================================================
+static int64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//==============================================================================
+static double percentile(
+        const std::vector<int64_t>& sorted,
+        double quantile)
+{
+    if (sorted.empty())
+    {
+        return 0.0;
+    }
+
+    const std::size_t index = std::min(
+        sorted.size() - 1, static_cast<std::size_t>(quantile * static_cast<double>(sorted.size())));
+    return static_cast<double>(sorted[index]) / 1e3;
+}
+
+//==============================================================================
+struct Scenario
+{
+    bool tls;
+    std::size_t message_size;
+
+    // Publications per second, or zero to publish as fast as possible
+    uint32_t rate;
+    uint32_t subscribers;
+    uint32_t topics;
+};
+
+struct Options
+{
+    bool quick = false;
+    bool tcp = true;
+    bool tls = true;
+    bool micro = true;
+    bool end_to_end = true;
+    std::size_t messages = 20000;
+};
+
+//==============================================================================
+/**
+ * Gathers what the subscriptions of a scenario receive. It is shared with the
+ * subscription callbacks, which may still be called once the scenario is over.
+ */
+struct Collector
+{
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<int64_t> latencies;
+    std::size_t warmup_received = 0;
+    std::size_t received = 0;
+
+    void receive(
+            const xtypes::DynamicData& message)
+    {
+        const int64_t arrival = now_ns();
+        const uint64_t stamp = message["stamp"].value<uint64_t>();
+
+        const std::lock_guard<std::mutex> lock(mutex);
+        if (0 == stamp)
+        {
+            ++warmup_received;
+        }
+        else
+        {
+            latencies.push_back(arrival - static_cast<int64_t>(stamp));
+            ++received;
+        }
+        cv.notify_all();
+    }
+};
+
+//==============================================================================
+static std::string topic_name(
+        const std::string& prefix,
+        uint32_t topic)
+{
+    return prefix + "_" + std::to_string(topic);
+}
+
+//==============================================================================
+static std::string server_config(
+        const Scenario& scenario,
+        uint16_t port,
+        const std::string& prefix)
+{
+    std::ostringstream config;
+    config << "types: { idls: [ \"" << BenchIdl << "\" ] }\n"
+           << "systems:\n"
+           << "  ws_server: { type: websocket_server, port: " << port << ", ";
+    if (scenario.tls)
+    {
+        config << "cert: " << CertsDir << "/websocket_test.crt, key: " << CertsDir << "/websocket_test.key, ";
+    }
+    else
+    {
+        config << "security: none, ";
+    }
+    config << "authentication: { policies: [ { secret: " << BenchSecret << ", algo: HS256 } ] } }\n"
+           << "  mock: { type: mock, types-from: ws_server }\n"
+           << "routes:\n"
+           << "  mock_to_server: { from: mock, to: ws_server }\n"
+           << "topics:\n";
+    for (uint32_t i = 0; i < scenario.topics; ++i)
+    {
+        config << "  " << topic_name(prefix, i) << ": { type: BenchMessage, route: mock_to_server }\n";
+    }
+    return config.str();
+}
+
+//==============================================================================
+static std::string client_config(
+        const Scenario& scenario,
+        uint16_t port,
+        const std::string& prefix)
+{
+    std::ostringstream config;
+    config << "types: { idls: [ \"" << BenchIdl << "\" ] }\n"
+           << "systems:\n"
+           << "  ws_client: { type: websocket_client, host: localhost, port: " << port << ", ";
+    if (scenario.tls)
+    {
+        config << "cert_authorities: [ " << CertsDir << "/test_authority.ca.crt ], ";
+    }
+    else
+    {
+        config << "security: none, ";
+    }
+    config << "authentication: { token: " << BenchToken << " } }\n"
+           << "  mock: { type: mock, types-from: ws_client }\n"
+           << "routes:\n"
+           << "  client_to_mock: { from: ws_client, to: mock }\n"
+           << "topics:\n";
+    for (uint32_t i = 0; i < scenario.topics; ++i)
+    {
+        config << "  " << topic_name(prefix, i) << ": { type: BenchMessage, route: client_to_mock }\n";
+    }
+    return config.str();
+}
+
+//==============================================================================
+static bool run_scenario(
+        const Scenario& scenario,
+        std::size_t messages,
+        uint16_t port,
+        const std::string& prefix)
+{
+    is::core::InstanceHandle server = is::run_instance(YAML::Load(server_config(scenario, port, prefix)));
+    if (!server)
+    {
+        logger << is::utils::Logger::Level::ERROR << "Could not start the server" << std::endl;
+        return false;
+    }
+
+    std::vector<is::core::InstanceHandle> clients;
+    for (uint32_t i = 0; i < scenario.subscribers; ++i)
+    {
+        clients.push_back(is::run_instance(YAML::Load(client_config(scenario, port, prefix))));
+        if (!clients.back())
+        {
+            logger << is::utils::Logger::Level::ERROR << "Could not start client " << i << std::endl;
+            return false;
+        }
+    }
+
+    const auto collector = std::make_shared<Collector>();
+    collector->latencies.reserve(messages * scenario.subscribers);
+    for (uint32_t i = 0; i < scenario.topics; ++i)
+    {
+        is::sh::mock::subscribe(
+            topic_name(prefix, i),
+            [collector](const xtypes::DynamicData& message)
+            {
+                collector->receive(message);
+            });
+    }
+
+    xtypes::DynamicData message(*server.type_registry("mock")->at("BenchMessage"));
+    message["payload"] = std::string(scenario.message_size, 'x');
+
+    // Publish until a round of publications reaches every subscriber on every topic,
+    // which means that every client is connected and subscribed
+    const std::size_t expected_warmup = static_cast<std::size_t>(scenario.subscribers) * scenario.topics;
+    const auto connect_deadline = std::chrono::steady_clock::now() + ConnectTimeout;
+    bool connected = false;
+    while (!connected && std::chrono::steady_clock::now() < connect_deadline)
+    {
+        {
+            const std::lock_guard<std::mutex> lock(collector->mutex);
+            collector->warmup_received = 0;
+        }
+
+        message["stamp"] = uint64_t(0);
+        for (uint32_t i = 0; i < scenario.topics; ++i)
+        {
+            is::sh::mock::publish_message(topic_name(prefix, i), message);
+        }
+
+        std::unique_lock<std::mutex> lock(collector->mutex);
+        connected = collector->cv.wait_for(lock, std::chrono::milliseconds(200), [&]()
+                        {
+                            return collector->warmup_received >= expected_warmup;
+                        });
+    }
+
+    if (!connected)
+    {
+        logger << is::utils::Logger::Level::ERROR << "The clients did not connect in time" << std::endl;
+        return false;
+    }
+
+    // Let the last warmup publications go by
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+    const uint64_t allocated_before = allocated_bytes.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < messages; ++i)
+    {
+        if (scenario.rate > 0)
+        {
+            std::this_thread::sleep_until(start + i * std::chrono::nanoseconds(1000000000 / scenario.rate));
+        }
+
+        message["stamp"] = static_cast<uint64_t>(now_ns());
+        is::sh::mock::publish_message(topic_name(prefix, static_cast<uint32_t>(i % scenario.topics)), message);
+    }
+
+    const std::size_t expected = messages * scenario.subscribers;
+    std::vector<int64_t> latencies;
+    std::size_t received = 0;
+    {
+        std::unique_lock<std::mutex> lock(collector->mutex);
+        collector->cv.wait_for(lock, DrainTimeout, [&]()
+                    {
+                        return collector->received >= expected;
+                    });
+        received = collector->received;
+        latencies = collector->latencies;
+    }
+    const double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t allocated = allocated_bytes.load(std::memory_order_relaxed) - allocated_before;
+
+    std::sort(latencies.begin(), latencies.end());
+    std::printf("%-4s %8zu %8u %5u %6u | %12.0f %10.1f %10.1f %10.1f %12.0f %8.2f%%\n",
+            scenario.tls ? "tls" : "tcp",
+            scenario.message_size,
+            scenario.rate,
+            scenario.subscribers,
+            scenario.topics,
+            elapsed > 0 ? static_cast<double>(received) / elapsed : 0.0,
+            percentile(latencies, 0.5),
+            percentile(latencies, 0.99),
+            percentile(latencies, 0.999),
+            received > 0 ? static_cast<double>(allocated) / static_cast<double>(received) : 0.0,
+            received < expected ?
+            100.0 * static_cast<double>(expected - received) / static_cast<double>(expected) : 0.0);
+    std::fflush(stdout);
+
+    for (is::core::InstanceHandle& client : clients)
+    {
+        client.quit().wait();
+    }
+    server.quit().wait();
+
+    return true;
+}
+
+//==============================================================================
+static void run_end_to_end(
+        const Options& options)
+{
+    const std::vector<std::size_t> sizes = options.quick ?
+            std::vector<std::size_t>{64, 16384} : std::vector<std::size_t>{64, 1024, 16384, 262144};
+    const std::vector<uint32_t> rates = options.quick ?
+            std::vector<uint32_t>{0} : std::vector<uint32_t>{0, 1000, 10000};
+    const std::vector<uint32_t> subscribers = options.quick ?
+            std::vector<uint32_t>{1, 4} : std::vector<uint32_t>{1, 4, 16};
+    const std::vector<uint32_t> topics = options.quick ?
+            std::vector<uint32_t>{1} : std::vector<uint32_t>{1, 8};
+
+    std::vector<bool> transports;
+    if (options.tcp)
+    {
+        transports.push_back(false);
+    }
+    if (options.tls)
+    {
+        transports.push_back(true);
+    }
+
+    std::printf("\n%-4s %8s %8s %5s %6s | %12s %10s %10s %10s %12s %9s\n",
+            "", "size", "rate", "subs", "topics", "msgs/s", "p50 us", "p99 us", "p999 us", "bytes/msg", "lost");
+
+    // Every scenario uses a port and topics of its own, so that none of them
+    // is disturbed by the connections and the subscriptions of the previous one
+    uint16_t port = 23100;
+    std::size_t index = 0;
+    for (const bool tls : transports)
+    {
+        for (const std::size_t size : sizes)
+        {
+            for (const uint32_t rate : rates)
+            {
+                for (const uint32_t subscriber_count : subscribers)
+                {
+                    for (const uint32_t topic_count : topics)
+                    {
+                        const Scenario scenario{tls, size, rate, subscriber_count, topic_count};
+
+                        // Big messages at an unbounded rate would take too long otherwise
+                        const std::size_t messages = std::max<std::size_t>(
+                            100, std::min(options.messages, (std::size_t(256) << 20) / (size + 1)));
+
+                        run_scenario(scenario, messages, port++, "bench_" + std::to_string(index++));
+                    }
+                }
+            }
+        }
+    }
+}
+
+//==============================================================================
+/**
+ * Endpoint without connections, which receives the messages interpreted by its
+ * encoding, so that decoding can be measured along with the publication delivery.
+ */
+class BenchEndpoint : public websocket::Endpoint
+{
+public:
+
+    BenchEndpoint()
+        : Endpoint("is::sh::WebSocket::bench")
+    {
+    }
+
+    using Endpoint::get_encoding;
+
+    bool okay() const override
+    {
+        return true;
+    }
+
+    bool spin_once() override
+    {
+        return true;
+    }
+
+    void runtime_advertisement(
+            const std::string& /*topic*/,
+            const xtypes::DynamicType& /*message_type*/,
+            const std::string& /*id*/,
+            const YAML::Node& /*configuration*/) override
+    {
+    }
+
+private:
+
+    websocket::TlsEndpoint* configure_tls_endpoint(
+            const is::core::RequiredTypes& /*types*/,
+            const YAML::Node& /*configuration*/) override
+    {
+        return nullptr;
+    }
+
+    websocket::TcpEndpoint* configure_tcp_endpoint(
+            const is::core::RequiredTypes& /*types*/,
+            const YAML::Node& /*configuration*/) override
+    {
+        // Never initialized, as nothing is sent
+        return &_server;
+    }
+
+    websocket::TcpServer _server;
+};
+
+//==============================================================================
+template<typename Operation>
+static void measure(
+        const std::string& name,
+        std::size_t iterations,
+        Operation operation)
+{
+    // Warm up the caches and the lazily built state
+    for (std::size_t i = 0; i < std::min<std::size_t>(iterations / 10 + 1, 1000); ++i)
+    {
+        operation();
+    }
+
+    const uint64_t allocated_before = allocated_bytes.load(std::memory_order_relaxed);
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < iterations; ++i)
+    {
+        operation();
+    }
+    const double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    const uint64_t allocated = allocated_bytes.load(std::memory_order_relaxed) - allocated_before;
+
+    std::printf("%-36s %12.0f %12.0f %12.0f\n",
+            name.c_str(),
+            elapsed / static_cast<double>(iterations),
+            1e9 * static_cast<double>(iterations) / elapsed,
+            static_cast<double>(allocated) / static_cast<double>(iterations));
+    std::fflush(stdout);
+}
+
+//==============================================================================
+static void run_micro(
+        const Options& options)
+{
+    std::printf("\n%-36s %12s %12s %12s\n", "", "ns/op", "ops/s", "bytes/op");
+
+    xtypes::StructType type("BenchMessage");
+    type.add_member("stamp", xtypes::primitive_type<uint64_t>());
+    type.add_member("payload", xtypes::StringType());
+
+    const std::size_t iterations = options.quick ? 2000 : 20000;
+    const std::vector<std::pair<std::string, std::string>> encodings = {
+        {"json", "json"}, {"cbor", "cbor"}, {"msgpack", "msgpack"}};
+
+    for (const auto& [name, encoding_name] : encodings)
+    {
+        BenchEndpoint endpoint;
+        is::TypeRegistry type_registry;
+        if (!endpoint.configure(
+                    is::core::RequiredTypes(),
+                    YAML::Load("{ security: none, encoding: " + encoding_name + " }"),
+                    type_registry))
+        {
+            logger << is::utils::Logger::Level::ERROR
+                   << "Could not configure the " << name << " encoding" << std::endl;
+            continue;
+        }
+
+        std::size_t delivered = 0;
+        is::TopicSubscriberSystem::SubscriptionCallback callback =
+                [&delivered](const xtypes::DynamicData& /*message*/, void* /*filter_handle*/)
+                {
+                    ++delivered;
+                };
+        endpoint.subscribe("bench", type, &callback, YAML::Node());
+
+        const websocket::Encoding& encoding = endpoint.get_encoding();
+        const websocket::TopicId topic_id = encoding.register_topic("bench", type.name());
+
+        for (const std::size_t size : {std::size_t(64), std::size_t(16384)})
+        {
+            xtypes::DynamicData message(type);
+            message["stamp"] = uint64_t(1);
+            message["payload"] = std::string(size, 'x');
+
+            measure(name + " encode " + std::to_string(size) + " B", iterations, [&]()
+                    {
+                        encoding.encode_publication_msg(topic_id, "bench", type.name(), "", message);
+                    });
+
+            const std::string payload = encoding.encode_publication_msg(topic_id, "bench", type.name(), "", message);
+            measure(name + " decode " + std::to_string(size) + " B", iterations, [&]()
+                    {
+                        encoding.interpret_websocket_msg(payload, endpoint, nullptr);
+                    });
+        }
+
+        if (0 == delivered)
+        {
+            logger << is::utils::Logger::Level::ERROR
+                   << "The " << name << " decoding did not deliver any publication" << std::endl;
+        }
+    }
+
+    websocket::JwtValidator validator;
+    validator.add_verification_policy(websocket::VerificationPolicy({}, {}, BenchSecret));
+    measure("jwt verify (cached)", iterations, [&]()
+            {
+                validator.verify(BenchToken);
+            });
+
+    validator.set_cache_limits(0, std::chrono::seconds(0));
+    measure("jwt verify (uncached)", iterations, [&]()
+            {
+                validator.verify(BenchToken);
+            });
+}
+
+//==============================================================================
+int main(
+        int argc,
+        char** argv)
+{
+    Options options;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "--quick")
+        {
+            options.quick = true;
+            options.messages = 2000;
+        }
+        else if (arg == "--transport" && i + 1 < argc)
+        {
+            const std::string transport = argv[++i];
+            options.tcp = transport == "tcp" || transport == "both";
+            options.tls = transport == "tls" || transport == "both";
+        }
+        else if (arg == "--messages" && i + 1 < argc)
+        {
+            options.messages = std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (arg == "--micro-only")
+        {
+            options.end_to_end = false;
+        }
+        else if (arg == "--no-micro")
+        {
+            options.micro = false;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [--quick] [--transport tcp|tls|both] [--messages N]"
+                      << " [--micro-only] [--no-micro]" << std::endl;
+            return 1;
+        }
+    }
+
+    if (options.micro)
+    {
+        run_micro(options);
+    }
+
+    if (options.end_to_end)
+    {
+        run_end_to_end(options);
+    }
+
+    return 0;
+}
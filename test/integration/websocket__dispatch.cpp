@@ -137,6 +137,33 @@ TEST(WebSocket, Transmit_and_dispatch_messages_without_security)
     // is normal and to be expected as far as I can tell.
 }
 
+TEST(WebSocket, Transmit_and_dispatch_messages_with_a_thread_pool)
+{
+    using namespace std::chrono_literals;
+
+    is::core::InstanceHandle handle =
+            is::run_instance(WEBSOCKET__DISPATCH_THREADS__NOSECURITY__TEST_CONFIG);
+    ASSERT_TRUE(handle);
+
+    logger << is::utils::Logger::Level::INFO
+           << "Waiting to make sure the client has time to connect..." << std::endl;
+
+    std::this_thread::sleep_for(5s);
+
+    logger << is::utils::Logger::Level::INFO
+           << "Done waiting!" << std::endl;
+
+    run_test_case(handle, "dispatch_into_client", "apple", 1, "/topic");
+    run_test_case(handle, "dispatch_into_client", "banana", 2, "/topic");
+    run_test_case(handle, "dispatch_into_client", "cherry", 3, "/topic");
+
+    run_test_case(handle, "dispatch_into_server", "avocado", 10, "");
+    run_test_case(handle, "dispatch_into_server", "blueberry", 20, "");
+    run_test_case(handle, "dispatch_into_server", "citrus", 30, "");
+
+    EXPECT_EQ(handle.quit().wait(), 0);
+}
+
 int main(
         int argc,
         char** argv)
@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <Cluster.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(Cluster, Parses_the_configuration)
+{
+    ClusterOptions options;
+    std::string error;
+    ASSERT_TRUE(parse_cluster_options(YAML::Load(
+                "{ node_id: a, peers: [ 'b.local:8080', '10.0.0.3:80' ], token: abc, secret: s3cr3t, reconnect_ms: 500,"
+                "  cert_authorities: [ ca.crt ] }"),
+            options, error)) << error;
+
+    EXPECT_EQ("a", options.node_id);
+    EXPECT_EQ((std::vector<std::string>{"b.local:8080", "10.0.0.3:80"}), options.peers);
+    EXPECT_EQ("abc", options.token);
+    EXPECT_EQ("s3cr3t", options.secret);
+    EXPECT_EQ(std::chrono::milliseconds(500), options.reconnect_delay);
+    EXPECT_EQ(std::vector<std::string>{"ca.crt"}, options.cert_authorities);
+}
+
+TEST(Cluster, Rejects_invalid_settings)
+{
+    ClusterOptions options;
+    std::string error;
+    EXPECT_FALSE(parse_cluster_options(YAML::Load("{ node_id: a }"), options, error));
+
+    for (const std::string peer : {"nohost", ":80", "host:", "host:0", "host:65536", "host:8o"})
+    {
+        options = ClusterOptions();
+        EXPECT_FALSE(parse_cluster_options(YAML::Load("{ peers: [ '" + peer + "' ] }"), options, error)) << peer;
+    }
+
+    options = ClusterOptions();
+    EXPECT_FALSE(parse_cluster_options(YAML::Load("{ peers: [ 'b:80' ], reconnect_ms: 0 }"), options, error));
+    EXPECT_FALSE(parse_cluster_options(YAML::Load("{ peers: [ 'b:80' ], reconnect_ms: soon }"), options, error));
+}
+
+TEST(Cluster, Trusts_only_the_links_of_the_cluster)
+{
+    ClusterOptions options;
+    options.peers = {"b.local:8080", "10.0.0.3:80"};
+
+    // Without a secret, the node id must be one of the peers
+    EXPECT_TRUE(is_trusted_cluster_link(options, "b.local:8080", ""));
+    EXPECT_FALSE(is_trusted_cluster_link(options, "c.local:8080", ""));
+    EXPECT_FALSE(is_trusted_cluster_link(options, "", ""));
+
+    // With one, only the secret matters
+    options.secret = "s3cr3t";
+    EXPECT_TRUE(is_trusted_cluster_link(options, "c.local:8080", "s3cr3t"));
+    EXPECT_FALSE(is_trusted_cluster_link(options, "b.local:8080", ""));
+    EXPECT_FALSE(is_trusted_cluster_link(options, "b.local:8080", "s3cr3"));
+    EXPECT_FALSE(is_trusted_cluster_link(options, "b.local:8080", "s3cr3T"));
+    EXPECT_FALSE(is_trusted_cluster_link(options, "", "s3cr3t"));
+}
+
+TEST(Cluster, Announces_the_first_and_the_last_listener)
+{
+    ClusterInterest interest;
+    const auto first = std::make_shared<int>(1);
+    const auto second = std::make_shared<int>(2);
+
+    EXPECT_TRUE(interest.add_listener("chatter", first));
+    EXPECT_FALSE(interest.add_listener("chatter", second));
+    EXPECT_TRUE(interest.add_listener("status", second));
+
+    std::vector<std::string> topics = interest.topics();
+    std::sort(topics.begin(), topics.end());
+    EXPECT_EQ((std::vector<std::string>{"chatter", "status"}), topics);
+
+    EXPECT_FALSE(interest.remove_listener("chatter", first));
+    EXPECT_TRUE(interest.remove_listener("chatter", second));
+    EXPECT_FALSE(interest.remove_listener("chatter", second));
+    EXPECT_EQ(std::vector<std::string>{"status"}, interest.topics());
+}
+
+TEST(Cluster, Links_are_not_listeners)
+{
+    ClusterInterest interest;
+    const auto link = std::make_shared<int>(1);
+    const auto client = std::make_shared<int>(2);
+
+    interest.add_link(link);
+    EXPECT_TRUE(interest.is_link(link));
+    EXPECT_FALSE(interest.is_link(client));
+    EXPECT_EQ(1u, interest.links());
+
+    // The interest of the other nodes is not announced back to them
+    EXPECT_FALSE(interest.add_listener("chatter", link));
+    EXPECT_TRUE(interest.topics().empty());
+    EXPECT_TRUE(interest.add_listener("chatter", client));
+    EXPECT_FALSE(interest.remove_listener("chatter", link));
+    EXPECT_EQ(std::vector<std::string>{"chatter"}, interest.topics());
+
+    EXPECT_TRUE(interest.remove_link(link));
+    EXPECT_FALSE(interest.remove_link(link));
+    EXPECT_EQ(0u, interest.links());
+}
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <ConnectionIndex.hpp>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(ConnectionIndex, Indexes_the_names_of_each_connection)
+{
+    ConnectionIndex index;
+    const std::shared_ptr<void> a = std::make_shared<int>(1);
+    const std::shared_ptr<void> b = std::make_shared<int>(2);
+
+    EXPECT_TRUE(index.add(a, "/chatter"));
+    EXPECT_FALSE(index.add(a, "/chatter"));
+    EXPECT_TRUE(index.add(a, "/image"));
+    EXPECT_TRUE(index.add(b, "/chatter"));
+
+    EXPECT_EQ(2u, index.count(a));
+    EXPECT_EQ(1u, index.count(b));
+    EXPECT_EQ(2u, index.connections());
+
+    EXPECT_TRUE(index.remove(b, "/chatter"));
+    EXPECT_FALSE(index.remove(b, "/chatter"));
+    EXPECT_FALSE(index.remove(b, "/image"));
+    EXPECT_EQ(0u, index.count(b));
+
+    // Connections without names are dropped
+    EXPECT_EQ(1u, index.connections());
+}
+
+TEST(ConnectionIndex, Takes_every_name_of_a_connection)
+{
+    ConnectionIndex index;
+    const std::shared_ptr<void> a = std::make_shared<int>(1);
+    const std::shared_ptr<void> b = std::make_shared<int>(2);
+
+    index.add(a, "/chatter");
+    index.add(a, "/image");
+    index.add(b, "/image");
+
+    std::vector<std::string> names = index.take(a);
+    std::sort(names.begin(), names.end());
+    EXPECT_EQ((std::vector<std::string>{"/chatter", "/image"}), names);
+
+    EXPECT_EQ(0u, index.count(a));
+    EXPECT_TRUE(index.take(a).empty());
+    EXPECT_EQ(std::vector<std::string>{"/image"}, index.take(b));
+    EXPECT_EQ(0u, index.connections());
+}
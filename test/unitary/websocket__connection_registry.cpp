@@ -0,0 +1,125 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ConnectionRegistry.hpp>
+
+#include <thread>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+using FakeConnectionPtr = std::shared_ptr<int>;
+
+TEST(ConnectionRegistry, Assigns_increasing_ids)
+{
+    ConnectionRegistry<FakeConnectionPtr> registry;
+    const auto first = std::make_shared<int>(1);
+    const auto second = std::make_shared<int>(2);
+
+    EXPECT_EQ(1u, registry.add(first));
+    EXPECT_EQ(2u, registry.add(second));
+    EXPECT_EQ(1u, registry.add(first));
+    EXPECT_EQ(2u, registry.size());
+
+    EXPECT_EQ(1u, registry.id_of(first));
+    EXPECT_EQ(2u, registry.id_of(second));
+    EXPECT_EQ(0u, registry.id_of(std::make_shared<int>(3)));
+}
+
+TEST(ConnectionRegistry, Remove_returns_id)
+{
+    ConnectionRegistry<FakeConnectionPtr> registry;
+    const auto connection = std::make_shared<int>(1);
+    registry.add(connection);
+
+    uint16_t id = 0;
+    EXPECT_TRUE(registry.remove(connection, id));
+    EXPECT_EQ(1u, id);
+    EXPECT_EQ(0u, registry.size());
+
+    id = 0;
+    EXPECT_FALSE(registry.remove(connection, id));
+    EXPECT_EQ(0u, id);
+}
+
+TEST(ConnectionRegistry, Snapshot_is_not_affected_by_later_changes)
+{
+    ConnectionRegistry<FakeConnectionPtr> registry;
+    const auto first = std::make_shared<int>(1);
+    const auto second = std::make_shared<int>(2);
+    registry.add(first);
+
+    const auto snapshot = registry.snapshot();
+    registry.add(second);
+    uint16_t id = 0;
+    registry.remove(first, id);
+
+    ASSERT_EQ(1u, snapshot->size());
+    EXPECT_EQ(1u, snapshot->count(first));
+    EXPECT_EQ(1u, registry.size());
+    EXPECT_EQ(1u, registry.snapshot()->count(second));
+}
+
+TEST(ConnectionRegistry, Concurrent_readers_and_writers)
+{
+    ConnectionRegistry<FakeConnectionPtr> registry;
+    constexpr int connections_per_writer = 200;
+
+    std::vector<std::thread> writers;
+    for (int w = 0; w < 4; ++w)
+    {
+        writers.emplace_back([&registry]()
+                {
+                    for (int i = 0; i < connections_per_writer; ++i)
+                    {
+                        const auto connection = std::make_shared<int>(i);
+                        registry.add(connection);
+                        uint16_t id = 0;
+                        if (i % 2 == 0)
+                        {
+                            registry.remove(connection, id);
+                        }
+                    }
+                });
+    }
+
+    std::thread reader([&registry]()
+            {
+                for (int i = 0; i < 1000; ++i)
+                {
+                    const auto snapshot = registry.snapshot();
+                    std::size_t count = 0;
+                    for (const auto& connection : *snapshot)
+                    {
+                        (void)connection;
+                        ++count;
+                    }
+                    EXPECT_EQ(snapshot->size(), count);
+                }
+            });
+
+    for (std::thread& writer : writers)
+    {
+        writer.join();
+    }
+    reader.join();
+
+    EXPECT_EQ(4u * connections_per_writer / 2, registry.size());
+}
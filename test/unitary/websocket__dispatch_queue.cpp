@@ -0,0 +1,146 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <DispatchQueue.hpp>
+
+#include <future>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+DispatchQueue::Options make_options(
+        std::size_t capacity,
+        OverflowPolicy policy)
+{
+    DispatchQueue::Options options;
+    options.capacity = capacity;
+    options.policy = policy;
+    return options;
+}
+
+/**
+ * @brief Downstream system double, which holds the dispatch thread until it is released.
+ */
+struct SlowDownstream
+{
+    std::promise<void> started;
+    std::promise<void> release;
+    std::vector<int> delivered;
+
+    void block(
+            DispatchQueue& queue)
+    {
+        std::shared_future<void> released = release.get_future().share();
+        queue.push([this, released]()
+                {
+                    started.set_value();
+                    released.wait();
+                });
+        started.get_future().wait();
+    }
+
+    DispatchQueue::Task deliver(
+            int value)
+    {
+        return [this, value]()
+               {
+                   delivered.push_back(value);
+               };
+    }
+};
+
+TEST(DispatchQueue, Delivers_in_order)
+{
+    DispatchQueue queue(make_options(16, OverflowPolicy::DROP_OLDEST));
+
+    std::vector<int> delivered;
+    std::promise<void> finished;
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_TRUE(queue.push([&delivered, i]()
+                {
+                    delivered.push_back(i);
+                }));
+
+        while (queue.depth() >= 16)
+        {
+            std::this_thread::yield();
+        }
+    }
+    queue.push([&finished]()
+            {
+                finished.set_value();
+            });
+    finished.get_future().wait();
+
+    ASSERT_EQ(100u, delivered.size());
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_EQ(i, delivered[i]);
+    }
+    EXPECT_EQ(101u, queue.dispatched());
+    EXPECT_EQ(0u, queue.dropped());
+}
+
+TEST(DispatchQueue, Drops_oldest_deliveries)
+{
+    DispatchQueue queue(make_options(2, OverflowPolicy::DROP_OLDEST));
+    SlowDownstream downstream;
+    downstream.block(queue);
+
+    EXPECT_TRUE(queue.push(downstream.deliver(1)));
+    EXPECT_TRUE(queue.push(downstream.deliver(2)));
+    EXPECT_FALSE(queue.push(downstream.deliver(3)));
+    EXPECT_EQ(2u, queue.depth());
+    EXPECT_EQ(1u, queue.dropped());
+
+    downstream.release.set_value();
+    while (queue.dispatched() < 3)
+    {
+        std::this_thread::yield();
+    }
+
+    std::promise<void> finished;
+    EXPECT_TRUE(queue.push([&finished]()
+            {
+                finished.set_value();
+            }));
+    finished.get_future().wait();
+    EXPECT_EQ((std::vector<int>{2, 3}), downstream.delivered);
+}
+
+TEST(DispatchQueue, Drops_newest_deliveries)
+{
+    DispatchQueue queue(make_options(2, OverflowPolicy::DROP_NEWEST));
+    SlowDownstream downstream;
+    downstream.block(queue);
+
+    EXPECT_TRUE(queue.push(downstream.deliver(1)));
+    EXPECT_TRUE(queue.push(downstream.deliver(2)));
+    EXPECT_FALSE(queue.push(downstream.deliver(3)));
+    EXPECT_EQ(1u, queue.dropped());
+
+    // Dropped deliveries are never run, and stopping drops the pending ones too
+    downstream.release.set_value();
+    queue.stop();
+    EXPECT_LE(downstream.delivered.size(), 2u);
+    EXPECT_EQ(3u, queue.dropped() + downstream.delivered.size());
+    EXPECT_FALSE(queue.push(downstream.deliver(4)));
+}
@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <DynamicDataPool.hpp>
+
+using namespace eprosima::is::sh::websocket;
+namespace xtypes = eprosima::xtypes;
+
+const std::string test_idl =
+        R"(
+struct Point
+{
+    float x;
+    double y;
+    string label;
+    int32 history[3];
+};
+
+struct Path
+{
+    sequence<Point> points;
+};
+)";
+
+TEST(DynamicDataPool, Poolable_types)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+
+    EXPECT_TRUE(DynamicDataPool::poolable(*types.at("Point")));
+    EXPECT_FALSE(DynamicDataPool::poolable(*types.at("Path")));
+}
+
+TEST(DynamicDataPool, Recycles_instances)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    DynamicDataPool pool(*types.at("Point"));
+
+    const xtypes::DynamicData* first = nullptr;
+    {
+        DynamicDataPool::Handle data = pool.acquire();
+        EXPECT_FALSE(data.recycled());
+        (*data)["label"] = std::string("first");
+        first = &*data;
+    }
+    EXPECT_EQ(1u, pool.idle());
+
+    DynamicDataPool::Handle data = pool.acquire();
+    EXPECT_TRUE(data.recycled());
+    EXPECT_EQ(first, &*data);
+    EXPECT_EQ("first", (*data)["label"].value<std::string>());
+    EXPECT_EQ(0u, pool.idle());
+
+    // Newly created instances hold the default values, and are given back as well
+    DynamicDataPool::Handle fresh = pool.create();
+    EXPECT_FALSE(fresh.recycled());
+    EXPECT_EQ("", (*fresh)["label"].value<std::string>());
+    fresh = DynamicDataPool::Handle();
+    EXPECT_EQ(1u, pool.idle());
+}
+
+TEST(DynamicDataPool, Bounded_capacity)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    DynamicDataPool pool(*types.at("Point"), 2);
+
+    {
+        DynamicDataPool::Handle a = pool.acquire();
+        DynamicDataPool::Handle b = pool.acquire();
+        DynamicDataPool::Handle c = pool.acquire();
+    }
+    EXPECT_EQ(2u, pool.idle());
+}
+
+TEST(DynamicDataPool, Never_recycles_variable_layouts)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    DynamicDataPool pool(*types.at("Path"));
+
+    {
+        DynamicDataPool::Handle data = pool.acquire();
+        EXPECT_EQ(0u, (*data)["points"].size());
+    }
+    EXPECT_EQ(0u, pool.idle());
+    EXPECT_FALSE(pool.acquire().recycled());
+}
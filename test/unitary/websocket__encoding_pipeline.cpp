@@ -0,0 +1,131 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <EncodingPipeline.hpp>
+
+#include <future>
+#include <map>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+EncodingPipeline::Options make_options(
+        std::size_t threads,
+        std::size_t queue_length)
+{
+    EncodingPipeline::Options options;
+    options.threads = threads;
+    options.queue_length = queue_length;
+    return options;
+}
+
+TEST(EncodingPipeline, Keeps_order_per_key)
+{
+    std::mutex mutex;
+    std::map<std::size_t, std::vector<int>> ran;
+    {
+        EncodingPipeline pipeline(make_options(4, 10000));
+        for (int i = 0; i < 1000; ++i)
+        {
+            for (std::size_t key = 0; key < 8; ++key)
+            {
+                EXPECT_TRUE(pipeline.push(key, [&, key, i]()
+                        {
+                            const std::lock_guard<std::mutex> lock(mutex);
+                            ran[key].push_back(i);
+                        }));
+            }
+        }
+
+        // Waits for every worker to get through its tasks
+        for (std::size_t key = 0; key < 4; ++key)
+        {
+            std::promise<void> finished;
+            std::future<void> future = finished.get_future();
+            pipeline.push(key, [&finished]()
+                    {
+                        finished.set_value();
+                    });
+            future.wait();
+        }
+    }
+
+    ASSERT_EQ(8u, ran.size());
+    for (const auto& entry : ran)
+    {
+        ASSERT_EQ(1000u, entry.second.size());
+        for (int i = 0; i < 1000; ++i)
+        {
+            EXPECT_EQ(i, entry.second[i]);
+        }
+    }
+}
+
+TEST(EncodingPipeline, Drops_oldest_tasks)
+{
+    EncodingPipeline pipeline(make_options(1, 2));
+
+    // Keeps the single worker busy
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    pipeline.push(0, [&started, released]()
+            {
+                started.set_value();
+                released.wait();
+            });
+    started.get_future().wait();
+
+    std::vector<int> ran;
+    std::promise<void> finished;
+    EXPECT_TRUE(pipeline.push(0, [&ran]()
+            {
+                ran.push_back(1);
+            }));
+    EXPECT_TRUE(pipeline.push(1, [&ran]()
+            {
+                ran.push_back(2);
+            }));
+    EXPECT_FALSE(pipeline.push(0, [&ran, &finished]()
+            {
+                ran.push_back(3);
+                finished.set_value();
+            }));
+    EXPECT_EQ(2u, pipeline.pending());
+    EXPECT_EQ(1u, pipeline.dropped());
+
+    release.set_value();
+    finished.get_future().wait();
+    EXPECT_EQ((std::vector<int>{2, 3}), ran);
+}
+
+TEST(EncodingPipeline, Drops_tasks_once_stopped)
+{
+    EncodingPipeline pipeline(make_options(2, 16));
+    pipeline.stop();
+
+    bool ran = false;
+    EXPECT_FALSE(pipeline.push(0, [&ran]()
+            {
+                ran = true;
+            }));
+    EXPECT_FALSE(ran);
+    EXPECT_EQ(1u, pipeline.dropped());
+}
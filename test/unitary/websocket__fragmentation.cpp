@@ -0,0 +1,105 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <Fragmentation.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(Fragmentation, Splits_into_fragments)
+{
+    const std::string message = "0123456789";
+
+    EXPECT_EQ(std::vector<std::string_view>{message}, split_into_fragments(message, 0));
+    EXPECT_EQ(std::vector<std::string_view>{message}, split_into_fragments(message, 10));
+    EXPECT_EQ((std::vector<std::string_view>{"0123", "4567", "89"}), split_into_fragments(message, 4));
+}
+
+TEST(Fragmentation, Keeps_utf8_characters_whole)
+{
+    // "a", then the two bytes of "ñ", then the three bytes of "€"
+    const std::string message = "a\xC3\xB1\xE2\x82\xAC";
+
+    EXPECT_EQ((std::vector<std::string_view>{"a", "\xC3\xB1", "\xE2\x82\xAC"}), split_into_fragments(message, 2));
+
+    // Characters larger than the fragment size go whole
+    EXPECT_EQ((std::vector<std::string_view>{"a", "\xC3\xB1", "\xE2\x82\xAC"}), split_into_fragments(message, 1));
+}
+
+TEST(Fragmentation, Reassembles_out_of_order)
+{
+    FragmentAssembler assembler;
+    std::string message;
+
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("a", "89", 2, 3, message));
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("b", "xy", 1, 2, message));
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("a", "0123", 0, 3, message));
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("a", "0123", 0, 3, message));
+    EXPECT_EQ(2u, assembler.pending_messages());
+    EXPECT_EQ(8u, assembler.buffered_bytes());
+
+    EXPECT_EQ(FragmentAssembler::Result::COMPLETE, assembler.add("a", "4567", 1, 3, message));
+    EXPECT_EQ("0123456789", message);
+    EXPECT_EQ(1u, assembler.pending_messages());
+    EXPECT_EQ(2u, assembler.buffered_bytes());
+
+    EXPECT_EQ(FragmentAssembler::Result::COMPLETE, assembler.add("single", "whole", 0, 1, message));
+    EXPECT_EQ("whole", message);
+}
+
+TEST(Fragmentation, Rejects_invalid_fragments)
+{
+    FragmentAssembler assembler;
+    std::string message;
+
+    EXPECT_EQ(FragmentAssembler::Result::INVALID, assembler.add("a", "x", 0, 0, message));
+    EXPECT_EQ(FragmentAssembler::Result::INVALID, assembler.add("a", "x", 3, 3, message));
+
+    // The total must not change between the fragments of a message
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("a", "x", 0, 3, message));
+    EXPECT_EQ(FragmentAssembler::Result::INVALID, assembler.add("a", "y", 1, 4, message));
+    EXPECT_EQ(0u, assembler.pending_messages());
+    EXPECT_EQ(0u, assembler.buffered_bytes());
+}
+
+TEST(Fragmentation, Bounds_the_buffer)
+{
+    FragmentAssembler::Limits limits;
+    limits.max_bytes = 8;
+    limits.max_messages = 2;
+    FragmentAssembler assembler(limits);
+    std::string message;
+
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("a", "aaa", 0, 2, message));
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("b", "bbb", 0, 2, message));
+
+    // A third message evicts the oldest one
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("c", "c", 0, 2, message));
+    EXPECT_EQ(2u, assembler.pending_messages());
+    EXPECT_EQ(1u, assembler.discarded());
+    EXPECT_EQ(FragmentAssembler::Result::INCOMPLETE, assembler.add("a", "aaa", 1, 2, message));
+    EXPECT_EQ(2u, assembler.discarded());
+
+    // A message that does not fit on its own is given up
+    EXPECT_EQ(FragmentAssembler::Result::OVERFLOW, assembler.add("d", "ddddddddd", 0, 2, message));
+    EXPECT_LE(assembler.buffered_bytes(), limits.max_bytes);
+}
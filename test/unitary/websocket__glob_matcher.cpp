@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <GlobMatcher.hpp>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(GlobMatcher, Matches_literals)
+{
+    const GlobMatcher matcher("HS256");
+    EXPECT_TRUE(matcher.matches("HS256"));
+    EXPECT_FALSE(matcher.matches("HS2566"));
+    EXPECT_FALSE(matcher.matches("HS25"));
+    EXPECT_FALSE(matcher.matches(""));
+
+    // Characters which are special for regular expressions match themselves
+    EXPECT_TRUE(GlobMatcher("a.b+c").matches("a.b+c"));
+    EXPECT_FALSE(GlobMatcher("a.b").matches("axb"));
+    EXPECT_TRUE(GlobMatcher("a\\b").matches("a\\b"));
+}
+
+TEST(GlobMatcher, Matches_wildcards)
+{
+    EXPECT_TRUE(GlobMatcher("*").matches(""));
+    EXPECT_TRUE(GlobMatcher("*").matches("anything"));
+    EXPECT_TRUE(GlobMatcher("*e*").matches("test"));
+    EXPECT_FALSE(GlobMatcher("*e*").matches("toast"));
+    EXPECT_TRUE(GlobMatcher("te*").matches("test"));
+    EXPECT_FALSE(GlobMatcher("te*").matches("atest"));
+    EXPECT_TRUE(GlobMatcher("*st").matches("test"));
+    EXPECT_TRUE(GlobMatcher("a**b*c").matches("aXXbYYc"));
+    EXPECT_FALSE(GlobMatcher("a*b*c").matches("aXXcYYb"));
+
+    // The question mark matches one character or none
+    EXPECT_TRUE(GlobMatcher("?es?").matches("test"));
+    EXPECT_TRUE(GlobMatcher("?es?").matches("es"));
+    EXPECT_FALSE(GlobMatcher("?es?").matches("tests"));
+}
+
+TEST(GlobMatcher, Matches_character_classes)
+{
+    const GlobMatcher matcher("*[abt][a-z]s?");
+    EXPECT_TRUE(matcher.matches("test"));
+    EXPECT_TRUE(matcher.matches("bzs"));
+    EXPECT_FALSE(matcher.matches("cest"));
+    EXPECT_FALSE(matcher.matches("tEst"));
+
+    EXPECT_TRUE(GlobMatcher("[!0-9]x").matches("ax"));
+    EXPECT_FALSE(GlobMatcher("[^0-9]x").matches("5x"));
+    EXPECT_TRUE(GlobMatcher("[]]").matches("]"));
+
+    // Unterminated classes are literal
+    EXPECT_TRUE(GlobMatcher("a[b").matches("a[b"));
+}
+
+TEST(GlobMatcher, Matches_long_patterns)
+{
+    // Longer patterns than the inline state storage
+    std::string pattern;
+    std::string text;
+    for (int i = 0; i < 200; ++i)
+    {
+        pattern += "?x";
+        text += "x";
+    }
+    pattern += "*";
+
+    const GlobMatcher matcher(pattern);
+    EXPECT_TRUE(matcher.matches(text));
+    EXPECT_TRUE(matcher.matches(text + "yz"));
+    EXPECT_FALSE(matcher.matches(text.substr(1)));
+}
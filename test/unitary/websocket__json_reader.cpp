@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <JsonReader.hpp>
+
+#include <is/json-xtypes/conversion.hpp>
+
+using namespace eprosima::is::sh::websocket;
+namespace xtypes = eprosima::xtypes;
+namespace json_xtypes = eprosima::is::json_xtypes;
+
+const std::string test_idl =
+        R"(
+struct Point
+{
+    float x;
+    double y;
+    int64 z;
+};
+
+struct Reading
+{
+    string name;
+    boolean valid;
+    uint8 level;
+    Point origin;
+    sequence<Point> points;
+    sequence<uint8> raw;
+    double covariance[4];
+};
+)";
+
+TEST(JsonReader, Scans_envelope)
+{
+    const std::string message =
+            R"({ "op": "publish", "id" : 12, "topic":"some/topic", "msg": {"a": [1, {"b": "}"}]}, "other": null })";
+
+    JsonReader::Envelope envelope;
+    ASSERT_TRUE(JsonReader::scan_envelope(message, envelope));
+    EXPECT_EQ("publish", envelope.op);
+    EXPECT_EQ("some/topic", envelope.topic);
+    EXPECT_EQ("12", envelope.id);
+    EXPECT_EQ(R"({"a": [1, {"b": "}"}]})", envelope.msg);
+    EXPECT_TRUE(envelope.service.empty());
+    EXPECT_TRUE(envelope.args.empty());
+}
+
+TEST(JsonReader, Rejects_envelope)
+{
+    JsonReader::Envelope envelope;
+    EXPECT_FALSE(JsonReader::scan_envelope("[1, 2]", envelope));
+    EXPECT_FALSE(JsonReader::scan_envelope(R"({"op": "publish", "msg": {)", envelope));
+    EXPECT_FALSE(JsonReader::scan_envelope(R"({"op": "publish"} trailing)", envelope));
+
+    // Escaped envelope strings are left to the JSON library
+    EXPECT_FALSE(JsonReader::scan_envelope(R"({"op": "publish", "topic": "a\"b"})", envelope));
+}
+
+TEST(JsonReader, Splits_array)
+{
+    JsonReader::Envelope envelope;
+    ASSERT_TRUE(JsonReader::scan_envelope(
+                R"({"op": "batch", "msgs": [ {"op": "publish", "msg": [1, 2]} , "x,y", 3 ]})", envelope));
+
+    std::vector<std::string_view> elements;
+    ASSERT_TRUE(JsonReader::split_array(envelope.msgs, elements));
+    EXPECT_EQ((std::vector<std::string_view>{R"({"op": "publish", "msg": [1, 2]})", R"("x,y")", "3"}), elements);
+
+    EXPECT_TRUE(JsonReader::split_array(" [ ] ", elements));
+    EXPECT_TRUE(elements.empty());
+
+    EXPECT_FALSE(JsonReader::split_array("[1, 2", elements));
+    EXPECT_FALSE(JsonReader::split_array("[1,]", elements));
+    EXPECT_FALSE(JsonReader::split_array("{}", elements));
+}
+
+TEST(JsonReader, Same_data_as_conversion)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    const xtypes::DynamicType& reading = *types.at("Reading");
+
+    const std::string json = R"(
+{
+    "valid": true,
+    "name": "sensor \"front\"\né😀",
+    "level": 200,
+    "origin": { "x": 0.25, "y": 1e20, "z": -9000000000 },
+    "points": [ { "x": 1, "y": -1.5, "z": 2 }, { "z": 3, "y": 0, "x": 0 } ],
+    "raw": [ 0, 1, 255 ],
+    "covariance": [ 0.5, 1.5, 2.5, 3.5 ]
+})";
+
+    xtypes::DynamicData data(reading);
+    ASSERT_TRUE(JsonReader::read(json, data));
+
+    const xtypes::DynamicData expected = json_xtypes::convert(reading, json_xtypes::Json::parse(json));
+    EXPECT_EQ(json_xtypes::convert(expected), json_xtypes::convert(data));
+}
+
+TEST(JsonReader, Ignores_unknown_members)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    xtypes::DynamicData data(*types.at("Point"));
+
+    ASSERT_TRUE(JsonReader::read(R"({"unknown": [ {}, "x", null ], "z": 3})", data));
+    EXPECT_EQ(3, data["z"].value<int64_t>());
+    EXPECT_EQ(0.0, data["y"].value<double>());
+}
+
+TEST(JsonReader, Rejects_mismatching_data)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    const xtypes::DynamicType& reading = *types.at("Reading");
+
+    xtypes::DynamicData data(reading);
+    EXPECT_FALSE(JsonReader::read(R"({"level": -1})", data));
+
+    xtypes::DynamicData other(reading);
+    EXPECT_FALSE(JsonReader::read(R"({"covariance": [1, 2, 3, 4, 5]})", other));
+
+    xtypes::DynamicData malformed(reading);
+    EXPECT_FALSE(JsonReader::read(R"({"name": "unterminated})", malformed));
+}
+
+TEST(JsonReader, Tells_complete_data)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    xtypes::DynamicData point(*types.at("Point"));
+
+    bool complete = false;
+    ASSERT_TRUE(JsonReader::read(R"({"z": 3, "x": 1, "y": 2, "z": 4})", point, &complete));
+    EXPECT_TRUE(complete);
+
+    ASSERT_TRUE(JsonReader::read(R"({"z": 3, "z": 4, "x": 1})", point, &complete));
+    EXPECT_FALSE(complete);
+
+    const auto reading_type = types.at("Reading");
+    xtypes::DynamicData reading(*reading_type);
+    ASSERT_TRUE(JsonReader::read(R"({
+        "name": "", "valid": true, "level": 1, "origin": {"x": 0, "y": 0},
+        "points": [], "raw": [], "covariance": [1, 2, 3, 4]
+    })", reading, &complete));
+    EXPECT_FALSE(complete);
+
+    xtypes::DynamicData other(*reading_type);
+    ASSERT_TRUE(JsonReader::read(R"({"covariance": [1, 2]})", other, &complete));
+    EXPECT_FALSE(complete);
+}
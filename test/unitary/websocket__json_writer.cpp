@@ -0,0 +1,121 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <JsonWriter.hpp>
+
+#include <is/json-xtypes/conversion.hpp>
+
+using namespace eprosima::is::sh::websocket;
+namespace xtypes = eprosima::xtypes;
+namespace json_xtypes = eprosima::is::json_xtypes;
+
+const std::string test_idl =
+        R"(
+struct Point
+{
+    float x;
+    double y;
+    int64 z;
+};
+
+struct Reading
+{
+    string name;
+    boolean valid;
+    uint8 level;
+    int16 offset;
+    uint32 count;
+    Point origin;
+    sequence<Point> points;
+    sequence<uint8> raw;
+    double covariance[4];
+};
+
+struct Labelled
+{
+    char label;
+    wstring description;
+};
+)";
+
+TEST(JsonWriter, Supported_types)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+
+    EXPECT_TRUE(JsonWriter::supports(*types.at("Point")));
+    EXPECT_TRUE(JsonWriter::supports(*types.at("Reading")));
+    EXPECT_FALSE(JsonWriter::supports(*types.at("Labelled")));
+}
+
+TEST(JsonWriter, Same_json_as_conversion)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    const xtypes::DynamicType& point = *types.at("Point");
+    const xtypes::DynamicType& reading = *types.at("Reading");
+
+    xtypes::DynamicData data(reading);
+    data["name"] = std::string("sensor \"front\"\n\t\\ \x01");
+    data["valid"] = true;
+    data["level"] = static_cast<uint8_t>(200);
+    data["offset"] = static_cast<int16_t>(-12);
+    data["count"] = static_cast<uint32_t>(4000000000u);
+    data["origin"]["x"] = 0.1f;
+    data["origin"]["y"] = 1e20;
+    data["origin"]["z"] = static_cast<int64_t>(-9000000000ll);
+
+    for (int i = 0; i < 3; ++i)
+    {
+        xtypes::DynamicData p(point);
+        p["x"] = static_cast<float>(i) / 3.0f;
+        p["y"] = -static_cast<double>(i);
+        p["z"] = static_cast<int64_t>(i);
+        data["points"].push(p);
+        data["raw"].push(static_cast<uint8_t>(i));
+        data["covariance"][i] = 0.5 * i;
+    }
+
+    std::string output;
+    JsonWriter::write(data, output);
+
+    EXPECT_EQ(json_xtypes::convert(data), json_xtypes::Json::parse(output));
+}
+
+TEST(JsonWriter, Empty_collections)
+{
+    const auto types = xtypes::idl::parse(test_idl).get_all_types();
+    xtypes::DynamicData data(*types.at("Reading"));
+
+    std::string output;
+    JsonWriter::write(data, output);
+
+    const json_xtypes::Json parsed = json_xtypes::Json::parse(output);
+    EXPECT_TRUE(parsed.at("points").empty());
+    EXPECT_TRUE(parsed.at("raw").empty());
+    EXPECT_EQ(4u, parsed.at("covariance").size());
+}
+
+TEST(JsonWriter, Appends_to_buffer)
+{
+    std::string output = "{\"msg\":";
+    JsonWriter::write_string("a\"b", output);
+    output += '}';
+
+    EXPECT_EQ("{\"msg\":\"a\\\"b\"}", output);
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <Metrics.hpp>
+
+#include <chrono>
+#include <string>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(Metrics, Renders_counters)
+{
+    MetricsRegistry registry;
+    MetricsRegistry::Counter& a = registry.counter("messages_total", "Messages.", {{"topic", "a"}});
+    MetricsRegistry::Counter& b = registry.counter("messages_total", "Messages.", {{"topic", "b"}});
+    a.increment();
+    a.increment(2);
+    b.increment();
+
+    // The same labels give the same counter
+    EXPECT_EQ(&a, &registry.counter("messages_total", "Messages.", {{"topic", "a"}}));
+    EXPECT_EQ(3u, a.value());
+
+    EXPECT_EQ(
+        "# HELP messages_total Messages.\n"
+        "# TYPE messages_total counter\n"
+        "messages_total{topic=\"a\"} 3\n"
+        "messages_total{topic=\"b\"} 1\n",
+        registry.render());
+}
+
+TEST(Metrics, Escapes_label_values)
+{
+    EXPECT_EQ("", render_labels({}));
+    EXPECT_EQ("{a=\"x\",b=\"\\\"q\\\" \\\\ \\n\"}", render_labels({{"a", "x"}, {"b", "\"q\" \\ \n"}}));
+}
+
+TEST(Metrics, Renders_histograms)
+{
+    MetricsRegistry registry;
+    MetricsRegistry::Histogram& histogram = registry.histogram("encode_seconds", "Encoding time.");
+    histogram.observe(std::chrono::microseconds(3));
+    histogram.observe(std::chrono::milliseconds(2));
+    histogram.observe(std::chrono::seconds(20));
+    {
+        const MetricsRegistry::ScopedTimer timer(&histogram);
+    }
+    {
+        // Without a histogram nothing is measured
+        const MetricsRegistry::ScopedTimer timer(nullptr);
+    }
+    EXPECT_EQ(4u, histogram.count());
+
+    const std::string output = registry.render();
+    EXPECT_NE(std::string::npos, output.find("# TYPE encode_seconds histogram\n"));
+    EXPECT_NE(std::string::npos, output.find("encode_seconds_bucket{le=\"0.005\"} 3\n"));
+    EXPECT_NE(std::string::npos, output.find("encode_seconds_bucket{le=\"10\"} 3\n"));
+    EXPECT_NE(std::string::npos, output.find("encode_seconds_bucket{le=\"+Inf\"} 4\n"));
+    EXPECT_NE(std::string::npos, output.find("encode_seconds_count 4\n"));
+}
+
+TEST(Metrics, Renders_sampled_families)
+{
+    MetricsRegistry registry;
+    unsigned int depth = 7;
+    registry.sampled("queue_depth", "Queued messages.", MetricsRegistry::Type::GAUGE,
+            [&depth](MetricsRegistry::Samples& samples)
+            {
+                samples.push_back({{{"connection", "1.2.3.4:5"}}, static_cast<double>(depth)});
+                samples.push_back({{}, 0.5});
+            });
+
+    depth = 9;
+    EXPECT_EQ(
+        "# HELP queue_depth Queued messages.\n"
+        "# TYPE queue_depth gauge\n"
+        "queue_depth{connection=\"1.2.3.4:5\"} 9\n"
+        "queue_depth 0.5\n",
+        registry.render());
+}
@@ -0,0 +1,97 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <OfflineBuffer.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(OfflineBuffer, Parses_the_configuration)
+{
+    OfflineBufferOptions options;
+    std::string error;
+    ASSERT_TRUE(parse_offline_buffer_options(YAML::Load("true"), options, error)) << error;
+    EXPECT_EQ(1024u, options.max_messages);
+    EXPECT_FALSE(options.latest_only);
+
+    ASSERT_TRUE(parse_offline_buffer_options(
+                YAML::Load("{ max_messages: 10, mode: latest }"), options, error)) << error;
+    EXPECT_EQ(10u, options.max_messages);
+    EXPECT_TRUE(options.latest_only);
+
+    ASSERT_TRUE(parse_offline_buffer_options(YAML::Load("false"), options, error)) << error;
+    EXPECT_FALSE(OfflineBuffer(options).enabled());
+
+    EXPECT_FALSE(parse_offline_buffer_options(YAML::Load("{ mode: newest }"), options, error));
+    EXPECT_FALSE(parse_offline_buffer_options(YAML::Load("{ max_messages: many }"), options, error));
+    EXPECT_FALSE(parse_offline_buffer_options(YAML::Load("[ 1 ]"), options, error));
+}
+
+TEST(OfflineBuffer, Holds_every_publication_up_to_the_limit)
+{
+    OfflineBufferOptions options;
+    options.max_messages = 3;
+    OfflineBuffer buffer(options);
+
+    buffer.add("a", "a1");
+    buffer.add("b", "b1");
+    buffer.add("a", "a2");
+    buffer.add("a", "a3");
+    EXPECT_EQ(3u, buffer.size());
+    EXPECT_EQ(1u, buffer.dropped());
+
+    EXPECT_EQ((std::vector<std::string>{"a2", "a3"}), buffer.take("a"));
+    EXPECT_TRUE(buffer.take("a").empty());
+    EXPECT_EQ(std::vector<std::string>{"b1"}, buffer.take("b"));
+    EXPECT_EQ(0u, buffer.size());
+}
+
+TEST(OfflineBuffer, Holds_the_latest_publication_of_each_topic)
+{
+    OfflineBufferOptions options;
+    options.max_messages = 2;
+    options.latest_only = true;
+    OfflineBuffer buffer(options);
+
+    buffer.add("a", "a1");
+    buffer.add("b", "b1");
+    buffer.add("a", "a2");
+    EXPECT_EQ(2u, buffer.size());
+    EXPECT_EQ(0u, buffer.dropped());
+
+    // The oldest topic is the one dropped
+    buffer.add("c", "c1");
+    EXPECT_EQ(1u, buffer.dropped());
+    EXPECT_TRUE(buffer.take("b").empty());
+    EXPECT_EQ(std::vector<std::string>{"a2"}, buffer.take("a"));
+    EXPECT_EQ(std::vector<std::string>{"c1"}, buffer.take("c"));
+    EXPECT_EQ(0u, buffer.size());
+}
+
+TEST(OfflineBuffer, Holds_nothing_if_disabled)
+{
+    OfflineBuffer buffer;
+    buffer.add("a", "a1");
+    EXPECT_EQ(0u, buffer.size());
+    EXPECT_TRUE(buffer.take("a").empty());
+}
@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <OutboundQueue.hpp>
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+/**
+ * @brief Connection double, which buffers whatever is sent until it is told to write it.
+ */
+struct FakeConnection
+{
+    std::vector<std::string> sent;
+    std::size_t buffered = 0;
+    bool disconnected = false;
+    std::vector<std::function<void()> > scheduled;
+
+    OutboundQueuePtr make_queue(
+            std::size_t max_buffered_bytes,
+            std::size_t max_messages,
+            OverflowPolicy policy = OverflowPolicy::DROP_OLDEST)
+    {
+        OutboundQueue::Options options;
+        options.max_buffered_bytes = max_buffered_bytes;
+        options.max_messages = max_messages;
+        options.policy = policy;
+
+        OutboundQueue::Hooks hooks;
+        hooks.buffered_amount = [this]()
+                {
+                    return buffered;
+                };
+        hooks.send = [this](const TlsMessagePtr& message)
+                {
+                    sent.push_back(message->get_payload());
+                    buffered += message->get_payload().size();
+                    return true;
+                };
+        hooks.disconnect = [this]()
+                {
+                    disconnected = true;
+                };
+        hooks.schedule = [this](std::function<void()> flush)
+                {
+                    scheduled.push_back(std::move(flush));
+                };
+
+        return std::make_shared<OutboundQueue>(options, std::move(hooks));
+    }
+
+    void write_all()
+    {
+        buffered = 0;
+        std::vector<std::function<void()> > flushes;
+        flushes.swap(scheduled);
+        for (const auto& flush : flushes)
+        {
+            flush();
+        }
+    }
+};
+
+TEST(OutboundQueue, Sends_while_there_is_room)
+{
+    FakeConnection connection;
+    const OutboundQueuePtr queue = connection.make_queue(10, 4);
+
+    EXPECT_EQ(OutboundQueue::Result::SENT, queue->push(make_message("12345")));
+    EXPECT_EQ(OutboundQueue::Result::SENT, queue->push(make_message("12345")));
+    EXPECT_EQ(OutboundQueue::Result::QUEUED, queue->push(make_message("abc")));
+    EXPECT_EQ(1u, queue->depth());
+    EXPECT_EQ(2u, connection.sent.size());
+    ASSERT_EQ(1u, connection.scheduled.size());
+
+    connection.write_all();
+    EXPECT_EQ(0u, queue->depth());
+    ASSERT_EQ(3u, connection.sent.size());
+    EXPECT_EQ("abc", connection.sent.back());
+    EXPECT_TRUE(connection.scheduled.empty());
+}
+
+TEST(OutboundQueue, Keeps_order)
+{
+    FakeConnection connection;
+    const OutboundQueuePtr queue = connection.make_queue(1, 8);
+
+    queue->push(make_message("a"));
+    queue->push(make_message("b"));
+    queue->push(make_message("c"));
+
+    // Once there is room, the held messages go before the new one
+    connection.buffered = 0;
+    queue->push(make_message("d"));
+    connection.write_all();
+    connection.write_all();
+    connection.write_all();
+
+    EXPECT_EQ((std::vector<std::string>{"a", "b", "c", "d"}), connection.sent);
+}
+
+TEST(OutboundQueue, Drop_policies)
+{
+    FakeConnection oldest_connection;
+    const OutboundQueuePtr oldest = oldest_connection.make_queue(1, 2, OverflowPolicy::DROP_OLDEST);
+    oldest->push(make_message("a"));
+    oldest->push(make_message("b"));
+    oldest->push(make_message("c"));
+    EXPECT_EQ(OutboundQueue::Result::QUEUED, oldest->push(make_message("d")));
+    EXPECT_EQ(1u, oldest->dropped());
+
+    oldest_connection.buffered = 0;
+    oldest->flush();
+    oldest_connection.buffered = 0;
+    oldest->flush();
+    EXPECT_EQ((std::vector<std::string>{"a", "c", "d"}), oldest_connection.sent);
+
+    FakeConnection newest_connection;
+    const OutboundQueuePtr newest = newest_connection.make_queue(1, 2, OverflowPolicy::DROP_NEWEST);
+    newest->push(make_message("a"));
+    newest->push(make_message("b"));
+    newest->push(make_message("c"));
+    EXPECT_EQ(OutboundQueue::Result::DROPPED, newest->push(make_message("d")));
+    EXPECT_EQ(1u, newest->dropped());
+    EXPECT_EQ(2u, newest->depth());
+
+    // The policy of each message prevails over the default one
+    EXPECT_EQ(OutboundQueue::Result::QUEUED, newest->push(make_message("e"), OverflowPolicy::DROP_OLDEST));
+    EXPECT_EQ(2u, newest->dropped());
+}
+
+TEST(OutboundQueue, Disconnects_on_overflow)
+{
+    FakeConnection connection;
+    const OutboundQueuePtr queue = connection.make_queue(1, 1, OverflowPolicy::DISCONNECT);
+
+    queue->push(make_message("a"));
+    queue->push(make_message("b"));
+    EXPECT_FALSE(connection.disconnected);
+
+    EXPECT_EQ(OutboundQueue::Result::DISCONNECTED, queue->push(make_message("c")));
+    EXPECT_TRUE(connection.disconnected);
+    EXPECT_EQ(0u, queue->depth());
+
+    EXPECT_EQ(OutboundQueue::Result::DROPPED, queue->push(make_message("d")));
+}
+
+TEST(OutboundQueue, Parses_policies)
+{
+    OverflowPolicy policy = OverflowPolicy::DROP_OLDEST;
+    EXPECT_TRUE(parse_overflow_policy("disconnect", policy));
+    EXPECT_EQ(OverflowPolicy::DISCONNECT, policy);
+    EXPECT_TRUE(parse_overflow_policy("drop_newest", policy));
+    EXPECT_EQ(OverflowPolicy::DROP_NEWEST, policy);
+    EXPECT_FALSE(parse_overflow_policy("drop_random", policy));
+    EXPECT_EQ(OverflowPolicy::DROP_NEWEST, policy);
+}
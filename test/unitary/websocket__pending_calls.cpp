@@ -0,0 +1,85 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <PendingCalls.hpp>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+TEST(PendingCalls, Takes_each_call_once)
+{
+    PendingCalls<std::string> calls;
+    const uint64_t first = calls.add("first");
+    const uint64_t second = calls.add("second");
+    EXPECT_NE(0u, first);
+    EXPECT_NE(first, second);
+    EXPECT_EQ(2u, calls.size());
+
+    std::string call;
+    EXPECT_TRUE(calls.take(second, call));
+    EXPECT_EQ("second", call);
+
+    // A response arriving after the call expired finds nothing
+    EXPECT_FALSE(calls.take(second, call));
+    EXPECT_FALSE(calls.take(first + second, call));
+    EXPECT_EQ(1u, calls.size());
+}
+
+TEST(PendingCalls, Parses_ids)
+{
+    uint64_t id = 0;
+    EXPECT_TRUE(PendingCalls<int>::parse_id("42", id));
+    EXPECT_EQ(42u, id);
+
+    EXPECT_FALSE(PendingCalls<int>::parse_id("", id));
+    EXPECT_FALSE(PendingCalls<int>::parse_id("0", id));
+    EXPECT_FALSE(PendingCalls<int>::parse_id("-1", id));
+    EXPECT_FALSE(PendingCalls<int>::parse_id("42a", id));
+    EXPECT_FALSE(PendingCalls<int>::parse_id("call_42", id));
+}
+
+TEST(PendingCalls, Concurrent_calls)
+{
+    PendingCalls<int> calls;
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t)
+    {
+        threads.emplace_back([&calls, t]()
+                {
+                    for (int i = 0; i < 1000; ++i)
+                    {
+                        const uint64_t id = calls.add(t * 1000 + i);
+                        int call = -1;
+                        EXPECT_TRUE(calls.take(id, call));
+                        EXPECT_EQ(t * 1000 + i, call);
+                    }
+                });
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    EXPECT_EQ(0u, calls.size());
+}
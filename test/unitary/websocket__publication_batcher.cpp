@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <PublicationBatcher.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+using namespace std::chrono_literals;
+
+/**
+ * @brief Topic double, which records the batches sent and holds the flushes requested.
+ */
+struct FakeTopic
+{
+    std::vector<std::vector<std::string>> sent;
+    std::vector<std::function<void()>> timers;
+
+    PublicationBatcherPtr make_batcher(
+            std::size_t max_messages,
+            std::size_t max_bytes = 1024)
+    {
+        PublicationBatcher::Options options;
+        options.window = 5ms;
+        options.max_messages = max_messages;
+        options.max_bytes = max_bytes;
+
+        PublicationBatcher::Hooks hooks;
+        hooks.send = [this](std::vector<std::string>&& publications)
+                {
+                    sent.push_back(std::move(publications));
+                };
+        hooks.schedule = [this](std::chrono::milliseconds delay, std::function<void()> flush)
+                {
+                    EXPECT_EQ(5ms, delay);
+                    timers.push_back(std::move(flush));
+                };
+
+        return std::make_shared<PublicationBatcher>(options, std::move(hooks));
+    }
+};
+
+TEST(PublicationBatcher, Sends_full_batches)
+{
+    FakeTopic topic;
+    const PublicationBatcherPtr batcher = topic.make_batcher(3);
+
+    for (int i = 1; i <= 7; ++i)
+    {
+        batcher->add(std::to_string(i));
+    }
+
+    ASSERT_EQ(2u, topic.sent.size());
+    EXPECT_EQ((std::vector<std::string>{"1", "2", "3"}), topic.sent[0]);
+    EXPECT_EQ((std::vector<std::string>{"4", "5", "6"}), topic.sent[1]);
+    EXPECT_EQ(1u, batcher->pending());
+    EXPECT_EQ(2u, batcher->batches());
+
+    // Only the first publication of each batch starts a window
+    EXPECT_EQ(3u, topic.timers.size());
+}
+
+TEST(PublicationBatcher, Sends_once_the_window_elapses)
+{
+    FakeTopic topic;
+    const PublicationBatcherPtr batcher = topic.make_batcher(3);
+
+    batcher->add("a");
+    batcher->add("b");
+    ASSERT_EQ(1u, topic.timers.size());
+    EXPECT_TRUE(topic.sent.empty());
+
+    topic.timers[0]();
+    ASSERT_EQ(1u, topic.sent.size());
+    EXPECT_EQ((std::vector<std::string>{"a", "b"}), topic.sent[0]);
+    EXPECT_EQ(0u, batcher->pending());
+
+    // The window of a batch already sent does not cut the next one short
+    batcher->add("c");
+    batcher->add("d");
+    batcher->add("e");
+    batcher->add("f");
+    ASSERT_EQ(3u, topic.timers.size());
+    topic.timers[1]();
+    EXPECT_EQ(2u, topic.sent.size());
+    EXPECT_EQ(1u, batcher->pending());
+
+    topic.timers[2]();
+    ASSERT_EQ(3u, topic.sent.size());
+    EXPECT_EQ(std::vector<std::string>{"f"}, topic.sent[2]);
+}
+
+TEST(PublicationBatcher, Bounds_the_batch_size)
+{
+    FakeTopic topic;
+    const PublicationBatcherPtr batcher = topic.make_batcher(100, 8);
+
+    batcher->add("aaaa");
+    batcher->add("bbb");
+    EXPECT_TRUE(topic.sent.empty());
+    batcher->add("c");
+    ASSERT_EQ(1u, topic.sent.size());
+    EXPECT_EQ((std::vector<std::string>{"aaaa", "bbb", "c"}), topic.sent[0]);
+
+    batcher->add("d");
+    batcher->flush();
+    batcher->flush();
+    ASSERT_EQ(2u, topic.sent.size());
+    EXPECT_EQ(std::vector<std::string>{"d"}, topic.sent[1]);
+}
@@ -0,0 +1,96 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+#include <gtest/gtest.h>
+
+#include <ReconnectBackoff.hpp>
+
+#include <chrono>
+#include <string>
+
+using namespace eprosima::is::sh::websocket;
+using namespace std::chrono_literals;
+
+TEST(ReconnectBackoff, Parses_the_configuration)
+{
+    ReconnectOptions options;
+    std::string error;
+    ASSERT_TRUE(parse_reconnect_options(YAML::Load(
+                "{ initial_ms: 100, max_ms: 5000, multiplier: 3, jitter: 0.25 }"), options, error)) << error;
+
+    EXPECT_EQ(100ms, options.initial_delay);
+    EXPECT_EQ(5000ms, options.max_delay);
+    EXPECT_DOUBLE_EQ(3.0, options.multiplier);
+    EXPECT_DOUBLE_EQ(0.25, options.jitter);
+}
+
+TEST(ReconnectBackoff, Rejects_invalid_settings)
+{
+    for (const std::string settings : {
+            "true", "{ initial_ms: 0 }", "{ initial_ms: soon }", "{ initial_ms: 3000, max_ms: 1000 }",
+            "{ multiplier: 0.5 }", "{ jitter: 1.5 }", "{ jitter: -0.1 }"})
+    {
+        ReconnectOptions options;
+        std::string error;
+        EXPECT_FALSE(parse_reconnect_options(YAML::Load(settings), options, error)) << settings;
+    }
+}
+
+TEST(ReconnectBackoff, Backs_off_up_to_the_limit)
+{
+    ReconnectOptions options;
+    options.initial_delay = 100ms;
+    options.max_delay = 1000ms;
+    options.multiplier = 2.0;
+    options.jitter = 0.0;
+
+    ReconnectBackoff backoff(options, 7);
+    EXPECT_EQ(100ms, backoff.next_delay());
+    EXPECT_EQ(200ms, backoff.next_delay());
+    EXPECT_EQ(400ms, backoff.next_delay());
+    EXPECT_EQ(800ms, backoff.next_delay());
+    EXPECT_EQ(1000ms, backoff.next_delay());
+    EXPECT_EQ(1000ms, backoff.next_delay());
+    EXPECT_EQ(6u, backoff.attempts());
+
+    backoff.reset();
+    EXPECT_EQ(0u, backoff.attempts());
+    EXPECT_EQ(100ms, backoff.next_delay());
+}
+
+TEST(ReconnectBackoff, Draws_the_jitter_below_the_delay)
+{
+    ReconnectOptions options;
+    options.initial_delay = 1000ms;
+    options.max_delay = 1000ms;
+    options.jitter = 0.5;
+
+    ReconnectBackoff backoff(options, 7);
+    bool varied = false;
+    std::chrono::milliseconds first = backoff.next_delay();
+    for (int i = 0; i < 100; ++i)
+    {
+        const std::chrono::milliseconds delay = backoff.next_delay();
+        EXPECT_GE(delay, 500ms);
+        EXPECT_LE(delay, 1000ms);
+        varied = varied || delay != first;
+    }
+
+    EXPECT_TRUE(varied);
+}
@@ -0,0 +1,138 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <ServiceProviders.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+static std::vector<std::shared_ptr<void>> providers_of(
+        const std::vector<ServiceProviders::Call>& calls)
+{
+    std::vector<std::shared_ptr<void>> providers;
+    for (const ServiceProviders::Call& call : calls)
+    {
+        providers.push_back(call.provider);
+    }
+    return providers;
+}
+
+TEST(ServiceProviders, Parses_options)
+{
+    ServiceProvidersOptions options;
+    std::string error;
+    EXPECT_TRUE(parse_service_providers_options(
+                YAML::Load("{balance: round_robin, max_in_flight: 4}"), options, error));
+    EXPECT_EQ(ServiceProvidersOptions::Balance::ROUND_ROBIN, options.balance);
+    EXPECT_EQ(4u, options.max_in_flight);
+
+    EXPECT_FALSE(parse_service_providers_options(YAML::Load("{balance: random}"), options, error));
+    EXPECT_FALSE(parse_service_providers_options(YAML::Load("{max_in_flight: many}"), options, error));
+}
+
+TEST(ServiceProviders, Balances_the_least_outstanding)
+{
+    ServiceProviders service;
+    const std::shared_ptr<void> first = std::make_shared<int>(1);
+    const std::shared_ptr<void> second = std::make_shared<int>(2);
+    EXPECT_TRUE(service.add_provider(first));
+    EXPECT_TRUE(service.add_provider(second));
+    EXPECT_FALSE(service.add_provider(first));
+
+    for (uint64_t id = 1; id <= 4; ++id)
+    {
+        service.submit(id, "call");
+    }
+    EXPECT_EQ(4u, service.take_ready().size());
+    EXPECT_EQ(2u, service.in_flight(first));
+    EXPECT_EQ(2u, service.in_flight(second));
+
+    EXPECT_TRUE(service.take_ready().empty());
+
+    // Both finished calls were on the first provider, which takes the next ones
+    EXPECT_TRUE(service.complete(1));
+    EXPECT_TRUE(service.complete(3));
+    EXPECT_FALSE(service.complete(3));
+
+    service.submit(5, "call");
+    service.submit(6, "call");
+    EXPECT_EQ((std::vector<std::shared_ptr<void>>{first, first}), providers_of(service.take_ready()));
+    EXPECT_EQ(2u, service.in_flight(first));
+    EXPECT_EQ(2u, service.in_flight(second));
+}
+
+TEST(ServiceProviders, Takes_turns_in_round_robin)
+{
+    ServiceProvidersOptions options;
+    options.balance = ServiceProvidersOptions::Balance::ROUND_ROBIN;
+    ServiceProviders service;
+    service.configure(options);
+
+    const std::shared_ptr<void> first = std::make_shared<int>(1);
+    const std::shared_ptr<void> second = std::make_shared<int>(2);
+    const std::shared_ptr<void> third = std::make_shared<int>(3);
+    service.add_provider(first);
+    service.add_provider(second);
+    service.add_provider(third);
+
+    for (uint64_t id = 1; id <= 4; ++id)
+    {
+        service.submit(id, "call");
+    }
+    EXPECT_EQ((std::vector<std::shared_ptr<void>>{first, second, third, first}), providers_of(service.take_ready()));
+}
+
+TEST(ServiceProviders, Calls_wait_for_a_free_provider)
+{
+    ServiceProvidersOptions options;
+    options.max_in_flight = 1;
+    ServiceProviders service;
+    service.configure(options);
+
+    // Without providers, calls wait for one to show up
+    service.submit(1, "first");
+    service.submit(2, "second");
+    service.submit(3, "third");
+    EXPECT_TRUE(service.take_ready().empty());
+
+    const std::shared_ptr<void> provider = std::make_shared<int>(1);
+    service.add_provider(provider);
+    auto ready = service.take_ready();
+    ASSERT_EQ(1u, ready.size());
+    EXPECT_EQ(1u, ready[0].id);
+    EXPECT_EQ("first", ready[0].payload);
+    EXPECT_EQ(provider, ready[0].provider);
+    EXPECT_EQ(2u, service.waiting());
+
+    // A waiting call which is given up leaves the queue
+    EXPECT_TRUE(service.complete(2));
+    EXPECT_TRUE(service.complete(1));
+    ready = service.take_ready();
+    ASSERT_EQ(1u, ready.size());
+    EXPECT_EQ(3u, ready[0].id);
+
+    // The calls in flight on a provider which is gone are forgotten
+    EXPECT_TRUE(service.remove_provider(provider));
+    EXPECT_FALSE(service.complete(3));
+    EXPECT_EQ(0u, service.providers());
+}
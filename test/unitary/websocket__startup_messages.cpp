@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <StartupMessages.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+
+static std::string join(
+        const std::vector<std::string>& messages)
+{
+    std::string batch = "[";
+    for (const std::string& message : messages)
+    {
+        batch += message + ";";
+    }
+    return batch + "]";
+}
+
+TEST(StartupMessages, Deduplicates_by_key)
+{
+    StartupMessages messages;
+    EXPECT_TRUE(messages.set("advertise:a", "a"));
+    EXPECT_TRUE(messages.set("advertise:b", "b"));
+    EXPECT_FALSE(messages.set("advertise:a", "a"));
+    EXPECT_EQ((std::vector<std::string>{"a", "b"}), messages.frames());
+
+    // A replaced message keeps its position
+    EXPECT_TRUE(messages.set("advertise:a", "A"));
+    EXPECT_EQ((std::vector<std::string>{"A", "b"}), messages.frames());
+
+    EXPECT_TRUE(messages.remove("advertise:a"));
+    EXPECT_FALSE(messages.remove("advertise:a"));
+    EXPECT_EQ(1u, messages.size());
+    EXPECT_EQ((std::vector<std::string>{"b"}), messages.frames());
+}
+
+TEST(StartupMessages, Batches_up_to_the_frame_size)
+{
+    int batches = 0;
+    StartupMessages messages(
+        [&batches](const std::vector<std::string>& batch)
+        {
+            ++batches;
+            return join(batch);
+        }, 4);
+
+    for (const std::string name : {"aa", "bb", "cc", "dd", "e"})
+    {
+        messages.set(name, name);
+    }
+
+    EXPECT_EQ((std::vector<std::string>{"[aa;bb;]", "[cc;dd;]", "e"}), messages.frames());
+    EXPECT_EQ(2, batches);
+
+    // The frames are only built again once the messages change
+    messages.frames();
+    EXPECT_EQ(2, batches);
+    messages.set("f", "f");
+    EXPECT_EQ((std::vector<std::string>{"[aa;bb;]", "[cc;dd;]", "[e;f;]"}), messages.frames());
+    EXPECT_EQ(5, batches);
+}
+
+TEST(StartupMessages, Never_batches_beyond_the_frame_size)
+{
+    StartupMessages messages(
+        [](const std::vector<std::string>& batch)
+        {
+            return join(batch);
+        }, 5);
+
+    for (const std::string name : {"aa", "bbb", "cc", "dddddd", "e"})
+    {
+        messages.set(name, name);
+    }
+
+    EXPECT_EQ((std::vector<std::string>{"[aa;bbb;]", "cc", "dddddd", "e"}), messages.frames());
+}
+
+TEST(StartupMessages, Sends_one_by_one_without_batches)
+{
+    StartupMessages messages(
+        [](const std::vector<std::string>&)
+        {
+            return std::string();
+        });
+
+    messages.set("a", "a");
+    messages.set("b", "b");
+    EXPECT_EQ((std::vector<std::string>{"a", "b"}), messages.frames());
+}
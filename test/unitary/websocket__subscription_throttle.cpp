@@ -0,0 +1,124 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <SubscriptionThrottle.hpp>
+
+#include <string>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+using namespace std::chrono_literals;
+
+/**
+ * @brief Subscriber double, which records the messages sent and the releases requested.
+ */
+struct FakeSubscriber
+{
+    std::vector<std::string> sent;
+    std::vector<std::chrono::milliseconds> delays;
+
+    SubscriptionThrottlePtr make_throttle(
+            std::chrono::milliseconds throttle_rate,
+            std::size_t queue_length)
+    {
+        SubscriptionThrottle::Hooks hooks;
+        hooks.send = [this](const TlsMessagePtr& message)
+                {
+                    sent.push_back(message->get_payload());
+                };
+        hooks.schedule = [this](std::chrono::milliseconds delay, std::function<void()>)
+                {
+                    delays.push_back(delay);
+                };
+
+        return std::make_shared<SubscriptionThrottle>(throttle_rate, queue_length, std::move(hooks));
+    }
+};
+
+TEST(SubscriptionThrottle, Coalesces_to_latest_value)
+{
+    FakeSubscriber subscriber;
+    const SubscriptionThrottlePtr throttle = subscriber.make_throttle(100ms, 0);
+    const SubscriptionThrottle::Clock::time_point start = SubscriptionThrottle::Clock::now();
+
+    throttle->offer(make_message("1"), start);
+    for (int i = 2; i <= 100; ++i)
+    {
+        throttle->offer(make_message(std::to_string(i)), start + std::chrono::milliseconds(i - 1));
+    }
+
+    EXPECT_EQ(std::vector<std::string>{"1"}, subscriber.sent);
+    EXPECT_EQ(1u, throttle->pending());
+    EXPECT_EQ(98u, throttle->coalesced());
+    ASSERT_EQ(1u, subscriber.delays.size());
+    EXPECT_EQ(99ms, subscriber.delays.front());
+
+    throttle->release(start + 100ms);
+    EXPECT_EQ((std::vector<std::string>{"1", "100"}), subscriber.sent);
+    EXPECT_EQ(0u, throttle->pending());
+
+    // Once the throttle rate has elapsed, the next message is sent right away
+    throttle->offer(make_message("101"), start + 250ms);
+    EXPECT_EQ("101", subscriber.sent.back());
+}
+
+TEST(SubscriptionThrottle, Holds_queue_length_messages)
+{
+    FakeSubscriber subscriber;
+    const SubscriptionThrottlePtr throttle = subscriber.make_throttle(10ms, 2);
+    const SubscriptionThrottle::Clock::time_point start = SubscriptionThrottle::Clock::now();
+
+    throttle->offer(make_message("a"), start);
+    throttle->offer(make_message("b"), start + 1ms);
+    throttle->offer(make_message("c"), start + 2ms);
+    throttle->offer(make_message("d"), start + 3ms);
+    EXPECT_EQ(2u, throttle->pending());
+    EXPECT_EQ(1u, throttle->coalesced());
+
+    // The held messages are released one per throttle period
+    throttle->release(start + 10ms);
+    EXPECT_EQ((std::vector<std::string>{"a", "c"}), subscriber.sent);
+    ASSERT_EQ(2u, subscriber.delays.size());
+    EXPECT_EQ(10ms, subscriber.delays.back());
+
+    throttle->release(start + 15ms);
+    EXPECT_EQ(2u, subscriber.sent.size());
+
+    throttle->release(start + 20ms);
+    EXPECT_EQ((std::vector<std::string>{"a", "c", "d"}), subscriber.sent);
+}
+
+TEST(SubscriptionThrottle, Reconfigures)
+{
+    FakeSubscriber subscriber;
+    const SubscriptionThrottlePtr throttle = subscriber.make_throttle(10ms, 4);
+    const SubscriptionThrottle::Clock::time_point start = SubscriptionThrottle::Clock::now();
+
+    throttle->offer(make_message("a"), start);
+    throttle->offer(make_message("b"), start);
+    throttle->offer(make_message("c"), start);
+    EXPECT_EQ(2u, throttle->pending());
+
+    throttle->configure(10ms, 0);
+    EXPECT_EQ(1u, throttle->pending());
+
+    throttle->release(start + 10ms);
+    EXPECT_EQ((std::vector<std::string>{"a", "c"}), subscriber.sent);
+}
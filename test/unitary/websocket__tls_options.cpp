@@ -0,0 +1,211 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <TlsOptions.hpp>
+
+#include "paths.hpp"
+
+#include <openssl/ssl.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+using namespace eprosima::is::sh::websocket;
+
+namespace {
+
+using Context = boost::asio::ssl::context;
+
+std::string certs_dir()
+{
+    return test::test_dir + "/integration/resources/certs";
+}
+
+std::string write_ticket_keys(
+        const std::string& name,
+        std::size_t size)
+{
+    const std::string path = (std::filesystem::temp_directory_path() / name).string();
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        file.put(static_cast<char>(i * 7 + 3));
+    }
+    return path;
+}
+
+void make_server(
+        Context& context,
+        const TlsOptions& options)
+{
+    context.use_certificate_chain_file(certs_dir() + "/websocket_test.crt");
+    context.use_private_key_file(certs_dir() + "/websocket_test.key", Context::pem);
+
+    std::string error;
+    ASSERT_TRUE(apply_tls_options(context, options, TlsRole::SERVER, error)) << error;
+}
+
+void make_client(
+        Context& context,
+        const TlsOptions& options,
+        TlsSessionCache& cache)
+{
+    std::string error;
+    ASSERT_TRUE(apply_tls_options(context, options, TlsRole::CLIENT, error)) << error;
+    cache.attach(context);
+}
+
+// Runs a whole handshake in memory, and reports whether the client resumed its session
+bool handshake(
+        Context& server_context,
+        Context& client_context,
+        TlsSessionCache& cache)
+{
+    SSL* server = SSL_new(server_context.native_handle());
+    SSL* client = SSL_new(client_context.native_handle());
+    BIO* server_bio = nullptr;
+    BIO* client_bio = nullptr;
+    BIO_new_bio_pair(&server_bio, 0, &client_bio, 0);
+    SSL_set_bio(server, server_bio, server_bio);
+    SSL_set_bio(client, client_bio, client_bio);
+    SSL_set_accept_state(server);
+    SSL_set_connect_state(client);
+
+    cache.prepare(client);
+
+    bool server_done = false;
+    bool client_done = false;
+    for (int i = 0; i < 20 && !(server_done && client_done); ++i)
+    {
+        client_done = client_done || 1 == SSL_do_handshake(client);
+        server_done = server_done || 1 == SSL_do_handshake(server);
+    }
+    EXPECT_TRUE(server_done && client_done);
+
+    // TLS 1.3 tickets come after the handshake
+    char buffer[16];
+    SSL_read(client, buffer, sizeof(buffer));
+
+    const bool resumed = cache.handshake_completed(client);
+    SSL_free(client);
+    SSL_free(server);
+    return resumed;
+}
+
+} // anonymous namespace
+
+TEST(TlsOptions, Parses_the_configuration)
+{
+    TlsOptions options;
+    std::string error;
+    ASSERT_TRUE(parse_tls_options(YAML::Load(
+                "{ min_version: '1.2', max_version: '1.3', ciphers: 'HIGH:!aNULL',"
+                "  ciphersuites: TLS_AES_128_GCM_SHA256, session_cache: { size: 64, timeout: 600 },"
+                "  session_tickets: false, ticket_key_file: keys.bin, resume_sessions: false }"),
+            options, error)) << error;
+
+    EXPECT_EQ("1.2", options.min_version);
+    EXPECT_EQ("1.3", options.max_version);
+    EXPECT_EQ("HIGH:!aNULL", options.ciphers);
+    EXPECT_EQ("TLS_AES_128_GCM_SHA256", options.ciphersuites);
+    EXPECT_EQ(64u, options.session_cache_size);
+    EXPECT_EQ(std::chrono::seconds(600), options.session_timeout);
+    EXPECT_FALSE(options.session_tickets);
+    EXPECT_EQ("keys.bin", options.ticket_key_file);
+    EXPECT_EQ("is-websocket", options.session_id_context);
+    EXPECT_FALSE(options.resume_sessions);
+
+    // The cache may also be turned off altogether
+    ASSERT_TRUE(parse_tls_options(YAML::Load("{ session_cache: false }"), options, error)) << error;
+    EXPECT_EQ(0u, options.session_cache_size);
+}
+
+TEST(TlsOptions, Rejects_invalid_settings)
+{
+    TlsOptions options;
+    std::string error;
+    EXPECT_FALSE(parse_tls_options(YAML::Load("{ min_version: '1.4' }"), options, error));
+    EXPECT_FALSE(parse_tls_options(YAML::Load("{ session_tickets: maybe }"), options, error));
+    EXPECT_FALSE(parse_tls_options(YAML::Load(
+                "{ session_id_context: " + std::string(SSL_MAX_SID_CTX_LENGTH + 1, 'x') + " }"),
+            options, error));
+
+    Context context(Context::tls_server);
+    options = TlsOptions();
+    options.ciphers = "NOT-A-CIPHER";
+    EXPECT_FALSE(apply_tls_options(context, options, TlsRole::SERVER, error));
+
+    options = TlsOptions();
+    options.ticket_key_file = write_ticket_keys("is-websocket-short-keys.bin", 32);
+    EXPECT_FALSE(apply_tls_options(context, options, TlsRole::SERVER, error));
+    std::filesystem::remove(options.ticket_key_file);
+}
+
+TEST(TlsOptions, Client_resumes_its_last_session)
+{
+    for (const std::string version : {"1.2", "1.3"})
+    {
+        TlsOptions options;
+        options.min_version = version;
+        options.max_version = version;
+
+        Context server_context(Context::tls_server);
+        make_server(server_context, options);
+
+        Context client_context(Context::tls_client);
+        TlsSessionCache cache;
+        make_client(client_context, options, cache);
+
+        EXPECT_FALSE(handshake(server_context, client_context, cache)) << version;
+        EXPECT_TRUE(cache.has_session()) << version;
+        EXPECT_TRUE(handshake(server_context, client_context, cache)) << version;
+        EXPECT_TRUE(handshake(server_context, client_context, cache)) << version;
+        EXPECT_EQ(2u, cache.resumptions()) << version;
+
+        cache.clear();
+        EXPECT_FALSE(handshake(server_context, client_context, cache)) << version;
+    }
+}
+
+TEST(TlsOptions, Servers_sharing_ticket_keys_resume_each_others_sessions)
+{
+    TlsOptions options;
+    options.ticket_key_file = write_ticket_keys("is-websocket-ticket-keys.bin", 80);
+
+    Context first_server(Context::tls_server);
+    make_server(first_server, options);
+    Context second_server(Context::tls_server);
+    make_server(second_server, options);
+
+    Context client_context(Context::tls_client);
+    TlsSessionCache cache;
+    make_client(client_context, options, cache);
+
+    EXPECT_FALSE(handshake(first_server, client_context, cache));
+    EXPECT_TRUE(handshake(second_server, client_context, cache));
+
+    // Servers with their own keys do not
+    Context other_server(Context::tls_server);
+    make_server(other_server, TlsOptions());
+    EXPECT_FALSE(handshake(other_server, client_context, cache));
+
+    std::filesystem::remove(options.ticket_key_file);
+}
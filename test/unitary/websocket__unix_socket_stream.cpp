@@ -0,0 +1,223 @@
+/*
+ * Copyright (C) 2019 Open Source Robotics Foundation
+ * Copyright (C) 2020 - present Proyectos y Sistemas de Mantenimiento SL (eProsima).
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ *
+ */
+
+
+
+#include <gtest/gtest.h>
+
+#include <UnixSocketStream.hpp>
+
+#include <boost/asio/read.hpp>
+#include <boost/asio/write.hpp>
+
+#include <unistd.h>
+
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace eprosima::is::sh::websocket;
+using namespace std::chrono_literals;
+
+namespace {
+
+using boost::asio::local::stream_protocol;
+
+/**
+ * @brief Accepts a single connection on a Unix socket into a UnixSocketStream, and connects a
+ *        plain socket to it, while a couple of threads run the io_service.
+ */
+class UnixSocketStreamTest : public ::testing::Test
+{
+protected:
+
+    void SetUp() override
+    {
+        _path = "/tmp/websocket__unix_socket_stream_" + std::to_string(::getpid()) + ".sock";
+        ::unlink(_path.c_str());
+
+        stream_protocol::acceptor acceptor(_io_service, stream_protocol::endpoint(_path));
+        stream = std::make_shared<UnixSocketStream>(_io_service);
+        peer.connect(stream_protocol::endpoint(_path));
+        acceptor.accept(stream->socket());
+
+        for (std::thread& thread : _threads)
+        {
+            thread = std::thread([this]()
+                            {
+                                _io_service.run();
+                            });
+        }
+    }
+
+    void TearDown() override
+    {
+        stream->close();
+        _work.reset();
+        for (std::thread& thread : _threads)
+        {
+            thread.join();
+        }
+
+        ::unlink(_path.c_str());
+    }
+
+    boost::asio::io_service _io_service;
+    std::unique_ptr<boost::asio::io_service::work> _work =
+            std::make_unique<boost::asio::io_service::work>(_io_service);
+    std::thread _threads[2];
+    std::string _path;
+
+    std::shared_ptr<UnixSocketStream> stream;
+    stream_protocol::socket peer{_io_service};
+};
+
+} // anonymous namespace
+
+TEST_F(UnixSocketStreamTest, Reads_and_writes_through_the_socket)
+{
+    std::promise<std::string> received;
+    stream->start([&received](const char* data, std::size_t size)
+            {
+                received.set_value(std::string(data, size));
+            }, nullptr, 0ms);
+
+    boost::asio::write(peer, boost::asio::buffer(std::string("ping")));
+    auto future = received.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(5s));
+    EXPECT_EQ("ping", future.get());
+
+    stream->write("pong");
+    std::string reply(4, '\0');
+    boost::asio::read(peer, boost::asio::buffer(&reply[0], reply.size()));
+    EXPECT_EQ("pong", reply);
+
+    for (int i = 0; i < 100 && stream->pending_bytes() > 0; ++i)
+    {
+        std::this_thread::sleep_for(10ms);
+    }
+    EXPECT_EQ(0u, stream->pending_bytes());
+}
+
+TEST_F(UnixSocketStreamTest, Reports_the_bytes_not_written_yet)
+{
+    stream->start([](const char*, std::size_t)
+            {
+            }, nullptr, 0ms);
+
+    // The peer reads nothing, so the socket buffers fill up and the rest stays queued
+    const std::string chunk(1024 * 1024, 'x');
+    for (int i = 0; i < 16; ++i)
+    {
+        stream->write(chunk);
+    }
+
+    std::this_thread::sleep_for(100ms);
+    EXPECT_GT(stream->pending_bytes(), 0u);
+    EXPECT_LE(stream->pending_bytes(), 16 * chunk.size());
+}
+
+TEST_F(UnixSocketStreamTest, Writes_from_several_threads_are_not_interleaved)
+{
+    stream->start([](const char*, std::size_t)
+            {
+            }, nullptr, 0ms);
+
+    constexpr std::size_t chunk_size = 64 * 1024;
+    constexpr int writes_per_thread = 8;
+    std::vector<std::thread> writers;
+    for (char letter : {'a', 'b', 'c', 'd'})
+    {
+        writers.emplace_back([this, letter]()
+                {
+                    for (int i = 0; i < writes_per_thread; ++i)
+                    {
+                        stream->write(std::string(chunk_size, letter));
+                    }
+                });
+    }
+
+    std::string received(4 * writes_per_thread * chunk_size, '\0');
+    boost::asio::read(peer, boost::asio::buffer(&received[0], received.size()));
+    for (std::thread& writer : writers)
+    {
+        writer.join();
+    }
+
+    for (std::size_t offset = 0; offset < received.size(); offset += chunk_size)
+    {
+        EXPECT_EQ(std::string(chunk_size, received[offset]), received.substr(offset, chunk_size)) << offset;
+    }
+}
+
+TEST_F(UnixSocketStreamTest, Closes_if_the_handshake_times_out)
+{
+    std::promise<boost::system::error_code> closed;
+    stream->start([](const char*, std::size_t)
+            {
+            }, [&closed](const boost::system::error_code& ec)
+            {
+                closed.set_value(ec);
+            }, 50ms);
+
+    auto future = closed.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(5s));
+    EXPECT_EQ(boost::asio::error::timed_out, future.get());
+}
+
+TEST_F(UnixSocketStreamTest, Closes_once_idle_for_too_long)
+{
+    std::promise<boost::system::error_code> closed;
+    stream->start([](const char*, std::size_t)
+            {
+            }, [&closed](const boost::system::error_code& ec)
+            {
+                closed.set_value(ec);
+            }, 50ms);
+    stream->opened(300ms);
+
+    // The traffic keeps it open past the handshake timeout
+    auto future = closed.get_future();
+    for (int i = 0; i < 5; ++i)
+    {
+        boost::asio::write(peer, boost::asio::buffer(std::string("ping")));
+        EXPECT_EQ(std::future_status::timeout, future.wait_for(100ms));
+    }
+
+    ASSERT_EQ(std::future_status::ready, future.wait_for(5s));
+    EXPECT_EQ(boost::asio::error::timed_out, future.get());
+}
+
+TEST_F(UnixSocketStreamTest, Reports_the_peer_closing_it)
+{
+    std::promise<boost::system::error_code> closed;
+    stream->start([](const char*, std::size_t)
+            {
+            }, [&closed](const boost::system::error_code& ec)
+            {
+                closed.set_value(ec);
+            }, 0ms);
+
+    peer.close();
+
+    auto future = closed.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(5s));
+    EXPECT_EQ(boost::asio::error::eof, future.get());
+}